@@ -0,0 +1,101 @@
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' HOST FRAME DECODER ''''''''''''''''''' //
+// Decodes batches of insole frames (the SensorData wire layout sent by
+// BLE_SendBuffer()) straight into structure-of-arrays columns.
+
+#define FRAME_SIZE_RAW          sizeof(SensorData)       // 39 bytes
+#define FRAME_SIZE_TIMESTAMPED  (4 + sizeof(SensorData)) // uint32 LE milliseconds + frame
+
+// Wire offsets inside one SensorData frame
+#define FRAME_OFS_BATTERY   0
+#define FRAME_OFS_ACCEL_X   1
+#define FRAME_OFS_ACCEL_Y   3
+#define FRAME_OFS_ACCEL_Z   5
+#define FRAME_OFS_PRESSURE  7
+
+typedef enum {
+    DECODER_OK = 0,
+    DECODER_ERR_ARGS,          // null pointers or invalid layout
+    DECODER_ERR_TRUNCATED,     // trailing bytes that do not form a whole record
+    DECODER_ERR_CAPACITY,      // more records than the output columns can hold
+    DECODER_ERR_TIMESTAMP,     // timestamps going backwards (records are still decoded)
+    DECODER_ERR_FORMAT         // unknown packed format or shift
+} DecoderStatus_t;
+
+// Record layout inside a byte stream: one frame every `stride` bytes
+typedef struct {
+    size_t stride;          // bytes per record
+    size_t frameOffset;     // offset of the SensorData payload inside the record
+    int    timestampOffset; // offset of a uint32 LE timestamp, -1 if none
+} FrameLayout;
+
+static const FrameLayout FRAME_LAYOUT_RAW         = { FRAME_SIZE_RAW, 0, -1 };
+static const FrameLayout FRAME_LAYOUT_TIMESTAMPED = { FRAME_SIZE_TIMESTAMPED, 4, 0 };
+
+// Caller-owned output columns, `capacity` rows each. timestamp, valid and
+// adcHealthy may be null; only packed frames carry the last two (see
+// FrameCodecModule.h), so Decoder_DecodeBatch leaves them untouched.
+typedef struct {
+    size_t    capacity;
+    uint32_t* timestamp;
+    uint8_t*  battery;
+    int16_t*  accel_x;
+    int16_t*  accel_y;
+    int16_t*  accel_z;
+    uint16_t* pressure[PRESSURE_CHANNEL_COUNT];
+    PressureMask_t* valid;      // bit n => pressure[n] converted for this frame, else held
+    uint8_t*  adcHealthy;       // bit n => ADS1115 n in the scan
+} FrameColumns;
+
+typedef struct {
+    DecoderStatus_t status;
+    size_t frames;          // rows written
+    size_t bytesConsumed;   // bytes of input covered by those rows
+} DecoderResult;
+
+/**
+ * @brief Decodes every whole record of `buf` into `out`, starting at row `row`.
+ *        Never reads past `len` and never writes past `out->capacity`.
+ */
+DecoderResult Decoder_DecodeBatch(const uint8_t* buf, size_t len, const FrameLayout& layout,
+                                  FrameColumns& out, size_t row = 0);
+
+// Zero-copy access to frame `index` of a buffer without decoding the batch
+class FrameView {
+public:
+    FrameView(const uint8_t* buf, size_t len, const FrameLayout& layout)
+        : m_buf(buf), m_layout(layout), m_count(layout.stride ? len / layout.stride : 0) {}
+
+    size_t   size() const { return m_count; }
+    const uint8_t* frame(size_t i) const { return m_buf + i * m_layout.stride + m_layout.frameOffset; }
+    uint8_t  battery(size_t i) const { return frame(i)[FRAME_OFS_BATTERY]; }
+    int16_t  accel(size_t i, int axis) const { return (int16_t)le16(frame(i) + FRAME_OFS_ACCEL_X + 2 * axis); }
+    uint16_t pressure(size_t i, int ch) const { return le16(frame(i) + FRAME_OFS_PRESSURE + 2 * ch); }
+    uint32_t timestamp(size_t i) const;
+
+private:
+    static uint16_t le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+    const uint8_t* m_buf;
+    FrameLayout    m_layout;
+    size_t         m_count;
+};
+
+/**
+ * @brief Decodes a concatenation of packed frames (FrameCodecModule.h, header byte first),
+ *        e.g. the payload of one or more notifications, into `out` starting at row `row`.
+ *        Pressure values are scaled back to ADC counts, the frame status goes to the
+ *        valid/adcHealthy columns. Stops at the first malformed frame.
+ */
+DecoderResult Decoder_DecodePacked(const uint8_t* buf, size_t len, FrameColumns& out, size_t row = 0);
+
+const char* Decoder_StatusString(DecoderStatus_t status);
+
+#endif // FRAME_DECODER_H
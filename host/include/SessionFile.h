@@ -0,0 +1,163 @@
+#ifndef SESSION_FILE_H
+#define SESSION_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "CommonTypes.h"
+#include "FrameDecoder.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' SESSION FILE ''''''''''''''''''' //
+// Chunked, columnar container for recorded insole sessions (one file per foot).
+//
+//   [SessionFileHeader]
+//   [chunk 0: one block per column, each 8-byte aligned] [chunk 1] ...
+//   [SessionChunkIndex x chunkCount]      <- header.indexOffset
+//
+// Every chunk holds up to chunkRows rows. Each column block is either raw
+// little-endian values, readable in place from the mapping, or zigzag varint
+// deltas. The index keeps per-chunk min/max of every column, so time ranges
+// and value predicates skip whole chunks without touching their data.
+// Timestamps must be non-decreasing. Little-endian hosts only.
+
+#define SESSION_MAGIC               0x53455349u   // "ISES" little-endian
+#define SESSION_VERSION             1
+#define SESSION_COLUMN_COUNT        (5 + PRESSURE_CHANNEL_COUNT)
+#define SESSION_DEFAULT_CHUNK_ROWS  4096
+
+typedef enum {
+    SESSION_COL_TIMESTAMP = 0,  // uint32 ms
+    SESSION_COL_BATTERY,        // uint8
+    SESSION_COL_ACCEL_X,        // int16
+    SESSION_COL_ACCEL_Y,
+    SESSION_COL_ACCEL_Z,
+    SESSION_COL_PRESSURE0       // uint16, PRESSURE_CHANNEL_COUNT columns
+} SessionColumn_t;
+
+typedef enum {
+    SESSION_ENC_RAW = 0,        // plain values
+    SESSION_ENC_DELTA_VARINT    // first value and deltas, zigzag LEB128
+} SessionEncoding_t;
+
+typedef enum {
+    SESSION_OK = 0,
+    SESSION_ERR_ARGS,           // null pointers, file not open
+    SESSION_ERR_IO,             // open/write/mmap failed
+    SESSION_ERR_FORMAT,         // bad magic, version or index
+    SESSION_ERR_TIMESTAMP,      // timestamp older than the previous row
+    SESSION_ERR_CAPACITY        // output columns too small
+} SessionStatus_t;
+
+#pragma pack(push, 1)
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t columns;           // SESSION_COLUMN_COUNT
+    uint32_t chunkRows;         // max rows per chunk
+    uint32_t chunkCount;
+    uint64_t rowCount;
+    uint64_t indexOffset;       // 0 while the writer is open
+} SessionFileHeader;            // 32 bytes
+
+typedef struct {
+    uint64_t offset;            // file offset of the block
+    uint32_t bytes;             // block size
+    uint8_t  encoding;          // SessionEncoding_t
+    uint8_t  reserved[3];
+    int64_t  min;
+    int64_t  max;
+} SessionColumnIndex;           // 32 bytes
+
+typedef struct {
+    uint64_t firstRow;
+    uint32_t rows;
+    uint32_t reserved;
+    SessionColumnIndex column[SESSION_COLUMN_COUNT];
+} SessionChunkIndex;
+#pragma pack(pop)
+
+typedef struct {
+    uint32_t chunkRows;         // rows per chunk, SESSION_DEFAULT_CHUNK_ROWS if 0
+    bool     deltaEncode;       // per column, keep the delta block when it is smaller than raw
+} SessionWriterOptions;
+
+typedef struct {
+    SessionStatus_t status;
+    size_t rows;                // rows written to the output columns
+} SessionResult;
+
+// Bytes per value of a column
+size_t Session_ColumnWidth(int column);
+
+const char* Session_StatusString(SessionStatus_t status);
+
+class SessionWriter {
+public:
+    SessionWriter() {}
+    ~SessionWriter() { close(); }
+
+    SessionStatus_t open(const char* path, const SessionWriterOptions& options);
+    SessionStatus_t append(uint32_t timestamp, const SensorData& frame);
+    // Appends `rows` rows of decoded columns (timestamp column required)
+    SessionStatus_t append(const FrameColumns& columns, size_t rows);
+    // Flushes the last chunk and writes the index; called by the destructor
+    SessionStatus_t close();
+
+    uint64_t rowCount() const { return m_rowCount; }
+
+private:
+    SessionStatus_t flushChunk();
+    SessionStatus_t writeBlock(const uint8_t* data, size_t len, uint64_t* offset);
+
+    FILE*    m_file = nullptr;
+    SessionWriterOptions m_options = { SESSION_DEFAULT_CHUNK_ROWS, false };
+    std::vector<int64_t> m_pending[SESSION_COLUMN_COUNT];
+    std::vector<SessionChunkIndex> m_index;
+    std::vector<uint8_t> m_raw;
+    std::vector<uint8_t> m_delta;
+    uint64_t m_offset = 0;
+    uint64_t m_rowCount = 0;
+    int64_t  m_lastTimestamp = -1;
+};
+
+class SessionReader {
+public:
+    SessionReader() {}
+    ~SessionReader() { close(); }
+
+    // Maps the file read-only and validates header, index and the order of every chunk's timestamps
+    SessionStatus_t open(const char* path);
+    void close();
+
+    uint64_t rowCount() const { return m_header ? m_header->rowCount : 0; }
+    size_t   chunkCount() const { return m_header ? m_header->chunkCount : 0; }
+    const SessionChunkIndex& chunk(size_t i) const { return m_index[i]; }
+
+    // First and one-past-last chunk that may hold timestamps in [t0, t1]
+    void findChunks(uint32_t t0, uint32_t t1, size_t* first, size_t* last) const;
+
+    // True if the chunk's [min, max] of the column overlaps [lo, hi]
+    bool chunkMayContain(size_t chunk, int column, int64_t lo, int64_t hi) const;
+
+    // Pointer to the column values inside the mapping, nullptr if the block is not raw
+    const void* columnData(size_t chunk, int column) const;
+
+    // Decodes a chunk's column into dst (chunk(i).rows values of Session_ColumnWidth(column) bytes)
+    SessionStatus_t readColumn(size_t chunk, int column, void* dst) const;
+
+    /**
+     * @brief Copies every row with t0 <= timestamp <= t1 into `out`, starting at row `row`.
+     *        out.timestamp may be null.
+     */
+    SessionResult readRange(uint32_t t0, uint32_t t1, FrameColumns& out, size_t row = 0) const;
+
+private:
+    const uint8_t* m_map = nullptr;
+    size_t m_size = 0;
+    const SessionFileHeader* m_header = nullptr;
+    const SessionChunkIndex* m_index = nullptr;
+};
+
+#endif // SESSION_FILE_H
@@ -0,0 +1,66 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' SPSC QUEUE ''''''''''''''''''' //
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread at a time. Capacity is a power of two; head and tail live on their
+// own cache lines so producer and consumer do not share a line.
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // false if the queue is full; the item is not consumed
+    bool tryPush(const T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == Capacity) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == Capacity) {
+                return false;
+            }
+        }
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns a pointer to the oldest item, or nullptr if empty; call pop() when done with it
+    const T* front()
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) {
+                return nullptr;
+            }
+        }
+        return &m_items[head & (Capacity - 1)];
+    }
+
+    void pop()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    alignas(64) std::atomic<size_t> m_head{0};  // consumer
+    size_t m_tailCache = 0;                     // consumer's view of m_tail
+    alignas(64) std::atomic<size_t> m_tail{0};  // producer
+    size_t m_headCache = 0;                     // producer's view of m_head
+    alignas(64) T m_items[Capacity];
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,57 @@
+#ifndef ADAFRUIT_ADS1X15_SHIM_H
+#define ADAFRUIT_ADS1X15_SHIM_H
+
+#include "Wire.h"
+
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_0  (0x4000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_1  (0x5000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_2  (0x6000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_3  (0x7000)
+#define RATE_ADS1115_860SPS              (0x00E0)
+
+typedef enum { GAIN_TWOTHIRDS, GAIN_ONE, GAIN_TWO } adsGain_t;
+
+// ''''''' FAULT INJECTION ''''''''''''''''''' //
+// Every device is addressed by bus (0 => Wire, 1 => Wire1) and I2C address.
+// Devices start absent, so tools that never program one see an empty bus and
+// the driver's error paths are what runs.
+typedef enum {
+    SHIM_ADS_ABSENT,        // begin() fails
+    SHIM_ADS_OK,            // converts Shim_AdsValue()
+    SHIM_ADS_READ_ERROR,    // answers, but conversions read back negative
+    SHIM_ADS_TIMEOUT        // answers, but conversions never complete
+} ShimAdsMode_t;
+
+void Shim_AdsSetMode(uint8_t bus, uint8_t address, ShimAdsMode_t mode);
+ShimAdsMode_t Shim_AdsGetMode(uint8_t bus, uint8_t address);
+// What a working device converts on an input: identifies bus, address and input
+int16_t Shim_AdsValue(uint8_t bus, uint8_t address, uint8_t input);
+// Conversions read back from a device, successful or not
+uint32_t Shim_AdsReads(uint8_t bus, uint8_t address);
+void Shim_AdsCountRead(uint8_t bus, uint8_t address);
+
+class Adafruit_ADS1X15 {
+public:
+    bool begin(uint8_t address = 0x48, TwoWire* wire = &Wire) {
+        m_bus = (wire == &Wire1) ? 1 : 0;
+        m_address = address;
+        return Shim_AdsGetMode(m_bus, m_address) != SHIM_ADS_ABSENT;
+    }
+    void setGain(adsGain_t) {}
+    void setDataRate(uint16_t) {}
+    void startADCReading(uint16_t mux, bool) { m_input = (uint8_t)((mux >> 12) & 3); }
+    bool conversionComplete() { return Shim_AdsGetMode(m_bus, m_address) != SHIM_ADS_TIMEOUT; }
+    int16_t getLastConversionResults() {
+        Shim_AdsCountRead(m_bus, m_address);
+        return (Shim_AdsGetMode(m_bus, m_address) == SHIM_ADS_OK) ? Shim_AdsValue(m_bus, m_address, m_input) : -1;
+    }
+
+private:
+    uint8_t m_bus = 0;
+    uint8_t m_address = 0x48;
+    uint8_t m_input = 0;
+};
+
+class Adafruit_ADS1115 : public Adafruit_ADS1X15 {};
+
+#endif // ADAFRUIT_ADS1X15_SHIM_H
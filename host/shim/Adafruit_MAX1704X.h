@@ -0,0 +1,10 @@
+#ifndef ADAFRUIT_MAX1704X_SHIM_H
+#define ADAFRUIT_MAX1704X_SHIM_H
+
+class Adafruit_MAX17048 {
+public:
+    bool begin() { return false; }
+    float cellVoltage() { return -1.0f; }
+};
+
+#endif // ADAFRUIT_MAX1704X_SHIM_H
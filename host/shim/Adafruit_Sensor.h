@@ -0,0 +1,6 @@
+#ifndef ADAFRUIT_SENSOR_SHIM_H
+#define ADAFRUIT_SENSOR_SHIM_H
+
+#define SENSORS_GRAVITY_STANDARD  (9.80665F)
+
+#endif // ADAFRUIT_SENSOR_SHIM_H
@@ -0,0 +1,115 @@
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' HOST SHIM: ARDUINO + FREERTOS ''''''''''''''''''' //
+// Just enough of the ESP32 Arduino core for the firmware's hot-path modules
+// to build and run on the host (see tools/firmware_bench.cpp). Peripherals are
+// no-ops; millis()/micros() follow the host clock plus Shim_AdvanceUs(), and
+// queues are real bounded FIFOs so LoggerPrint() pays for its enqueue.
+// Build with -DARDUINO -Ihost/shim.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PROGMEM
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+// ''''''' TIME ''''''''''''''''''' //
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// ''''''' SERIAL ''''''''''''''''''' //
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    size_t setTxBufferSize(size_t n) { return n; }
+    size_t print(const char* s) { return strlen(s); }
+    size_t println(const char* s) { return strlen(s) + 2; }
+    size_t write(const uint8_t*, size_t n) { return n; }
+    size_t write(uint8_t) { return 1; }
+    int availableForWrite() { return 4096; }
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() {}
+    operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+// ''''''' FREERTOS ''''''''''''''''''' //
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint8_t  StackType_t;
+typedef void*    TaskHandle_t;
+typedef struct ShimQueue* QueueHandle_t;
+typedef struct { uint8_t reserved[96]; } StaticQueue_t;
+typedef struct { int unused; } portMUX_TYPE;
+typedef struct { int held; } StaticSemaphore_t;
+typedef StaticSemaphore_t* SemaphoreHandle_t;
+
+#define portMUX_INITIALIZER_UNLOCKED  {0}
+#define portENTER_CRITICAL(mux)       ((void)(mux))
+#define portEXIT_CRITICAL(mux)        ((void)(mux))
+#define pdTRUE                        1
+#define pdFALSE                       0
+#define portMAX_DELAY                 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)             ((TickType_t)(ms))
+// Benchmarks are single-threaded: critical sections never wait. A mutex its one task
+// already holds is never given back while it waits, so taking it again fails at once
+// (on the device, the same re-entry from a callback would block or time out)
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    (void)wait;
+    if (sem->held) {
+        return pdFALSE;
+    }
+    sem->held = 1;
+    return pdTRUE;
+}
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    sem->held = 0;
+    return pdTRUE;
+}
+static inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer)
+{
+    buffer->held = 0;
+    return buffer;
+}
+
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+// One task, the caller. vTaskDelay() runs the task hook (the other tasks) once; a take
+// that has to wait runs it once per tick until notified, without a hook the wait just passes.
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t wait);
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize, uint8_t* storage, StaticQueue_t* buffer);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+
+// ''''''' ESP-IDF ''''''''''''''''''' //
+typedef enum {
+    ESP_RST_UNKNOWN, ESP_RST_POWERON, ESP_RST_EXT, ESP_RST_SW, ESP_RST_PANIC, ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT, ESP_RST_WDT, ESP_RST_DEEPSLEEP, ESP_RST_BROWNOUT, ESP_RST_SDIO
+} esp_reset_reason_t;
+static inline esp_reset_reason_t esp_reset_reason(void) { return ESP_RST_POWERON; }
+
+// ''''''' SHIM CONTROL ''''''''''''''''''' //
+// Moves millis()/micros() forward, e.g. to refill the logger's rate limiter
+void Shim_AdvanceUs(uint64_t us);
+// Empties every queue, standing in for the tasks that would consume them
+void Shim_DrainQueues(void);
+// Runs while vTaskDelay()/ulTaskNotifyTake() wait, standing in for the other tasks; NULL => none
+void Shim_SetTaskHook(void (*hook)(void));
+
+#endif // ARDUINO_SHIM_H
@@ -0,0 +1,133 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include "Adafruit_ADS1X15.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+TwoWire Wire;
+TwoWire Wire1;
+
+// ''''''' TIME ''''''''''''''''''' //
+
+static const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+static uint64_t s_advanceUs = 0;
+
+static uint64_t nowUs(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - s_epoch).count() + s_advanceUs;
+}
+
+unsigned long millis(void) { return (unsigned long)(uint32_t)(nowUs() / 1000); }
+unsigned long micros(void) { return (unsigned long)(uint32_t)nowUs(); }
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void Shim_AdvanceUs(uint64_t us) { s_advanceUs += us; }
+
+// ''''''' FREERTOS ''''''''''''''''''' //
+
+struct ShimQueue {
+    uint8_t* storage;
+    size_t length;
+    size_t itemSize;
+    size_t head;
+    size_t count;
+};
+
+static std::vector<ShimQueue*> s_queues;
+
+static int s_task;                      // the only task; its address is the handle
+static uint32_t s_notifyCount = 0;
+static void (*s_taskHook)(void) = nullptr;
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (s_taskHook) {
+        s_taskHook();
+    }
+    delay(ticks);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return &s_task; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t)
+{
+    s_notifyCount++;
+    return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t wait)
+{
+    for (TickType_t waited = 0; s_notifyCount == 0 && waited < wait; waited++) {
+        if (!s_taskHook) {
+            if (wait != portMAX_DELAY) {
+                Shim_AdvanceUs((uint64_t)(wait - waited) * 1000);
+            }
+            break;
+        }
+        s_taskHook();
+        Shim_AdvanceUs(1000);
+    }
+    uint32_t count = s_notifyCount;
+    if (count) {
+        s_notifyCount = clearOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+void Shim_SetTaskHook(void (*hook)(void)) { s_taskHook = hook; }
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize, uint8_t* storage, StaticQueue_t*)
+{
+    ShimQueue* q = new ShimQueue{ storage, length, itemSize, 0, 0 };
+    s_queues.push_back(q);
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t)
+{
+    if (q->count == q->length) {
+        return pdFALSE;
+    }
+    memcpy(q->storage + ((q->head + q->count) % q->length) * q->itemSize, item, q->itemSize);
+    q->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t)
+{
+    if (q->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item, q->storage + q->head * q->itemSize, q->itemSize);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+void Shim_DrainQueues(void)
+{
+    for (ShimQueue* q : s_queues) {
+        q->head = 0;
+        q->count = 0;
+    }
+}
+
+// ' ADS1115 FAULT INJECTION ' //
+
+static uint8_t  s_adsMode[2][128];     // ShimAdsMode_t, zero => absent
+static uint32_t s_adsReads[2][128];
+
+void Shim_AdsSetMode(uint8_t bus, uint8_t address, ShimAdsMode_t mode) { s_adsMode[bus & 1][address & 0x7F] = (uint8_t)mode; }
+ShimAdsMode_t Shim_AdsGetMode(uint8_t bus, uint8_t address) { return (ShimAdsMode_t)s_adsMode[bus & 1][address & 0x7F]; }
+uint32_t Shim_AdsReads(uint8_t bus, uint8_t address) { return s_adsReads[bus & 1][address & 0x7F]; }
+void Shim_AdsCountRead(uint8_t bus, uint8_t address) { s_adsReads[bus & 1][address & 0x7F]++; }
+
+int16_t Shim_AdsValue(uint8_t bus, uint8_t address, uint8_t input)
+{
+    return (int16_t)(1000 * (bus * 8 + (address & 7)) + 100 * input + 1);
+}
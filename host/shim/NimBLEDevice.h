@@ -0,0 +1,210 @@
+#ifndef NIMBLE_DEVICE_SHIM_H
+#define NIMBLE_DEVICE_SHIM_H
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' HOST SHIM: NIMBLE-ARDUINO ''''''''''''''''''' //
+// The part of NimBLE-Arduino 2.x that src/BluetoothModule.cpp uses, so the send
+// path runs unchanged on the host. There is no radio: the test plays the central
+// and the NimBLE task through the Shim_Ble* calls below, which invoke the
+// firmware's callbacks synchronously. notify() succeeds while the controller has
+// a free TX buffer and is logged with its time; either way it calls onStatus() with
+// the outcome before it returns, as NimBLE does. Freed buffers are not announced.
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+class NimBLEUUID {
+public:
+    NimBLEUUID(const char* uuid) : m_uuid(uuid) {}
+    bool equals(const NimBLEUUID& other) const { return m_uuid == other.m_uuid; }
+    const std::string& str() const { return m_uuid; }
+private:
+    std::string m_uuid;
+};
+
+class NimBLEAttValue {
+public:
+    NimBLEAttValue() {}
+    NimBLEAttValue(const uint8_t* data, size_t len) : m_value(data, data + len) {}
+    const uint8_t* data() const { return m_value.data(); }
+    size_t size() const { return m_value.size(); }
+    size_t length() const { return m_value.size(); }
+private:
+    std::vector<uint8_t> m_value;
+};
+
+class NimBLEConnInfo {
+public:
+    uint16_t getConnHandle() const { return m_handle; }
+    uint16_t getConnInterval() const { return m_interval; }
+    uint16_t getConnLatency() const { return m_latency; }
+    uint16_t getConnTimeout() const { return m_timeout; }
+    uint16_t getMTU() const { return m_mtu; }
+
+    uint16_t m_handle = 1;
+    uint16_t m_interval = 24;       // x 1.25 ms
+    uint16_t m_latency = 0;
+    uint16_t m_timeout = 400;       // x 10 ms
+    uint16_t m_mtu = 23;
+};
+
+namespace NIMBLE_PROPERTY {
+enum { READ = 0x02, WRITE_NR = 0x04, WRITE = 0x08, NOTIFY = 0x10, INDICATE = 0x20 };
+}
+
+class NimBLECharacteristic;
+
+class NimBLECharacteristicCallbacks {
+public:
+    virtual ~NimBLECharacteristicCallbacks() {}
+    virtual void onRead(NimBLECharacteristic*, NimBLEConnInfo&) {}
+    virtual void onWrite(NimBLECharacteristic*, NimBLEConnInfo&) {}
+    virtual void onStatus(NimBLECharacteristic*, int) {}
+    virtual void onSubscribe(NimBLECharacteristic*, NimBLEConnInfo&, uint16_t) {}
+};
+
+class NimBLEDescriptor {};
+
+class NimBLECharacteristic {
+public:
+    NimBLECharacteristic(const char* uuid, uint32_t properties) : m_uuid(uuid), m_properties(properties) {}
+    void setValue(const uint8_t* data, size_t len) { m_value = NimBLEAttValue(data, len); }
+    NimBLEAttValue getValue() { return m_value; }
+    bool notify(bool = true) { return notify(m_value.data(), m_value.size()); }
+    bool notify(const uint8_t* data, size_t len, uint16_t connHandle = 0xFFFF);
+    NimBLEUUID getUUID() { return m_uuid; }
+    void setCallbacks(NimBLECharacteristicCallbacks* callbacks) { m_callbacks = callbacks; }
+    NimBLECharacteristicCallbacks* getCallbacks() { return m_callbacks; }
+    NimBLEDescriptor* createDescriptor(const char*, uint32_t) { return &m_descriptor; }
+    uint32_t getProperties() const { return m_properties; }
+private:
+    NimBLEUUID m_uuid;
+    uint32_t m_properties;
+    NimBLEAttValue m_value;
+    NimBLECharacteristicCallbacks* m_callbacks = nullptr;
+    NimBLEDescriptor m_descriptor;
+};
+
+class NimBLEService {
+public:
+    NimBLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties, uint16_t maxLen = 512);
+    bool start() { return true; }
+};
+
+class NimBLEServer;
+
+class NimBLEServerCallbacks {
+public:
+    virtual ~NimBLEServerCallbacks() {}
+    virtual void onConnect(NimBLEServer*, NimBLEConnInfo&) {}
+    virtual void onDisconnect(NimBLEServer*, NimBLEConnInfo&, int) {}
+    virtual void onMTUChange(uint16_t, NimBLEConnInfo&) {}
+    virtual void onConnParamsUpdate(NimBLEConnInfo&) {}
+    virtual void onPhyUpdate(NimBLEConnInfo&, uint8_t, uint8_t) {}
+};
+
+class NimBLEServer {
+public:
+    void setCallbacks(NimBLEServerCallbacks* callbacks, bool = true) { m_callbacks = callbacks; }
+    NimBLEServerCallbacks* getCallbacks() { return m_callbacks; }
+    NimBLEService* createService(const char*) { return &m_service; }
+    size_t getConnectedCount();
+    bool updateConnParams(uint16_t, uint16_t, uint16_t, uint16_t, uint16_t) { return true; }
+    bool updatePhy(uint16_t, uint8_t, uint8_t, uint16_t) { return true; }
+    bool setDataLen(uint16_t, uint16_t txOctets);
+    uint16_t getPeerMTU(uint16_t);
+private:
+    NimBLEServerCallbacks* m_callbacks = nullptr;
+    NimBLEService m_service;
+};
+
+class NimBLEAdvertisementData {
+public:
+    bool setName(const std::string&, bool = true) { return true; }
+    bool setCompleteServices(const NimBLEUUID&) { return true; }
+    bool setFlags(uint8_t) { return true; }
+    bool setManufacturerData(const uint8_t*, size_t) { return true; }
+    bool setPreferredParams(uint16_t, uint16_t) { return true; }
+};
+
+class NimBLEAdvertising {
+public:
+    bool start(uint32_t = 0) { return true; }
+    bool stop() { return true; }
+    bool setAdvertisementData(const NimBLEAdvertisementData&) { return true; }
+    bool setScanResponseData(const NimBLEAdvertisementData&) { return true; }
+    void setMinInterval(uint16_t) {}
+    void setMaxInterval(uint16_t) {}
+};
+
+#define BLE_GAP_LE_PHY_1M_MASK      0x01
+#define BLE_GAP_LE_PHY_2M_MASK      0x02
+#define BLE_GAP_LE_PHY_CODED_MASK   0x04
+#define BLE_GAP_LE_PHY_ANY_MASK     0x07
+#define BLE_HS_EAGAIN               1
+#define BLE_HS_EMSGSIZE             4
+#define BLE_HS_ENOMEM               6
+
+// The one GAP event the firmware listens for itself
+#define BLE_GAP_EVENT_DATA_LEN_CHG  34
+
+struct ble_gap_event {
+    uint8_t type;
+    union {
+        struct {
+            uint16_t conn_handle;
+            uint16_t max_tx_octets;
+            uint16_t max_tx_time;
+            uint16_t max_rx_octets;
+            uint16_t max_rx_time;
+        } data_len_chg;
+    };
+};
+
+typedef int (*gap_event_handler)(ble_gap_event* event, void* arg);
+
+class NimBLEDevice {
+public:
+    static bool init(const std::string& name);
+    static bool deinit(bool clearAll = false);
+    static bool isInitialized();
+    static bool setMTU(uint16_t mtu);
+    static uint16_t getMTU();
+    static NimBLEServer* createServer();
+    static NimBLEAdvertising* getAdvertising();
+    static bool setDefaultPhy(uint8_t, uint8_t) { return true; }
+    static bool setPower(int8_t) { return true; }
+    static bool setCustomGapHandler(gap_event_handler handler);
+};
+
+// ''''''' SHIM CONTROL ''''''''''''''''''' //
+typedef struct {
+    std::string uuid;
+    std::vector<uint8_t> data;
+    uint32_t us;                // micros() when notify() took it
+} ShimBleNotify_t;
+
+// A central connects and agrees on the given MTU (capped by NimBLEDevice::setMTU) / leaves
+void Shim_BleConnect(uint16_t mtu);
+void Shim_BleDisconnect(void);
+// The central grants a connection interval (1.25 ms units) / the controller settles on a TX data length
+void Shim_BleConnParams(uint16_t interval);
+void Shim_BleDataLenChange(uint16_t txOctets);
+// TX data length the firmware last asked for with setDataLen(), 0 if none this connection
+uint16_t Shim_BleRequestedDataLen(void);
+// The central (un)subscribes to notifications of the characteristic with this UUID
+void Shim_BleSubscribe(const char* uuid, bool on);
+// The central writes the characteristic / reads it (returns the value onRead() set)
+void Shim_BleWrite(const char* uuid, const uint8_t* data, size_t len);
+NimBLEAttValue Shim_BleRead(const char* uuid);
+// Controller TX buffers: notify() takes one and is refused when none is free.
+// Shim_BleTxDone() returns up to n taken buffers without a callback.
+void Shim_BleSetTxBuffers(uint16_t n);
+void Shim_BleTxDone(uint16_t n);
+uint16_t Shim_BleTxInFlight(void);
+// Every notification accepted since the last clear, oldest first
+const std::vector<ShimBleNotify_t>& Shim_BleNotifications(void);
+void Shim_BleClearNotifications(void);
+
+#endif // NIMBLE_DEVICE_SHIM_H
@@ -0,0 +1,218 @@
+#include "NimBLEDevice.h"
+#include <memory>
+
+// ''''''' STACK ''''''''''''''''''' //
+
+static bool s_initialized = false;
+static uint16_t s_localMtu = 23;
+static std::unique_ptr<NimBLEServer> s_server;
+static NimBLEAdvertising s_advertising;
+static std::vector<std::unique_ptr<NimBLECharacteristic>> s_chars;
+static gap_event_handler s_gapHandler = nullptr;
+
+// ''''''' LINK ''''''''''''''''''' //
+
+static bool s_connected = false;
+static NimBLEConnInfo s_conn;
+static uint16_t s_txBuffers = 0xFFFF;   // unlimited until a test sets a count
+static uint16_t s_txInFlight = 0;
+static std::vector<ShimBleNotify_t> s_notifications;
+static uint16_t s_requestedDataLen = 0;
+
+bool NimBLEDevice::init(const std::string&)
+{
+    s_initialized = true;
+    return true;
+}
+
+bool NimBLEDevice::deinit(bool)
+{
+    s_initialized = false;
+    s_server.reset();
+    s_chars.clear();
+    s_txInFlight = 0;
+    s_connected = false;
+    return true;
+}
+
+bool NimBLEDevice::isInitialized() { return s_initialized; }
+
+bool NimBLEDevice::setMTU(uint16_t mtu)
+{
+    s_localMtu = mtu;
+    return true;
+}
+
+uint16_t NimBLEDevice::getMTU() { return s_localMtu; }
+
+bool NimBLEDevice::setCustomGapHandler(gap_event_handler handler)
+{
+    s_gapHandler = handler;
+    return true;
+}
+
+NimBLEServer* NimBLEDevice::createServer()
+{
+    if (!s_server) {
+        s_server.reset(new NimBLEServer());
+    }
+    return s_server.get();
+}
+
+NimBLEAdvertising* NimBLEDevice::getAdvertising() { return &s_advertising; }
+
+NimBLECharacteristic* NimBLEService::createCharacteristic(const char* uuid, uint32_t properties, uint16_t)
+{
+    s_chars.emplace_back(new NimBLECharacteristic(uuid, properties));
+    return s_chars.back().get();
+}
+
+size_t NimBLEServer::getConnectedCount() { return s_connected ? 1 : 0; }
+
+uint16_t NimBLEServer::getPeerMTU(uint16_t) { return s_connected ? s_conn.m_mtu : 0; }
+
+// The controller negotiates in the background; Shim_BleDataLenChange() reports the outcome
+bool NimBLEServer::setDataLen(uint16_t, uint16_t txOctets)
+{
+    s_requestedDataLen = txOctets;
+    return true;
+}
+
+// Like ble_gattc_notify_custom(), raises NOTIFY_TX with the outcome before returning, on
+// the caller's task: onStatus() announces the attempt, never a buffer coming back
+bool NimBLECharacteristic::notify(const uint8_t* data, size_t len, uint16_t)
+{
+    if (!s_connected) {
+        return false;
+    }
+    int rc = 0;
+    if (len > (size_t)(s_conn.m_mtu - 3)) {
+        rc = BLE_HS_EMSGSIZE;
+    } else if (s_txInFlight >= s_txBuffers) {
+        rc = BLE_HS_ENOMEM;
+    } else {
+        s_txInFlight++;
+        s_notifications.push_back(ShimBleNotify_t{ m_uuid.str(), std::vector<uint8_t>(data, data + len),
+                                                   (uint32_t)micros() });
+    }
+    if (m_callbacks) {
+        m_callbacks->onStatus(this, rc);
+    }
+    return rc == 0;
+}
+
+// ''''''' SHIM CONTROL ''''''''''''''''''' //
+
+static NimBLECharacteristic* findChar(const char* uuid)
+{
+    for (auto& c : s_chars) {
+        if (c->getUUID().str() == uuid) {
+            return c.get();
+        }
+    }
+    return nullptr;
+}
+
+void Shim_BleConnect(uint16_t mtu)
+{
+    if (!s_server) {
+        return;
+    }
+    s_conn = NimBLEConnInfo();
+    s_connected = true;
+    s_requestedDataLen = 0;
+    s_txInFlight = 0;
+    if (s_server->getCallbacks()) {
+        s_server->getCallbacks()->onConnect(s_server.get(), s_conn);
+    }
+    s_conn.m_mtu = (mtu < s_localMtu) ? mtu : s_localMtu;
+    if (s_conn.m_mtu > 23 && s_server->getCallbacks()) {
+        s_server->getCallbacks()->onMTUChange(s_conn.m_mtu, s_conn);
+    }
+}
+
+void Shim_BleDisconnect(void)
+{
+    if (!s_server || !s_connected) {
+        return;
+    }
+    s_connected = false;
+    s_txInFlight = 0;
+    if (s_server->getCallbacks()) {
+        s_server->getCallbacks()->onDisconnect(s_server.get(), s_conn, 0x13);
+    }
+}
+
+void Shim_BleConnParams(uint16_t interval)
+{
+    if (!s_connected) {
+        return;
+    }
+    s_conn.m_interval = interval;
+    if (s_server->getCallbacks()) {
+        s_server->getCallbacks()->onConnParamsUpdate(s_conn);
+    }
+}
+
+void Shim_BleDataLenChange(uint16_t txOctets)
+{
+    if (!s_connected || !s_gapHandler) {
+        return;
+    }
+    ble_gap_event event = {};
+    event.type = BLE_GAP_EVENT_DATA_LEN_CHG;
+    event.data_len_chg.conn_handle = s_conn.m_handle;
+    event.data_len_chg.max_tx_octets = txOctets;
+    event.data_len_chg.max_tx_time = (uint16_t)((txOctets + 14) * 8);
+    event.data_len_chg.max_rx_octets = txOctets;
+    event.data_len_chg.max_rx_time = event.data_len_chg.max_tx_time;
+    s_gapHandler(&event, nullptr);
+}
+
+void Shim_BleSubscribe(const char* uuid, bool on)
+{
+    NimBLECharacteristic* c = findChar(uuid);
+    if (c && c->getCallbacks()) {
+        c->getCallbacks()->onSubscribe(c, s_conn, on ? 1 : 0);
+    }
+}
+
+void Shim_BleWrite(const char* uuid, const uint8_t* data, size_t len)
+{
+    NimBLECharacteristic* c = findChar(uuid);
+    if (!c) {
+        return;
+    }
+    c->setValue(data, len);
+    if (c->getCallbacks()) {
+        c->getCallbacks()->onWrite(c, s_conn);
+    }
+}
+
+NimBLEAttValue Shim_BleRead(const char* uuid)
+{
+    NimBLECharacteristic* c = findChar(uuid);
+    if (!c) {
+        return NimBLEAttValue();
+    }
+    if (c->getCallbacks()) {
+        c->getCallbacks()->onRead(c, s_conn);
+    }
+    return c->getValue();
+}
+
+void Shim_BleSetTxBuffers(uint16_t n) { s_txBuffers = n; }
+
+// Completed packets return their buffers silently, as the controller does
+void Shim_BleTxDone(uint16_t n)
+{
+    s_txInFlight = (n < s_txInFlight) ? (uint16_t)(s_txInFlight - n) : 0;
+}
+
+uint16_t Shim_BleTxInFlight(void) { return s_txInFlight; }
+
+uint16_t Shim_BleRequestedDataLen(void) { return s_requestedDataLen; }
+
+const std::vector<ShimBleNotify_t>& Shim_BleNotifications(void) { return s_notifications; }
+
+void Shim_BleClearNotifications(void) { s_notifications.clear(); }
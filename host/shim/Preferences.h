@@ -0,0 +1,17 @@
+#ifndef PREFERENCES_SHIM_H
+#define PREFERENCES_SHIM_H
+
+#include "Arduino.h"
+
+// NVS that is never available: begin() fails, so callers take their no-cache path
+class Preferences {
+public:
+    bool begin(const char*, bool = false) { return false; }
+    void end() {}
+    bool clear() { return false; }
+    size_t getBytesLength(const char*) { return 0; }
+    size_t getBytes(const char*, void*, size_t) { return 0; }
+    size_t putBytes(const char*, const void*, size_t) { return 0; }
+};
+
+#endif // PREFERENCES_SHIM_H
@@ -0,0 +1,13 @@
+#ifndef ESP_BT_SHIM_H
+#define ESP_BT_SHIM_H
+
+// TX power setting of the ESP32 controller; no radio on the host
+typedef enum { ESP_BLE_PWR_TYPE_DEFAULT = 9 } esp_ble_power_type_t;
+typedef enum {
+    ESP_PWR_LVL_N12, ESP_PWR_LVL_N9, ESP_PWR_LVL_N6, ESP_PWR_LVL_N3, ESP_PWR_LVL_N0,
+    ESP_PWR_LVL_P3, ESP_PWR_LVL_P6, ESP_PWR_LVL_P9
+} esp_power_level_t;
+
+static inline int esp_ble_tx_power_set(esp_ble_power_type_t, esp_power_level_t) { return 0; }
+
+#endif // ESP_BT_SHIM_H
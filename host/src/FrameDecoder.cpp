@@ -0,0 +1,273 @@
+#include "FrameDecoder.h"
+#include "FrameCodecModule.h"
+#include <string.h>
+
+// Frames are transposed in blocks: 16 frames are copied into a small
+// row-major tile that stays in L1, then written out column by column.
+// Both inner loops have fixed trip counts, which lets the compiler turn
+// them into vector loads/shuffles/stores.
+#define DECODER_BLOCK 16
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define DECODER_HOST_LE 1
+#else
+#define DECODER_HOST_LE 0
+#endif
+
+static inline uint16_t le16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t le32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Wire pressure words -> host order
+static inline void loadPressure(const uint8_t* frame, uint16_t* dst)
+{
+#if DECODER_HOST_LE
+    memcpy(dst, frame + FRAME_OFS_PRESSURE, PRESSURE_CHANNEL_COUNT * sizeof(uint16_t));
+#else
+    for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+        dst[c] = le16(frame + FRAME_OFS_PRESSURE + 2 * c);
+    }
+#endif
+}
+
+uint32_t FrameView::timestamp(size_t i) const
+{
+    if (m_layout.timestampOffset < 0) {
+        return 0;
+    }
+    return le32(m_buf + i * m_layout.stride + m_layout.timestampOffset);
+}
+
+static bool layoutValid(const FrameLayout& layout)
+{
+    if (layout.stride == 0 || layout.frameOffset + FRAME_SIZE_RAW > layout.stride) {
+        return false;
+    }
+    if (layout.timestampOffset >= 0 && (size_t)layout.timestampOffset + 4 > layout.stride) {
+        return false;
+    }
+    return true;
+}
+
+DecoderResult Decoder_DecodeBatch(const uint8_t* buf, size_t len, const FrameLayout& layout,
+                                  FrameColumns& out, size_t row)
+{
+    DecoderResult res = { DECODER_OK, 0, 0 };
+
+    if ((!buf && len) || !layoutValid(layout) || !out.battery || !out.accel_x || !out.accel_y || !out.accel_z) {
+        res.status = DECODER_ERR_ARGS;
+        return res;
+    }
+    for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+        if (!out.pressure[c]) {
+            res.status = DECODER_ERR_ARGS;
+            return res;
+        }
+    }
+
+    size_t records = len / layout.stride;
+    size_t room = (row < out.capacity) ? out.capacity - row : 0;
+    if (records > room) {
+        records = room;
+        res.status = DECODER_ERR_CAPACITY;
+    } else if (len % layout.stride) {
+        res.status = DECODER_ERR_TRUNCATED;
+    }
+
+    const uint8_t* base = buf + layout.frameOffset;
+    const size_t stride = layout.stride;
+
+    // Scalar fields
+    for (size_t i = 0; i < records; i++) {
+        const uint8_t* f = base + i * stride;
+        out.battery[row + i] = f[FRAME_OFS_BATTERY];
+        out.accel_x[row + i] = (int16_t)le16(f + FRAME_OFS_ACCEL_X);
+        out.accel_y[row + i] = (int16_t)le16(f + FRAME_OFS_ACCEL_Y);
+        out.accel_z[row + i] = (int16_t)le16(f + FRAME_OFS_ACCEL_Z);
+    }
+
+    // Pressure words: blocked transpose into 16 columns
+    uint16_t tile[DECODER_BLOCK][PRESSURE_CHANNEL_COUNT];
+    size_t i = 0;
+    for (; i + DECODER_BLOCK <= records; i += DECODER_BLOCK) {
+        for (int k = 0; k < DECODER_BLOCK; k++) {
+            loadPressure(base + (i + k) * stride, tile[k]);
+        }
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+            uint16_t* col = out.pressure[c] + row + i;
+            for (int k = 0; k < DECODER_BLOCK; k++) {
+                col[k] = tile[k][c];
+            }
+        }
+    }
+    for (; i < records; i++) {
+        loadPressure(base + i * stride, tile[0]);
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+            out.pressure[c][row + i] = tile[0][c];
+        }
+    }
+
+    // Timestamps, checked for monotonicity
+    if (layout.timestampOffset >= 0 && out.timestamp) {
+        const uint8_t* ts = buf + layout.timestampOffset;
+        uint32_t prev = (row > 0 && row <= out.capacity) ? out.timestamp[row - 1] : 0;
+        bool backwards = false;
+        for (size_t k = 0; k < records; k++) {
+            uint32_t t = le32(ts + k * stride);
+            backwards |= (t < prev);
+            prev = t;
+            out.timestamp[row + k] = t;
+        }
+        if (backwards && res.status == DECODER_OK) {
+            res.status = DECODER_ERR_TIMESTAMP;
+        }
+    }
+
+    res.frames = records;
+    res.bytesConsumed = records * stride;
+    return res;
+}
+
+// Fixed-size unpackers for the 16 pressure values of a packed frame. The trip
+// counts are compile-time constants so the loops vectorize.
+static inline void unpack16x12(const uint8_t* in, uint16_t* v)
+{
+    for (int j = 0; j < PRESSURE_CHANNEL_COUNT / 2; j++) {
+        const uint8_t* b = in + 3 * j;
+        v[2 * j]     = (uint16_t)(b[0] | ((b[1] & 0x0F) << 8));
+        v[2 * j + 1] = (uint16_t)((b[1] >> 4) | (b[2] << 4));
+    }
+}
+
+static inline void unpack16x10(const uint8_t* in, uint16_t* v)
+{
+    for (int j = 0; j < PRESSURE_CHANNEL_COUNT / 4; j++) {
+        const uint8_t* b = in + 5 * j;
+        v[4 * j]     = (uint16_t)((b[0]        | (b[1] << 8)) & 0x3FF);
+        v[4 * j + 1] = (uint16_t)(((b[1] >> 2) | (b[2] << 6)) & 0x3FF);
+        v[4 * j + 2] = (uint16_t)(((b[2] >> 4) | (b[3] << 4)) & 0x3FF);
+        v[4 * j + 3] = (uint16_t)(((b[3] >> 6) | (b[4] << 2)) & 0x3FF);
+    }
+}
+
+static inline void unpack16x8(const uint8_t* in, uint16_t* v)
+{
+    for (int j = 0; j < PRESSURE_CHANNEL_COUNT; j++) {
+        v[j] = in[j];
+    }
+}
+
+DecoderResult Decoder_DecodePacked(const uint8_t* buf, size_t len, FrameColumns& out, size_t row)
+{
+    DecoderResult res = { DECODER_OK, 0, 0 };
+    if ((!buf && len) || !out.battery || !out.accel_x || !out.accel_y || !out.accel_z) {
+        res.status = DECODER_ERR_ARGS;
+        return res;
+    }
+    for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+        if (!out.pressure[c]) {
+            res.status = DECODER_ERR_ARGS;
+            return res;
+        }
+    }
+
+    uint16_t tile[DECODER_BLOCK][PRESSURE_CHANNEL_COUNT];
+    size_t pos = 0;
+    size_t n = 0;           // frames decoded
+    int inTile = 0;
+
+    while (pos < len) {
+        if (row + n >= out.capacity) {
+            res.status = DECODER_ERR_CAPACITY;
+            break;
+        }
+        uint8_t fmt = buf[pos] >> 4;
+        uint8_t shift = buf[pos] & 0x0F;
+        size_t size = Codec_FrameSize(fmt);
+        if (fmt == FRAME_FMT_LEGACY16 || size == 0) {
+            res.status = DECODER_ERR_FORMAT;
+            break;
+        }
+        if (pos + size > len) {
+            res.status = DECODER_ERR_TRUNCATED;
+            break;
+        }
+
+        const uint8_t* f = buf + pos;
+        size_t r = row + n;
+        out.battery[r] = f[1];
+        out.accel_x[r] = (int16_t)le16(f + 2);
+        out.accel_y[r] = (int16_t)le16(f + 4);
+        out.accel_z[r] = (int16_t)le16(f + 6);
+        if (out.valid || out.adcHealthy) {
+            PressureMask_t valid;
+            uint8_t healthy;
+            Codec_UnpackStatus(f + 8, &valid, &healthy);
+            if (out.valid) {
+                out.valid[r] = valid;
+            }
+            if (out.adcHealthy) {
+                out.adcHealthy[r] = healthy;
+            }
+        }
+
+        uint16_t* v = tile[inTile];
+        const uint8_t* p = f + FRAME_PACKED_HEADER_SIZE;
+        switch (fmt) {
+            case FRAME_FMT_PACKED12: unpack16x12(p, v); break;
+            case FRAME_FMT_PACKED10: unpack16x10(p, v); break;
+            case FRAME_FMT_PACKED8:  unpack16x8(p, v);  break;
+            default:
+                for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+                    v[c] = le16(p + 2 * c);
+                }
+                break;
+        }
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+            v[c] = (uint16_t)(v[c] << shift);
+        }
+
+        pos += size;
+        n++;
+        // Flush a full tile column by column
+        if (++inTile == DECODER_BLOCK) {
+            size_t first = row + n - DECODER_BLOCK;
+            for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+                for (int k = 0; k < DECODER_BLOCK; k++) {
+                    out.pressure[c][first + k] = tile[k][c];
+                }
+            }
+            inTile = 0;
+        }
+    }
+    // Partial tile
+    size_t first = row + n - inTile;
+    for (int k = 0; k < inTile; k++) {
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+            out.pressure[c][first + k] = tile[k][c];
+        }
+    }
+
+    res.frames = n;
+    res.bytesConsumed = pos;
+    return res;
+}
+
+const char* Decoder_StatusString(DecoderStatus_t status)
+{
+    switch (status) {
+        case DECODER_OK:            return "ok";
+        case DECODER_ERR_ARGS:      return "invalid arguments";
+        case DECODER_ERR_TRUNCATED: return "truncated record";
+        case DECODER_ERR_CAPACITY:  return "output capacity exceeded";
+        case DECODER_ERR_TIMESTAMP: return "timestamps not monotonic";
+        case DECODER_ERR_FORMAT:    return "unknown frame format";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,442 @@
+#include "SessionFile.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SESSION_BLOCK_ALIGN 8
+
+size_t Session_ColumnWidth(int column)
+{
+    switch (column) {
+        case SESSION_COL_TIMESTAMP: return 4;
+        case SESSION_COL_BATTERY:   return 1;
+        default:                    return 2;
+    }
+}
+
+static void storeValue(uint8_t* p, size_t width, int64_t v)
+{
+    for (size_t i = 0; i < width; i++) {
+        p[i] = (uint8_t)((uint64_t)v >> (8 * i));
+    }
+}
+
+// Output array of a column inside caller-owned FrameColumns
+static uint8_t* outputColumn(const FrameColumns& out, int column)
+{
+    switch (column) {
+        case SESSION_COL_TIMESTAMP: return (uint8_t*)out.timestamp;
+        case SESSION_COL_BATTERY:   return (uint8_t*)out.battery;
+        case SESSION_COL_ACCEL_X:   return (uint8_t*)out.accel_x;
+        case SESSION_COL_ACCEL_Y:   return (uint8_t*)out.accel_y;
+        case SESSION_COL_ACCEL_Z:   return (uint8_t*)out.accel_z;
+        default:                    return (uint8_t*)out.pressure[column - SESSION_COL_PRESSURE0];
+    }
+}
+
+// ''''''' WRITER ''''''''''''''''''' //
+
+SessionStatus_t SessionWriter::open(const char* path, const SessionWriterOptions& options)
+{
+    close();
+    if (!path) {
+        return SESSION_ERR_ARGS;
+    }
+    m_file = fopen(path, "wb");
+    if (!m_file) {
+        return SESSION_ERR_IO;
+    }
+    m_options = options;
+    if (m_options.chunkRows == 0) {
+        m_options.chunkRows = SESSION_DEFAULT_CHUNK_ROWS;
+    }
+    for (int c = 0; c < SESSION_COLUMN_COUNT; c++) {
+        m_pending[c].clear();
+        m_pending[c].reserve(m_options.chunkRows);
+    }
+    m_index.clear();
+    m_rowCount = 0;
+    m_lastTimestamp = -1;
+
+    // Placeholder, rewritten by close()
+    SessionFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = SESSION_MAGIC;
+    hdr.version = SESSION_VERSION;
+    hdr.columns = SESSION_COLUMN_COUNT;
+    hdr.chunkRows = m_options.chunkRows;
+    if (fwrite(&hdr, sizeof(hdr), 1, m_file) != 1) {
+        fclose(m_file);
+        m_file = nullptr;
+        return SESSION_ERR_IO;
+    }
+    m_offset = sizeof(hdr);
+    return SESSION_OK;
+}
+
+SessionStatus_t SessionWriter::append(uint32_t timestamp, const SensorData& frame)
+{
+    if (!m_file) {
+        return SESSION_ERR_ARGS;
+    }
+    if ((int64_t)timestamp < m_lastTimestamp) {
+        return SESSION_ERR_TIMESTAMP;
+    }
+    m_lastTimestamp = timestamp;
+
+    m_pending[SESSION_COL_TIMESTAMP].push_back(timestamp);
+    m_pending[SESSION_COL_BATTERY].push_back(frame.battery);
+    m_pending[SESSION_COL_ACCEL_X].push_back(frame.accel_x);
+    m_pending[SESSION_COL_ACCEL_Y].push_back(frame.accel_y);
+    m_pending[SESSION_COL_ACCEL_Z].push_back(frame.accel_z);
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        m_pending[SESSION_COL_PRESSURE0 + ch].push_back(frame.pressure[ch]);
+    }
+    m_rowCount++;
+
+    if (m_pending[SESSION_COL_TIMESTAMP].size() >= m_options.chunkRows) {
+        return flushChunk();
+    }
+    return SESSION_OK;
+}
+
+SessionStatus_t SessionWriter::append(const FrameColumns& columns, size_t rows)
+{
+    if (!columns.timestamp || rows > columns.capacity) {
+        return SESSION_ERR_ARGS;
+    }
+    for (size_t r = 0; r < rows; r++) {
+        SensorData frame;
+        frame.battery = columns.battery[r];
+        frame.accel_x = columns.accel_x[r];
+        frame.accel_y = columns.accel_y[r];
+        frame.accel_z = columns.accel_z[r];
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            frame.pressure[ch] = columns.pressure[ch][r];
+        }
+        SessionStatus_t st = append(columns.timestamp[r], frame);
+        if (st != SESSION_OK) {
+            return st;
+        }
+    }
+    return SESSION_OK;
+}
+
+SessionStatus_t SessionWriter::writeBlock(const uint8_t* data, size_t len, uint64_t* offset)
+{
+    static const uint8_t zeros[SESSION_BLOCK_ALIGN] = {0};
+    size_t pad = (size_t)((SESSION_BLOCK_ALIGN - m_offset % SESSION_BLOCK_ALIGN) % SESSION_BLOCK_ALIGN);
+    if (pad && fwrite(zeros, 1, pad, m_file) != pad) {
+        return SESSION_ERR_IO;
+    }
+    m_offset += pad;
+    *offset = m_offset;
+    if (len && fwrite(data, 1, len, m_file) != len) {
+        return SESSION_ERR_IO;
+    }
+    m_offset += len;
+    return SESSION_OK;
+}
+
+SessionStatus_t SessionWriter::flushChunk()
+{
+    size_t rows = m_pending[SESSION_COL_TIMESTAMP].size();
+    if (rows == 0) {
+        return SESSION_OK;
+    }
+    SessionChunkIndex idx;
+    memset(&idx, 0, sizeof(idx));
+    idx.firstRow = m_rowCount - rows;
+    idx.rows = (uint32_t)rows;
+
+    for (int c = 0; c < SESSION_COLUMN_COUNT; c++) {
+        const std::vector<int64_t>& v = m_pending[c];
+        size_t width = Session_ColumnWidth(c);
+        SessionColumnIndex& col = idx.column[c];
+        col.min = *std::min_element(v.begin(), v.end());
+        col.max = *std::max_element(v.begin(), v.end());
+
+        m_raw.resize(rows * width);
+        for (size_t r = 0; r < rows; r++) {
+            storeValue(&m_raw[r * width], width, v[r]);
+        }
+        const std::vector<uint8_t>* block = &m_raw;
+        col.encoding = SESSION_ENC_RAW;
+
+        if (m_options.deltaEncode) {
+            m_delta.clear();
+            int64_t prev = 0;
+            for (size_t r = 0; r < rows; r++) {
+                int64_t d = v[r] - prev;
+                uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+                prev = v[r];
+                do {
+                    uint8_t b = (uint8_t)(z & 0x7F);
+                    z >>= 7;
+                    m_delta.push_back(z ? (uint8_t)(b | 0x80) : b);
+                } while (z);
+            }
+            if (m_delta.size() < m_raw.size()) {
+                block = &m_delta;
+                col.encoding = SESSION_ENC_DELTA_VARINT;
+            }
+        }
+        col.bytes = (uint32_t)block->size();
+        SessionStatus_t st = writeBlock(block->data(), block->size(), &col.offset);
+        if (st != SESSION_OK) {
+            return st;
+        }
+        m_pending[c].clear();
+    }
+    m_index.push_back(idx);
+    return SESSION_OK;
+}
+
+SessionStatus_t SessionWriter::close()
+{
+    if (!m_file) {
+        return SESSION_OK;
+    }
+    SessionStatus_t st = flushChunk();
+    uint64_t indexOffset = 0;
+    if (st == SESSION_OK) {
+        st = writeBlock((const uint8_t*)m_index.data(), m_index.size() * sizeof(SessionChunkIndex), &indexOffset);
+    }
+    if (st == SESSION_OK) {
+        SessionFileHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.magic = SESSION_MAGIC;
+        hdr.version = SESSION_VERSION;
+        hdr.columns = SESSION_COLUMN_COUNT;
+        hdr.chunkRows = m_options.chunkRows;
+        hdr.chunkCount = (uint32_t)m_index.size();
+        hdr.rowCount = m_rowCount;
+        hdr.indexOffset = indexOffset;
+        if (fseek(m_file, 0, SEEK_SET) != 0 || fwrite(&hdr, sizeof(hdr), 1, m_file) != 1) {
+            st = SESSION_ERR_IO;
+        }
+    }
+    if (fclose(m_file) != 0 && st == SESSION_OK) {
+        st = SESSION_ERR_IO;
+    }
+    m_file = nullptr;
+    return st;
+}
+
+// ''''''' READER ''''''''''''''''''' //
+
+SessionStatus_t SessionReader::open(const char* path)
+{
+    close();
+    if (!path) {
+        return SESSION_ERR_ARGS;
+    }
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return SESSION_ERR_IO;
+    }
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        ::close(fd);
+        return SESSION_ERR_IO;
+    }
+    if ((size_t)sb.st_size < sizeof(SessionFileHeader)) {
+        ::close(fd);
+        return SESSION_ERR_FORMAT;
+    }
+    void* map = mmap(nullptr, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return SESSION_ERR_IO;
+    }
+    m_map = (const uint8_t*)map;
+    m_size = (size_t)sb.st_size;
+    m_header = (const SessionFileHeader*)m_map;
+
+    // Validate everything the accessors rely on, once
+    const SessionFileHeader* h = m_header;
+    bool ok = h->magic == SESSION_MAGIC && h->version == SESSION_VERSION && h->columns == SESSION_COLUMN_COUNT &&
+              h->indexOffset >= sizeof(SessionFileHeader) && h->indexOffset % SESSION_BLOCK_ALIGN == 0 &&
+              h->indexOffset <= m_size &&
+              (m_size - h->indexOffset) / sizeof(SessionChunkIndex) >= h->chunkCount;
+    if (ok) {
+        m_index = (const SessionChunkIndex*)(m_map + h->indexOffset);
+        uint64_t rows = 0;
+        std::vector<uint32_t> ts;
+        for (uint32_t i = 0; ok && i < h->chunkCount; i++) {
+            const SessionChunkIndex& idx = m_index[i];
+            ok = idx.firstRow == rows && idx.rows > 0 &&
+                 (i == 0 || idx.column[SESSION_COL_TIMESTAMP].min >= m_index[i - 1].column[SESSION_COL_TIMESTAMP].max);
+            for (int c = 0; ok && c < SESSION_COLUMN_COUNT; c++) {
+                const SessionColumnIndex& col = idx.column[c];
+                ok = col.offset % SESSION_BLOCK_ALIGN == 0 && col.offset <= m_size && col.bytes <= m_size - col.offset &&
+                     (col.encoding == SESSION_ENC_DELTA_VARINT ||
+                      (col.encoding == SESSION_ENC_RAW && col.bytes == (uint64_t)idx.rows * Session_ColumnWidth(c)));
+            }
+            if (ok) {
+                // readRange binary-searches the timestamps: ordered, and spanning exactly the index min/max
+                const SessionColumnIndex& t = idx.column[SESSION_COL_TIMESTAMP];
+                ts.resize(idx.rows);
+                ok = readColumn(i, SESSION_COL_TIMESTAMP, ts.data()) == SESSION_OK &&
+                     std::is_sorted(ts.begin(), ts.end()) && t.min == ts.front() && t.max == ts.back();
+            }
+            rows += idx.rows;
+        }
+        ok = ok && rows == h->rowCount;
+    }
+    if (!ok) {
+        close();
+        return SESSION_ERR_FORMAT;
+    }
+    return SESSION_OK;
+}
+
+void SessionReader::close()
+{
+    if (m_map) {
+        munmap((void*)m_map, m_size);
+    }
+    m_map = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_index = nullptr;
+}
+
+void SessionReader::findChunks(uint32_t t0, uint32_t t1, size_t* first, size_t* last) const
+{
+    size_t n = chunkCount();
+    const SessionChunkIndex* begin = m_index;
+    const SessionChunkIndex* end = m_index + n;
+    // Chunks are ordered by time: first chunk ending at or after t0, first chunk starting after t1
+    const SessionChunkIndex* lo = std::lower_bound(begin, end, (int64_t)t0,
+        [](const SessionChunkIndex& c, int64_t t) { return c.column[SESSION_COL_TIMESTAMP].max < t; });
+    const SessionChunkIndex* hi = std::upper_bound(lo, end, (int64_t)t1,
+        [](int64_t t, const SessionChunkIndex& c) { return t < c.column[SESSION_COL_TIMESTAMP].min; });
+    *first = (size_t)(lo - begin);
+    *last = (size_t)(hi - begin);
+}
+
+bool SessionReader::chunkMayContain(size_t chunk, int column, int64_t lo, int64_t hi) const
+{
+    const SessionColumnIndex& col = m_index[chunk].column[column];
+    return col.max >= lo && col.min <= hi;
+}
+
+const void* SessionReader::columnData(size_t chunk, int column) const
+{
+    const SessionColumnIndex& col = m_index[chunk].column[column];
+    return (col.encoding == SESSION_ENC_RAW) ? m_map + col.offset : nullptr;
+}
+
+SessionStatus_t SessionReader::readColumn(size_t chunk, int column, void* dst) const
+{
+    if (!m_map || chunk >= chunkCount() || column < 0 || column >= SESSION_COLUMN_COUNT || !dst) {
+        return SESSION_ERR_ARGS;
+    }
+    const SessionChunkIndex& idx = m_index[chunk];
+    const SessionColumnIndex& col = idx.column[column];
+    const uint8_t* p = m_map + col.offset;
+    if (col.encoding == SESSION_ENC_RAW) {
+        memcpy(dst, p, col.bytes);
+        return SESSION_OK;
+    }
+
+    const uint8_t* end = p + col.bytes;
+    size_t width = Session_ColumnWidth(column);
+    uint8_t* out = (uint8_t*)dst;
+    int64_t value = 0;
+    for (uint32_t r = 0; r < idx.rows; r++) {
+        uint64_t z = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            if (p >= end || shift > 63) {
+                return SESSION_ERR_FORMAT;
+            }
+            b = *p++;
+            z |= (uint64_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        value += (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+        storeValue(out + r * width, width, value);
+    }
+    return SESSION_OK;
+}
+
+SessionResult SessionReader::readRange(uint32_t t0, uint32_t t1, FrameColumns& out, size_t row) const
+{
+    SessionResult res = { SESSION_OK, 0 };
+    if (!m_map || !out.battery || !out.accel_x || !out.accel_y || !out.accel_z) {
+        res.status = SESSION_ERR_ARGS;
+        return res;
+    }
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        if (!out.pressure[ch]) {
+            res.status = SESSION_ERR_ARGS;
+            return res;
+        }
+    }
+
+    size_t first, last;
+    findChunks(t0, t1, &first, &last);
+    std::vector<uint32_t> ts;
+    std::vector<uint8_t> scratch;
+
+    for (size_t i = first; i < last; i++) {
+        const SessionChunkIndex& idx = m_index[i];
+        ts.resize(idx.rows);
+        res.status = readColumn(i, SESSION_COL_TIMESTAMP, ts.data());
+        if (res.status != SESSION_OK) {
+            return res;
+        }
+        size_t lo = (size_t)(std::lower_bound(ts.begin(), ts.end(), t0) - ts.begin());
+        size_t hi = (size_t)(std::upper_bound(ts.begin(), ts.end(), t1) - ts.begin());
+        size_t n = hi - lo;
+        if (n == 0) {
+            continue;
+        }
+        if (row + res.rows + n > out.capacity) {
+            res.status = SESSION_ERR_CAPACITY;
+            return res;
+        }
+        size_t dstRow = row + res.rows;
+
+        for (int c = 0; c < SESSION_COLUMN_COUNT; c++) {
+            uint8_t* dst = outputColumn(out, c);
+            if (!dst) {
+                continue;   // optional timestamp column
+            }
+            size_t width = Session_ColumnWidth(c);
+            const uint8_t* src;
+            if (c == SESSION_COL_TIMESTAMP) {
+                src = (const uint8_t*)ts.data();
+            } else if ((src = (const uint8_t*)columnData(i, c)) == nullptr) {
+                scratch.resize((size_t)idx.rows * width);
+                res.status = readColumn(i, c, scratch.data());
+                if (res.status != SESSION_OK) {
+                    return res;
+                }
+                src = scratch.data();
+            }
+            memcpy(dst + dstRow * width, src + lo * width, n * width);
+        }
+        res.rows += n;
+    }
+    return res;
+}
+
+const char* Session_StatusString(SessionStatus_t status)
+{
+    switch (status) {
+        case SESSION_OK:            return "ok";
+        case SESSION_ERR_ARGS:      return "invalid arguments";
+        case SESSION_ERR_IO:        return "i/o error";
+        case SESSION_ERR_FORMAT:    return "not a valid session file";
+        case SESSION_ERR_TIMESTAMP: return "timestamps not monotonic";
+        case SESSION_ERR_CAPACITY:  return "output columns too small";
+    }
+    return "unknown";
+}
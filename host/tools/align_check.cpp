@@ -0,0 +1,161 @@
+// Timebase alignment check: feeds signals with known per-channel sample skew through
+// the resampler and compares naive (newest sample) and aligned values with the truth
+// at each frame instant. Then extrapolates a lift-off on a half-rate channel through zero
+// (and steep rises past the top) and stores the results the way Align_Apply() does: a
+// pressure field must read 0 or full scale, never a wrapped value or PRESSURE_VALUE_DOWN.
+// Exits non-zero if alignment does not hold.
+// Usage: align_check [frames]
+#include "AlignModule.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK_PI 3.14159265358979
+
+typedef struct {
+    const char* name;
+    uint32_t periodUs;      // frame period
+    uint32_t accOffsetUs;   // accel sample instant after the frame instant
+    uint32_t inputStepUs;   // per ADS1115 input: the four devices convert in parallel
+    uint32_t deviceStepUs;  // per ADS1115: I2C traffic between the devices
+    int      slowEvery;     // odd pressure channels only sampled every n-th frame (1 = every frame)
+    uint32_t startUs;       // first frame instant, near the wrap for the last case
+} SkewCase;
+
+#define SEQUENTIAL_STEP_US  (19000 / PRESSURE_CHANNEL_COUNT)
+
+static const SkewCase CASES[] = {
+    { "parallel",   20000,  300, 1163, 150, 1, 1000000u },
+    // One conversion after the other, spread over the whole frame
+    { "sequential", 20000,  300, SEQUENTIAL_STEP_US, 4 * SEQUENTIAL_STEP_US, 1, 1000000u },
+    { "half-rate",  20000,  300, 1163, 150, 2, 1000000u },
+    { "wrap",       20000,  300, 1163, 150, 1, 0xFFFFFFFFu - 500000u },
+};
+
+typedef enum { SIG_RAMP = 0, SIG_SINE, SIG_COUNT } Signal_t;
+static const char* SIGNAL_NAME[SIG_COUNT] = { "ramp", "sine" };
+
+// Known input: value of channel ch at elapsed time t [us]
+static double truth(Signal_t sig, int ch, double t)
+{
+    if (sig == SIG_RAMP) {
+        return 1000.0 + (50.0 + 5.0 * ch) * t / 1e6;           // counts per second, per-channel slope
+    }
+    double hz = (ch < PRESSURE_CHANNEL_COUNT) ? 1.8 : 6.0;      // gait load vs. heel-strike band
+    return 8000.0 + 6000.0 * sin(2.0 * CHECK_PI * hz * t / 1e6 + 0.3 * ch);
+}
+
+typedef struct {
+    double naiveMax, naiveSq, alignMax, alignSq;
+    size_t n;
+} ErrStats;
+
+static void account(ErrStats* s, double naive, double aligned)
+{
+    s->naiveMax = fmax(s->naiveMax, fabs(naive));
+    s->alignMax = fmax(s->alignMax, fabs(aligned));
+    s->naiveSq += naive * naive;
+    s->alignSq += aligned * aligned;
+    s->n++;
+}
+
+// Two samples 40 ms apart (a 25 Hz channel), then the value one frame and one span on
+typedef struct {
+    const char* name;
+    uint8_t channel;
+    int32_t v0, v1;
+    int32_t want;           // what the frame field must hold
+} ClampCase;
+
+static const ClampCase CLAMP_CASES[] = {
+    { "lift-off",   1,                  2000,    100,   0 },
+    { "load",       1,                  30000,   32000, ALIGN_PRESSURE_MAX },
+    { "accel fall", ALIGN_CH_ACC_X,     -30000,  -32000, INT16_MIN },
+    { "accel rise", ALIGN_CH_ACC_X + 2, 30000,   32000, INT16_MAX },
+};
+
+static int checkClamp(void)
+{
+    static const uint32_t FRAMES_US[] = { 60000u, 80000u };
+    int failures = 0;
+    for (const ClampCase& c : CLAMP_CASES) {
+        for (uint32_t frameUs : FRAMES_US) {
+            Align_Reset();
+            Align_Push(c.channel, c.v0, 0);
+            Align_Push(c.channel, c.v1, 40000);
+            int32_t v = 0;
+            Align_Sample(c.channel, frameUs, &v);
+            // The stores of Align_Apply()
+            int32_t stored = (c.channel < ALIGN_CH_ACC_X) ? (int32_t)(uint16_t)v : (int32_t)(int16_t)v;
+            if (stored != c.want || (c.channel < ALIGN_CH_ACC_X && stored == PRESSURE_VALUE_DOWN)) {
+                printf("  FAIL: %s at %u us: stored %d, expected %d\n", c.name, frameUs, stored, c.want);
+                failures++;
+            }
+        }
+    }
+    printf("clamp: %s\n", failures ? "FAIL" : "ok");
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = (argc > 1) ? atoi(argv[1]) : 3000;
+    int failures = 0;
+
+    printf("%-11s %-5s %12s %12s %12s %12s\n", "case", "sig", "naive max", "naive rms", "aligned max", "aligned rms");
+    for (const SkewCase& c : CASES) {
+        for (int sig = 0; sig < SIG_COUNT; sig++) {
+            Align_Reset();
+            ErrStats st = {};
+            int32_t naive[ALIGN_CHANNEL_COUNT] = {};
+
+            for (int f = 0; f < frames; f++) {
+                double frameT = (double)f * c.periodUs;
+                uint32_t frameUs = c.startUs + (uint32_t)f * c.periodUs;
+
+                // Samples of this frame arrive after its nominal instant
+                for (int ch = 0; ch < ALIGN_CHANNEL_COUNT; ch++) {
+                    bool acc = ch >= ALIGN_CH_ACC_X;
+                    if (!acc && (ch & 1) && (f % c.slowEvery) != 0) {
+                        continue;
+                    }
+                    uint32_t offset = acc ? c.accOffsetUs :
+                                      (uint32_t)(ch % 4) * c.inputStepUs + (uint32_t)(ch / 4) * c.deviceStepUs;
+                    int32_t v = (int32_t)lround(truth((Signal_t)sig, ch, frameT + offset));
+                    Align_Push((uint8_t)ch, v, frameUs + offset);
+                    naive[ch] = v;
+                }
+
+                if (f < 2 * c.slowEvery) {
+                    continue;   // history not bracketing the frame instant yet
+                }
+                for (int ch = 0; ch < ALIGN_CHANNEL_COUNT; ch++) {
+                    int32_t aligned;
+                    if (!Align_Sample((uint8_t)ch, frameUs, &aligned)) {
+                        printf("%s: channel %d has no samples\n", c.name, ch);
+                        return 1;
+                    }
+                    double want = truth((Signal_t)sig, ch, frameT);
+                    account(&st, naive[ch] - want, aligned - want);
+                }
+            }
+
+            double naiveRms = sqrt(st.naiveSq / st.n);
+            double alignRms = sqrt(st.alignSq / st.n);
+            printf("%-11s %-5s %12.1f %12.2f %12.1f %12.2f\n", c.name, SIGNAL_NAME[sig],
+                   st.naiveMax, naiveRms, st.alignMax, alignRms);
+
+            // Linear input is reconstructed up to rounding of input and output (extrapolation
+            // doubles the input share); anything else must improve
+            double rampBound = (c.slowEvery > 1) ? 2.0 : 1.0;
+            bool ok = (sig == SIG_RAMP) ? (st.alignMax <= rampBound) : (alignRms < 0.5 * naiveRms);
+            if (!ok) {
+                printf("  FAIL: %s / %s\n", c.name, SIGNAL_NAME[sig]);
+                failures++;
+            }
+        }
+    }
+    failures += checkClamp();
+    printf("%s\n", failures ? "alignment check FAILED" : "alignment check passed");
+    return failures ? 1 : 0;
+}
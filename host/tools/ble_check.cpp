@@ -0,0 +1,541 @@
+// BLE send path check: src/BluetoothModule.cpp on the NimBLE shim, fed 50 Hz frames
+// whose sensor reads take READ_US, over a link that frees a few TX buffers per frame
+// and stalls now and then. Nothing announces a freed buffer; the comm task's retry wakes
+// (BLE_ServiceRetx) hand it what waits. Checks that sample-to-air latency is recorded once per
+// notification the stack accepted (never for frames that were only batched,
+// suppressed by send-on-delta or parked in the retry ring), that every recorded
+// latency stays within the bound the batch size, the stall and the retry wake put on it, that
+// BLE_SendFrame() reports a notification parked in the ring as not sent, and that
+// no notification of a connection reaches the next one. Then overflows
+// the retry ring of a delta stream that has no periodic keyframes and checks that the
+// receiver still ends up with the sender's frame, and that SET_DELTA refuses settings
+// whose silent gaps the sequence byte cannot count. Last, runs the self-test over
+// BLE_CMD_SELFTEST: it must wait for SensorTask to acknowledge the pause, and its
+// filler must go to the self-test characteristic, never to the stream.
+// Also streams over a slow link: packed and delta batches must grow to what the granted
+// interval and data length carry, and data length extension only counts once the
+// controller reports it, not when the link manager asks for it.
+// Exits non-zero on failure.
+// Usage: ble_check [-v]
+#include "BluetoothModule.h"
+#include "LatencyModule.h"
+#include "LoggerModule.h"
+#include "FrameCodecModule.h"
+#include "DeltaModule.h"
+#include "RetransmitModule.h"
+#include "SelfTestModule.h"
+#include "Config.h"
+#include "NimBLEDevice.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FRAME_US            (DEFAULT_LOOP_INTERVAL_MS * 1000)
+#define READ_US             3000    // sensor reads before the frame is handed to the comm task
+#define TX_PER_FRAME        4       // buffers the controller empties between two frames
+#define TX_EVENT_US         (FRAME_US / 2)  // when in the frame it does, a connection event
+#define SLACK_US            2000    // host clock running during the check itself
+#define FRAMES              250     // leaves a partial batch at 4 frames per notification, which the
+                                    // next connection must not get
+
+typedef struct {
+    const char* name;
+    uint8_t  format;
+    uint8_t  framesPerNotify;
+    bool     moving;            // pressure changes every frame; static data lets delta suppress frames
+    uint16_t txBuffers;
+    uint16_t stallFrames;       // the link completes nothing for this long, from frame 50
+    bool     expectSuppressed;  // fewer notifications than frames because delta held some back
+} Scenario;
+
+static const Scenario SCENARIOS[] = {
+    { "legacy",          FRAME_FMT_LEGACY16, 1, true,  8,  0, false },
+    { "packed12 x4",     FRAME_FMT_PACKED12, 4, true,  8,  0, false },
+    { "delta static",    FRAME_FMT_DELTA,    1, false, 8,  0, true },
+    { "legacy stall",    FRAME_FMT_LEGACY16, 1, true,  4, 10, false },
+    { "packed12 stall",  FRAME_FMT_PACKED12, 2, true,  2, 12, false },
+};
+
+static void setFormat(uint8_t format, uint8_t framesPerNotify)
+{
+    const uint8_t cmd[4] = { BLE_CMD_SET_FORMAT, format, 0xFF, framesPerNotify };
+    Shim_BleWrite(CONTROL_UUID_RIGHT, cmd, sizeof(cmd));
+}
+
+// The comm task between two frames, idleUs long: it retries the ring once after the frame
+// and then every RETX_POLL_MS while notifications wait (BLE_ServiceRetx), on the 1 ms tick.
+// Unless the link stalls, the connection event at TX_EVENT_US frees TX_PER_FRAME buffers,
+// which nothing announces.
+static void commTaskIdle(uint32_t idleUs, bool linkUp)
+{
+    uint32_t frameUs = FRAME_US - idleUs;
+    uint16_t waiting = BLE_ServiceRetx();
+    uint32_t wakeUs = frameUs + RETX_POLL_MS * 1000;
+    for (uint32_t t = frameUs + 1000; t <= FRAME_US; t += 1000) {
+        Shim_AdvanceUs(1000);
+        if (linkUp && t - 1000 < TX_EVENT_US && t >= TX_EVENT_US) {
+            Shim_BleTxDone(TX_PER_FRAME);
+        }
+        if (waiting && t >= wakeUs && t < FRAME_US) {
+            waiting = BLE_ServiceRetx();
+            wakeUs = t + RETX_POLL_MS * 1000;
+        }
+    }
+}
+
+// The link is back for good: the comm task keeps waking until the ring is empty (a ring
+// that never drains is left for the checks to find)
+static void flushRetx(void)
+{
+    for (int wake = 0; wake <= RETX_SLOTS; wake++) {
+        Shim_AdvanceUs(RETX_POLL_MS * 1000);
+        Shim_BleTxDone(0xFFFF);
+        if (BLE_ServiceRetx() == 0) {
+            break;
+        }
+    }
+}
+
+static size_t streamNotifications(void)
+{
+    size_t n = 0;
+    for (const ShimBleNotify_t& note : Shim_BleNotifications()) {
+        n += (note.uuid == CHARACTERISTIC_UUID_RIGHT);
+    }
+    return n;
+}
+
+static int runScenario(const Scenario* sc, bool verbose)
+{
+    int failures = 0;
+    Shim_BleConnect(BLE_PREFERRED_MTU);
+    Shim_BleSubscribe(CHARACTERISTIC_UUID_RIGHT, true);
+    Shim_BleSetTxBuffers(sc->txBuffers);
+    setFormat(sc->format, sc->framesPerNotify);
+    Shim_BleClearNotifications();
+    Latency_Reset();
+
+    SensorData frame;
+    memset(&frame, 0, sizeof(frame));
+    SensorFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.pressure_valid = (PressureMask_t)~(PressureMask_t)0;
+    info.adc_healthy = 0xFF;
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        frame.pressure[ch] = (uint16_t)(1000 + 10 * ch);
+    }
+
+    uint32_t notSent = 0;
+    for (uint16_t f = 0; f < FRAMES; f++) {
+        info.sample_us = micros();
+        Shim_AdvanceUs(READ_US);
+        if (sc->moving) {
+            for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+                frame.pressure[ch] = (uint16_t)(1000 + 10 * ch + (f * 37 + ch * 11) % 400);
+            }
+        }
+        notSent += !BLE_SendFrame((const uint8_t*)&frame, sizeof(frame), &info);
+        bool stalled = sc->stallFrames && f >= 50 && f < 50 + sc->stallFrames;
+        commTaskIdle(FRAME_US - READ_US, !stalled);
+        Shim_DrainQueues();     // the logger task
+    }
+    flushRetx();
+
+    LatencySummary_t lat;
+    Latency_GetSummary(&lat);
+    RetxStats_t st;
+    Retx_GetStats(&st);
+    size_t notes = streamNotifications();
+    // Every notification is in this connection's format: a batch left over from the
+    // previous connection would show up in its format
+    size_t foreign = 0;
+    for (const ShimBleNotify_t& note : Shim_BleNotifications()) {
+        if (note.uuid != CHARACTERISTIC_UUID_RIGHT) {
+            continue;
+        }
+        bool legacy = note.data.size() == sizeof(SensorData);
+        foreign += (sc->format == FRAME_FMT_LEGACY16) ? !legacy : (legacy || (note.data[0] >> 4) != sc->format);
+    }
+    // Batches never carry more than the MTU holds
+    uint8_t perNotify = sc->framesPerNotify;
+    if (sc->format != FRAME_FMT_LEGACY16 && sc->format != FRAME_FMT_DELTA) {
+        uint8_t fit = Codec_FramesPerNotification(sc->format, BLE_PREFERRED_MTU);
+        perNotify = (perNotify > fit) ? fit : perNotify;
+    }
+    // Oldest frame of a full batch waited for the rest of it. In a stall (starting on a batch
+    // boundary) the free TX buffers take the first notifications; the first one refused
+    // starts txBuffers batches in and waits for the connection event TX_EVENT_US into the
+    // frame after the stall, then up to RETX_POLL_MS for the comm task's next wake
+    uint32_t batchUs = (uint32_t)(perNotify - 1) * FRAME_US + READ_US;
+    uint32_t stallUs = (uint32_t)sc->stallFrames * FRAME_US;
+    uint32_t retxUs = stallUs - (uint32_t)(sc->txBuffers * perNotify) * FRAME_US + TX_EVENT_US;
+    uint32_t maxBound = (stallUs ? retxUs + RETX_POLL_MS * 1000 : batchUs) + SLACK_US;
+    uint32_t maxFloor = stallUs ? retxUs : batchUs;
+
+    printf("%-15s %6u %6u %8u %9u %9u %9u\n", sc->name, FRAMES, (unsigned)notes, (unsigned)lat.count,
+           (unsigned)lat.p50_us, (unsigned)lat.max_us, (unsigned)maxBound);
+
+    if (foreign) {
+        printf("  FAIL %s: %u notifications not in format %u\n", sc->name, (unsigned)foreign, sc->format);
+        failures++;
+    }
+    // A frame whose notification was parked in the retry ring was not sent
+    if (notSent != st.queued) {
+        printf("  FAIL %s: BLE_SendFrame() false %u times, %u notifications queued for retry\n", sc->name,
+               (unsigned)notSent, (unsigned)st.queued);
+        failures++;
+    }
+    if (lat.count != notes) {
+        printf("  FAIL %s: %u latencies recorded for %u notifications\n", sc->name, (unsigned)lat.count,
+               (unsigned)notes);
+        failures++;
+    }
+    if (notes == 0 || (sc->expectSuppressed != (notes * perNotify < (size_t)FRAMES - perNotify))) {
+        printf("  FAIL %s: %u notifications for %u frames\n", sc->name, (unsigned)notes, FRAMES);
+        failures++;
+    }
+    if (lat.max_us > maxBound || lat.max_us < maxFloor) {
+        printf("  FAIL %s: max latency %u us outside %u .. %u us\n", sc->name, (unsigned)lat.max_us,
+               (unsigned)maxFloor, (unsigned)maxBound);
+        failures++;
+    }
+    // Every notification waits at least for its first frame's reads (and its batch, when full)
+    uint32_t p0 = Latency_Percentile(1);
+    if (p0 < batchUs) {
+        printf("  FAIL %s: min latency %u us below the %u us batch\n", sc->name, (unsigned)p0, (unsigned)batchUs);
+        failures++;
+    }
+    if (verbose) {
+        printf("  %-15s p90 %u us, p99 %u us, %u TX buffers in flight\n", sc->name, (unsigned)lat.p90_us,
+               (unsigned)lat.p99_us, Shim_BleTxInFlight());
+    }
+    Shim_BleDisconnect();
+    Shim_DrainQueues();
+    return failures;
+}
+
+// ''''''' DELTA RESYNC ''''''''''''''''''' //
+
+#define DROP_STATIC_FRAMES  60      // unchanged frames after the stall, heartbeats only
+
+static void setDelta(uint16_t keyframeInterval, uint8_t maxSilence)
+{
+    const uint8_t cmd[7] = { BLE_CMD_SET_DELTA, DELTA_PRESSURE_DEADBAND & 0xFF, DELTA_PRESSURE_DEADBAND >> 8,
+                             DELTA_ACCEL_DEADBAND, (uint8_t)keyframeInterval, (uint8_t)(keyframeInterval >> 8),
+                             maxSilence };
+    Shim_BleWrite(CONTROL_UUID_RIGHT, cmd, sizeof(cmd));
+}
+
+static int runDeltaDrop(bool verbose)
+{
+    int failures = 0;
+    Shim_BleConnect(BLE_PREFERRED_MTU);
+    Shim_BleSubscribe(CHARACTERISTIC_UUID_RIGHT, true);
+    Shim_BleSetTxBuffers(2);
+    setFormat(FRAME_FMT_DELTA, 1);
+    setDelta(0, 10);            // heartbeats only: nothing but the drop itself can trigger a keyframe
+    setDelta(0, 0);             // no bound on a gap at all: must be refused
+    Shim_BleClearNotifications();
+
+    SensorData frame;
+    memset(&frame, 0, sizeof(frame));
+    SensorFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.pressure_valid = (PressureMask_t)~(PressureMask_t)0;
+    info.adc_healthy = 0xFF;
+
+    // The ring overflows during the stall and drops its oldest deltas. Even channels stop
+    // moving early, so their last change is in one of those; odd channels keep the ring
+    // filling. Afterwards nothing moves, so only a keyframe can repair the even ones.
+    int stall = 2 * RETX_SLOTS;
+    for (int f = 0; f < 10 + stall + DROP_STATIC_FRAMES; f++) {
+        if (f >= 10 && f < 10 + stall) {
+            for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+                int moves = (ch & 1) ? f - 10 : ((f - 10 < RETX_SLOTS / 2) ? f - 10 : RETX_SLOTS / 2);
+                frame.pressure[ch] = (uint16_t)(1000 + 200 * moves + ch);
+            }
+        }
+        info.sample_us = micros();
+        BLE_SendFrame((const uint8_t*)&frame, sizeof(frame), &info);
+        commTaskIdle(FRAME_US, f < 10 || f >= 10 + stall);
+        Shim_DrainQueues();
+    }
+    flushRetx();
+
+    RetxStats_t st;
+    Retx_GetStats(&st);
+    DeltaDecoder_t dec;
+    Delta_InitDecoder(&dec);
+    size_t notes = 0, heartbeats = 0;
+    for (const ShimBleNotify_t& note : Shim_BleNotifications()) {
+        if (note.uuid != CHARACTERISTIC_UUID_RIGHT) {
+            continue;
+        }
+        notes++;
+        size_t off = 0;
+        while (off < note.data.size()) {
+            SensorData out;
+            uint8_t elapsed;
+            size_t n = Delta_Decode(&dec, note.data.data() + off, note.data.size() - off, &out, &elapsed);
+            if (n == 0) {
+                break;
+            }
+            heartbeats += (n == 2 + DELTA_MASK_BYTES);
+            off += n;
+        }
+    }
+    int wrong = 0;
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        int d = (int)dec.current.pressure[ch] - frame.pressure[ch];
+        wrong += (d > DELTA_PRESSURE_DEADBAND || -d > DELTA_PRESSURE_DEADBAND);
+    }
+
+    printf("%-15s %6d %6u  %u dropped, %d channels off, %u heartbeats\n", "delta resync",
+           10 + stall + DROP_STATIC_FRAMES, (unsigned)notes, (unsigned)st.dropped, wrong, (unsigned)heartbeats);
+    if (st.dropped == 0) {
+        printf("  FAIL delta resync: the stall did not overflow the retry ring\n");
+        failures++;
+    }
+    if (wrong) {
+        printf("  FAIL delta resync: %d channels still off after the drop\n", wrong);
+        failures++;
+    }
+    // The refused settings would leave the static tail silent
+    if (heartbeats < DROP_STATIC_FRAMES / 10 - 2) {
+        printf("  FAIL delta resync: %u heartbeats in %d static frames, SET_DELTA without a bound was applied\n",
+               (unsigned)heartbeats, DROP_STATIC_FRAMES);
+        failures++;
+    }
+    if (verbose) {
+        printf("  delta resync    %u queued, %u resent, last dropped #%u\n", (unsigned)st.queued,
+               (unsigned)st.resent, st.lastDroppedIndex);
+    }
+    Shim_BleDisconnect();
+    Shim_DrainQueues();
+    return failures;
+}
+
+// ' SELF-TEST ' //
+
+static bool s_sensorTaskPauses = false;
+static uint32_t s_pausedFrames = 0;
+
+// Runs whenever the self-test waits: the controller sends, SensorTask reaches a frame boundary
+static void otherTasksHook(void)
+{
+    Shim_BleTxDone(TX_PER_FRAME);
+    if (SelfTest_Active()) {
+        s_pausedFrames++;
+        if (s_sensorTaskPauses) {
+            SelfTest_AckPause();
+        }
+    }
+}
+
+static void countNotifications(size_t* stream, size_t* streamOther, size_t* filler)
+{
+    *stream = *streamOther = *filler = 0;
+    for (const ShimBleNotify_t& note : Shim_BleNotifications()) {
+        if (note.uuid == CHARACTERISTIC_UUID_RIGHT) {
+            (*stream)++;
+            *streamOther += (note.data.size() != sizeof(SensorData));     // the stream is legacy here
+        } else if (note.uuid == SELFTEST_UUID_RIGHT) {
+            (*filler)++;
+        }
+    }
+}
+
+static int runSelfTest(bool verbose)
+{
+    int failures = 0;
+    const uint8_t cmd[1] = { BLE_CMD_SELFTEST };
+    Shim_BleConnect(BLE_PREFERRED_MTU);
+    Shim_BleSubscribe(CHARACTERISTIC_UUID_RIGHT, true);
+    Shim_BleSubscribe(SELFTEST_UUID_RIGHT, true);
+    Shim_BleSetTxBuffers(8);
+    Shim_SetTaskHook(otherTasksHook);
+
+    // SensorTask never gets to a frame boundary: the self-test must give up, not take the bus
+    s_sensorTaskPauses = false;
+    s_pausedFrames = 0;
+    Shim_BleClearNotifications();
+    Shim_BleWrite(CONTROL_UUID_RIGHT, cmd, sizeof(cmd));
+    SelfTest_Service();
+    Shim_DrainQueues();
+    size_t stream, streamOther, filler;
+    countNotifications(&stream, &streamOther, &filler);
+    if (filler || stream || SelfTest_Active() || s_pausedFrames == 0) {
+        printf("  FAIL self-test: ran (%u filler, %u stream notifications) without SensorTask's acknowledgement\n",
+               (unsigned)filler, (unsigned)stream);
+        failures++;
+    }
+
+    // SensorTask acknowledges between frames: the test runs, its filler stays off the stream
+    s_sensorTaskPauses = true;
+    Shim_BleClearNotifications();
+    Shim_BleWrite(CONTROL_UUID_RIGHT, cmd, sizeof(cmd));
+    SelfTest_Service();
+    Shim_DrainQueues();
+    countNotifications(&stream, &streamOther, &filler);
+    printf("%-15s %6s %6u  %u filler notifications, %u on the stream not a frame\n", "self-test", "-",
+           (unsigned)(stream + filler), (unsigned)filler, (unsigned)streamOther);
+    if (filler == 0 || SelfTest_Active()) {
+        printf("  FAIL self-test: no filler on the self-test characteristic after the acknowledged pause\n");
+        failures++;
+    }
+    if (streamOther) {
+        printf("  FAIL self-test: %u notifications on the stream that are no frame\n", (unsigned)streamOther);
+        failures++;
+    }
+    if (verbose) {
+        printf("  self-test       %u frames paused, %u stream frames from its frame phase\n",
+               (unsigned)s_pausedFrames, (unsigned)stream);
+    }
+    Shim_SetTaskHook(NULL);
+    Shim_BleDisconnect();
+    Shim_DrainQueues();
+    return failures;
+}
+
+// ' LINK BATCHING ' //
+
+#define LINK_SLOW_INTERVAL  80      // 100 ms: 4 PDUs per event, 40 per second
+#define LINK_FAST_INTERVAL  24      // 30 ms: 133 PDUs per second, single frames go through
+#define LINK_PHASE_FRAMES   360     // a multiple of every batch size below, so each phase ends on a full one
+
+// Streams moving frames with the comm task's link service in between (long enough for the
+// manager to step down to POWER and ask for data length extension); counts the stream
+// notifications that do not hold `expect` frames of frameSize (expect 0: no check) and
+// those sent after the first LINK_MEASURE_MS, once the delta stream has measured itself
+#define LINK_SETTLED_FRAMES (LINK_PHASE_FRAMES - LINK_MEASURE_MS * 1000 / FRAME_US)
+static size_t streamPhase(size_t frameSize, uint8_t expect, size_t* wrong, size_t* settled = NULL)
+{
+    Shim_BleClearNotifications();
+    uint32_t settledUs = micros() + LINK_MEASURE_MS * 1000u;
+    SensorData frame;
+    memset(&frame, 0, sizeof(frame));
+    SensorFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.pressure_valid = (PressureMask_t)~(PressureMask_t)0;
+    info.adc_healthy = 0xFF;
+    for (uint16_t f = 0; f < LINK_PHASE_FRAMES; f++) {
+        info.sample_us = micros();
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            frame.pressure[ch] = (uint16_t)(1000 + 10 * ch + (f * 37 + ch * 11) % 400);
+        }
+        BLE_SendFrame((const uint8_t*)&frame, sizeof(frame), &info);
+        Shim_AdvanceUs(FRAME_US);
+        Shim_BleTxDone(0xFFFF);
+        BLE_ServiceLink();
+        Shim_DrainQueues();
+    }
+    size_t notes = 0, late = 0;
+    *wrong = 0;
+    for (const ShimBleNotify_t& note : Shim_BleNotifications()) {
+        if (note.uuid == CHARACTERISTIC_UUID_RIGHT) {
+            notes++;
+            late += (int32_t)(note.us - settledUs) >= 0;
+            *wrong += expect && note.data.size() != expect * frameSize;
+        }
+    }
+    if (settled) {
+        *settled = late;
+    }
+    return notes;
+}
+
+static int runLinkBatching(bool verbose)
+{
+    int failures = 0;
+    const uint8_t format = FRAME_FMT_PACKED12;
+    const size_t frameSize = Codec_FrameSize(format);
+    const uint8_t fit = Codec_FramesPerNotification(format, BLE_PREFERRED_MTU);
+    Shim_BleSetTxBuffers(0xFFFF);
+    Shim_BleConnect(BLE_PREFERRED_MTU);
+    Shim_BleSubscribe(CHARACTERISTIC_UUID_RIGHT, true);
+    setFormat(format, 1);
+
+    // The central keeps a 100 ms interval and ignores the link manager's requests. Without
+    // the controller's word on data length, every notification is 27-byte PDUs: whole MTUs.
+    Shim_BleConnParams(LINK_SLOW_INTERVAL);
+    size_t wrong;
+    size_t notes = streamPhase(frameSize, fit, &wrong);
+    printf("%-15s %6u %6u  %u frames per notification, data length %u requested\n", "link 27 B", LINK_PHASE_FRAMES,
+           (unsigned)notes, fit, Shim_BleRequestedDataLen());
+    if (Shim_BleRequestedDataLen() == 0) {
+        printf("  FAIL link: the link manager never asked for data length extension\n");
+        failures++;
+    }
+    if (notes == 0 || wrong) {
+        printf("  FAIL link 27 B: %u of %u notifications not %u frames\n", (unsigned)wrong, (unsigned)notes, fit);
+        failures++;
+    }
+
+    // The controller reports 251 octets: a notification is one PDU, 40 per second carry 50 Hz in twos
+    Shim_BleDataLenChange(LINK_MAX_DATA_LEN);
+    uint8_t pairs = (fit < 2) ? fit : 2;
+    notes = streamPhase(frameSize, pairs, &wrong);
+    printf("%-15s %6u %6u  %u frames per notification\n", "link 251 B", LINK_PHASE_FRAMES, (unsigned)notes, pairs);
+    if (notes == 0 || wrong) {
+        printf("  FAIL link 251 B: %u of %u notifications not %u frames\n", (unsigned)wrong, (unsigned)notes, pairs);
+        failures++;
+    }
+
+    // A 30 ms interval carries every frame on its own: the central's count stands
+    Shim_BleConnParams(LINK_FAST_INTERVAL);
+    notes = streamPhase(frameSize, 1, &wrong);
+    printf("%-15s %6u %6u  1 frame per notification\n", "link fast", LINK_PHASE_FRAMES, (unsigned)notes);
+    if (notes == 0 || wrong) {
+        printf("  FAIL link fast: %u of %u notifications not single frames\n", (unsigned)wrong, (unsigned)notes);
+        failures++;
+    }
+    Shim_BleDisconnect();
+    Shim_DrainQueues();
+
+    // The next connection starts without data length extension. Delta batches grow as well
+    // once a window has measured the stream: to 3 frames, or as many of the largest as fit.
+    const size_t deltaFit = (BLE_PREFERRED_MTU - 3) / DELTA_MAX_FRAME_SIZE;
+    const size_t deltaWant = (deltaFit < 3) ? deltaFit : 3;
+    size_t settled;
+    Shim_BleConnect(BLE_PREFERRED_MTU);
+    Shim_BleSubscribe(CHARACTERISTIC_UUID_RIGHT, true);
+    setFormat(FRAME_FMT_DELTA, 1);
+    Shim_BleConnParams(LINK_SLOW_INTERVAL);
+    notes = streamPhase(0, 0, &wrong, &settled);
+    printf("%-15s %6u %6u  %u after the first window\n", "link delta", LINK_PHASE_FRAMES, (unsigned)notes,
+           (unsigned)settled);
+    if (settled == 0 || settled * deltaWant > LINK_SETTLED_FRAMES + deltaWant) {
+        printf("  FAIL link delta: %u notifications for the last %u frames, %u frames each expected\n",
+               (unsigned)settled, LINK_SETTLED_FRAMES, (unsigned)deltaWant);
+        failures++;
+    }
+    if (verbose) {
+        printf("  link            %u B packed frames, %u fit MTU %u\n", (unsigned)frameSize, fit, BLE_PREFERRED_MTU);
+    }
+    Shim_BleDisconnect();
+    Shim_DrainQueues();
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    LoggerInit();
+    if (!BLE_Init(true)) {
+        printf("BLE_Init failed\nble check FAILED\n");
+        return 1;
+    }
+
+    printf("%d ms frames, %d us reads, %d TX buffers freed per frame, MTU %d\n\n", DEFAULT_LOOP_INTERVAL_MS,
+           READ_US, TX_PER_FRAME, BLE_PREFERRED_MTU);
+    printf("scenario        frames  notes  latency  p50 us    max us    bound\n");
+    int failures = 0;
+    for (const Scenario& sc : SCENARIOS) {
+        failures += runScenario(&sc, verbose);
+    }
+    failures += runDeltaDrop(verbose);
+    failures += runSelfTest(verbose);
+    failures += runLinkBatching(verbose);
+
+    printf("\nble check %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,308 @@
+// Burst capture check: feeds the ring the way the drivers do (ADS1115 scan ticks, 800 Hz
+// ADXL345 FIFO drained once per frame and back-dated) for long enough to wrap the ring many
+// times and to cross the micros() wrap. An accel impact, a pressure step and a command each
+// capture a window; the check verifies the trigger instant, that the window holds every
+// record of [trigger - pre, trigger + post] in push order, the chunk round-trip, that triggers
+// while frozen are ignored, and that a window nobody closes is frozen by Burst_Poll().
+// Exits non-zero on failure.
+// Usage: burst_check
+#include "BurstModule.h"
+#include "SensorTopology.h"
+#include "Config.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define FRAME_US            20000
+#define TICKS_PER_FRAME     PRESSURE_SCAN_TICKS_PER_FRAME
+#define TICK_US             (FRAME_US / TICKS_PER_FRAME)
+#define ACC_PERIOD_US       1250        // 800 Hz
+#define CONV_US             1163
+#define UPLOAD_US           150000      // frozen this long before the "upload" releases it
+#define RUN_US              12000000u
+#define START_US            (0xFFFFFFFFu - 4000000u)    // micros() wraps 4 s into the run
+
+#define PRE_US              ((uint32_t)BURST_PRE_MS * 1000u)
+#define POST_US             ((uint32_t)BURST_POST_MS * 1000u)
+
+typedef struct {
+    const char* name;
+    BurstTrigger_t source;
+    uint32_t atUs;              // offset from START_US
+} Event;
+
+// The accel impact window spans the micros() wrap; the command comes with a second one
+// while its window is still frozen
+static const Event EVENTS[] = {
+    { "accel impact",   BURST_TRIG_ACCEL,    3900000 },
+    { "pressure step",  BURST_TRIG_PRESSURE, 6500000 },
+    { "command",        BURST_TRIG_COMMAND,  9000000 },
+};
+#define EVENT_COUNT         (sizeof(EVENTS) / sizeof(EVENTS[0]))
+#define PRESSURE_EVENT_SLOT 3
+
+typedef struct {
+    uint32_t t;
+    uint8_t  ch;
+    int16_t  v0;
+} Pushed;
+
+static std::vector<Pushed> s_log;       // pushes since the last release
+static uint32_t s_firstPushAfterRequest = 0;
+static bool s_requestPending = false;
+
+static bool after(uint32_t t, uint32_t ref)
+{
+    return (int32_t)(t - ref) >= 0;
+}
+
+static int16_t accelZ(uint32_t rel)
+{
+    const Event& e = EVENTS[0];
+    // One sample at ~8 g, otherwise 1 g at 4 mg/LSB with a little ripple
+    if (rel == e.atUs) {
+        return 2000;
+    }
+    return (int16_t)(256 + (rel / ACC_PERIOD_US) % 5);
+}
+
+static int16_t pressure(uint8_t slot, uint32_t rel)
+{
+    // Slow walk-like ramp (well below the slope threshold) plus, on one slot, a step that
+    // rises within one conversion and decays slowly
+    int32_t v = 4000 + (int32_t)((rel / 1000 + slot * 37) % 1000) * 2;
+    if (slot == PRESSURE_EVENT_SLOT && rel >= EVENTS[1].atUs) {
+        uint32_t since = rel - EVENTS[1].atUs;
+        int32_t step = 16000 - (int32_t)(since / 1000) * 40;
+        v += step > 0 ? step : 0;
+    }
+    return (int16_t)v;
+}
+
+static void push(uint8_t ch, int16_t v0, int16_t v1, int16_t v2, uint32_t t)
+{
+    if (s_requestPending) {
+        s_firstPushAfterRequest = t;
+        s_requestPending = false;
+    }
+    if (ch == BURST_CH_ACC) {
+        Burst_PushAcc(v0, v1, v2, t);
+    } else {
+        Burst_PushPressure(ch, v0, t);
+    }
+    s_log.push_back({ t, ch, v0 });
+}
+
+static uint32_t getLe(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+// Window against the pushes since the last release, and the chunk round-trip
+static bool checkWindow(const Event& e, uint32_t expectUs)
+{
+    bool ok = true;
+    BurstWindow_t w;
+    if (!Burst_GetWindow(&w)) {
+        printf("  FAIL: %s: no frozen window\n", e.name);
+        return false;
+    }
+    if (w.source != e.source || w.triggerUs != expectUs) {
+        printf("  FAIL: %s: trigger %d at %+d us, expected %d at %+d us\n", e.name, w.source,
+               (int)(w.triggerUs - expectUs), e.source, 0);
+        ok = false;
+    }
+    uint32_t start = w.triggerUs - PRE_US, end = w.triggerUs + POST_US;
+
+    // Window records appear in push order; none is later than the end, and only records that
+    // were interleaved with the first in-window one (one frame of back-dated accel) are earlier
+    size_t cursor = 0, matched = 0;
+    for (uint32_t i = 0; i < w.count; i++) {
+        const BurstRecord_t* r = Burst_GetRecord(i);
+        while (cursor < s_log.size() && !(s_log[cursor].t == r->t_us && s_log[cursor].ch == r->channel &&
+                                          s_log[cursor].v0 == r->v[0])) {
+            cursor++;
+        }
+        if (cursor == s_log.size()) {
+            printf("  FAIL: %s: record %u not in push order\n", e.name, i);
+            ok = false;
+            break;
+        }
+        cursor++;
+        if (after(r->t_us, end + 1) || !after(r->t_us, start - FRAME_US)) {
+            printf("  FAIL: %s: record %u at %+d us outside the window\n", e.name, i, (int)(r->t_us - w.triggerUs));
+            ok = false;
+        }
+        if (after(r->t_us, start)) {
+            matched++;
+        }
+    }
+    size_t expected = 0;
+    for (const Pushed& p : s_log) {
+        if (after(p.t, start) && after(end, p.t)) {
+            expected++;
+        }
+    }
+    if (matched != expected) {
+        printf("  FAIL: %s: %zu of %zu records of [T-pre, T+post] in the window\n", e.name, matched, expected);
+        ok = false;
+    }
+
+    // Encode every chunk at two payload sizes and rebuild the window
+    const size_t payloads[] = { 182, 20 };
+    for (size_t payload : payloads) {
+        uint16_t chunks = Burst_ChunkCount(payload);
+        uint8_t buf[256];
+        uint32_t got = 0, count = 0, trig = 0;
+        for (uint16_t c = 0; c < chunks; c++) {
+            size_t n = Burst_EncodeChunk(c, buf, payload);
+            if (n == 0 || n > payload || getLe(buf, 2) != c || getLe(buf + 2, 2) != chunks) {
+                printf("  FAIL: %s: chunk %u/%u header (payload %zu)\n", e.name, c, chunks, payload);
+                ok = false;
+                break;
+            }
+            if (c == 0) {
+                count = getLe(buf + 5, 4);
+                trig = getLe(buf + 9, 4);
+                if (n != BURST_CHUNK_HEADER_SIZE + BURST_META_SIZE || buf[4] != w.source || count != w.count ||
+                    trig != w.triggerUs || buf[17] != PRESSURE_CHANNEL_COUNT) {
+                    printf("  FAIL: %s: metadata chunk\n", e.name);
+                    ok = false;
+                }
+                continue;
+            }
+            for (const uint8_t* p = buf + BURST_CHUNK_HEADER_SIZE; p < buf + n; p += BURST_WIRE_RECORD_SIZE, got++) {
+                const BurstRecord_t* r = Burst_GetRecord(got);
+                if (!r || trig + getLe(p, 4) != r->t_us || p[4] != r->channel ||
+                    (int16_t)getLe(p + 5, 2) != r->v[0] || (int16_t)getLe(p + 7, 2) != r->v[1] ||
+                    (int16_t)getLe(p + 9, 2) != r->v[2]) {
+                    printf("  FAIL: %s: record %u differs after decoding (payload %zu)\n", e.name, got, payload);
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        if (got != w.count) {
+            printf("  FAIL: %s: %u of %u records uploaded (payload %zu)\n", e.name, got, w.count, payload);
+            ok = false;
+        }
+    }
+    printf("%-14s %8u %+9d %+9d %8u %7u  %s\n", e.name, w.count, (int)(w.firstUs - w.triggerUs),
+           (int)(w.lastUs - w.triggerUs), Burst_ChunkCount(182), Burst_ChunkCount(20), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void)
+{
+    int failures = 0;
+    Burst_Reset();
+    printf("ring: %d records x %zu B, pre %d ms, post %d ms, %d ADS1115 + 800 Hz accel\n\n",
+           BURST_RING_RECORDS, sizeof(BurstRecord_t), BURST_PRE_MS, BURST_POST_MS, (int)ActiveTopology::AdcCount);
+    printf("%-14s %8s %9s %9s %8s %7s  %s\n", "trigger", "records", "first us", "last us", "chunks", "@20 B", "checks");
+
+    size_t next = 0, captured = 0;
+    uint32_t pushed = 0, frozenAt = 0, accNext = START_US, tick = 0;
+    bool frozen = false, ignoredSent = false;
+    uint32_t expectUs[EVENT_COUNT] = {};
+
+    for (uint32_t rel = 0; rel < RUN_US; rel += FRAME_US) {
+        uint32_t frameUs = START_US + rel;
+
+        // Command trigger from the central, taken at the next pushed sample
+        if (next < EVENT_COUNT && EVENTS[next].source == BURST_TRIG_COMMAND && !s_requestPending &&
+            after(frameUs, START_US + EVENTS[next].atUs) && Burst_GetState() == BURST_ARMED && !frozen) {
+            Burst_Request();
+            s_requestPending = true;
+        }
+
+        // Acc_DrainFifo(): everything sampled up to now, the newest taken as now
+        while (after(frameUs, accNext)) {
+            uint32_t r = accNext - START_US;
+            push(BURST_CH_ACC, 3, -2, accelZ(r), accNext);
+            pushed++;
+            accNext += ACC_PERIOD_US;
+        }
+        // Pressure_Read(): scan ticks, devices converting in parallel
+        for (int k = 0; k < TICKS_PER_FRAME; k++, tick++) {
+            for (unsigned dev = 0; dev < ActiveTopology::AdcCount; dev++) {
+                uint32_t t = frameUs + 2000 + k * TICK_US + dev * 120 + CONV_US / 2;
+                uint8_t slot = ActiveTopology::sensorOf(dev, tick % ActiveTopology::ChannelsPerAdc);
+                push(slot, pressure(slot, t - START_US), 0, 0, t);
+                pushed++;
+            }
+        }
+        Burst_Poll(frameUs + FRAME_US - 1000);
+
+        if (Burst_GetState() == BURST_FROZEN && !frozen) {
+            frozen = true;
+            frozenAt = frameUs;
+            if (next >= EVENT_COUNT) {
+                printf("  FAIL: unexpected capture\n");
+                failures++;
+            } else {
+                const Event& e = EVENTS[next];
+                if (e.source == BURST_TRIG_ACCEL) {
+                    expectUs[next] = START_US + e.atUs;
+                } else if (e.source == BURST_TRIG_PRESSURE) {
+                    // First conversion of the stepped slot at or after the step
+                    expectUs[next] = 0;
+                    for (const Pushed& p : s_log) {
+                        if (p.ch == PRESSURE_EVENT_SLOT && after(p.t, START_US + e.atUs)) {
+                            expectUs[next] = p.t;
+                            break;
+                        }
+                    }
+                } else {
+                    expectUs[next] = s_firstPushAfterRequest;
+                }
+                if (!checkWindow(e, expectUs[next])) {
+                    failures++;
+                }
+                captured++;
+                next++;
+            }
+            // A trigger while the window waits for its upload is ignored
+            if (!ignoredSent) {
+                Burst_Request();
+                ignoredSent = true;
+            }
+        }
+        if (frozen && frameUs - frozenAt >= UPLOAD_US) {
+            Burst_Release();
+            s_log.clear();
+            frozen = false;
+        }
+    }
+
+    BurstStats_t st;
+    Burst_GetStats(&st);
+    bool statsOk = st.triggers == EVENT_COUNT && st.uploaded == EVENT_COUNT && st.ignored == 1 &&
+                   captured == EVENT_COUNT;
+    printf("\n%u records pushed (%.1f ring wraps), %u triggers, %u ignored, %u uploaded  %s\n", pushed,
+           (double)pushed / BURST_RING_RECORDS, st.triggers, st.ignored, st.uploaded, statsOk ? "ok" : "FAIL");
+    if (!statsOk) {
+        failures++;
+    }
+
+    // Sensors stop right after a trigger: Burst_Poll() closes the window once it is due
+    Burst_Reset();
+    uint32_t t0 = 0xFFFFFF00u;
+    Burst_PushAcc(0, 0, 256, t0);
+    Burst_Request();
+    Burst_PushAcc(0, 0, 256, t0 + ACC_PERIOD_US);
+    Burst_Poll(t0 + ACC_PERIOD_US + POST_US);
+    bool early = Burst_GetState() == BURST_POST;
+    Burst_Poll(t0 + ACC_PERIOD_US + POST_US + (uint32_t)LOOP_INTERVAL_MS * 1000u);
+    BurstWindow_t w;
+    bool pollOk = early && Burst_GetWindow(&w) && w.source == BURST_TRIG_COMMAND && w.count == 2 &&
+                  w.triggerUs == t0 + ACC_PERIOD_US;
+    printf("stalled sensors: window closed by Burst_Poll  %s\n", pollOk ? "ok" : "FAIL");
+    if (!pollOk) {
+        failures++;
+    }
+
+    printf("%s\n", failures ? "burst check FAILED" : "burst check passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+// Packed pressure format benchmark: frames per notification, pack and unpack throughput.
+// Usage: codec_bench [frames] [seconds]
+#include "FrameCodecModule.h"
+#include "FrameDecoder.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const char* FORMAT_NAME[FRAME_FMT_COUNT] = { "legacy16", "packed16", "packed12", "packed10", "packed8" };
+static const uint16_t MTUS[] = { 23, 50, 185, 247 };
+
+int main(int argc, char** argv)
+{
+    size_t frames = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 16384;
+    double seconds = (argc > 2) ? atof(argv[2]) : 1.0;
+
+    std::vector<SensorData> input(frames);
+    srand(7);
+    for (auto& d : input) {
+        d.battery = 200;
+        d.accel_x = (int16_t)(rand() % 400 - 200);
+        d.accel_y = (int16_t)(rand() % 400 - 200);
+        d.accel_z = (int16_t)(98 + rand() % 20);
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) d.pressure[c] = (uint16_t)(rand() % 32768);
+    }
+
+    printf("%-9s %5s", "format", "bytes");
+    for (uint16_t mtu : MTUS) printf("  mtu%-4u", mtu);
+    printf("  %12s %12s\n", "pack Mf/s", "unpack Mf/s");
+
+    std::vector<uint16_t> cols[PRESSURE_CHANNEL_COUNT];
+    std::vector<uint8_t> batt(frames);
+    std::vector<int16_t> ax(frames), ay(frames), az(frames);
+    FrameColumns out = { frames, nullptr, batt.data(), ax.data(), ay.data(), az.data(), {}, nullptr, nullptr };
+    for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+        cols[c].resize(frames);
+        out.pressure[c] = cols[c].data();
+    }
+
+    for (uint8_t fmt = 0; fmt < FRAME_FMT_COUNT; fmt++) {
+        size_t size = Codec_FrameSize(fmt);
+        printf("%-9s %5zu", FORMAT_NAME[fmt], size);
+        for (uint16_t mtu : MTUS) printf("  %7u", Codec_FramesPerNotification(fmt, mtu));
+
+        FrameCodecConfig cfg = { fmt, Codec_DefaultShift(fmt), 1 };
+        std::vector<uint8_t> stream(frames * size);
+
+        // Pack
+        size_t packed = 0;
+        auto start = std::chrono::steady_clock::now();
+        double elapsed = 0;
+        do {
+            uint8_t* p = stream.data();
+            for (size_t i = 0; i < frames; i++) {
+                p += Codec_Encode(&input[i], NULL, &cfg, p, size);
+            }
+            packed += frames;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < seconds);
+        double packRate = packed / elapsed;
+
+        // Unpack
+        size_t unpacked = 0;
+        start = std::chrono::steady_clock::now();
+        do {
+            DecoderResult r = (fmt == FRAME_FMT_LEGACY16)
+                ? Decoder_DecodeBatch(stream.data(), stream.size(), FRAME_LAYOUT_RAW, out)
+                : Decoder_DecodePacked(stream.data(), stream.size(), out);
+            if (r.status != DECODER_OK) {
+                printf("  decode failed: %s\n", Decoder_StatusString(r.status));
+                return 1;
+            }
+            unpacked += r.frames;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < seconds);
+
+        printf("  %12.1f %12.1f\n", packRate / 1e6, unpacked / elapsed / 1e6);
+    }
+    return 0;
+}
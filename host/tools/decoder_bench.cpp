@@ -0,0 +1,90 @@
+// Batch decoder throughput benchmark.
+// Usage: decoder_bench [frames_per_batch] [seconds]
+#include "FrameDecoder.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+struct ColumnStore {
+    std::vector<uint32_t> timestamp;
+    std::vector<uint8_t>  battery;
+    std::vector<int16_t>  accel[3];
+    std::vector<uint16_t> pressure[PRESSURE_CHANNEL_COUNT];
+
+    explicit ColumnStore(size_t rows) : timestamp(rows), battery(rows) {
+        for (auto& a : accel) a.resize(rows);
+        for (auto& p : pressure) p.resize(rows);
+    }
+
+    FrameColumns columns() {
+        FrameColumns c = {};
+        c.capacity = battery.size();
+        c.timestamp = timestamp.data();
+        c.battery = battery.data();
+        c.accel_x = accel[0].data();
+        c.accel_y = accel[1].data();
+        c.accel_z = accel[2].data();
+        for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) c.pressure[i] = pressure[i].data();
+        return c;
+    }
+};
+
+static std::vector<uint8_t> makeStream(size_t frames, const FrameLayout& layout)
+{
+    std::vector<uint8_t> buf(frames * layout.stride);
+    srand(1);
+    for (size_t i = 0; i < frames; i++) {
+        uint8_t* rec = buf.data() + i * layout.stride;
+        if (layout.timestampOffset >= 0) {
+            uint32_t t = (uint32_t)(i * 20);
+            memcpy(rec + layout.timestampOffset, &t, 4);
+        }
+        SensorData d;
+        d.battery = 200;
+        d.accel_x = (int16_t)(rand() % 400 - 200);
+        d.accel_y = (int16_t)(rand() % 400 - 200);
+        d.accel_z = (int16_t)(98 + rand() % 20);
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) d.pressure[c] = (uint16_t)(rand() % 32768);
+        memcpy(rec + layout.frameOffset, &d, sizeof(d));
+    }
+    return buf;
+}
+
+static void run(const char* name, const FrameLayout& layout, size_t frames, double seconds)
+{
+    std::vector<uint8_t> stream = makeStream(frames, layout);
+    ColumnStore store(frames);
+    FrameColumns cols = store.columns();
+
+    size_t total = 0;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        DecoderResult r = Decoder_DecodeBatch(stream.data(), stream.size(), layout, cols);
+        if (r.status != DECODER_OK) {
+            printf("%s: decode failed: %s\n", name, Decoder_StatusString(r.status));
+            return;
+        }
+        total += r.frames;
+        checksum += store.pressure[total % PRESSURE_CHANNEL_COUNT][total % frames];
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < seconds);
+
+    double fps = total / elapsed;
+    printf("%-12s %10.1f Mframes/s  %8.1f Mframes/min  %7.2f GB/s  (checksum %llu)\n",
+           name, fps / 1e6, fps * 60 / 1e6, fps * layout.stride / 1e9, (unsigned long long)checksum);
+}
+
+int main(int argc, char** argv)
+{
+    size_t frames = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 65536;
+    double seconds = (argc > 2) ? atof(argv[2]) : 2.0;
+
+    printf("batch of %zu frames, %.1f s per layout\n", frames, seconds);
+    run("raw39", FRAME_LAYOUT_RAW, frames, seconds);
+    run("timestamped", FRAME_LAYOUT_TIMESTAMPED, frames, seconds);
+    return 0;
+}
@@ -0,0 +1,318 @@
+// Malformed-input check for the host decoders: feeds host/src/FrameDecoder.cpp and the
+// firmware codecs truncated, oversized and bad-header input in every format (raw and
+// timestamped batches, each packed format, delta frames) and checks the status, the
+// frames and bytes reported, and that nothing is written past the output capacity or
+// read past the input (the input always ends at a buffer end; build with
+// -fsanitize=address to have stray reads reported). Ends with random garbage.
+// Exits non-zero on failure.
+// Usage: decoder_check [fuzz iterations]
+#include "FrameDecoder.h"
+#include "FrameCodecModule.h"
+#include "DeltaModule.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define CAPACITY    8
+#define GUARD       4
+#define CANARY      0xA5
+
+static int s_failures = 0;
+
+static void expect(bool ok, const char* what, size_t arg)
+{
+    if (!ok && s_failures++ < 20) {
+        printf("  FAIL %s (%zu)\n", what, arg);
+    }
+}
+
+// Output columns of CAPACITY rows, followed by GUARD rows that must stay untouched
+struct Columns {
+    std::vector<uint32_t> timestamp;
+    std::vector<uint8_t>  battery;
+    std::vector<int16_t>  accel[3];
+    std::vector<uint16_t> pressure[PRESSURE_CHANNEL_COUNT];
+    std::vector<PressureMask_t> valid;
+    std::vector<uint8_t>  healthy;
+
+    Columns() {
+        timestamp.resize(CAPACITY + GUARD);
+        battery.resize(CAPACITY + GUARD);
+        for (auto& a : accel) a.resize(CAPACITY + GUARD);
+        for (auto& p : pressure) p.resize(CAPACITY + GUARD);
+        valid.resize(CAPACITY + GUARD);
+        healthy.resize(CAPACITY + GUARD);
+        poison();
+    }
+    void poison() {
+        memset(timestamp.data(), CANARY, timestamp.size() * sizeof(uint32_t));
+        memset(battery.data(), CANARY, battery.size());
+        for (auto& a : accel) memset(a.data(), CANARY, a.size() * sizeof(int16_t));
+        for (auto& p : pressure) memset(p.data(), CANARY, p.size() * sizeof(uint16_t));
+        memset(valid.data(), CANARY, valid.size() * sizeof(PressureMask_t));
+        memset(healthy.data(), CANARY, healthy.size());
+    }
+    FrameColumns view() {
+        FrameColumns c = {};
+        c.capacity = CAPACITY;
+        c.timestamp = timestamp.data();
+        c.battery = battery.data();
+        c.accel_x = accel[0].data();
+        c.accel_y = accel[1].data();
+        c.accel_z = accel[2].data();
+        for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) c.pressure[i] = pressure[i].data();
+        c.valid = valid.data();
+        c.adcHealthy = healthy.data();
+        return c;
+    }
+    // Rows from `first` on were not written
+    bool untouchedFrom(size_t first) const {
+        for (size_t r = first; r < CAPACITY + GUARD; r++) {
+            bool clean = battery[r] == CANARY && (uint16_t)accel[2][r] == 0xA5A5 &&
+                         pressure[PRESSURE_CHANNEL_COUNT - 1][r] == 0xA5A5 && healthy[r] == CANARY &&
+                         timestamp[r] == 0xA5A5A5A5u;
+            if (!clean) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+static SensorData sampleFrame(int i)
+{
+    SensorData d;
+    d.battery = (uint8_t)(80 + i);
+    d.accel_x = (int16_t)(-100 * i);
+    d.accel_y = (int16_t)(7 * i);
+    d.accel_z = 981;
+    for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+        d.pressure[c] = (uint16_t)((c * 1031 + i * 97) & 0x7FFF);
+    }
+    return d;
+}
+
+// Input in a heap block of exactly `len` bytes, so a read past the end is out of bounds
+static std::vector<uint8_t> exact(const uint8_t* data, size_t len)
+{
+    return std::vector<uint8_t>(data, data + len);
+}
+
+static void checkBatch(const char* name, const FrameLayout& layout)
+{
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < CAPACITY + 3; i++) {
+        std::vector<uint8_t> rec(layout.stride, 0);
+        if (layout.timestampOffset >= 0) {
+            uint32_t t = 1000u + (uint32_t)i * 20;
+            memcpy(rec.data() + layout.timestampOffset, &t, 4);
+        }
+        SensorData d = sampleFrame(i);
+        memcpy(rec.data() + layout.frameOffset, &d, sizeof(d));
+        stream.insert(stream.end(), rec.begin(), rec.end());
+    }
+
+    Columns cols;
+    FrameColumns out = cols.view();
+    // Every truncated length of the first two records
+    for (size_t len = 0; len < 2 * layout.stride; len++) {
+        cols.poison();
+        std::vector<uint8_t> in = exact(stream.data(), len);
+        DecoderResult r = Decoder_DecodeBatch(in.data(), len, layout, out);
+        size_t whole = len / layout.stride;
+        expect(r.frames == whole && r.bytesConsumed == whole * layout.stride, name, len);
+        expect(r.status == ((len % layout.stride) ? DECODER_ERR_TRUNCATED : DECODER_OK), name, len);
+        expect(cols.untouchedFrom(whole), name, len);
+    }
+    // Oversized: more records than the columns hold, with and without a starting row
+    for (size_t row = 0; row <= CAPACITY + 1; row++) {
+        cols.poison();
+        DecoderResult r = Decoder_DecodeBatch(stream.data(), stream.size(), layout, out, row);
+        size_t room = (row < CAPACITY) ? CAPACITY - row : 0;
+        expect(r.status == DECODER_ERR_CAPACITY && r.frames == room, name, row);
+        expect(cols.untouchedFrom(CAPACITY), name, row);
+    }
+    // Timestamps going backwards are decoded and reported
+    if (layout.timestampOffset >= 0) {
+        std::vector<uint8_t> back(stream.begin(), stream.begin() + 3 * layout.stride);
+        uint32_t t = 5;
+        memcpy(back.data() + 2 * layout.stride + layout.timestampOffset, &t, 4);
+        DecoderResult r = Decoder_DecodeBatch(back.data(), back.size(), layout, out);
+        expect(r.status == DECODER_ERR_TIMESTAMP && r.frames == 3, name, 3);
+    }
+    // Bad arguments
+    DecoderResult r = Decoder_DecodeBatch(nullptr, layout.stride, layout, out);
+    expect(r.status == DECODER_ERR_ARGS && r.frames == 0, name, 0);
+    FrameColumns missing = out;
+    missing.pressure[PRESSURE_CHANNEL_COUNT / 2] = nullptr;
+    r = Decoder_DecodeBatch(stream.data(), stream.size(), layout, missing);
+    expect(r.status == DECODER_ERR_ARGS && r.frames == 0, name, 1);
+}
+
+static void checkLayouts(void)
+{
+    Columns cols;
+    FrameColumns out = cols.view();
+    uint8_t buf[2 * FRAME_SIZE_TIMESTAMPED] = {0};
+    const FrameLayout bad[] = {
+        { 0, 0, -1 },                                       // no stride
+        { FRAME_SIZE_RAW - 1, 0, -1 },                      // frame longer than the record
+        { FRAME_SIZE_TIMESTAMPED, 5, 0 },                   // frame runs past the record
+        { FRAME_SIZE_TIMESTAMPED, 4, (int)FRAME_SIZE_TIMESTAMPED - 2 },   // timestamp runs past it
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        cols.poison();
+        DecoderResult r = Decoder_DecodeBatch(buf, sizeof(buf), bad[i], out);
+        expect(r.status == DECODER_ERR_ARGS && r.frames == 0 && cols.untouchedFrom(0), "bad layout", i);
+    }
+}
+
+static void checkPacked(uint8_t fmt)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "packed fmt %u", fmt);
+    FrameCodecConfig cfg = { fmt, Codec_DefaultShift(fmt), 1 };
+    size_t size = Codec_FrameSize(fmt);
+    SensorFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.pressure_valid = (PressureMask_t)0x5A5A5A5Au;
+    info.adc_healthy = 0x02;
+
+    std::vector<uint8_t> stream((CAPACITY + 3) * size);
+    for (int i = 0; i < CAPACITY + 3; i++) {
+        SensorData d = sampleFrame(i);
+        expect(Codec_Encode(&d, &info, &cfg, stream.data() + i * size, size) == size, name, (size_t)i);
+    }
+
+    Columns cols;
+    FrameColumns out = cols.view();
+    // Every truncated length of the first two frames
+    for (size_t len = 0; len < 2 * size; len++) {
+        cols.poison();
+        std::vector<uint8_t> in = exact(stream.data(), len);
+        DecoderResult r = Decoder_DecodePacked(in.data(), len, out);
+        size_t whole = len / size;
+        expect(r.frames == whole && r.bytesConsumed == whole * size, name, len);
+        expect(r.status == ((len % size) ? DECODER_ERR_TRUNCATED : DECODER_OK), name, len);
+        expect(cols.untouchedFrom(whole), name, len);
+        SensorData d;
+        expect(Codec_Decode(in.data(), len, fmt, &d, NULL) == ((len >= size) ? size : 0), name, len);
+    }
+    if (cols.valid[0] != info.pressure_valid || cols.healthy[0] != info.adc_healthy) {
+        expect(false, "packed status", fmt);
+    }
+    // Oversized
+    for (size_t row = 0; row <= CAPACITY + 1; row++) {
+        cols.poison();
+        DecoderResult r = Decoder_DecodePacked(stream.data(), stream.size(), out, row);
+        size_t room = (row < CAPACITY) ? CAPACITY - row : 0;
+        expect(r.status == DECODER_ERR_CAPACITY && r.frames == room && r.bytesConsumed == room * size, name, row);
+        expect(cols.untouchedFrom(CAPACITY), name, row);
+    }
+    // Bad header in the second frame: legacy, unused numbers, delta
+    const uint8_t badFormats[] = { FRAME_FMT_LEGACY16, FRAME_FMT_COUNT, 7, FRAME_FMT_DELTA, 15 };
+    for (uint8_t bad : badFormats) {
+        cols.poison();
+        std::vector<uint8_t> in(stream.begin(), stream.begin() + 3 * size);
+        in[size] = (uint8_t)((bad << 4) | (in[size] & 0x0F));
+        DecoderResult r = Decoder_DecodePacked(in.data(), in.size(), out);
+        expect(r.status == DECODER_ERR_FORMAT && r.frames == 1 && r.bytesConsumed == size, name, bad);
+        expect(cols.untouchedFrom(1), name, bad);
+        SensorData d;
+        expect(Codec_Decode(in.data() + size, in.size() - size, fmt, &d, NULL) == 0, name, bad);
+    }
+    // Bad arguments
+    DecoderResult r = Decoder_DecodePacked(nullptr, size, out);
+    expect(r.status == DECODER_ERR_ARGS && r.frames == 0, name, 0);
+}
+
+static void checkDelta(void)
+{
+    DeltaEncoder_t enc;
+    Delta_InitEncoder(&enc);
+    enc.keyframeInterval = 0;
+    uint8_t key[DELTA_MAX_FRAME_SIZE];
+    uint8_t delta[DELTA_MAX_FRAME_SIZE];
+    SensorData a = sampleFrame(0);
+    SensorData b = sampleFrame(5);
+    size_t keyLen = Delta_Encode(&enc, &a, NULL, key, sizeof(key));
+    size_t deltaLen = Delta_Encode(&enc, &b, NULL, delta, sizeof(delta));
+    expect(keyLen == DELTA_KEYFRAME_SIZE && deltaLen > 2 + DELTA_MASK_BYTES, "delta encode", deltaLen);
+
+    DeltaDecoder_t dec;
+    Delta_InitDecoder(&dec);
+    SensorData out;
+    uint8_t elapsed;
+    for (size_t len = 0; len < keyLen; len++) {
+        std::vector<uint8_t> in = exact(key, len);
+        expect(Delta_Decode(&dec, in.data(), len, &out, &elapsed) == 0 && !dec.synced, "delta keyframe", len);
+    }
+    expect(Delta_Decode(&dec, key, keyLen, &out, &elapsed) == keyLen, "delta keyframe", keyLen);
+    DeltaDecoder_t synced = dec;
+    for (size_t len = 0; len < deltaLen; len++) {
+        std::vector<uint8_t> in = exact(delta, len);
+        expect(Delta_Decode(&dec, in.data(), len, &out, &elapsed) == 0, "delta frame", len);
+        expect(memcmp(&dec, &synced, sizeof(dec)) == 0, "delta frame untouched", len);
+    }
+    uint8_t bad[DELTA_MAX_FRAME_SIZE];
+    memcpy(bad, delta, deltaLen);
+    bad[0] = (uint8_t)((FRAME_FMT_PACKED12 << 4) | DELTA_KIND_DELTA);
+    expect(Delta_Decode(&dec, bad, deltaLen, &out, &elapsed) == 0, "delta bad format", 0);
+    bad[0] = (uint8_t)((FRAME_FMT_DELTA << 4) | 0x0F);
+    expect(Delta_Decode(&dec, bad, deltaLen, &out, &elapsed) == 0, "delta bad kind", 0);
+    expect(memcmp(&dec, &synced, sizeof(dec)) == 0, "delta bad header untouched", 0);
+}
+
+// Random bytes: whatever comes back must be consistent with the input
+static void fuzz(int iterations)
+{
+    Columns cols;
+    FrameColumns out = cols.view();
+    srand(7);
+    for (int it = 0; it < iterations; it++) {
+        size_t len = (size_t)(rand() % 400);
+        std::vector<uint8_t> in(len);
+        for (auto& b : in) b = (uint8_t)rand();
+        // Mostly valid headers, so decoding gets past the first byte
+        for (size_t p = 0; p < len; p += 1 + rand() % 40) {
+            if (rand() % 2) in[p] = (uint8_t)(((1 + rand() % 4) << 4) | (rand() & 0x0F));
+        }
+        cols.poison();
+        DecoderResult r = Decoder_DecodePacked(in.data(), len, out);
+        expect(r.bytesConsumed <= len && r.frames <= CAPACITY && cols.untouchedFrom(CAPACITY), "fuzz packed", (size_t)it);
+        expect(r.status == DECODER_OK ? r.bytesConsumed == len : r.status != DECODER_ERR_TIMESTAMP, "fuzz status", (size_t)it);
+        r = Decoder_DecodeBatch(in.data(), len, FRAME_LAYOUT_TIMESTAMPED, out);
+        expect(r.bytesConsumed <= len && r.frames <= CAPACITY && cols.untouchedFrom(CAPACITY), "fuzz batch", (size_t)it);
+
+        DeltaDecoder_t dec;
+        Delta_InitDecoder(&dec);
+        SensorData d;
+        uint8_t elapsed;
+        size_t pos = 0;
+        while (pos < len) {
+            size_t n = Delta_Decode(&dec, in.data() + pos, len - pos, &d, &elapsed);
+            if (n == 0) break;
+            pos += n;
+        }
+        expect(pos <= len, "fuzz delta", (size_t)it);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 20000;
+
+    checkBatch("raw batch", FRAME_LAYOUT_RAW);
+    checkBatch("timestamped batch", FRAME_LAYOUT_TIMESTAMPED);
+    checkLayouts();
+    for (uint8_t fmt = FRAME_FMT_PACKED16; fmt < FRAME_FMT_COUNT; fmt++) {
+        checkPacked(fmt);
+    }
+    checkDelta();
+    fuzz(iterations);
+
+    printf("raw, timestamped, packed16/12/10/8 and delta input, %d fuzz iterations\n", iterations);
+    printf("decoder check %s\n", s_failures ? "FAILED" : "passed");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+// Send-on-delta check and benchmark: encodes synthetic gait traces with several deadband
+// settings, reconstructs them like a receiver and reports the air bytes against the fixed
+// formats. Fails (non-zero exit) if a reconstructed channel leaves its deadband on a clean
+// link, the heartbeat gap is exceeded, or a lossy link does not heal by the next keyframe.
+// Usage: delta_bench [frames] [loss percent]
+#include "DeltaModule.h"
+#include "FrameCodecModule.h"
+#include "TraceModule.h"
+#include "Config.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_PERIOD_MS     20
+
+typedef struct {
+    const char* name;
+    uint16_t pressure;
+    uint16_t accel;
+} Deadband;
+
+static const Deadband DEADBANDS[] = {
+    { "exact",   0, 0 },
+    { "fine",   32, 2 },
+    { "default", DELTA_PRESSURE_DEADBAND, DELTA_ACCEL_DEADBAND },
+    { "coarse", 128, 6 },
+};
+
+static const TraceGait_t GAITS[] = { TRACE_GAIT_STAND, TRACE_GAIT_WALK, TRACE_GAIT_RUN };
+static const char* GAIT_NAME[] = { "stand", "walk", "run" };
+
+static int32_t channelOf(const SensorData* d, int ch)
+{
+    if (ch < PRESSURE_CHANNEL_COUNT) return d->pressure[ch];
+    if (ch == DELTA_CH_ACC_X)        return d->accel_x;
+    if (ch == DELTA_CH_ACC_X + 1)    return d->accel_y;
+    if (ch == DELTA_CH_ACC_X + 2)    return d->accel_z;
+    return d->battery;
+}
+
+typedef struct {
+    size_t bytes, sent, keyframes, maxGap;
+    int32_t maxErr[2];          // pressure, accel
+    size_t violations;          // frames outside the deadband (clean) / after healing (lossy)
+    size_t lost;
+} RunStats;
+
+// Deterministic loss pattern, same for every run
+static uint32_t s_lossState;
+static bool dropNext(unsigned lossPercent)
+{
+    s_lossState = s_lossState * 1103515245u + 12345u;
+    return ((s_lossState >> 16) % 100) < lossPercent;
+}
+
+static RunStats runOne(TraceGait_t gait, const Deadband& db, int frames, unsigned lossPercent)
+{
+    RunStats st = {};
+    DeltaEncoder_t enc;
+    DeltaDecoder_t dec;
+    Delta_InitEncoder(&enc);
+    Delta_InitDecoder(&dec);
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) enc.deadband[ch] = db.pressure;
+    for (int axis = 0; axis < 3; axis++) enc.deadband[DELTA_CH_ACC_X + axis] = db.accel;
+    s_lossState = 1;
+
+    uint8_t buf[DELTA_MAX_FRAME_SIZE];
+    SensorData rx = {};
+    long rxFrame = -1;          // frame index the reconstruction stands at
+    int lastSent = 0;
+    long healedAt = 0;          // after a loss, the receiver is exact again from the next keyframe on
+
+    for (int f = 0; f < frames; f++) {
+        SensorData in;
+        Trace_Synthesize(gait, (uint32_t)f * FRAME_PERIOD_MS, &in);
+
+        size_t n = Delta_Encode(&enc, &in, NULL, buf, sizeof(buf));
+        if (n > 0) {
+            st.bytes += n;
+            st.sent++;
+            if ((buf[0] & 0x0F) == DELTA_KIND_KEY) st.keyframes++;
+            if ((size_t)(f - lastSent) > st.maxGap && f > 0) st.maxGap = (size_t)(f - lastSent);
+            lastSent = f;
+
+            if (lossPercent && dropNext(lossPercent)) {
+                st.lost++;
+                healedAt = -1;
+            } else {
+                uint8_t elapsed;
+                if (Delta_Decode(&dec, buf, n, &rx, &elapsed) != n) {
+                    printf("  decode failed at frame %d\n", f);
+                    st.violations++;
+                    return st;
+                }
+                if (elapsed) {
+                    rxFrame = (rxFrame < 0) ? f : rxFrame + elapsed;
+                    if (rxFrame != f) {
+                        printf("  frame count off at frame %d (receiver at %ld)\n", f, rxFrame);
+                        st.violations++;
+                        return st;
+                    }
+                }
+                if (healedAt < 0 && (buf[0] & 0x0F) == DELTA_KIND_KEY) healedAt = f;
+            }
+        }
+        if (rxFrame < 0 || healedAt < 0) {
+            continue;           // before the first keyframe, or waiting for one after a loss
+        }
+
+        // Frames without a notification hold the previous reconstruction
+        bool outside = false;
+        for (int ch = 0; ch < DELTA_CHANNEL_COUNT; ch++) {
+            int32_t err = abs(channelOf(&rx, ch) - channelOf(&in, ch));
+            int kind = (ch < PRESSURE_CHANNEL_COUNT) ? 0 : 1;
+            if (ch != DELTA_CH_BATTERY && err > st.maxErr[kind]) st.maxErr[kind] = err;
+            if (err > enc.deadband[ch]) outside = true;
+        }
+        if (outside) st.violations++;
+    }
+    return st;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = (argc > 1) ? atoi(argv[1]) : 3000;
+    unsigned lossPercent = (argc > 2) ? (unsigned)atoi(argv[2]) : 2;
+    double seconds = frames * FRAME_PERIOD_MS / 1000.0;
+    double legacyBps = (double)Codec_FrameSize(FRAME_FMT_LEGACY16) * frames / seconds;
+    double packed12Bps = (double)Codec_FrameSize(FRAME_FMT_PACKED12) * frames / seconds;
+    int failures = 0;
+
+    printf("%d frames at %d ms, %d pressure channels; legacy %.0f B/s, packed12 %.0f B/s\n\n",
+           frames, FRAME_PERIOD_MS, PRESSURE_CHANNEL_COUNT, legacyBps, packed12Bps);
+    printf("%-6s %-8s %6s %9s %8s %8s %6s %7s %7s\n", "gait", "deadband", "sent%", "B/s",
+           "vs leg", "vs p12", "gap", "max dP", "max dA");
+    for (size_t g = 0; g < sizeof(GAITS) / sizeof(GAITS[0]); g++) {
+        for (const Deadband& db : DEADBANDS) {
+            RunStats st = runOne(GAITS[g], db, frames, 0);
+            double bps = st.bytes / seconds;
+            printf("%-6s %-8s %5.1f%% %9.0f %7.1f%% %7.1f%% %6zu %7d %7d\n", GAIT_NAME[g], db.name,
+                   100.0 * st.sent / frames, bps, 100.0 * (1.0 - bps / legacyBps),
+                   100.0 * (1.0 - bps / packed12Bps), st.maxGap, st.maxErr[0], st.maxErr[1]);
+            if (st.violations || st.maxGap > DELTA_MAX_SILENCE) {
+                printf("  FAIL: %s / %s: %zu frames outside the deadband, gap %zu\n",
+                       GAIT_NAME[g], db.name, st.violations, st.maxGap);
+                failures++;
+            }
+        }
+    }
+
+    // A lost notification may leave the receiver off until the next keyframe, never longer
+    if (lossPercent) {
+        printf("\n%u%% notifications lost, checked from the next keyframe on:\n", lossPercent);
+        for (size_t g = 0; g < sizeof(GAITS) / sizeof(GAITS[0]); g++) {
+            RunStats st = runOne(GAITS[g], DEADBANDS[2], frames, lossPercent);
+            printf("%-6s %-8s lost %4zu, keyframes %4zu, frames outside the deadband %zu\n",
+                   GAIT_NAME[g], DEADBANDS[2].name, st.lost, st.keyframes, st.violations);
+            if (st.violations) {
+                printf("  FAIL: %s did not heal at the keyframe\n", GAIT_NAME[g]);
+                failures++;
+            }
+        }
+    }
+
+    printf("%s\n", failures ? "delta check FAILED" : "delta check passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,329 @@
+// ADS1115 fault injection: runs the sensor task's per-frame path (Pressure_Read, filter,
+// alignment, PackSensorData/PackSensorInfo) against the programmable ADS1X15 shim and
+// injects read errors, conversion timeouts and a device missing at boot. Every frame is
+// sent through the legacy, packed and delta encodings and decoded again. Checks that a
+// downed device's channels reach the receiver as PRESSURE_VALUE_DOWN with their valid and
+// health bits clear in every format, that the working devices keep their conversion rate,
+// that a frame never overruns the loop period, that devices recover, that a device
+// missing from the boot discovery map is not probed, and that a boot discovery with more
+// devices than the map holds leaves the map empty so every device is probed.
+// Exits non-zero on failure.
+// Usage: fault_check [-v]
+#include "PressureModule.h"
+#include "FilterModule.h"
+#include "AlignModule.h"
+#include "FrameCodecModule.h"
+#include "DeltaModule.h"
+#include "UtilitiesModule.h"
+#include "BootModule.h"
+#include "LoggerModule.h"
+#include "Config.h"
+#include <Adafruit_ADS1X15.h>
+#include <Wire.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#define FRAMES_PER_PHASE    (2 * 1000 / LOOP_INTERVAL_MS)   // two seconds
+#define RATE_TOLERANCE      0.02                            // conversions/s of a working device
+
+typedef struct {
+    const char* name;
+    ShimAdsMode_t mode[PRESSURE_ADC_COUNT];
+    uint8_t expectDown;         // devices that must be down once the phase settled
+    int settleFrames;           // frames allowed to detect or recover
+} Phase;
+
+typedef struct {
+    double maxFrameMs;
+    double readsPerSec[PRESSURE_ADC_COUNT];
+    int failures;
+} PhaseResult;
+
+static DeltaEncoder_t s_deltaEnc;
+static DeltaDecoder_t s_deltaDec;
+
+static void setModes(const ShimAdsMode_t* mode)
+{
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        Shim_AdsSetMode(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address, mode[dev]);
+    }
+}
+
+static void fail(PhaseResult* r, const char* phase, int frame, const char* what, int index, int got, int want)
+{
+    if (r->failures++ < 10) {
+        printf("  FAIL %s frame %d: %s %d: %d, expected %d\n", phase, frame, what, index, got, want);
+    }
+}
+
+// The sensor task's frame, as in main.cpp; returns its wall time
+static double runFrame(SensorData* frame, SensorFrameInfo* info)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    uint32_t sampleUs = micros();
+    Pressure_Read();
+    if (DSP_DECIMATION_ENABLED) {
+        Filter_Apply();
+    }
+    if (ALIGN_ENABLED) {
+        Align_Apply(sampleUs);
+    }
+    PackSensorData(*frame);
+    PackSensorInfo(*info);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    Shim_DrainQueues();
+    Shim_AdvanceUs((uint64_t)LOOP_INTERVAL_MS * 1000);
+    return ms;
+}
+
+// A settled frame: downed channels carry the marker, working ones the shim's value
+static void checkFrame(PhaseResult* r, const Phase* p, int f, const SensorData* frame, const SensorFrameInfo* info)
+{
+    uint8_t wantHealthy = (uint8_t)(((1u << PRESSURE_ADC_COUNT) - 1) & ~p->expectDown);
+    if (info->adc_healthy != wantHealthy) {
+        fail(r, p->name, f, "health mask", 0, info->adc_healthy, wantHealthy);
+    }
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        bool down = (p->expectDown >> dev) & 1;
+        for (int input = 0; input < PRESSURE_CHANNELS_PER_ADC; input++) {
+            uint8_t ch = ActiveTopology::sensorOf(dev, input);
+            bool valid = (info->pressure_valid >> ch) & 1;
+            if (down) {
+                if (frame->pressure[ch] != PRESSURE_VALUE_DOWN) {
+                    fail(r, p->name, f, "downed channel", ch, frame->pressure[ch], PRESSURE_VALUE_DOWN);
+                }
+                if (valid) {
+                    fail(r, p->name, f, "valid bit of downed channel", ch, 1, 0);
+                }
+            } else if (valid) {
+                int want = Shim_AdsValue(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address, (uint8_t)input);
+                if (frame->pressure[ch] != want) {
+                    fail(r, p->name, f, "channel", ch, frame->pressure[ch], want);
+                }
+            }
+        }
+    }
+}
+
+// Whatever the format, the receiver must see the same health and the marker on downed channels
+static void checkWire(PhaseResult* r, const Phase* p, int f, const SensorData* frame, const SensorFrameInfo* info)
+{
+    static const uint8_t FORMATS[] = { FRAME_FMT_LEGACY16, FRAME_FMT_PACKED16, FRAME_FMT_PACKED12, FRAME_FMT_PACKED8 };
+    uint8_t wire[FRAME_CODEC_MAX_SIZE > DELTA_MAX_FRAME_SIZE ? FRAME_CODEC_MAX_SIZE : DELTA_MAX_FRAME_SIZE];
+    for (uint8_t format : FORMATS) {
+        FrameCodecConfig cfg = { format, Codec_DefaultShift(format), 1 };
+        size_t n = Codec_Encode(frame, info, &cfg, wire, sizeof(wire));
+        SensorData out;
+        SensorFrameInfo got;
+        if (n == 0 || Codec_Decode(wire, n, format, &out, &got) != n) {
+            fail(r, p->name, f, "round trip of format", format, 0, (int)n);
+            continue;
+        }
+        if (got.adc_healthy != info->adc_healthy) {
+            fail(r, p->name, f, "health on the wire, format", format, got.adc_healthy, info->adc_healthy);
+        }
+        // Legacy frames cannot tell a held value from a fresh one
+        PressureMask_t wantValid = (format == FRAME_FMT_LEGACY16) ? (got.pressure_valid | info->pressure_valid)
+                                                                  : info->pressure_valid;
+        if (got.pressure_valid != wantValid) {
+            fail(r, p->name, f, "valid mask on the wire, format", format, (int)got.pressure_valid, (int)wantValid);
+        }
+        for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            for (int input = 0; input < PRESSURE_CHANNELS_PER_ADC && !((info->adc_healthy >> dev) & 1); input++) {
+                uint8_t ch = ActiveTopology::sensorOf(dev, input);
+                if (out.pressure[ch] != PRESSURE_VALUE_DOWN) {
+                    fail(r, p->name, f, "downed channel on the wire", ch, out.pressure[ch], PRESSURE_VALUE_DOWN);
+                }
+            }
+        }
+    }
+
+    size_t n = Delta_Encode(&s_deltaEnc, frame, info, wire, sizeof(wire));
+    uint8_t elapsed;
+    SensorData out;
+    if (n > 0 && Delta_Decode(&s_deltaDec, wire, n, &out, &elapsed) != n) {
+        fail(r, p->name, f, "delta round trip", 0, 0, (int)n);
+    }
+    if (s_deltaDec.synced && s_deltaDec.adcHealthy != info->adc_healthy) {
+        fail(r, p->name, f, "delta health", 0, s_deltaDec.adcHealthy, info->adc_healthy);
+    }
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        if (frame->pressure[ch] == PRESSURE_VALUE_DOWN && s_deltaDec.current.pressure[ch] != PRESSURE_VALUE_DOWN) {
+            fail(r, p->name, f, "delta downed channel", ch, s_deltaDec.current.pressure[ch], PRESSURE_VALUE_DOWN);
+        }
+    }
+}
+
+static PhaseResult runPhase(const Phase* p, bool verbose)
+{
+    PhaseResult r;
+    memset(&r, 0, sizeof(r));
+    setModes(p->mode);
+
+    uint32_t reads[PRESSURE_ADC_COUNT];
+    SensorData frame;
+    SensorFrameInfo info;
+    for (int f = 0; f < p->settleFrames + FRAMES_PER_PHASE; f++) {
+        if (f == p->settleFrames) {
+            for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+                reads[dev] = Shim_AdsReads(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address);
+            }
+        }
+        double ms = runFrame(&frame, &info);
+        if (ms > r.maxFrameMs) {
+            r.maxFrameMs = ms;
+        }
+        checkWire(&r, p, f, &frame, &info);
+        if (f >= p->settleFrames) {
+            checkFrame(&r, p, f, &frame, &info);
+        }
+        if (verbose) {
+            printf("  %-10s frame %3d  healthy 0x%02X  valid 0x%08X  %.2f ms\n",
+                   p->name, f, info.adc_healthy, (unsigned)info.pressure_valid, ms);
+        }
+    }
+    if (r.maxFrameMs >= LOOP_INTERVAL_MS) {
+        printf("  FAIL %s: a frame took %.2f ms, the loop period is %d ms\n", p->name, r.maxFrameMs, LOOP_INTERVAL_MS);
+        r.failures++;
+    }
+    double seconds = FRAMES_PER_PHASE * LOOP_INTERVAL_MS / 1000.0;
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        uint32_t now = Shim_AdsReads(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address);
+        r.readsPerSec[dev] = (now - reads[dev]) / seconds;
+    }
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    LoggerInit();
+
+    // Last device missing at boot, then every fault kind on the first two devices
+    static Phase phases[] = {
+        { "boot",       {}, 0, 3 },    // alignment needs a few frames of history
+        { "healthy",    {}, 0, 0 },
+        { "read error", {}, 0, 2 },
+        { "timeout",    {}, 0, 2 },
+        { "recovered",  {}, 0, 0 },
+    };
+    const int last = PRESSURE_ADC_COUNT - 1;
+    // Backoff doubles on every failed retry; the recovery phase waits for the longest one
+    const int recoverFrames = PRESSURE_REINIT_BACKOFF_MAX_MS / LOOP_INTERVAL_MS + 2;
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        for (Phase& p : phases) {
+            p.mode[dev] = SHIM_ADS_OK;
+        }
+    }
+    phases[0].mode[last] = SHIM_ADS_ABSENT;
+    phases[0].expectDown = (uint8_t)(1u << last);
+    phases[1].settleFrames = recoverFrames;
+    phases[2].mode[1] = SHIM_ADS_READ_ERROR;
+    phases[2].expectDown = 1u << 1;
+    phases[3].mode[0] = SHIM_ADS_TIMEOUT;
+    phases[3].mode[1] = SHIM_ADS_READ_ERROR;
+    phases[3].expectDown = (1u << 0) | (1u << 1);
+    phases[4].settleFrames = recoverFrames;
+
+    int failures = 0;
+    // Boot map: a Wire device that did not answer discovery stays down without a probe
+    {
+        setModes(phases[1].mode);
+        uint8_t present[PRESSURE_ADC_COUNT];
+        uint8_t presentCount = 0;
+        for (int dev = 1; dev < PRESSURE_ADC_COUNT; dev++) {
+            if (ActiveTopology::adc(dev).bus == 0) {
+                present[presentCount++] = ActiveTopology::adc(dev).address;
+            }
+        }
+        uint32_t before = Shim_AdsReads(ActiveTopology::adc(0).bus, ActiveTopology::adc(0).address);
+        Pressure_Init(present, presentCount);
+        if (Pressure_GetHealthyMask() & 1 ||
+            Shim_AdsReads(ActiveTopology::adc(0).bus, ActiveTopology::adc(0).address) != before) {
+            printf("  FAIL boot map: ADS1115 0 missing from the map was probed (healthy 0x%02X)\n",
+                   Pressure_GetHealthyMask());
+            failures++;
+        }
+    }
+    // Boot map overflow: more devices answer than the map holds, so the map stays empty and
+    // every device is probed (a truncated map would leave the ones past it down)
+    {
+        setModes(phases[1].mode);
+        uint8_t answering = 0;
+        for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            if (ActiveTopology::adc(dev).bus == 0) {
+                Shim_WireSetPresent(Wire, ActiveTopology::adc(dev).address, true);
+                answering++;
+            }
+        }
+        for (uint8_t address = 0x08; answering <= BOOT_MAX_I2C_DEVICES + 3; address++) {
+            if (!Wire.present_[address]) {
+                Shim_WireSetPresent(Wire, address, true);
+                answering++;
+            }
+        }
+        uint32_t before[PRESSURE_ADC_COUNT];
+        for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            before[dev] = Shim_AdsReads(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address);
+        }
+        BootDeviceMap_t map;
+        Boot_DiscoverI2C(&map);
+        if (map.count != 0) {
+            printf("  FAIL boot map: %u devices answered, map kept %u of them\n", answering, map.count);
+            failures++;
+        }
+        Pressure_Init(map.count ? map.addr : nullptr, map.count);
+        for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            if (!(Pressure_GetHealthyMask() & (1u << dev)) ||
+                Shim_AdsReads(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address) == before[dev]) {
+                printf("  FAIL boot map: %u devices answered, ADS1115 %d not probed (healthy 0x%02X)\n",
+                       answering, dev, Pressure_GetHealthyMask());
+                failures++;
+            }
+        }
+        for (int address = 0; address < 128; address++) {
+            Shim_WireSetPresent(Wire, (uint8_t)address, false);
+        }
+    }
+
+    setModes(phases[0].mode);
+    uint8_t initErr = Pressure_Init();
+    Filter_Reset();
+    Align_Reset();
+    Delta_InitEncoder(&s_deltaEnc);
+    Delta_InitDecoder(&s_deltaDec);
+    if (initErr != PRESSURE_ERR_INIT || Pressure_Status != PRESSURE_STATUS_DEGRADED) {
+        printf("  FAIL boot: Pressure_Init() = %u, status %d with one ADS1115 missing\n", initErr, (int)Pressure_Status);
+        failures++;
+    }
+
+    printf("%d sensors, %d ADS1115, %d ms loop, %d frames per phase\n\n",
+           PRESSURE_CHANNEL_COUNT, (int)PRESSURE_ADC_COUNT, LOOP_INTERVAL_MS, FRAMES_PER_PHASE);
+    printf("phase       down  max frame ms  conversions/s per ADS1115\n");
+    double baseRate[PRESSURE_ADC_COUNT] = {0};
+    for (const Phase& p : phases) {
+        PhaseResult r = runPhase(&p, verbose);
+        printf("%-10s  0x%02X  %12.2f ", p.name, p.expectDown, r.maxFrameMs);
+        for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            printf(" %6.1f", r.readsPerSec[dev]);
+        }
+        printf("\n");
+        // Working devices keep the rate they had with every device up
+        for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            if (&p == &phases[1]) {
+                baseRate[dev] = r.readsPerSec[dev];
+            } else if (&p != &phases[0] && !((p.expectDown >> dev) & 1) &&
+                       (r.readsPerSec[dev] < baseRate[dev] * (1 - RATE_TOLERANCE) ||
+                        r.readsPerSec[dev] > baseRate[dev] * (1 + RATE_TOLERANCE))) {
+                printf("  FAIL %s: ADS1115 %d converts %.1f/s, %.1f/s with every device up\n",
+                       p.name, dev, r.readsPerSec[dev], baseRate[dev]);
+                r.failures++;
+            }
+        }
+        failures += r.failures;
+    }
+
+    printf("\nfault check %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+// Decimation filter check: pushes random frames through src/FilterModule.cpp with every
+// number of active pressure channels and 1 .. DSP_MAX_SAMPLES_PER_FRAME (plus overflow)
+// samples per channel, and compares each Filter_Decimate() output with a double-precision
+// mean of the same samples. The Q24 reciprocal may move a rounded mean by at most
+// sum x 2^-25, so an output must be within 0.5 + 32767 x 64 x 2^-25 of the exact mean.
+// Also checks the sample instants (across the micros() wrap), the updated mask, held
+// channels, and the accelerometer average, then benchmarks samples/s.
+// Exits non-zero on failure.
+// Usage: filter_check [seconds]
+#include "FilterModule.h"
+#include "Config.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES_PER_CASE     20
+#define TOLERANCE           (0.5 + 32767.0 * DSP_MAX_SAMPLES_PER_FRAME / (1 << 25))
+
+static uint32_t s_rng = 12345;
+
+static uint32_t nextRandom(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+typedef struct {
+    uint32_t frames;
+    uint32_t outputs;
+    uint32_t exact;         // rounded like the reference
+    double   maxError;
+    int      failures;
+} CheckResult;
+
+static void fail(CheckResult* r, const char* what, int channels, int samples, int ch, double got, double want)
+{
+    if (r->failures++ < 10) {
+        printf("  FAIL %s: %d channels, %d samples, ch%02d: %.3f, reference %.3f\n",
+               what, channels, samples, ch, got, want);
+    }
+}
+
+static void compare(CheckResult* r, const char* what, int channels, int samples, int ch, double got, double want)
+{
+    double err = fabs(got - want);
+    r->outputs++;
+    r->exact += (got == floor(want + 0.5));
+    if (err > r->maxError) {
+        r->maxError = err;
+    }
+    if (err > TOLERANCE) {
+        fail(r, what, channels, samples, ch, got, want);
+    }
+}
+
+// One frame: `channels` active pressure channels with `samples` each, the accel with `samples`
+static void checkFrame(CheckResult* r, int channels, int samples, uint32_t startUs, uint16_t* out, uint32_t* outUs)
+{
+    double sum[PRESSURE_CHANNEL_COUNT] = {0};
+    double timeSum[PRESSURE_CHANNEL_COUNT] = {0};
+    double accSum[3] = {0};
+    double accTime = 0;
+    int kept = (samples < DSP_MAX_SAMPLES_PER_FRAME) ? samples : DSP_MAX_SAMPLES_PER_FRAME;
+    uint16_t before[PRESSURE_CHANNEL_COUNT];
+    uint32_t beforeUs[PRESSURE_CHANNEL_COUNT];
+    memcpy(before, out, sizeof(before));
+    memcpy(beforeUs, outUs, sizeof(beforeUs));
+
+    // Sample instants grow from startUs, 1163 us apart with jitter, as the scan tick does
+    uint32_t t = startUs;
+    for (int k = 0; k < samples; k++) {
+        for (int ch = 0; ch < channels; ch++) {
+            // Full-scale frames now and then, so the largest sums are covered
+            int16_t raw = (r->frames % 7 == 0) ? 32767 : (int16_t)(nextRandom() % 32768);
+            uint32_t ts = t + (uint32_t)ch * 13;
+            Filter_PushPressure((uint8_t)ch, raw, ts);
+            if (k < kept) {
+                sum[ch] += raw;
+                timeSum[ch] += (double)(int32_t)(ts - startUs);
+            }
+        }
+        int16_t acc[3];
+        for (int axis = 0; axis < 3; axis++) {
+            acc[axis] = (int16_t)((int32_t)(nextRandom() % 8192) - 4096);
+            if (k < kept) {
+                accSum[axis] += acc[axis];
+            }
+        }
+        Filter_PushAcc(acc[0], acc[1], acc[2], t + 7);
+        if (k < kept) {
+            accTime += (double)(int32_t)(t + 7 - startUs);
+        }
+        t += 1163 + nextRandom() % 40;
+    }
+
+    int16_t accOut[3] = {0};
+    uint32_t accUs = 0;
+    PressureMask_t mask = Filter_Decimate(out, accOut, outUs, &accUs);
+    r->frames++;
+
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        bool active = ch < channels && samples > 0;
+        if (((mask >> ch) & 1) != (PressureMask_t)active) {
+            fail(r, "mask", channels, samples, ch, (double)((mask >> ch) & 1), active);
+            continue;
+        }
+        if (!active) {
+            if (out[ch] != before[ch] || outUs[ch] != beforeUs[ch]) {
+                fail(r, "held value", channels, samples, ch, out[ch], before[ch]);
+            }
+            continue;
+        }
+        compare(r, "pressure", channels, samples, ch, out[ch], sum[ch] / kept);
+        compare(r, "instant", channels, samples, ch, (double)(int32_t)(outUs[ch] - startUs), timeSum[ch] / kept);
+    }
+    if (samples > 0) {
+        for (int axis = 0; axis < 3; axis++) {
+            compare(r, "accel", channels, samples, axis, accOut[axis], accSum[axis] / kept);
+        }
+        compare(r, "accel instant", channels, samples, 0, (double)(int32_t)(accUs - startUs), accTime / kept);
+    }
+}
+
+// Push + decimate throughput with every channel at `samples` per frame
+static double benchmark(int samples, double seconds)
+{
+    uint16_t out[PRESSURE_CHANNEL_COUNT] = {0};
+    uint32_t outUs[PRESSURE_CHANNEL_COUNT] = {0};
+    int16_t acc[3];
+    uint32_t accUs;
+    uint64_t pushed = 0;
+    uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        for (int f = 0; f < 100; f++) {
+            uint32_t t = (uint32_t)pushed;
+            for (int k = 0; k < samples; k++) {
+                for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+                    Filter_PushPressure((uint8_t)ch, (int16_t)((k * 131 + ch * 17) & 0x7FFF), t + k * 1163);
+                }
+            }
+            sink += Filter_Decimate(out, acc, outUs, &accUs);
+            sink += out[f % PRESSURE_CHANNEL_COUNT];
+            pushed += (uint64_t)samples * PRESSURE_CHANNEL_COUNT;
+        }
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < seconds);
+    if (sink == 0xFFFFFFFFu) {
+        printf("\n");   // keeps the loop from being optimized away
+    }
+    return pushed / elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 0.5;
+    Filter_Reset();
+
+    CheckResult r;
+    memset(&r, 0, sizeof(r));
+    uint16_t out[PRESSURE_CHANNEL_COUNT] = {0};
+    uint32_t outUs[PRESSURE_CHANNEL_COUNT] = {0};
+    // Starts shortly before the micros() wrap, so frames straddle it
+    uint32_t startUs = 0xFFFFFFFFu - 40u * 1000 * 1000;
+
+    const int sampleCases[] = { 0, 1, 2, 3, 5, 6, 7, 8, 15, 16, 17, 31, 32, 33, 63,
+                                DSP_MAX_SAMPLES_PER_FRAME, DSP_MAX_SAMPLES_PER_FRAME + 5 };
+    for (int channels = 1; channels <= PRESSURE_CHANNEL_COUNT; channels++) {
+        for (int samples : sampleCases) {
+            for (int f = 0; f < FRAMES_PER_CASE; f++) {
+                checkFrame(&r, channels, samples, startUs, out, outUs);
+                startUs += 20000;
+            }
+        }
+    }
+
+    printf("%u frames, %u outputs: %.2f%% rounded like the reference, max error %.4f (limit %.4f)\n",
+           r.frames, r.outputs, r.outputs ? 100.0 * r.exact / r.outputs : 0.0, r.maxError, TOLERANCE);
+
+    printf("\nsamples/frame  Msamples/s  (%d channels, push + decimate)\n", PRESSURE_CHANNEL_COUNT);
+    const int benchCases[] = { 1, 6, 16, DSP_MAX_SAMPLES_PER_FRAME };
+    for (int samples : benchCases) {
+        printf("%13d  %10.1f\n", samples, benchmark(samples, seconds) / 1e6);
+    }
+
+    printf("\nfilter check %s\n", r.failures ? "FAILED" : "passed");
+    return r.failures ? 1 : 0;
+}
@@ -0,0 +1,541 @@
+// Microbenchmarks of the firmware's per-frame hot functions, built against host/shim.
+// Usage: firmware_bench [--filter text] [--min-ms n] [--json out.json]
+//                       [--compare baseline.json] [--threshold pct] [--min-delta-ns ns]
+// --compare exits non-zero if any benchmark is slower than the baseline by more
+// than threshold percent (default 15) and by more than min-delta-ns (default 2).
+#include "UtilitiesModule.h"
+#include "LoggerModule.h"
+#include "FilterModule.h"
+#include "AlignModule.h"
+#include "FrameCodecModule.h"
+#include "TraceModule.h"
+#include "StatsModule.h"
+#include "SerialStreamModule.h"
+#include "FramePoolModule.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_REPEATS       9       // batches per benchmark, the median is reported
+#define BENCH_FRAMES        1024    // synthetic frames cycled through by the benchmarks
+#define BENCH_ACC_PER_FRAME 16      // ADXL345 FIFO entries per 20 ms frame at 800 Hz
+#define BENCH_CONV_PER_FRAME 2      // pressure conversions per channel and frame
+
+typedef std::function<void(size_t)> BenchFn;
+
+struct Bench {
+    const char* name;
+    BenchFn fn;         // runs n iterations
+};
+
+// Representative input: a synthetic walking session
+static std::vector<SensorData> s_frames;
+static volatile uint32_t s_sink;    // keeps results alive
+
+static void loadFrame(size_t i)
+{
+    const SensorData& f = s_frames[i % s_frames.size()];
+    BatteryVoltage = f.battery;
+    Acc_Array[0] = f.accel_x;
+    Acc_Array[1] = f.accel_y;
+    Acc_Array[2] = f.accel_z;
+    memcpy(Pressure_Array, f.pressure, sizeof(Pressure_Array));
+}
+
+// Pushes one frame's worth of oversampled conversions into the decimation filter
+static void pushFrameSamples(size_t i, uint32_t frameUs)
+{
+    const SensorData& f = s_frames[i % s_frames.size()];
+    for (int k = 0; k < BENCH_CONV_PER_FRAME; k++) {
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            Filter_PushPressure((uint8_t)ch, (int16_t)(f.pressure[ch] + k), frameUs + 600 + 1163 * k);
+        }
+    }
+    for (int k = 0; k < BENCH_ACC_PER_FRAME; k++) {
+        Filter_PushAcc(f.accel_x, f.accel_y, (int16_t)(f.accel_z + k), frameUs - 1250 * (BENCH_ACC_PER_FRAME - 1 - k));
+    }
+}
+
+// ''''''' SEND PATH ''''''''''''''''''' //
+// The sensor-to-notification path before and after the frame pool, with every
+// byte the path copies counted. Packing the frame is common to both and not counted.
+
+static uint64_t s_copied;   // bytes copied by the send-path stand-ins
+
+// NimBLECharacteristic stand-in: setValue() copies into the attribute value,
+// notify() copies into the outgoing mbuf
+struct BenchCharacteristic {
+    uint8_t value[FRAME_MAX_SIZE];
+    uint8_t mbuf[FRAME_MAX_SIZE];
+    size_t  valueLen;
+
+    void setValue(const uint8_t* data, size_t len) {
+        memcpy(value, data, len);
+        valueLen = len;
+        s_copied += len;
+    }
+    bool notify(const uint8_t* data, size_t len) {
+        memcpy(mbuf, data, len);
+        s_copied += len;
+        return true;
+    }
+    bool notify() {
+        return notify(value, valueLen);
+    }
+};
+static BenchCharacteristic s_characteristic;
+
+// processAndTransmitSensorData before the frame pool: per-field temporaries, a
+// concatenated copy, a hex dump formatted whatever the log level, setValue + notify
+static bool sendBefore(const SensorData* data)
+{
+    uint8_t battery_arr[1] = {data->battery};
+    uint8_t accel_x_arr[2];
+    memcpy(accel_x_arr, &data->accel_x, sizeof(data->accel_x));
+    uint8_t accel_y_arr[2];
+    memcpy(accel_y_arr, &data->accel_y, sizeof(data->accel_y));
+    uint8_t accel_z_arr[2];
+    memcpy(accel_z_arr, &data->accel_z, sizeof(data->accel_z));
+    uint8_t pressure_arr[PRESSURE_CHANNEL_COUNT][2];
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
+        memcpy(pressure_arr[i], &data->pressure[i], sizeof(uint16_t));
+    }
+    s_copied += sizeof(SensorData);
+
+    uint8_t final_buffer[sizeof(SensorData)];
+    int offset = 0;
+    memcpy(final_buffer + offset, battery_arr, 1);
+    offset += 1;
+    memcpy(final_buffer + offset, accel_x_arr, 2);
+    offset += 2;
+    memcpy(final_buffer + offset, accel_y_arr, 2);
+    offset += 2;
+    memcpy(final_buffer + offset, accel_z_arr, 2);
+    offset += 2;
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
+        memcpy(final_buffer + offset, pressure_arr[i], 2);
+        offset += 2;
+    }
+    s_copied += sizeof(SensorData);
+
+    char hex_str[3 * sizeof(SensorData) + 1] = {0};
+    for (size_t i = 0; i < sizeof(SensorData); i++) {
+        snprintf(hex_str + strlen(hex_str), sizeof(hex_str) - strlen(hex_str), "%02X ", final_buffer[i]);
+    }
+    s_copied += 3 * sizeof(SensorData);
+    s_sink += (uint8_t)hex_str[0];
+
+    s_characteristic.setValue(final_buffer, sizeof(SensorData));
+    return s_characteristic.notify();
+}
+
+// One frame through the old global SensorData
+static bool sendBeforeFrame(size_t i)
+{
+    static SensorData sensor_data;
+    loadFrame(i);
+    PackSensorData(sensor_data);
+    return sendBefore(&sensor_data);
+}
+
+// One frame through the pool in a release build: packed once into a slot, borrowed
+// by the comm task and notified straight from the slot (processAndTransmitFrame)
+static bool sendAfterFrame(size_t i)
+{
+    FrameSlot_t* slot = FramePool_Acquire();
+    if (!slot) {
+        return false;
+    }
+    loadFrame(i);
+    PackSensorData(*FramePool_AsSensorData(slot));
+    PackSensorInfo(slot->info);
+    slot->length = sizeof(SensorData);
+    FramePool_Publish(slot);
+
+    FrameSlot_t* frame = FramePool_BorrowLatest();
+    if (!frame) {
+        return false;
+    }
+    bool sent = s_characteristic.notify(frame->data, frame->length);
+    FramePool_Release(frame);
+    return sent;
+}
+
+static double nsPerOp(const BenchFn& fn, double minMs)
+{
+    using clock = std::chrono::steady_clock;
+    // Grow the batch until it runs for minMs, then time BENCH_REPEATS batches
+    size_t n = 1;
+    for (;;) {
+        auto t0 = clock::now();
+        fn(n);
+        double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        if (ms >= minMs || n >= (1u << 30)) {
+            break;
+        }
+        n = (ms <= 0.01) ? n * 16 : (size_t)(n * (minMs / ms) * 1.2) + 1;
+    }
+    std::vector<double> samples;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        auto t0 = clock::now();
+        fn(n);
+        samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - t0).count() / n);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[BENCH_REPEATS / 2];
+}
+
+static std::vector<Bench> makeBenches()
+{
+    std::vector<Bench> b;
+
+    b.push_back({ "PackSensorData", [](size_t n) {
+        SensorData out;
+        for (size_t i = 0; i < n; i++) {
+            loadFrame(i);
+            PackSensorData(out);
+            s_sink += out.pressure[i % PRESSURE_CHANNEL_COUNT];
+        }
+    }});
+    b.push_back({ "PackSensorInfo", [](size_t n) {
+        SensorFrameInfo info;
+        for (size_t i = 0; i < n; i++) {
+            Pressure_Age[i % PRESSURE_CHANNEL_COUNT]++;
+            PackSensorInfo(info);
+            s_sink += info.pressure_age[0];
+        }
+    }});
+    b.push_back({ "clearSensorData", [](size_t n) {
+        SensorData out;
+        for (size_t i = 0; i < n; i++) {
+            out.battery = (uint8_t)i;
+            clearSensorData(&out);
+            s_sink += out.battery;
+        }
+    }});
+
+    // Frame serialization on the send path (BLE_SendFrame -> Codec_Encode)
+    static const struct { const char* name; uint8_t format; } FORMATS[] = {
+        { "Codec_Encode/legacy16", FRAME_FMT_LEGACY16 },
+        { "Codec_Encode/packed16", FRAME_FMT_PACKED16 },
+        { "Codec_Encode/packed12", FRAME_FMT_PACKED12 },
+        { "Codec_Encode/packed10", FRAME_FMT_PACKED10 },
+        { "Codec_Encode/packed8",  FRAME_FMT_PACKED8 },
+    };
+    for (const auto& f : FORMATS) {
+        uint8_t format = f.format;
+        b.push_back({ f.name, [format](size_t n) {
+            FrameCodecConfig cfg = { format, Codec_DefaultShift(format), 1 };
+            uint8_t out[FRAME_CODEC_MAX_SIZE];
+            for (size_t i = 0; i < n; i++) {
+                s_sink += (uint32_t)Codec_Encode(&s_frames[i % s_frames.size()], NULL, &cfg, out, sizeof(out));
+            }
+        }});
+    }
+
+    // Wired stream packet, next to the BLE encodings above (SerialStream_SendFrame without the UART copy)
+    b.push_back({ "SerialStream_Encode/frame", [](size_t n) {
+        uint8_t payload[SERIAL_STREAM_FRAME_SIZE];
+        uint8_t out[SERIAL_STREAM_WIRE_SIZE(SERIAL_STREAM_FRAME_SIZE)];
+        for (size_t i = 0; i < n; i++) {
+            uint32_t us = (uint32_t)(i * 20000);
+            memcpy(payload, &us, sizeof(us));
+            memcpy(payload + 4, &s_frames[i % s_frames.size()], sizeof(SensorData));
+            s_sink += (uint32_t)SerialStream_Encode(SERIAL_STREAM_TYPE_FRAME, (uint8_t)i, payload, sizeof(payload),
+                                                     out, sizeof(out));
+        }
+    }});
+
+    // Accepted lines: the clock moves a second per call so the rate limiter never trips,
+    // and the queue is drained the way the logger task would
+    static const struct { const char* name; uint8_t level; } LEVELS[] = {
+        { "LoggerPrint/error", LOGGER_LEVEL_ERROR },
+        { "LoggerPrint/warn",  LOGGER_LEVEL_WARN },
+        { "LoggerPrint/info",  LOGGER_LEVEL_INFO },
+        { "LoggerPrint/debug", LOGGER_LEVEL_DEBUG },
+    };
+    for (const auto& l : LEVELS) {
+        uint8_t level = l.level;
+        b.push_back({ l.name, [level](size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                Shim_AdvanceUs(1000000);
+                LoggerPrint(level, __FUNCTION__, __LINE__, "ADS1115 read error: dev=%d ch=%d%s", (int)(i & 3), (int)(i >> 2 & 3), "");
+                if ((i & 7) == 7) {
+                    Shim_DrainQueues();
+                }
+            }
+            Shim_DrainQueues();
+        }});
+    }
+    b.push_back({ "LoggerPrint/rate_limited", [](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            LoggerPrint(LOGGER_LEVEL_DEBUG, __FUNCTION__, __LINE__, "flood %u", (unsigned)i);
+        }
+        Shim_DrainQueues();
+    }});
+    b.push_back({ "LoggerPrint/filtered", [](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            LoggerPrint(LOGGER_LEVEL_VERBOSE, __FUNCTION__, __LINE__, "verbose %u", (unsigned)i);
+        }
+    }});
+    b.push_back({ "LoggerPrintLoopMessage", [](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Shim_AdvanceUs(1000000);    // past PRINT_INTERVAL, so every call formats
+            LoggerPrintLoopMessage(&s_frames[i % s_frames.size()]);
+            if ((i & 7) == 7) {
+                Shim_DrainQueues();
+            }
+        }
+        Shim_DrainQueues();
+    }});
+
+    // Conversion math
+    b.push_back({ "Acc_RawToMs2x10/3axes", [](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            const SensorData& f = s_frames[i % s_frames.size()];
+            s_sink += (uint32_t)(Acc_RawToMs2x10(f.accel_x) + Acc_RawToMs2x10(f.accel_y) + Acc_RawToMs2x10(f.accel_z));
+        }
+    }});
+    b.push_back({ "Filter/push+decimate", [](size_t n) {
+        uint16_t pressure[PRESSURE_CHANNEL_COUNT] = {0};
+        uint32_t pressureUs[PRESSURE_CHANNEL_COUNT] = {0};
+        int16_t acc[3] = {0};
+        uint32_t accUs = 0;
+        for (size_t i = 0; i < n; i++) {
+            pushFrameSamples(i, (uint32_t)(i * 20000));
+            s_sink += Filter_Decimate(pressure, acc, pressureUs, &accUs);
+        }
+    }});
+    b.push_back({ "Align_Apply", [](size_t n) {
+        Align_Reset();
+        for (size_t i = 0; i < n; i++) {
+            loadFrame(i);
+            uint32_t frameUs = (uint32_t)(i * 20000);
+            for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+                Pressure_SampleUs[ch] = frameUs + 600 + 150 * ch;
+            }
+            Acc_SampleUs = frameUs + 300;
+            Align_Apply(frameUs);
+            s_sink += Pressure_Array[0];
+        }
+    }});
+
+    b.push_back({ "Stats_Update", [](size_t n) {
+        Stats_Reset();
+        for (size_t i = 0; i < n; i++) {
+            Stats_Update(&s_frames[i % s_frames.size()], NULL, (uint32_t)(i * 20000));
+        }
+    }});
+    // One BLE read of the stats characteristic
+    b.push_back({ "Stats_EncodePage", [](size_t n) {
+        uint8_t page[STATS_PAGE_SIZE];
+        for (size_t i = 0; i < n; i++) {
+            s_sink += (uint32_t)Stats_EncodePage((uint8_t)(i % STATS_PAGES), page, sizeof(page));
+        }
+    }});
+
+    // Sensor frame to notification, see reportSendPath() for the copies
+    b.push_back({ "send/before", [](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            s_sink += sendBeforeFrame(i);
+        }
+    }});
+    b.push_back({ "send/after", [](size_t n) {
+        FramePool_Init();
+        for (size_t i = 0; i < n; i++) {
+            s_sink += sendAfterFrame(i);
+        }
+    }});
+
+    // Everything the sensor task does per frame besides the bus traffic
+    b.push_back({ "frame/total", [](size_t n) {
+        Align_Reset();
+        SensorData out;
+        SensorFrameInfo info;
+        FrameCodecConfig cfg = { FRAME_FMT_PACKED12, Codec_DefaultShift(FRAME_FMT_PACKED12), 1 };
+        uint8_t wire[FRAME_CODEC_MAX_SIZE];
+        for (size_t i = 0; i < n; i++) {
+            uint32_t frameUs = (uint32_t)(i * 20000);
+            pushFrameSamples(i, frameUs);
+            Filter_Apply();
+            Align_Apply(frameUs);
+            PackSensorData(out);
+            PackSensorInfo(info);
+            Stats_Update(&out, &info, frameUs);
+            s_sink += (uint32_t)Codec_Encode(&out, &info, &cfg, wire, sizeof(wire));
+        }
+    }});
+    return b;
+}
+
+// Bytes copied and TSC cycles per frame of both send paths (no cycle counter off x86)
+static void reportSendPath(void)
+{
+    static const struct { const char* name; bool (*fn)(size_t); } PATHS[] = {
+        { "before", sendBeforeFrame },
+        { "after",  sendAfterFrame },
+    };
+    const size_t frames = 100000;
+    printf("\nsend path  bytes copied/frame  cycles/frame  (%d sensors, packing not counted)\n",
+           PRESSURE_CHANNEL_COUNT);
+    for (const auto& p : PATHS) {
+        FramePool_Init();
+        s_copied = 0;
+        double cycles = 0;
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+#if defined(__x86_64__) || defined(__i386__)
+            uint64_t t0 = __rdtsc();
+#endif
+            for (size_t i = 0; i < frames; i++) {
+                s_sink += p.fn(i);
+            }
+#if defined(__x86_64__) || defined(__i386__)
+            double c = (double)(__rdtsc() - t0) / frames;
+            cycles = (r == 0 || c < cycles) ? c : cycles;
+#endif
+        }
+        printf("%-9s  %18.1f  %12.1f\n", p.name, (double)s_copied / ((double)frames * BENCH_REPEATS), cycles);
+    }
+}
+
+// ''''''' BASELINE FILES ''''''''''''''''''' //
+
+static bool writeJson(const char* path, const std::vector<std::pair<std::string, double>>& results)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "{\n  \"tool\": \"firmware_bench\",\n  \"sensors\": %d,\n  \"unit\": \"ns/op\",\n  \"results\": {\n",
+            PRESSURE_CHANNEL_COUNT);
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(f, "    \"%s\": %.2f%s\n", results[i].first.c_str(), results[i].second,
+                (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(f, "  }\n}\n");
+    return fclose(f) == 0;
+}
+
+// Reads the "results" object written above: flat "name": number pairs
+static bool readJson(const char* path, std::map<std::string, double>* out)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        text.append(buf, n);
+    }
+    fclose(f);
+
+    size_t pos = text.find("\"results\"");
+    if (pos == std::string::npos || (pos = text.find('{', pos)) == std::string::npos) {
+        return false;
+    }
+    size_t end = text.find('}', pos);
+    while (pos < end) {
+        size_t k0 = text.find('"', pos);
+        if (k0 == std::string::npos || k0 > end) {
+            break;
+        }
+        size_t k1 = text.find('"', k0 + 1);
+        size_t colon = text.find(':', k1);
+        if (k1 == std::string::npos || colon == std::string::npos || colon > end) {
+            return false;
+        }
+        (*out)[text.substr(k0 + 1, k1 - k0 - 1)] = strtod(text.c_str() + colon + 1, nullptr);
+        pos = text.find_first_of(",}", colon);
+        pos = (pos == std::string::npos) ? end : pos + 1;
+    }
+    return !out->empty();
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    const char* jsonOut = nullptr;
+    const char* baseline = nullptr;
+    double minMs = 20.0;
+    double threshold = 15.0;
+    double minDeltaNs = 2.0;
+    for (int i = 1; i < argc; i++) {
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!strcmp(argv[i], "--filter") && next)            { filter = next; i++; }
+        else if (!strcmp(argv[i], "--json") && next)         { jsonOut = next; i++; }
+        else if (!strcmp(argv[i], "--compare") && next)      { baseline = next; i++; }
+        else if (!strcmp(argv[i], "--min-ms") && next)       { minMs = atof(next); i++; }
+        else if (!strcmp(argv[i], "--threshold") && next)    { threshold = atof(next); i++; }
+        else if (!strcmp(argv[i], "--min-delta-ns") && next) { minDeltaNs = atof(next); i++; }
+        else {
+            fprintf(stderr, "usage: firmware_bench [--filter text] [--min-ms n] [--json out.json]\n"
+                            "                      [--compare baseline.json] [--threshold pct] [--min-delta-ns ns]\n");
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> base;
+    if (baseline && !readJson(baseline, &base)) {
+        fprintf(stderr, "cannot read baseline %s\n", baseline);
+        return 2;
+    }
+
+    s_frames.resize(BENCH_FRAMES);
+    for (size_t i = 0; i < s_frames.size(); i++) {
+        Trace_Synthesize(TRACE_GAIT_WALK, (uint32_t)(i * 20), &s_frames[i]);
+    }
+    LoggerInit();
+    Filter_Reset();
+
+    std::vector<std::pair<std::string, double>> results;
+    int regressions = 0;
+    printf("%-28s %12s", "benchmark", "ns/op");
+    if (baseline) {
+        printf(" %12s %9s", "baseline", "delta");
+    }
+    printf("\n");
+    for (const Bench& b : makeBenches()) {
+        if (filter && !strstr(b.name, filter)) {
+            continue;
+        }
+        double ns = nsPerOp(b.fn, minMs);
+        results.push_back(std::make_pair(std::string(b.name), ns));
+        printf("%-28s %12.2f", b.name, ns);
+        if (baseline) {
+            auto it = base.find(b.name);
+            if (it == base.end()) {
+                printf(" %12s %9s", "-", "new");
+            } else {
+                double pct = (it->second > 0) ? (ns - it->second) * 100.0 / it->second : 0.0;
+                bool regressed = pct > threshold && ns - it->second > minDeltaNs;
+                printf(" %12.2f %+8.1f%%%s", it->second, pct, regressed ? "  REGRESSION" : "");
+                regressions += regressed;
+            }
+        }
+        printf("\n");
+    }
+
+    if (!filter || strstr("send/", filter)) {
+        reportSendPath();
+    }
+
+    if (jsonOut && !writeJson(jsonOut, results)) {
+        fprintf(stderr, "cannot write %s\n", jsonOut);
+        return 2;
+    }
+    if (baseline) {
+        printf("%d regression(s) above %.0f%%\n", regressions, threshold);
+    }
+    return regressions ? 1 : 0;
+}
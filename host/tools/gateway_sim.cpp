@@ -0,0 +1,498 @@
+// Multi-insole gateway ingestion simulator.
+// Producers emulate insoles sending BLE notifications in the firmware's wire formats,
+// each stream feeds a lock-free SPSC queue, a work-stealing pool decodes and aggregates.
+// --stress ping-pongs single packets on every stream instead, so each push races the
+// worker releasing the stream, and exits non-zero if a packet is left with no worker.
+// Usage:
+//   gateway_sim [--streams 1,2,4,...] [--seconds s] [--workers n] [--producers n]
+//               [--format legacy|packed16|packed12|packed10|packed8] [--mtu n] [--rate hz | --flood]
+//               [--stress rounds]
+#include "FrameCodecModule.h"
+#include "FrameDecoder.h"
+#include "SpscQueue.h"
+#include "TraceModule.h"
+#include "Config.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define GATEWAY_MAX_PAYLOAD     244     // ATT payload at the largest MTU the tool accepts (247)
+#define GATEWAY_QUEUE_DEPTH     256     // notifications buffered per stream
+#define GATEWAY_DRAIN_BATCH     32      // notifications a worker drains before rescheduling a stream
+#define GATEWAY_WAKEUP_MS       100     // --stress: a packet waiting this long was never scheduled
+#define HIST_SUB_BITS           3
+#define HIST_BUCKETS            320
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// One BLE notification as received by the gateway radio
+struct Packet {
+    uint32_t seq;
+    uint16_t len;
+    uint8_t  frames;
+    uint64_t sentNs;
+    uint8_t  data[GATEWAY_MAX_PAYLOAD];
+};
+
+// Log-linear latency histogram, 8 buckets per octave
+struct Histogram {
+    uint64_t buckets[HIST_BUCKETS] = {0};
+    uint64_t count = 0;
+    uint64_t max = 0;
+
+    static int bucketOf(uint64_t v)
+    {
+        const uint64_t linear = 1u << (HIST_SUB_BITS + 1);
+        if (v < linear) return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        uint64_t sub = (v >> (msb - HIST_SUB_BITS)) & ((1u << HIST_SUB_BITS) - 1);
+        int idx = (int)(linear + ((uint64_t)(msb - HIST_SUB_BITS - 1) << HIST_SUB_BITS) + sub);
+        return std::min(idx, HIST_BUCKETS - 1);
+    }
+
+    static uint64_t upperOf(int idx)
+    {
+        const uint64_t linear = 1u << (HIST_SUB_BITS + 1);
+        if ((uint64_t)idx < linear) return (uint64_t)idx;
+        uint64_t octave = ((uint64_t)idx - linear) >> HIST_SUB_BITS;
+        uint64_t sub = ((uint64_t)idx - linear) & ((1u << HIST_SUB_BITS) - 1);
+        int msb = (int)octave + HIST_SUB_BITS + 1;
+        return (1ull << msb) + (sub + 1) * (1ull << (msb - HIST_SUB_BITS)) - 1;
+    }
+
+    void record(uint64_t v)
+    {
+        buckets[bucketOf(v)]++;
+        count++;
+        max = std::max(max, v);
+    }
+
+    void merge(const Histogram& o)
+    {
+        for (int i = 0; i < HIST_BUCKETS; i++) buckets[i] += o.buckets[i];
+        count += o.count;
+        max = std::max(max, o.max);
+    }
+
+    uint64_t percentile(double p) const
+    {
+        if (!count) return 0;
+        uint64_t rank = std::max<uint64_t>(1, (uint64_t)(p * count + 0.999999));
+        uint64_t seen = 0;
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) return std::min(upperOf(i), max);
+        }
+        return max;
+    }
+};
+
+// Per-stream state. The queue has one producer thread; the consumer side is owned by
+// whichever worker holds `scheduled`, which also makes the aggregate single-writer.
+// Producer (push, then set `scheduled`) and worker (clear `scheduled`, then check the
+// queue) each store one side and load the other, so a seq_cst fence sits between the
+// two on both sides; otherwise both loads can see the old value and the packet waits
+// with no worker on it.
+struct alignas(64) Stream {
+    SpscQueue<Packet, GATEWAY_QUEUE_DEPTH> queue;
+    std::atomic<bool> scheduled{false};
+    int home = 0;                   // worker whose deque gets the stream when it becomes ready
+
+    // Producer side
+    uint32_t nextSeq = 0;
+    uint32_t sampleMs = 0;
+    uint64_t dropped = 0;           // notifications lost to a full queue
+
+    // Aggregate sink (consumer side)
+    uint64_t frames = 0;
+    uint64_t packets = 0;
+    uint64_t seqGaps = 0;
+    uint32_t expectSeq = 0;
+    uint64_t heelLoad = 0;
+};
+
+// Mutex-protected deque per worker: the owner pops the newest entry, thieves take the oldest
+struct WorkDeque {
+    std::mutex lock;
+    std::deque<int> items;
+};
+
+struct Options {
+    std::vector<int> streamCounts = { 1, 2, 4, 8, 16, 32, 64 };
+    double seconds = 3.0;
+    int workers = 0;
+    int producers = 0;
+    uint8_t format = FRAME_FMT_LEGACY16;
+    uint16_t mtu = 185;
+    double rateHz = 1000.0 / DEFAULT_LOOP_INTERVAL_MS;
+    bool flood = false;
+    uint32_t stressRounds = 0;
+};
+
+struct RunResult {
+    uint64_t frames = 0;
+    uint64_t offered = 0;
+    uint64_t dropped = 0;
+    uint64_t gaps = 0;
+    uint64_t steals = 0;
+    Histogram latency;
+    double seconds = 0;
+};
+
+class Gateway {
+public:
+    Gateway(const Options& opt, int streams)
+        : m_opt(opt), m_streams(streams), m_deques(opt.workers), m_stats(opt.workers)
+    {
+        m_state.reset(new Stream[streams]);
+        for (int s = 0; s < streams; s++) m_state[s].home = s % opt.workers;
+        m_codec.format = opt.format;
+        m_codec.shift = Codec_DefaultShift(opt.format);
+        m_codec.framesPerNotify = 0;
+        m_framesPerPacket = (opt.format == FRAME_FMT_LEGACY16) ? 1 : Codec_FramesPerNotification(opt.format, opt.mtu);
+        if (m_framesPerPacket == 0) m_framesPerPacket = 1;
+    }
+
+    RunResult run()
+    {
+        std::vector<std::thread> threads;
+        for (int w = 0; w < m_opt.workers; w++) threads.emplace_back(&Gateway::worker, this, w);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < m_opt.producers; p++) producers.emplace_back(&Gateway::producer, this, p);
+
+        auto start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(m_opt.seconds));
+        m_producing = false;
+        for (auto& t : producers) t.join();
+        m_running = false;      // workers drain what is queued, then stop
+        for (auto& t : threads) t.join();
+
+        RunResult r;
+        r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (int s = 0; s < m_streams; s++) {
+            r.frames += m_state[s].frames;
+            r.offered += (uint64_t)m_state[s].nextSeq * m_framesPerPacket;
+            r.dropped += m_state[s].dropped;
+            r.gaps += m_state[s].seqGaps;
+        }
+        for (auto& st : m_stats) {
+            r.latency.merge(st.latency);
+            r.steals += st.steals;
+        }
+        return r;
+    }
+
+    // One producer thread per stream pushes a packet and waits until a worker has taken it.
+    // Returns the packets that were left unscheduled; each is rescheduled so the run ends.
+    uint64_t stress(uint32_t rounds)
+    {
+        std::vector<std::thread> threads;
+        for (int w = 0; w < m_opt.workers; w++) threads.emplace_back(&Gateway::worker, this, w);
+        std::atomic<uint64_t> lost{0};
+        std::vector<std::thread> producers;
+        for (int s = 0; s < m_streams; s++) {
+            producers.emplace_back([this, s, rounds, &lost] {
+                Stream& st = m_state[s];
+                for (uint32_t r = 0; r < rounds; r++) {
+                    emit(s, DEFAULT_LOOP_INTERVAL_MS);
+                    uint64_t deadline = nowNs() + (uint64_t)GATEWAY_WAKEUP_MS * 1000000;
+                    while (!st.queue.empty()) {
+                        if (nowNs() > deadline && !st.scheduled.load(std::memory_order_seq_cst)) {
+                            lost++;
+                            schedule(s);
+                            deadline = nowNs() + (uint64_t)GATEWAY_WAKEUP_MS * 1000000;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& t : producers) t.join();
+        m_running = false;
+        for (auto& t : threads) t.join();
+        return lost.load();
+    }
+
+    size_t bytesPerStream() const { return sizeof(Stream); }
+    int framesPerPacket() const { return m_framesPerPacket; }
+
+private:
+    struct alignas(64) WorkerStats {
+        Histogram latency;
+        uint64_t steals = 0;
+    };
+
+    // Marks a stream ready and queues it on its home worker unless a worker already owns it
+    void schedule(int s)
+    {
+        if (m_state[s].scheduled.exchange(true, std::memory_order_acq_rel)) return;
+        WorkDeque& d = m_deques[m_state[s].home];
+        std::lock_guard<std::mutex> g(d.lock);
+        d.items.push_back(s);
+    }
+
+    bool take(int self, int* s, std::mt19937& rng)
+    {
+        {
+            WorkDeque& d = m_deques[self];
+            std::lock_guard<std::mutex> g(d.lock);
+            if (!d.items.empty()) {
+                *s = d.items.back();
+                d.items.pop_back();
+                return true;
+            }
+        }
+        // Steal the oldest ready stream from a random victim
+        int n = m_opt.workers;
+        int first = (int)(rng() % n);
+        for (int i = 0; i < n; i++) {
+            int v = (first + i) % n;
+            if (v == self) continue;
+            WorkDeque& d = m_deques[v];
+            std::lock_guard<std::mutex> g(d.lock);
+            if (!d.items.empty()) {
+                *s = d.items.front();
+                d.items.pop_front();
+                m_stats[self].steals++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void producer(int id)
+    {
+        const uint64_t periodNs = m_opt.flood ? 0 : (uint64_t)(1e9 / m_opt.rateHz);
+        const uint64_t packetNs = periodNs * m_framesPerPacket;
+        const uint32_t framePeriodMs = (uint32_t)(1000.0 / m_opt.rateHz);
+        uint64_t start = nowNs();
+        std::vector<uint64_t> due;
+        std::vector<int> mine;
+        for (int s = id; s < m_streams; s += m_opt.producers) {
+            mine.push_back(s);
+            // Spread stream phases over one packet period like independent devices
+            due.push_back(start + (packetNs * mine.size()) / (m_streams / m_opt.producers + 1));
+        }
+
+        while (m_producing.load(std::memory_order_relaxed)) {
+            uint64_t now = nowNs();
+            uint64_t nextDue = UINT64_MAX;
+            for (size_t i = 0; i < mine.size(); i++) {
+                if (due[i] <= now) {
+                    emit(mine[i], framePeriodMs);
+                    due[i] += packetNs;
+                    if (due[i] < now) due[i] = now;   // fell behind: do not burst to catch up
+                }
+                nextDue = std::min(nextDue, due[i]);
+            }
+            if (!m_opt.flood && nextDue > nowNs()) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(nextDue - nowNs()));
+            }
+        }
+    }
+
+    // Builds one notification the way the firmware's send path does and pushes it
+    void emit(int s, uint32_t framePeriodMs)
+    {
+        Stream& st = m_state[s];
+        Packet p;
+        p.seq = st.nextSeq++;
+        p.len = 0;
+        p.frames = (uint8_t)m_framesPerPacket;
+        for (int f = 0; f < m_framesPerPacket; f++) {
+            SensorData d;
+            Trace_Synthesize(TRACE_GAIT_WALK, st.sampleMs + (uint32_t)s * 37, &d);
+            st.sampleMs += framePeriodMs;
+            if (m_codec.format == FRAME_FMT_LEGACY16) {
+                memcpy(p.data, &d, sizeof(d));
+                p.len = sizeof(d);
+            } else {
+                p.len += (uint16_t)Codec_Encode(&d, NULL, &m_codec, p.data + p.len, sizeof(p.data) - p.len);
+            }
+        }
+        p.sentNs = nowNs();
+        if (!st.queue.tryPush(p)) {
+            st.dropped++;
+            return;
+        }
+        // The push must be visible before schedule() reads `scheduled` (see Stream)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        schedule(s);
+    }
+
+    void worker(int self)
+    {
+        std::mt19937 rng(1234 + self);
+        uint16_t pressure[PRESSURE_CHANNEL_COUNT][16];
+        uint8_t battery[16];
+        int16_t ax[16], ay[16], az[16];
+        FrameColumns cols = { 16, nullptr, battery, ax, ay, az, {}, nullptr, nullptr };
+        for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) cols.pressure[c] = pressure[c];
+        WorkerStats& stats = m_stats[self];
+
+        for (;;) {
+            int s;
+            if (!take(self, &s, rng)) {
+                if (!m_running.load(std::memory_order_acquire) && allIdle()) return;
+                std::this_thread::yield();
+                continue;
+            }
+            Stream& st = m_state[s];
+            for (int n = 0; n < GATEWAY_DRAIN_BATCH; n++) {
+                const Packet* p = st.queue.front();
+                if (!p) break;
+                DecoderResult r = (m_codec.format == FRAME_FMT_LEGACY16)
+                    ? Decoder_DecodeBatch(p->data, p->len, FRAME_LAYOUT_RAW, cols)
+                    : Decoder_DecodePacked(p->data, p->len, cols);
+                // Aggregate sink: heel load and sequence accounting per stream
+                for (size_t f = 0; f < r.frames; f++) {
+                    st.heelLoad += pressure[0][f] + pressure[1][f];
+                }
+                st.frames += r.frames;
+                st.packets++;
+                if (p->seq != st.expectSeq) st.seqGaps += p->seq - st.expectSeq;
+                st.expectSeq = p->seq + 1;
+                stats.latency.record(nowNs() - p->sentNs);
+                st.queue.pop();
+            }
+            if (m_opt.stressRounds) {
+                std::this_thread::yield();  // widen the release window, also on a single core
+            }
+            // Release the stream; re-arm it if packets arrived while we held it. The fence
+            // keeps the queue check from being satisfied before the release is visible.
+            st.scheduled.store(false, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!st.queue.empty()) schedule(s);
+        }
+    }
+
+    bool allIdle()
+    {
+        for (int s = 0; s < m_streams; s++) {
+            if (!m_state[s].queue.empty() || m_state[s].scheduled.load(std::memory_order_acquire)) return false;
+        }
+        return true;
+    }
+
+    const Options& m_opt;
+    int m_streams;
+    std::unique_ptr<Stream[]> m_state;
+    std::vector<WorkDeque> m_deques;
+    std::vector<WorkerStats> m_stats;
+    FrameCodecConfig m_codec;
+    int m_framesPerPacket = 1;
+    std::atomic<bool> m_producing{true};
+    std::atomic<bool> m_running{true};
+};
+
+static long residentKb()
+{
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    long pages = 0, resident = 0;
+    int n = fscanf(f, "%ld %ld", &pages, &resident);
+    fclose(f);
+    return (n == 2) ? resident * 4 : -1;
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt)
+{
+    static const char* formats[FRAME_FMT_COUNT] = { "legacy", "packed16", "packed12", "packed10", "packed8" };
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--streams") && more) {
+            opt.streamCounts.clear();
+            for (char* tok = strtok(argv[++i], ","); tok; tok = strtok(nullptr, ",")) {
+                if (atoi(tok) > 0) opt.streamCounts.push_back(atoi(tok));
+            }
+        } else if (!strcmp(argv[i], "--seconds") && more) {
+            opt.seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--workers") && more) {
+            opt.workers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--producers") && more) {
+            opt.producers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--mtu") && more) {
+            opt.mtu = (uint16_t)std::min(247, std::max(23, atoi(argv[++i])));
+        } else if (!strcmp(argv[i], "--rate") && more) {
+            opt.rateHz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--flood")) {
+            opt.flood = true;
+        } else if (!strcmp(argv[i], "--stress") && more) {
+            opt.stressRounds = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--format") && more) {
+            const char* f = argv[++i];
+            int found = -1;
+            for (int k = 0; k < FRAME_FMT_COUNT; k++) {
+                if (!strcmp(f, formats[k])) found = k;
+            }
+            if (found < 0) return false;
+            opt.format = (uint8_t)found;
+        } else {
+            return false;
+        }
+    }
+    return !opt.streamCounts.empty() && opt.seconds > 0 && opt.rateHz > 0;
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        fprintf(stderr, "usage: gateway_sim [--streams 1,2,4,...] [--seconds s] [--workers n] [--producers n]\n"
+                        "                   [--format legacy|packed16|packed12|packed10|packed8] [--mtu n]\n"
+                        "                   [--rate hz | --flood] [--stress rounds]\n");
+        return 1;
+    }
+    int hw = (int)std::max(2u, std::thread::hardware_concurrency());
+    if (opt.workers <= 0) opt.workers = std::max(1, hw / 2);
+    if (opt.producers <= 0) opt.producers = std::max(1, hw / 4);
+
+    if (opt.stressRounds > 0) {
+        printf("%d workers, %u single-packet rounds per stream\n", opt.workers, opt.stressRounds);
+        printf("%7s %12s %9s %9s\n", "streams", "packets", "lost", "seconds");
+        uint64_t lostTotal = 0;
+        for (int streams : opt.streamCounts) {
+            Gateway gw(opt, streams);
+            auto start = Clock::now();
+            uint64_t lost = gw.stress(opt.stressRounds);
+            printf("%7d %12llu %9llu %9.2f\n", streams, (unsigned long long)streams * opt.stressRounds,
+                   (unsigned long long)lost, std::chrono::duration<double>(Clock::now() - start).count());
+            lostTotal += lost;
+        }
+        printf("\ngateway stress %s\n", lostTotal ? "FAILED: packets left without a worker" : "passed");
+        return lostTotal ? 1 : 0;
+    }
+
+    printf("%d workers, %d producers, %s, %.3g s per run\n", opt.workers, opt.producers,
+           opt.flood ? "flood" : "paced", opt.seconds);
+    printf("%7s %12s %12s %9s %7s %9s %9s %9s %9s %9s %10s %8s\n", "streams", "frames/s", "offered/s", "dropped",
+           "gaps", "steals", "p50 us", "p99 us", "p99.9 us", "max us", "KB/stream", "RSS MB");
+
+    for (int streams : opt.streamCounts) {
+        Gateway gw(opt, streams);
+        RunResult r = gw.run();
+        // Stream state is the queue plus the aggregate; RSS includes the decoder pool and runtime
+        long rss = residentKb();
+        printf("%7d %12.0f %12.0f %9llu %7llu %9llu %9.1f %9.1f %9.1f %9.1f %10.1f %8.1f\n", streams,
+               r.frames / r.seconds, r.offered / r.seconds, (unsigned long long)r.dropped,
+               (unsigned long long)r.gaps, (unsigned long long)r.steals,
+               r.latency.percentile(0.50) / 1e3, r.latency.percentile(0.99) / 1e3,
+               r.latency.percentile(0.999) / 1e3, r.latency.max / 1e3, gw.bytesPerStream() / 1024.0,
+               rss >= 0 ? rss / 1024.0 : 0.0);
+    }
+    return 0;
+}
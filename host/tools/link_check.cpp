@@ -0,0 +1,315 @@
+// BLE link manager check: runs the profile selection of src/LinkModule.cpp against
+// modelled centrals through a connection whose load changes (idle, 50 Hz stream, 2x
+// replay, burst upload, unsubscribe). The centrals grant intervals their own way, may
+// not know 2M or data length extension, or ignore requests altogether.
+// Checks the profile at the end of every phase, that stepping down waits
+// LINK_STEP_DOWN_MS, that requests per profile change stay within LINK_MAX_REQUESTS,
+// that the stream is not refused once the grant is in place, and that a central
+// which cannot carry the load is reported. Also prints the capacity model and checks
+// the batch sizes it picks for the stream.
+// Exits non-zero on failure.
+// Usage: link_check [-v]
+#include "LinkModule.h"
+#include "Config.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define STEP_MS         100
+#define LEGACY_PAYLOAD  39
+#define MTU             185
+
+typedef struct {
+    const char* name;
+    uint16_t connectInterval;   // chosen by the central at connect
+    bool     honours;           // answers connection parameter requests
+    uint16_t minInterval;       // shortest interval it grants
+    uint16_t step;              // grants multiples of this
+    bool     picksMax;          // takes the slowest interval of the range
+    bool     phy2m;
+    uint16_t maxDataLen;        // what data length extension ends up at
+    uint32_t answerMs;
+    bool     shortOnReplay;     // cannot carry the 2x replay: refusals and a shortfall expected
+    bool     expectRejected;
+    bool     expectPhyRefused;
+    bool     powerRefused;      // refuses the 50 Hz stream under POWER, so it stays at THROUGHPUT
+} Central;
+
+static const Central CENTRALS[] = {
+    //                        conn  honours min step max    2M     DLE  answer short  rej    phy    pwr
+    { "android",              24,   true,   6,  1,   false, true,  251, 200,   false, false, false, false },
+    { "ios",                  24,   true,   12, 12,  false, true,  251, 300,   false, false, false, false },
+    { "bt 4.2 dongle",        40,   true,   6,  1,   true,  false, 27,  100,   true,  false, true,  true  },
+    { "fixed gateway",        40,   false,  0,  1,   false, false, 251, 0,     true,  true,  true,  false },
+};
+
+typedef struct {
+    const char* name;
+    uint32_t    lengthMs;
+    bool        streaming;
+    uint16_t    payload;
+    uint16_t    notifyPerSec;
+    bool        bulk;
+    LinkProfile_t expect;           // at the end of the phase
+    LinkProfile_t expectSlow;       // same for a central that refuses the stream under POWER
+} Phase;
+
+static const Phase PHASES[] = {
+    { "connected",  10000, false, 0,              0,   false, LINK_PROFILE_IDLE,       LINK_PROFILE_IDLE },
+    { "stream",     20000, true,  LEGACY_PAYLOAD, 50,  false, LINK_PROFILE_POWER,      LINK_PROFILE_THROUGHPUT },
+    { "2x replay",  20000, true,  LEGACY_PAYLOAD, 100, false, LINK_PROFILE_THROUGHPUT, LINK_PROFILE_THROUGHPUT },
+    { "stream",     20000, true,  LEGACY_PAYLOAD, 50,  false, LINK_PROFILE_POWER,      LINK_PROFILE_THROUGHPUT },
+    { "burst",      5000,  true,  LEGACY_PAYLOAD, 50,  true,  LINK_PROFILE_THROUGHPUT, LINK_PROFILE_THROUGHPUT },
+    { "stream",     15000, true,  LEGACY_PAYLOAD, 50,  false, LINK_PROFILE_POWER,      LINK_PROFILE_THROUGHPUT },
+    { "unsubscribed", 15000, false, 0,            0,   false, LINK_PROFILE_IDLE,       LINK_PROFILE_IDLE },
+};
+#define PHASE_COUNT (sizeof(PHASES) / sizeof(PHASES[0]))
+#define HOLD_PHASE  3       // load dropped at its start: THROUGHPUT must hold for LINK_STEP_DOWN_MS
+
+typedef struct {
+    uint32_t dueMs;
+    LinkProfileParams_t req;
+} Answer;
+
+typedef struct {
+    const Central* c;
+    LinkParams_t actual;        // what the controllers use
+    LinkParams_t believed;      // what the firmware knows: the data length it asked for
+    std::vector<Answer> answers;
+} Link;
+
+static uint16_t grantInterval(const Central* c, const LinkProfileParams_t* req, uint16_t current)
+{
+    uint16_t lo = (req->minInterval > c->minInterval) ? req->minInterval : c->minInterval;
+    uint16_t i = (uint16_t)((lo + c->step - 1) / c->step * c->step);
+    if (i > req->maxInterval) {
+        return current;
+    }
+    return c->picksMax ? (uint16_t)(req->maxInterval / c->step * c->step) : i;
+}
+
+static void answer(Link* l, const LinkProfileParams_t* req)
+{
+    const Central* c = l->c;
+    if (req->minInterval && c->honours) {
+        uint16_t i = grantInterval(c, req, l->actual.interval);
+        if (i != l->actual.interval) {
+            l->actual.interval = l->believed.interval = i;
+            l->actual.latency = l->believed.latency = req->latency;
+            l->actual.timeout = l->believed.timeout = req->timeout;
+        }
+    }
+    if (req->phy && c->phy2m) {
+        l->actual.txPhy = l->actual.rxPhy = req->phy;
+        l->believed.txPhy = l->believed.rxPhy = req->phy;
+    }
+    if (req->dataLen) {
+        l->actual.dataLen = (req->dataLen < c->maxDataLen) ? req->dataLen : c->maxDataLen;
+    }
+}
+
+typedef struct {
+    LinkProfile_t profile;
+    LinkParams_t actual;
+    uint16_t loadPct;
+    uint32_t refused;           // in the last window
+    bool shortfall;
+} PhaseEnd;
+
+static int runCentral(const Central& c, bool verbose)
+{
+    Link l;
+    l.c = &c;
+    memset(&l.actual, 0, sizeof(l.actual));
+    l.actual.interval = c.connectInterval;
+    l.actual.timeout = 400;
+    l.actual.txPhy = l.actual.rxPhy = LINK_PHY_1M;
+    l.actual.dataLen = LINK_DEFAULT_DATA_LEN;
+    l.actual.mtu = MTU;
+    l.believed = l.actual;
+
+    Link_Reset(0);
+    int failures = 0;
+    uint32_t now = 0, windowMs = 0;
+    uint32_t lastRequestMs = 0, requestsThisChange = 0, lastChanges = 0;
+    uint32_t refused = 0;
+    bool holdOk = true;
+    std::vector<PhaseEnd> ends;
+
+    uint32_t phaseStart = 0;
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        const Phase& ph = PHASES[p];
+        for (; now < phaseStart + ph.lengthMs; now += STEP_MS) {
+            for (size_t i = 0; i < l.answers.size();) {
+                if (l.answers[i].dueMs <= now) {
+                    answer(&l, &l.answers[i].req);
+                    l.answers.erase(l.answers.begin() + i);
+                } else {
+                    i++;
+                }
+            }
+            if (now - windowMs < LINK_MEASURE_MS) {
+                continue;
+            }
+            windowMs = now;
+
+            // The stack refuses what the real link does not carry
+            LinkDemand_t d = { ph.streaming, ph.payload, ph.notifyPerSec, ph.bulk, 0 };
+            uint32_t carried = Link_NotifyRate(&l.actual, ph.payload ? ph.payload : 1);
+            refused = (ph.notifyPerSec > carried) ? ph.notifyPerSec - carried : 0;
+            d.refused = (uint16_t)refused;
+
+            LinkProfileParams_t req;
+            bool send = Link_Update(&l.believed, &d, now, &req);
+            LinkStats_t st;
+            Link_GetStats(&st);
+            if (st.changes != lastChanges) {
+                lastChanges = st.changes;
+                requestsThisChange = 0;
+            }
+            if (send) {
+                if (requestsThisChange && now - lastRequestMs < LINK_REQUEST_TIMEOUT_MS) {
+                    printf("  FAIL: %s asked again after %u ms\n", c.name, now - lastRequestMs);
+                    failures++;
+                }
+                if (++requestsThisChange > LINK_MAX_REQUESTS) {
+                    printf("  FAIL: %s: request %u for one profile change\n", c.name, requestsThisChange);
+                    failures++;
+                }
+                lastRequestMs = now;
+                if (req.dataLen) {
+                    l.believed.dataLen = req.dataLen;
+                }
+                l.answers.push_back({ now + c.answerMs, req });
+                if (verbose) {
+                    printf("  %6.1f s  %-10s interval %3u-%-3u PHY %u data length %3u\n", now / 1000.0,
+                           Link_ProfileName((LinkProfile_t)st.profile), req.minInterval, req.maxInterval,
+                           req.phy, req.dataLen);
+                }
+            }
+            if (p == HOLD_PHASE && now > phaseStart && now < phaseStart + LINK_STEP_DOWN_MS &&
+                st.profile != LINK_PROFILE_THROUGHPUT) {
+                holdOk = false;
+            }
+        }
+        LinkStats_t st;
+        Link_GetStats(&st);
+        PhaseEnd e = { (LinkProfile_t)st.profile, l.actual, st.loadPct, refused, st.shortfall };
+        ends.push_back(e);
+        phaseStart += ph.lengthMs;
+    }
+
+    LinkStats_t st;
+    Link_GetStats(&st);
+    printf("%s: %u requests, %u changes, %u rejected%s\n", c.name, st.requests, st.changes, st.rejected,
+           st.phyRefused ? ", PHY refused" : "");
+    printf("  %-13s %-10s %9s %4s %5s %6s %9s %8s  %s\n", "phase", "profile", "interval", "PHY", "DLE",
+           "load", "notify/s", "refused", "checks");
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        const Phase& ph = PHASES[p];
+        const PhaseEnd& e = ends[p];
+        LinkProfile_t expect = c.powerRefused ? ph.expectSlow : ph.expect;
+        bool replay = ph.notifyPerSec > 50;
+        bool shortExpected = c.shortOnReplay && replay;
+        bool ok = e.profile == expect && (shortExpected ? (e.refused > 0 && e.shortfall) : e.refused == 0);
+        LinkCapacity_t cap;
+        Link_Capacity(&e.actual, &cap);
+        printf("  %-13s %-10s %6.2f ms %4u %5u %5u%% %9u %8u  %s%s%s\n", ph.name, Link_ProfileName(e.profile),
+               e.actual.interval * 1.25, e.actual.txPhy, e.actual.dataLen, e.loadPct,
+               Link_NotifyRate(&e.actual, LEGACY_PAYLOAD), e.refused, ok ? "ok" : "FAIL:",
+               e.profile == expect ? "" : " profile",
+               (shortExpected ? (e.refused > 0 && e.shortfall) : e.refused == 0) ? "" : " load");
+        if (!ok) {
+            failures++;
+        }
+    }
+    if (!holdOk) {
+        printf("  FAIL: stepped down within %u ms of the load dropping\n", LINK_STEP_DOWN_MS);
+        failures++;
+    }
+    if ((st.rejected > 0) != c.expectRejected || st.phyRefused != c.expectPhyRefused) {
+        printf("  FAIL: rejected %u, PHY refused %d; expected %s, %s\n", st.rejected, st.phyRefused,
+               c.expectRejected ? "rejections" : "none", c.expectPhyRefused ? "PHY refused" : "PHY granted");
+        failures++;
+    }
+    printf("\n");
+    return failures;
+}
+
+// Capacity of a few parameter sets, legacy frames and full-MTU notifications
+static int capacityTable(void)
+{
+    static const uint16_t intervals[] = { 6, 12, 24, 36, 80 };
+    static const struct { uint8_t phy; uint16_t dataLen; } links[] = {
+        { LINK_PHY_1M, 27 }, { LINK_PHY_1M, 251 }, { LINK_PHY_2M, 251 }, { LINK_PHY_CODED, 251 },
+    };
+    int failures = 0;
+    printf("capacity model: %u packets/event max, %u%% of the interval, MTU %u\n",
+           LINK_MAX_PACKETS_PER_EVENT, LINK_EVENT_USE_PCT, MTU);
+    printf("%-9s %4s %5s %12s %13s %12s\n", "interval", "PHY", "DLE", "packets/ev", "39 B notify/s", "full B/s");
+    for (auto& k : links) {
+        for (uint16_t iv : intervals) {
+            LinkParams_t p = { iv, 0, 400, k.phy, k.phy, k.dataLen, MTU };
+            LinkCapacity_t cap;
+            Link_Capacity(&p, &cap);
+            uint32_t legacy = Link_NotifyRate(&p, LEGACY_PAYLOAD);
+            printf("%6.2f ms %4u %5u %12u %13u %12u\n", iv * 1.25, k.phy, k.dataLen, cap.packetsPerEvent,
+                   legacy, cap.bytesPerSec);
+            // 2M never carries less than 1M at the same interval and data length
+            if (k.phy == LINK_PHY_1M) {
+                LinkParams_t fast = p;
+                fast.txPhy = fast.rxPhy = LINK_PHY_2M;
+                LinkCapacity_t capFast;
+                Link_Capacity(&fast, &capFast);
+                if (capFast.bytesPerSec < cap.bytesPerSec) {
+                    printf("  FAIL: 2M carries less than 1M at %.2f ms\n", iv * 1.25);
+                    failures++;
+                }
+            }
+        }
+    }
+    // 1M, 27 B at 15 ms: a 39 B notification is 2 PDUs, 4 PDUs per event => 133/s
+    LinkParams_t p = { 12, 0, 400, LINK_PHY_1M, LINK_PHY_1M, 27, MTU };
+    if (Link_NotifyRate(&p, LEGACY_PAYLOAD) != 133) {
+        printf("  FAIL: 1M/27 at 15 ms carries %u legacy notifications/s, expected 133\n",
+               Link_NotifyRate(&p, LEGACY_PAYLOAD));
+        failures++;
+    }
+    // Data length extension fits a full MTU notification in one PDU
+    LinkParams_t q = p;
+    q.dataLen = 251;
+    LinkCapacity_t a, b;
+    Link_Capacity(&p, &a);
+    Link_Capacity(&q, &b);
+    if (b.bytesPerSec <= a.bytesPerSec) {
+        printf("  FAIL: data length extension adds no capacity\n");
+        failures++;
+    }
+    // 50 Hz of 35 B frames: 15 ms carries single frames; 100 ms (40 PDUs/s) needs pairs with
+    // data length extension and cannot keep up without it, so batches fill the MTU
+    static const struct { uint16_t interval; uint16_t dataLen; uint8_t frames; } batches[] = {
+        { 12, 27, 1 }, { 80, 251, 2 }, { 80, 27, 5 }, { 0, 27, 1 },
+    };
+    for (auto& k : batches) {
+        LinkParams_t r = { k.interval, 0, 400, LINK_PHY_1M, LINK_PHY_1M, k.dataLen, MTU };
+        uint8_t got = Link_BatchFrames(&r, 35, 50, 5);
+        if (got != k.frames) {
+            printf("  FAIL: %u x 1.25 ms, %u B: %u frames per notification, expected %u\n", k.interval,
+                   k.dataLen, got, k.frames);
+            failures++;
+        }
+    }
+    printf("\n");
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    int failures = capacityTable();
+    for (const Central& c : CENTRALS) {
+        failures += runCentral(c, verbose);
+    }
+    printf("%s\n", failures ? "link check FAILED" : "link check passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+// Slow log sink check: a simulated sensor task logs at several rates while the logger
+// task (LoggerService) writes to a mock sink that drains through a byte token bucket,
+// i.e. a UART slower than the log traffic, down to one that accepts nothing. Checks that
+// LoggerPrint() never reaches the sink and never takes as long as a sink retry, that every
+// line is accounted for as written or dropped (queue full, rate limit, sink), and that
+// drops show up in the log as a "[logger] dropped" line. Also checks that the periodic
+// TxMsg line carries every pressure channel, split over several lines on large insoles.
+// Exits non-zero on failure.
+// Usage: logger_check [-v]
+#include "LoggerModule.h"
+#include "Config.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#define FRAME_US            (DEFAULT_LOOP_INTERVAL_MS * 1000)
+#define REPORT_PREFIX       "[logger] dropped"
+
+// Sink that takes line bytes (plus CR LF) out of a token bucket, never waiting for it
+typedef struct {
+    double   bytesPerSec;
+    double   burst;
+    double   tokens;
+    uint32_t lastUs;
+    uint32_t accepted;
+    uint32_t refused;
+    uint32_t reports;           // accepted "[logger] dropped" lines
+    uint64_t bytes;
+    uint32_t fromProducer;      // writes while LoggerPrint() was running
+} SlowSink;
+
+static SlowSink s_slow;
+static bool s_inProducer = false;
+static std::string s_txMsg;     // TxMsg lines the sink took, pressure values only
+
+static bool slowWrite(const char* line, size_t len)
+{
+    if (s_inProducer) {
+        s_slow.fromProducer++;
+    }
+    uint32_t now = micros();
+    s_slow.tokens += (now - s_slow.lastUs) * s_slow.bytesPerSec / 1e6;
+    s_slow.lastUs = now;
+    if (s_slow.tokens > s_slow.burst) {
+        s_slow.tokens = s_slow.burst;
+    }
+    if (s_slow.tokens < len + 2) {
+        s_slow.refused++;
+        return false;
+    }
+    s_slow.tokens -= len + 2;
+    s_slow.accepted++;
+    s_slow.bytes += len + 2;
+    s_slow.reports += (strncmp(line, REPORT_PREFIX, strlen(REPORT_PREFIX)) == 0);
+    // The first line has the values after "Press[", the continuations after "... "; a
+    // line that continues ends in ", ..."
+    const char* msg = strstr(line, "TxMsg: ");
+    if (msg) {
+        std::string text(msg, line + len - msg);
+        size_t at = text.find("Press[");
+        text.erase(0, (at != std::string::npos) ? at + 6 : text.find("... ") + 4);
+        if (text.size() >= 5 && text.compare(text.size() - 5, 5, ", ...") == 0) {
+            text.erase(text.size() - 3);
+        }
+        s_txMsg += text;
+    }
+    return true;
+}
+
+static const LogSink_t s_slowSink = { "slow", nullptr, slowWrite };
+
+static void setSinkRate(double bytesPerSec)
+{
+    s_slow.bytesPerSec = bytesPerSec;
+    s_slow.burst = (bytesPerSec > 0) ? LOGGER_MAX_LOG_LENGTH + 2 : 0;
+    s_slow.tokens = s_slow.burst;
+    s_slow.lastUs = micros();
+}
+
+typedef struct {
+    const char* name;
+    double   sinkBytesPerSec;
+    uint8_t  level;
+    uint16_t linesPer100Frames;
+    uint8_t  servicePerFrame;   // lines the logger task gets to write per frame
+    uint16_t frames;
+    bool     expectDrops;
+} Scenario;
+
+static const Scenario SCENARIOS[] = {
+    { "quiet",        20000, LOGGER_LEVEL_INFO,   20, 4, 250, false },
+    { "rate limited", 20000, LOGGER_LEVEL_WARN,  500, 4, 250, true },
+    { "slow sink",     1500, LOGGER_LEVEL_ERROR, 200, 2, 250, true },
+    { "stalled sink",     0, LOGGER_LEVEL_ERROR, 100, 2, 100, true },
+};
+
+static LoggerStats_t diff(const LoggerStats_t& a, const LoggerStats_t& b)
+{
+    LoggerStats_t d;
+    d.queued = a.queued - b.queued;
+    d.written = a.written - b.written;
+    d.droppedQueueFull = a.droppedQueueFull - b.droppedQueueFull;
+    d.droppedRateLimit = a.droppedRateLimit - b.droppedRateLimit;
+    d.droppedSink = a.droppedSink - b.droppedSink;
+    return d;
+}
+
+// One LoggerPrintLoopMessage() with the widest values: every channel must reach the sink
+static int runLoopMessage(void)
+{
+    SensorData frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.battery = 255;
+    frame.accel_x = frame.accel_y = frame.accel_z = INT16_MIN;
+    std::string expect;
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        frame.pressure[ch] = (uint16_t)(65535 - ch);
+        expect += std::to_string(65535 - ch) + ((ch < PRESSURE_CHANNEL_COUNT - 1) ? ", " : "]");
+    }
+    setSinkRate(1e9);
+    s_txMsg.clear();
+    Shim_AdvanceUs((uint64_t)PRINT_INTERVAL * 1000);
+    LoggerPrintLoopMessage(&frame);
+    while (LoggerService(0)) {
+    }
+    printf("%-12s  %d channels, %u characters of values\n", "loop message", PRESSURE_CHANNEL_COUNT,
+           (unsigned)s_txMsg.size());
+    if (s_txMsg != expect) {
+        printf("  FAIL loop message: pressure values \"%s\", expected \"%s\"\n", s_txMsg.c_str(), expect.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+static int runScenario(const Scenario* sc, bool verbose)
+{
+    int failures = 0;
+    SlowSink before = s_slow;
+    LoggerStats_t start;
+    LoggerGetStats(&start);
+    setSinkRate(sc->sinkBytesPerSec);
+
+    uint32_t attempted = 0;
+    double maxPrintUs = 0;
+    uint32_t owed = 0;
+    for (uint16_t f = 0; f < sc->frames; f++) {
+        Shim_AdvanceUs(FRAME_US);
+        owed += sc->linesPer100Frames;
+        for (; owed >= 100; owed -= 100) {
+            s_inProducer = true;
+            auto t0 = std::chrono::steady_clock::now();
+            LoggerPrint(sc->level, __FUNCTION__, __LINE__, "ADS1115 read error: dev=%d ch=%d frame %u",
+                        (int)(attempted & 3), (int)((attempted >> 2) & 3), (unsigned)f);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            s_inProducer = false;
+            maxPrintUs = (us > maxPrintUs) ? us : maxPrintUs;
+            attempted++;
+        }
+        for (uint8_t k = 0; k < sc->servicePerFrame; k++) {
+            LoggerService(0);
+        }
+    }
+    LoggerStats_t run;
+    LoggerGetStats(&run);
+    LoggerStats_t d = diff(run, start);
+    uint32_t dropped = d.droppedQueueFull + d.droppedRateLimit + d.droppedSink;
+
+    // Fast sink and a report period later: the backlog drains and the drops are reported
+    setSinkRate(1e9);
+    Shim_AdvanceUs((uint64_t)LOGGER_DROP_REPORT_MS * 1000 + FRAME_US);
+    while (LoggerService(0)) {
+    }
+    LoggerService(0);
+    LoggerStats_t end;
+    LoggerGetStats(&end);
+    LoggerStats_t all = diff(end, start);
+    uint32_t accepted = s_slow.accepted - before.accepted;
+    uint32_t reports = s_slow.reports - before.reports;
+
+    printf("%-12s  %7.0f  %8u  %7u  %6u  %6u  %6u  %6u  %8.1f\n", sc->name, sc->sinkBytesPerSec, attempted,
+           d.written, d.droppedQueueFull, d.droppedRateLimit, d.droppedSink, reports, maxPrintUs);
+
+    if (s_slow.fromProducer != before.fromProducer) {
+        printf("  FAIL %s: the sink was written from LoggerPrint()\n", sc->name);
+        failures++;
+    }
+    if (maxPrintUs >= LOGGER_SINK_RETRY_MS * 1000.0) {
+        printf("  FAIL %s: LoggerPrint() took %.0f us, as long as a sink retry\n", sc->name, maxPrintUs);
+        failures++;
+    }
+    if (d.queued + d.droppedQueueFull + d.droppedRateLimit != attempted) {
+        printf("  FAIL %s: %u lines logged, %u queued + %u queue full + %u rate limited\n", sc->name, attempted,
+               d.queued, d.droppedQueueFull, d.droppedRateLimit);
+        failures++;
+    }
+    if (accepted != all.written) {
+        printf("  FAIL %s: sink took %u lines, logger counted %u written\n", sc->name, accepted, all.written);
+        failures++;
+    }
+    // Every queued line is written or dropped at the sink; the rest are drop reports,
+    // at most one per report period
+    uint32_t handled = all.written + all.droppedSink;
+    uint32_t periods = (uint32_t)((uint64_t)sc->frames * FRAME_US / (LOGGER_DROP_REPORT_MS * 1000)) + 2;
+    if (handled < all.queued + reports || handled > all.queued + periods) {
+        printf("  FAIL %s: %u queued, %u written + %u dropped at the sink, %u reports\n", sc->name, all.queued,
+               all.written, all.droppedSink, reports);
+        failures++;
+    }
+    if (sc->expectDrops != (dropped > 0)) {
+        printf("  FAIL %s: %u lines dropped\n", sc->name, dropped);
+        failures++;
+    }
+    if (dropped > 0 && reports == 0) {
+        printf("  FAIL %s: %u drops never reported\n", sc->name, dropped);
+        failures++;
+    }
+    if (verbose) {
+        printf("  %-12s sink %u accepted, %u refused, %llu bytes\n", sc->name, accepted,
+               s_slow.refused - before.refused, (unsigned long long)(s_slow.bytes - before.bytes));
+    }
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    LoggerClearSinks();
+    LoggerAddSink(&s_slowSink);
+    setSinkRate(1e9);
+    LoggerInit();
+
+    printf("queue %d lines, sink retry %d ms, %d ms frames\n\n", LOGGER_QUEUE_SIZE, LOGGER_SINK_RETRY_MS,
+           DEFAULT_LOOP_INTERVAL_MS);
+    printf("scenario       sink B/s    logged  written   queue    rate    sink  report  print max us\n");
+    int failures = 0;
+    for (const Scenario& sc : SCENARIOS) {
+        failures += runScenario(&sc, verbose);
+    }
+    failures += runLoopMessage();
+
+    printf("\nlogger check %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+// Notification retry ring check: 50 Hz frames through a modelled BLE stack (few TX
+// buffers, emptied a few packets per connection event) whose link stalls in bursts.
+// Checks that frames arrive strictly in order, that every frame is either delivered or
+// counted as dropped, that drops hit the oldest frames, that each frame keeps the stamp
+// it was queued with, and that the ring stays within RETX_SLOTS. The stack announces no
+// freed buffer, so the ring is retried on the comm task's wakes: with each frame and every
+// RETX_POLL_MS while it holds notifications; checks that a buffer a connection event
+// freed takes the ring's oldest frame within RETX_POLL_MS. Compares against discarding
+// refused notifications. Exits non-zero on failure.
+// Usage: retx_check
+#include "RetransmitModule.h"
+#include "Config.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define FRAME_PERIOD_US     20000
+#define FRAME_BYTES         39
+#define STACK_BUFFERS       8       // notifications the stack holds before refusing
+#define CONN_INTERVAL_US    15000
+#define PACKETS_PER_EVENT   4
+
+typedef struct {
+    uint32_t startMs;
+    uint32_t lengthMs;
+} Stall;
+
+typedef struct {
+    const char* name;
+    Stall stalls[4];
+    bool lossAllowed;           // outage longer than the ring covers; drops are still checked for policy
+} LinkCase;
+
+static const LinkCase CASES[] = {
+    { "clear",        { { 0, 0 } },                                   false },
+    { "short burst",  { { 1000, 200 } },                              false },
+    { "bursts",       { { 500, 150 }, { 1500, 250 }, { 3000, 300 } }, false },
+    { "long outage",  { { 1000, 2000 } },                             true },
+};
+
+typedef struct {
+    const LinkCase* c;
+    uint32_t nowUs;
+    std::vector<uint32_t> stack;        // notifications waiting in the controller, FIFO
+    std::vector<uint32_t> received;
+    uint32_t wrongStamps;               // sent with another frame's stamp
+    bool freed;                         // a connection event freed buffers while frames waited
+    uint32_t freedUs;
+    uint32_t maxRetryUs;                // longest from such an event to the next frame taken
+} Link;
+
+static bool stalled(const Link* l)
+{
+    uint32_t ms = l->nowUs / 1000;
+    for (const Stall& s : l->c->stalls) {
+        if (s.lengthMs && ms >= s.startMs && ms < s.startMs + s.lengthMs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Frames are stamped with the time they were produced
+static bool stackSend(const uint8_t* data, size_t len, uint32_t stamp, void* ctx)
+{
+    Link* l = (Link*)ctx;
+    if (l->stack.size() >= STACK_BUFFERS || len < sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t frame;
+    memcpy(&frame, data, sizeof(frame));
+    if (stamp != frame * FRAME_PERIOD_US) {
+        l->wrongStamps++;
+    }
+    if (l->freed) {
+        l->freed = false;
+        l->maxRetryUs = (l->nowUs - l->freedUs > l->maxRetryUs) ? l->nowUs - l->freedUs : l->maxRetryUs;
+    }
+    l->stack.push_back(frame);
+    return true;
+}
+
+// One connection event; returns true if notifications completed. Nothing announces it.
+static bool connectionEvent(Link* l)
+{
+    if (stalled(l) || l->stack.empty()) {
+        return false;
+    }
+    size_t n = l->stack.size() < PACKETS_PER_EVENT ? l->stack.size() : PACKETS_PER_EVENT;
+    l->received.insert(l->received.end(), l->stack.begin(), l->stack.begin() + n);
+    l->stack.erase(l->stack.begin(), l->stack.begin() + n);
+    return true;
+}
+
+typedef struct {
+    uint32_t produced, delivered, maxDepth, dropped, baselineLost, maxRetryUs;
+    bool ordered, accounted, oldestDropped, bounded, stamped, prompt;
+} CaseResult;
+
+static CaseResult runCase(const LinkCase& c, uint32_t durationMs, bool retry)
+{
+    Link l;
+    l.c = &c;
+    l.nowUs = 0;
+    l.wrongStamps = 0;
+    l.freed = false;
+    l.freedUs = 0;
+    l.maxRetryUs = 0;
+    Retx_Reset();
+    CaseResult r;
+    memset(&r, 0, sizeof(r));
+    uint32_t baselineLost = 0;
+    uint32_t nextFrameUs = 0, nextEventUs = CONN_INTERVAL_US, nextWakeUs = 0;
+    bool overrun = false;
+    uint8_t payload[FRAME_BYTES] = {};
+
+    // Produce for durationMs, then let the link drain
+    for (; l.nowUs < (durationMs + 1000) * 1000u; l.nowUs += 250) {
+        if (l.nowUs >= nextFrameUs && l.nowUs < durationMs * 1000u) {
+            memcpy(payload, &r.produced, sizeof(r.produced));
+            if (retry) {
+                Retx_Send(payload, sizeof(payload), nextFrameUs, stackSend, &l);
+                nextWakeUs = l.nowUs + RETX_POLL_MS * 1000;
+            } else if (!stackSend(payload, sizeof(payload), nextFrameUs, &l)) {
+                baselineLost++;
+            }
+            r.produced++;
+            nextFrameUs += FRAME_PERIOD_US;
+        }
+        if (l.nowUs >= nextEventUs) {
+            if (connectionEvent(&l) && retry && Retx_Depth() > 0 && !l.freed) {
+                l.freed = true;
+                l.freedUs = l.nowUs;
+            }
+            nextEventUs += CONN_INTERVAL_US;
+        }
+        // The comm task's poll wake while the ring holds notifications (BLE_ServiceRetx)
+        if (retry && Retx_Depth() > 0 && l.nowUs >= nextWakeUs) {
+            Retx_Drain(stackSend, &l);
+            nextWakeUs = l.nowUs + RETX_POLL_MS * 1000;
+        }
+        if (Retx_Depth() > RETX_SLOTS) {
+            overrun = true;
+        }
+    }
+
+    RetxStats_t st;
+    Retx_GetStats(&st);
+    r.delivered = (uint32_t)l.received.size();
+    r.dropped = retry ? st.dropped : baselineLost;
+    r.baselineLost = baselineLost;
+    r.maxDepth = st.maxDepth;
+    r.bounded = !overrun && st.maxDepth <= RETX_SLOTS;
+    r.stamped = (l.wrongStamps == 0);
+    // Freed buffers wait for the comm task's next wake: a frame, or the poll
+    r.maxRetryUs = l.maxRetryUs;
+    r.prompt = l.maxRetryUs <= RETX_POLL_MS * 1000;
+    r.ordered = true;
+    for (size_t i = 1; i < l.received.size(); i++) {
+        if (l.received[i] <= l.received[i - 1]) {
+            r.ordered = false;
+        }
+    }
+    r.accounted = (r.delivered + r.dropped == r.produced) && st.depth == 0 && l.stack.empty();
+
+    // Oldest-first: a full ring keeps the newest frames, so every gap in the delivered
+    // sequence ends right before RETX_SLOTS delivered frames in a row
+    r.oldestDropped = true;
+    if (retry) {
+        std::vector<bool> got(r.produced, false);
+        for (uint32_t f : l.received) got[f] = true;
+        for (uint32_t f = 0; f + 1 < r.produced; f++) {
+            if (got[f] || !got[f + 1]) continue;
+            for (uint32_t g = f + 1; g < r.produced && g <= f + RETX_SLOTS; g++) {
+                if (!got[g]) r.oldestDropped = false;
+            }
+        }
+    }
+    return r;
+}
+
+int main(void)
+{
+    const uint32_t durationMs = 6000;
+    int failures = 0;
+    printf("ring: %d slots x %d B = %zu B\n\n", RETX_SLOTS, RETX_SLOT_SIZE,
+           (size_t)RETX_SLOTS * (RETX_SLOT_SIZE + 8));
+    printf("%-12s %8s %9s %8s %9s %8s %10s  %s\n", "link", "frames", "delivered", "dropped", "max depth",
+           "retry ms", "no retry", "checks");
+    for (const LinkCase& c : CASES) {
+        CaseResult base = runCase(c, durationMs, false);
+        CaseResult r = runCase(c, durationMs, true);
+        bool ok = r.ordered && r.accounted && r.bounded && r.oldestDropped && r.stamped && r.prompt &&
+                  (c.lossAllowed || r.dropped == 0);
+        printf("%-12s %8u %9u %8u %9u %8.1f %10u  %s%s%s%s%s%s%s\n", c.name, r.produced, r.delivered, r.dropped,
+               r.maxDepth, r.maxRetryUs / 1000.0, base.dropped, ok ? "ok" : "FAIL:",
+               r.ordered ? "" : " order", r.accounted ? "" : " accounting",
+               r.bounded ? "" : " bound", r.oldestDropped ? "" : " drop-policy", r.stamped ? "" : " stamp",
+               r.prompt ? "" : " retry");
+        if (!c.lossAllowed && r.dropped) {
+            printf("  FAIL: %s lost %u frames\n", c.name, r.dropped);
+        }
+        if (!ok) {
+            failures++;
+        }
+    }
+    printf("%s\n", failures ? "retry check FAILED" : "retry check passed");
+    return failures ? 1 : 0;
+}
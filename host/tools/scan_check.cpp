@@ -0,0 +1,272 @@
+// Pressure scan scheduler check: builds the mux sequences of src/ScanSchedulerModule.cpp
+// for several rate tables and replays one second of scan ticks, i.e. a fixed I2C budget
+// of ticks/s conversions per ADS1115. Reports the conversions every channel gets against
+// a uniform scan that spends the same number of conversions, and the effective bandwidth
+// gain on the hot channels (requested above the table's mean). Checks that replayed
+// counts match the scheduled rates, that the bus stays within its budget, that every
+// requested channel is scanned, and that a channel's slots are spread evenly. Then runs
+// the firmware scan (Pressure_Init/Pressure_Read) on the ADS1115 shim and checks that
+// every input lands in the frame slot the topology maps it to, and that a device that
+// goes down marks exactly its own slots. Build with -DINSOLE_SENSOR_COUNT=8, 16 or 32.
+// Exits non-zero on failure.
+// Usage: scan_check [-v]
+#include "ScanSchedulerModule.h"
+#include "PressureModule.h"
+#include "FilterModule.h"
+#include "LoggerModule.h"
+#include "Config.h"
+#include "Adafruit_ADS1X15.h"
+#include <stdio.h>
+#include <string.h>
+
+// Release loop period, whatever the log level of this build slows the loop down to
+#define TICK_RATE_HZ    (PRESSURE_SCAN_TICKS_PER_FRAME * 1000 / DEFAULT_LOOP_INTERVAL_MS)
+
+typedef struct {
+    const char* name;
+    uint16_t rates[PRESSURE_CHANNEL_COUNT];
+    bool expectGain;            // hot channels must beat the uniform scan
+} RateTable;
+
+static RateTable s_tables[] = {
+    { "config",  PRESSURE_CHANNEL_RATES_HZ, true },
+    { "uniform", {},                        false },
+    { "heel",    {},                        true },
+    { "over",    {},                        true },
+};
+
+static void fillTables(void)
+{
+    for (int s = 0; s < PRESSURE_CHANNEL_COUNT; s++) {
+        s_tables[1].rates[s] = 50;
+        // Heel quarter of the insole fast, the rest barely sampled
+        s_tables[2].rates[s] = (s < PRESSURE_CHANNEL_COUNT / 4) ? 200 : 10;
+        // Asks for more than an ADS1115 converts: the scheduler scales everybody down
+        s_tables[3].rates[s] = (s % 4 == 0) ? 400 : 100;
+    }
+}
+
+typedef struct {
+    uint32_t conversions;       // bus transactions in one second
+    uint32_t budget;            // ticks x devices
+    double   uniformHz;         // per channel if the same conversions were spread evenly
+    double   hotHz;             // mean rate of the hot channels
+    double   gain;              // hotHz / uniformHz
+    int      hot;
+    int      failures;
+} TableResult;
+
+static TableResult runTable(const RateTable* t, bool verbose)
+{
+    TableResult r;
+    memset(&r, 0, sizeof(r));
+    ScanScheduler_Init(t->rates, TICK_RATE_HZ);
+
+    uint32_t count[PRESSURE_CHANNEL_COUNT] = {0};
+    uint32_t lastTick[PRESSURE_CHANNEL_COUNT];
+    uint32_t maxGap[PRESSURE_CHANNEL_COUNT] = {0};
+    memset(lastTick, 0xFF, sizeof(lastTick));
+
+    // Two seconds, so the gaps across the sequence wrap are measured too; counts cover the second one
+    for (uint32_t tick = 0; tick < 2u * TICK_RATE_HZ; tick++) {
+        for (uint8_t dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+            uint8_t ch = ScanScheduler_NextChannel(dev);
+            if (ch == SCAN_SLOT_IDLE) {
+                continue;
+            }
+            uint8_t s = ActiveTopology::sensorOf(dev, ch);
+            if (lastTick[s] != 0xFFFFFFFFu && tick - lastTick[s] > maxGap[s]) {
+                maxGap[s] = tick - lastTick[s];
+            }
+            lastTick[s] = tick;
+            if (tick >= TICK_RATE_HZ) {
+                count[s]++;
+                r.conversions++;
+            }
+        }
+    }
+    r.budget = (uint32_t)TICK_RATE_HZ * PRESSURE_ADC_COUNT;
+    r.uniformHz = (double)r.conversions / PRESSURE_CHANNEL_COUNT;
+    if (r.conversions > r.budget) {
+        printf("  FAIL %s: %u conversions/s over the %u budget\n", t->name, r.conversions, r.budget);
+        r.failures++;
+    }
+
+    uint32_t requested = 0;
+    for (int s = 0; s < PRESSURE_CHANNEL_COUNT; s++) {
+        requested += t->rates[s];
+    }
+    double meanHz = (double)requested / PRESSURE_CHANNEL_COUNT;
+
+    double hotSum = 0;
+    for (int s = 0; s < PRESSURE_CHANNEL_COUNT; s++) {
+        uint16_t scheduled = ScanScheduler_GetScheduledRateHz((uint8_t)s);
+        if (count[s] != scheduled) {
+            printf("  FAIL %s ch%02d: %u conversions replayed, %u Hz scheduled\n", t->name, s, count[s], scheduled);
+            r.failures++;
+        }
+        if (t->rates[s] > 0 && count[s] == 0) {
+            printf("  FAIL %s ch%02d: requested %u Hz, never scanned\n", t->name, s, t->rates[s]);
+            r.failures++;
+        }
+        // Evenly spread: idle slots and neighbours may push a sample, but never by a whole period
+        if (count[s] > 0) {
+            uint32_t ideal = (TICK_RATE_HZ + count[s] - 1) / count[s];
+            if (maxGap[s] >= 2 * ideal) {
+                printf("  FAIL %s ch%02d: %u ticks between samples, %u expected\n", t->name, s, maxGap[s], ideal);
+                r.failures++;
+            }
+        }
+        if (t->rates[s] > meanHz) {
+            hotSum += count[s];
+            r.hot++;
+        }
+        if (verbose) {
+            printf("  %-8s ch%02d  requested %4u Hz  scheduled %4u Hz  max gap %3u ticks\n",
+                   t->name, s, t->rates[s], count[s], maxGap[s]);
+        }
+    }
+    r.hotHz = r.hot ? hotSum / r.hot : 0;
+    r.gain = (r.hot && r.uniformHz > 0) ? r.hotHz / r.uniformHz : 1.0;
+    if (t->expectGain && r.gain <= 1.0) {
+        printf("  FAIL %s: hot channels x%.2f of a uniform scan\n", t->name, r.gain);
+        r.failures++;
+    }
+    return r;
+}
+
+// ' ROUTING ' //
+
+#define ROUTING_FRAMES      50      // enough for every channel of the config table to convert
+#define DOWN_FRAMES         20      // read errors give up on a device well within this
+
+static void setDevices(ShimAdsMode_t mode)
+{
+    for (uint8_t dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        Shim_AdsSetMode(ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address, mode);
+    }
+}
+
+static PressureMask_t runFrames(int frames)
+{
+    PressureMask_t seen = 0;
+    for (int f = 0; f < frames; f++) {
+        Pressure_Read();
+        seen |= Pressure_ValidMask;
+        Shim_AdvanceUs((uint64_t)LOOP_INTERVAL_MS * 1000);
+        Shim_DrainQueues();     // the logger task
+    }
+    return seen;
+}
+
+// Slots of one device: its inputs' converted values, or PRESSURE_VALUE_DOWN once it is down
+static int checkDevice(uint8_t dev, bool down, const char* phase, bool verbose)
+{
+    int failures = 0;
+    const TopologyAdc adc = ActiveTopology::adc(dev);
+    for (uint8_t input = 0; input < PRESSURE_CHANNELS_PER_ADC; input++) {
+        uint8_t s = ActiveTopology::sensorOf(dev, input);
+        bool valid = (Pressure_ValidMask >> s) & 1;
+        uint16_t want = down ? PRESSURE_VALUE_DOWN : (uint16_t)Shim_AdsValue(adc.bus, adc.address, input);
+        if (Pressure_Array[s] != want || (down && valid)) {
+            printf("  FAIL %s: ADS1115 %u:0x%02X input %u => slot %u holds %u%s, %u expected\n", phase, adc.bus,
+                   adc.address, input, s, Pressure_Array[s], valid ? " (valid)" : "", want);
+            failures++;
+        }
+        if (verbose) {
+            printf("  %-8s ADS1115 %u:0x%02X input %u => slot %2u  %5u\n", phase, adc.bus, adc.address, input, s,
+                   Pressure_Array[s]);
+        }
+    }
+    return failures;
+}
+
+static int checkRouting(bool verbose)
+{
+    int failures = 0;
+
+    // The topology owns every frame slot exactly once
+    uint8_t owners[PRESSURE_CHANNEL_COUNT] = {0};
+    for (uint8_t dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        for (uint8_t input = 0; input < PRESSURE_CHANNELS_PER_ADC; input++) {
+            uint8_t s = ActiveTopology::sensorOf(dev, input);
+            if (s >= PRESSURE_CHANNEL_COUNT) {
+                printf("  FAIL topology: ADS1115 %u input %u => slot %u out of range\n", dev, input, s);
+                failures++;
+            } else {
+                owners[s]++;
+            }
+        }
+    }
+    for (int s = 0; s < PRESSURE_CHANNEL_COUNT; s++) {
+        if (owners[s] != 1) {
+            printf("  FAIL topology: slot %d owned by %u inputs\n", s, owners[s]);
+            failures++;
+        }
+    }
+
+    // Every input converts into its own slot
+    setDevices(SHIM_ADS_OK);
+    Pressure_Init();
+    Filter_Reset();
+    PressureMask_t all = (PressureMask_t)~(PressureMask_t)0;    // one bit per slot at every sensor count
+    PressureMask_t seen = runFrames(ROUTING_FRAMES);
+    if (seen != all) {
+        printf("  FAIL routing: slots 0x%llX converted, 0x%llX expected\n", (unsigned long long)seen,
+               (unsigned long long)all);
+        failures++;
+    }
+    for (uint8_t dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        failures += checkDevice(dev, false, "routing", verbose);
+    }
+
+    // One device down at a time: its slots, and only its slots, carry the marker
+    for (uint8_t dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        const TopologyAdc adc = ActiveTopology::adc(dev);
+        Shim_AdsSetMode(adc.bus, adc.address, SHIM_ADS_READ_ERROR);
+        int f = 0;
+        while (f < DOWN_FRAMES && (Pressure_GetHealthyMask() >> dev) & 1) {
+            runFrames(1);
+            f++;
+        }
+        if ((Pressure_GetHealthyMask() >> dev) & 1) {
+            printf("  FAIL down: ADS1115 %u still healthy after %d frames of read errors\n", dev, DOWN_FRAMES);
+            failures++;
+        }
+        runFrames(2);
+        for (uint8_t other = 0; other < PRESSURE_ADC_COUNT; other++) {
+            failures += checkDevice(other, other == dev, "down", verbose && other == dev);
+        }
+        Shim_AdsSetMode(adc.bus, adc.address, SHIM_ADS_OK);
+        Pressure_Init();
+        Filter_Reset();
+        runFrames(ROUTING_FRAMES);
+    }
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    LoggerInit();
+    fillTables();
+
+    printf("%d sensors, %d ADS1115, %d scan ticks/s => I2C budget %d conversions/s\n\n",
+           PRESSURE_CHANNEL_COUNT, (int)PRESSURE_ADC_COUNT, TICK_RATE_HZ, TICK_RATE_HZ * (int)PRESSURE_ADC_COUNT);
+    printf("table     conv/s  budget  uniform Hz  hot  hot Hz   gain\n");
+    int failures = 0;
+    for (const RateTable& t : s_tables) {
+        TableResult r = runTable(&t, verbose);
+        printf("%-8s  %6u  %6u  %10.1f  %3d  %6.1f  x%.2f\n",
+               t.name, r.conversions, r.budget, r.uniformHz, r.hot, r.hotHz, r.gain);
+        failures += r.failures;
+    }
+
+    int routing = checkRouting(verbose);
+    printf("\nrouting   %d ADS1115 x %d inputs => %d slots, one device down at a time: %s\n",
+           (int)PRESSURE_ADC_COUNT, PRESSURE_CHANNELS_PER_ADC, PRESSURE_CHANNEL_COUNT, routing ? "FAILED" : "ok");
+    failures += routing;
+
+    printf("\nscan check %s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+// Self-test against simulated devices: runs SelfTest_Run() on a virtual clock with
+// modelled ADS1115s, ADXL345 FIFO, per-frame path and BLE link, for a healthy unit and
+// for the faults the test has to catch. Exits non-zero if a verdict differs from the expected one.
+// Usage: selftest_sim [-v]
+#include "SelfTestModule.h"
+#include "Config.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const char* name;
+    uint32_t i2cHz;
+    uint32_t errorEvery;        // every n-th I2C transaction fails, 0 => none
+    uint32_t missingAdcMask;    // ADS1115s that do not answer
+    uint32_t accOdrHz;
+    bool     central;
+    uint16_t payload;           // notification payload the central negotiated
+    uint32_t connIntervalUs;
+    uint8_t  packetsPerEvent;
+    uint8_t  expectFailed;      // SELFTEST_FAIL_* bits
+} SimCase;
+
+// Eight ADS1115s are scanned from one task: in this model their serial I2C traffic does not
+// fit a 20 ms frame at 400 kHz, so the 32-sensor variant fails the frame rate even when healthy
+#define SIM_BASE_FAILED     ((SELFTEST_ADC_COUNT > 4) ? SELFTEST_FAIL_FRAME_RATE : 0)
+
+static const SimCase CASES[] = {
+    { "healthy",       400000, 0,   0, 800, true,  182, 15000, 4, SIM_BASE_FAILED },
+    { "no central",    400000, 0,   0, 800, false,   0,     0, 0, SIM_BASE_FAILED },
+    { "100 kHz bus",   100000, 0,   0, 800, true,  182, 15000, 4,
+      SELFTEST_FAIL_ADS_RATE | SELFTEST_FAIL_ACC_DRAIN | SELFTEST_FAIL_FRAME_RATE },
+    { "flaky bus",     400000, 150, 0, 800, true,  182, 15000, 4, SIM_BASE_FAILED | SELFTEST_FAIL_I2C_ERRORS },
+    { "missing ADS",   400000, 0,   1, 800, true,  182, 15000, 4,
+      SIM_BASE_FAILED | SELFTEST_FAIL_ADS_RATE | SELFTEST_FAIL_I2C_ERRORS },
+    { "weak link",     400000, 0,   0, 800, true,   20, 50000, 1, SIM_BASE_FAILED | SELFTEST_FAIL_NOTIFY_RATE },
+};
+
+#define SIM_CONV_US         1163    // ADS1115 at 860 SPS
+#define SIM_TX_OVERHEAD_US  10      // start/stop, driver
+#define SIM_FRAME_CPU_US    400     // filter, alignment, packing, encoding
+#define SIM_NOTIFY_CPU_US   40
+#define SIM_STACK_BUFFERS   12      // notifications the BLE stack can hold
+
+typedef struct {
+    const SimCase* c;
+    uint32_t now;
+    uint32_t transactions;
+    double   accPending;            // FIFO fill, fractional entries
+    uint32_t accLastUs;
+    uint32_t queued;                // notifications waiting for a connection event
+    uint32_t nextEventUs;
+} Sim;
+
+// Time for one I2C transaction of n bytes incl. address (9 clocks per byte)
+static uint32_t txUs(const Sim* s, uint32_t bytes)
+{
+    return bytes * 9u * 1000000u / s->c->i2cHz + SIM_TX_OVERHEAD_US;
+}
+
+static bool txFails(Sim* s)
+{
+    s->transactions++;
+    return s->c->errorEvery && (s->transactions % s->c->errorEvery) == 0;
+}
+
+static void advance(Sim* s, uint32_t us)
+{
+    s->now += us;
+    // Connection events drain the notification queue
+    if (s->c->central) {
+        while ((int32_t)(s->now - s->nextEventUs) >= 0) {
+            s->queued = (s->queued > s->c->packetsPerEvent) ? s->queued - s->c->packetsPerEvent : 0;
+            s->nextEventUs += s->c->connIntervalUs;
+        }
+    }
+}
+
+static uint32_t simNow(void* ctx)
+{
+    return ((Sim*)ctx)->now;
+}
+
+static void simDelay(void* ctx, uint32_t us)
+{
+    advance((Sim*)ctx, us);
+}
+
+// Traffic of one conversion besides the start: config poll and result read, pointer write + 2 bytes each
+static uint32_t collectUs(const Sim* s)
+{
+    return 2 * (txUs(s, 2) + txUs(s, 3));
+}
+
+// Config write, conversion, status poll, result read
+static bool simAdsConvert(void* ctx, uint8_t dev, uint8_t input)
+{
+    (void)input;                        // every input converts alike
+    Sim* s = (Sim*)ctx;
+    if (s->c->missingAdcMask & (1u << dev)) {
+        advance(s, txUs(s, 1));         // NACK on the address byte
+        s->transactions++;
+        return false;
+    }
+    advance(s, txUs(s, 4));
+    bool failed = txFails(s);
+    advance(s, SIM_CONV_US + collectUs(s));
+    return !failed;
+}
+
+static int simAccDrain(void* ctx)
+{
+    Sim* s = (Sim*)ctx;
+    s->accPending += (double)(s->now - s->accLastUs) * s->c->accOdrHz / 1e6;
+    if (s->accPending > 32) {
+        s->accPending = 32;             // stream mode keeps the newest 32
+    }
+    int entries = (int)s->accPending;
+    s->accPending -= entries;
+    s->accLastUs = s->now;              // the sensor keeps sampling while the FIFO is read
+    advance(s, txUs(s, 2) + txUs(s, 2));                 // FIFO_STATUS
+    for (int i = 0; i < entries; i++) {
+        advance(s, txUs(s, 2) + txUs(s, 7));             // DATAX0 pointer, 6-byte burst
+    }
+    return txFails(s) ? -1 : entries;
+}
+
+// The devices of a scan tick convert in parallel, their I2C traffic is serial: all starts,
+// the rest of the first conversion, then every device collected in turn
+static bool simFrame(void* ctx)
+{
+    Sim* s = (Sim*)ctx;
+    bool ok = simAccDrain(ctx) >= 0;
+    for (int tick = 0; tick < PRESSURE_SCAN_TICKS_PER_FRAME; tick++) {
+        uint32_t startsUs = 0;
+        for (int dev = 0; dev < SELFTEST_ADC_COUNT; dev++) {
+            startsUs += txUs(s, (s->c->missingAdcMask & (1u << dev)) ? 1 : 4);
+        }
+        advance(s, startsUs);
+        if (SIM_CONV_US > startsUs - txUs(s, 4)) {
+            advance(s, SIM_CONV_US - (startsUs - txUs(s, 4)));
+        }
+        for (int dev = 0; dev < SELFTEST_ADC_COUNT; dev++) {
+            if (s->c->missingAdcMask & (1u << dev)) {
+                ok = false;
+                continue;
+            }
+            advance(s, collectUs(s));
+            ok = !txFails(s) && ok;
+        }
+    }
+    advance(s, SIM_FRAME_CPU_US);
+    return ok;
+}
+
+static uint16_t simNotifyPayload(void* ctx)
+{
+    Sim* s = (Sim*)ctx;
+    return s->c->central ? s->c->payload : 0;
+}
+
+static bool simNotify(void* ctx, const uint8_t* data, size_t len)
+{
+    (void)data;                         // the cost is per notification, not per byte
+    (void)len;
+    Sim* s = (Sim*)ctx;
+    advance(s, SIM_NOTIFY_CPU_US);
+    if (s->queued >= SIM_STACK_BUFFERS) {
+        return false;
+    }
+    s->queued++;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    SelfTestLimits_t limits;
+    SelfTest_DefaultLimits(&limits);
+    int failures = 0;
+
+    printf("%-12s %8s %8s %8s %8s %8s %8s  %-6s %s\n", "case", "ADS SPS", "lat us", "err ppm",
+           "acc Hz", "frame Hz", "B/s", "failed", "expected");
+    for (const SimCase& c : CASES) {
+        Sim sim;
+        memset(&sim, 0, sizeof(sim));
+        sim.c = &c;
+        sim.now = 0xFFFFFFFFu - 1000000u;   // wraps during the run
+        sim.accLastUs = sim.now;
+        sim.nextEventUs = sim.now + c.connIntervalUs;
+        SelfTestOps_t ops = { &sim, simNow, simDelay, simAdsConvert, simAccDrain, simFrame,
+                              simNotifyPayload, simNotify };
+
+        SelfTestResult_t r;
+        SelfTest_Run(&ops, &limits, &r);
+
+        uint32_t minSps = 0xFFFFFFFFu, maxLat = 0;
+        for (int dev = 0; dev < SELFTEST_ADC_COUNT; dev++) {
+            if (r.adc[dev].sps < minSps) minSps = r.adc[dev].sps;
+            if (r.adc[dev].maxLatencyUs > maxLat) maxLat = r.adc[dev].maxLatencyUs;
+        }
+        bool ok = r.failed == c.expectFailed;
+        printf("%-12s %8u %8u %8u %8u %8u %8u  0x%02X   0x%02X %s\n", c.name, minSps, maxLat, r.i2cErrorPpm,
+               r.accDrainHz, r.frameHz, r.notifyBps, r.failed, c.expectFailed, ok ? "" : "MISMATCH");
+        if (verbose || !ok) {
+            char report[1024];
+            SelfTest_FormatReport(&r, &limits, report, sizeof(report));
+            printf("%s\n", report);
+        }
+        if (!ok) {
+            failures++;
+        }
+    }
+    printf("%s\n", failures ? "self-test simulation FAILED" : "self-test simulation passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,449 @@
+// Wired lab capture: reads the firmware's binary serial stream (include/SerialStreamModule.h)
+// from a tty or a recorded file, writes the frames to a session file and the log lines to a
+// text file, and reports frames/s, bytes/s, CRC errors and lost packets once per second.
+// A reader thread drains the port into a lock-free queue so disk stalls do not back up the tty.
+// --bench needs no device: it checks the codec on a synthetic stream (exact round trip, raw
+// text in between, corrupted bytes), times it, and compares the wire capacity with BLE.
+// Usage:
+//   serial_capture <tty|file> [--baud n] [--out session.ises] [--log file] [--seconds s]
+//   serial_capture --bench [--frames n]
+#include "SerialStreamModule.h"
+#include "SessionFile.h"
+#include "SpscQueue.h"
+#include "TraceModule.h"
+#include "Config.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <memory>
+#include <random>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define CAPTURE_CHUNK_SIZE      4096
+#define CAPTURE_QUEUE_DEPTH     256     // 1 MB, ~10 s at 921600 baud
+
+// BLE link of selftest_sim's healthy case: one frame per notification
+#define BLE_MODEL_INTERVAL_US       15000
+#define BLE_MODEL_PACKETS_PER_EVENT 4
+#define BLE_MODEL_LINK_OVERHEAD     17      // preamble, access address, LL header, CRC, L2CAP, ATT
+#define BLE_MODEL_NOTIFY_CPU_US     40
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static std::atomic<bool> s_stop{false};
+
+static void onSignal(int)
+{
+    s_stop = true;
+}
+
+// ''''''' CAPTURE ''''''''''''''''''' //
+
+struct Chunk {
+    uint16_t len;
+    uint8_t  data[CAPTURE_CHUNK_SIZE];
+};
+
+struct Capture {
+    SessionWriter* session = nullptr;
+    FILE*    log = nullptr;
+    bool     failed = false;
+    uint64_t frames = 0;
+    uint64_t logs = 0;
+    uint64_t lost = 0;          // seq gaps, any packet type
+    uint64_t badLength = 0;     // frames of another insole variant
+    bool     haveSeq = false;
+    uint8_t  lastSeq = 0;
+    bool     haveTime = false;
+    uint32_t lastUs = 0;
+    uint64_t elapsedUs = 0;     // since the first frame, unwrapped
+    int      helloFrameSize = -1;
+};
+
+static void onPacket(void* ctx, uint8_t type, uint8_t seq, const uint8_t* payload, size_t len)
+{
+    Capture* c = (Capture*)ctx;
+    if (c->haveSeq) {
+        c->lost += (uint8_t)(seq - c->lastSeq - 1);
+    }
+    c->haveSeq = true;
+    c->lastSeq = seq;
+
+    if (type == SERIAL_STREAM_TYPE_HELLO && len >= SERIAL_STREAM_HELLO_SIZE) {
+        if (payload[2] != c->helloFrameSize) {
+            c->helloFrameSize = payload[2];
+            printf("device: stream v%u, %u pressure channels, %u-byte frames, %u ms loop%s\n", payload[0],
+                   payload[1], payload[2], payload[3] | (payload[4] << 8),
+                   (payload[2] == sizeof(SensorData)) ? "" : " -- rebuild with the matching INSOLE_SENSOR_COUNT");
+        }
+    } else if (type == SERIAL_STREAM_TYPE_FRAME) {
+        if (len != SERIAL_STREAM_FRAME_SIZE) {
+            c->badLength++;
+            return;
+        }
+        uint32_t us = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) |
+                      ((uint32_t)payload[3] << 24);
+        // micros() wraps after 71 minutes; a step back means the device restarted
+        if (c->haveTime && (int32_t)(us - c->lastUs) > 0) {
+            c->elapsedUs += (uint32_t)(us - c->lastUs);
+        }
+        c->haveTime = true;
+        c->lastUs = us;
+        c->frames++;
+        if (c->session && !c->failed) {
+            SensorData f;
+            memcpy(&f, payload + 4, sizeof(f));
+            if (c->session->append((uint32_t)(c->elapsedUs / 1000), f) != SESSION_OK) {
+                fprintf(stderr, "session write failed\n");
+                c->failed = true;
+            }
+        }
+    } else if (type == SERIAL_STREAM_TYPE_LOG) {
+        c->logs++;
+        if (c->log) {
+            fwrite(payload, 1, len, c->log);
+            fputc('\n', c->log);
+        }
+    }
+}
+
+static speed_t baudConstant(uint32_t baud)
+{
+    switch (baud) {
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    default:      return 0;
+    }
+}
+
+// Raw mode; reads return after 100 ms without data so the reader can see a stop request
+static bool configureTty(int fd, uint32_t baud)
+{
+    struct termios tio;
+    speed_t speed = baudConstant(baud);
+    if (speed == 0) {
+        fprintf(stderr, "unsupported baud rate %u\n", baud);
+        return false;
+    }
+    if (tcgetattr(fd, &tio) != 0) {
+        perror("tcgetattr");
+        return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 1;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        perror("tcsetattr");
+        return false;
+    }
+    tcflush(fd, TCIFLUSH);
+    return true;
+}
+
+static int runCapture(const char* path, uint32_t baud, const char* outPath, const char* logPath, double seconds)
+{
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    bool tty = isatty(fd);
+    if (tty && !configureTty(fd, baud)) {
+        close(fd);
+        return 1;
+    }
+
+    SessionWriter session;
+    Capture cap;
+    if (outPath) {
+        if (session.open(outPath, { SESSION_DEFAULT_CHUNK_ROWS, false }) != SESSION_OK) {
+            fprintf(stderr, "cannot create %s\n", outPath);
+            close(fd);
+            return 1;
+        }
+        cap.session = &session;
+    }
+    cap.log = logPath ? fopen(logPath, "w") : stdout;
+    if (!cap.log) {
+        perror(logPath);
+        close(fd);
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+
+    // A file ends at EOF; a tty runs until Ctrl-C or --seconds
+    std::unique_ptr<SpscQueue<Chunk, CAPTURE_QUEUE_DEPTH>> queue(new SpscQueue<Chunk, CAPTURE_QUEUE_DEPTH>());
+    std::atomic<bool> readerDone{false};
+    std::atomic<uint64_t> bytesRead{0};
+    std::thread reader([&]() {
+        Chunk chunk;
+        while (!s_stop) {
+            ssize_t n = read(fd, chunk.data, sizeof(chunk.data));
+            if (n < 0 || (n == 0 && !tty)) {
+                break;
+            }
+            if (n == 0) {
+                continue;
+            }
+            chunk.len = (uint16_t)n;
+            bytesRead += (uint64_t)n;
+            while (!queue->tryPush(chunk) && !s_stop) {
+                std::this_thread::yield();
+            }
+        }
+        readerDone = true;
+    });
+
+    SerialStreamDecoder_t dec;
+    SerialStream_InitDecoder(&dec);
+    Clock::time_point t0 = Clock::now();
+    double lastReport = 0;
+    uint64_t lastFrames = 0, lastBytes = 0;
+    for (;;) {
+        const Chunk* chunk = queue->front();
+        if (chunk) {
+            SerialStream_Feed(&dec, chunk->data, chunk->len, onPacket, &cap);
+            queue->pop();
+            continue;
+        }
+        if (cap.failed) {
+            break;
+        }
+        if (readerDone) {
+            // The reader's last push happened before it set readerDone
+            if (queue->front()) {
+                continue;
+            }
+            break;
+        }
+        double t = secondsSince(t0);
+        if (seconds > 0 && t >= seconds) {
+            s_stop = true;
+        }
+        if (tty && t - lastReport >= 1.0) {
+            uint64_t bytes = bytesRead;
+            printf("%7.1f s  %6.0f frames/s  %7.1f kB/s  crc %u  framing %u  lost %llu\n", t,
+                   (cap.frames - lastFrames) / (t - lastReport), (bytes - lastBytes) / (t - lastReport) / 1000.0,
+                   dec.crcErrors, dec.framingErrors, (unsigned long long)cap.lost);
+            lastReport = t;
+            lastFrames = cap.frames;
+            lastBytes = bytes;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    s_stop = true;
+    reader.join();
+    close(fd);
+
+    double t = secondsSince(t0);
+    if (cap.log != stdout) {
+        fclose(cap.log);
+    }
+    if (cap.session) {
+        session.close();
+    }
+    printf("%llu frames, %llu log lines, %llu bytes in %.1f s; crc errors %u, framing errors %u, lost packets %llu\n",
+           (unsigned long long)cap.frames, (unsigned long long)cap.logs, (unsigned long long)bytesRead.load(), t,
+           dec.crcErrors, dec.framingErrors, (unsigned long long)cap.lost);
+    if (cap.badLength) {
+        printf("%llu frames had another variant's size and were skipped\n", (unsigned long long)cap.badLength);
+    }
+    if (cap.session) {
+        printf("%llu rows written to %s\n", (unsigned long long)session.rowCount(), outPath);
+    }
+    return cap.failed ? 1 : 0;
+}
+
+// ''''''' BENCH ''''''''''''''''''' //
+
+struct BenchRx {
+    const std::vector<SensorData>* sent;
+    uint64_t frames = 0;
+    uint64_t logs = 0;
+    uint64_t wrong = 0;         // delivered but not what was sent
+    uint32_t next = 0;          // expected frame index when lossless
+    bool     ordered = true;
+};
+
+static void onBenchPacket(void* ctx, uint8_t type, uint8_t seq, const uint8_t* payload, size_t len)
+{
+    BenchRx* rx = (BenchRx*)ctx;
+    (void)seq;
+    if (type == SERIAL_STREAM_TYPE_LOG) {
+        rx->logs++;
+        return;
+    }
+    if (type != SERIAL_STREAM_TYPE_FRAME) {
+        return;
+    }
+    // The sample time is the frame index
+    uint32_t i = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) |
+                 ((uint32_t)payload[3] << 24);
+    if (len != SERIAL_STREAM_FRAME_SIZE || i >= rx->sent->size() ||
+        memcmp(payload + 4, &(*rx->sent)[i], sizeof(SensorData)) != 0) {
+        rx->wrong++;
+        return;
+    }
+    rx->ordered = rx->ordered && i == rx->next;
+    rx->next = i + 1;
+    rx->frames++;
+}
+
+static BenchRx decodeAll(const std::vector<uint8_t>& wire, const std::vector<SensorData>& sent,
+                         SerialStreamDecoder_t* dec, size_t chunk)
+{
+    BenchRx rx;
+    rx.sent = &sent;
+    SerialStream_InitDecoder(dec);
+    for (size_t off = 0; off < wire.size(); off += chunk) {
+        SerialStream_Feed(dec, wire.data() + off, std::min(chunk, wire.size() - off), onBenchPacket, &rx);
+    }
+    return rx;
+}
+
+static int runBench(uint32_t frames)
+{
+    int failures = 0;
+    std::vector<SensorData> sent(frames);
+    for (uint32_t i = 0; i < frames; i++) {
+        Trace_Synthesize(TRACE_GAIT_WALK, i * DEFAULT_LOOP_INTERVAL_MS, &sent[i]);
+    }
+
+    // Encode cost per frame, as the sensor task pays it
+    uint8_t pkt[SERIAL_STREAM_MAX_WIRE_SIZE];
+    uint8_t payload[SERIAL_STREAM_FRAME_SIZE];
+    size_t frameWire = 0;
+    volatile size_t sink = 0;
+    Clock::time_point t0 = Clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        memcpy(payload, &i, 4);
+        memcpy(payload + 4, &sent[i], sizeof(SensorData));
+        frameWire = SerialStream_Encode(SERIAL_STREAM_TYPE_FRAME, (uint8_t)i, payload, sizeof(payload), pkt, sizeof(pkt));
+        sink = sink + pkt[frameWire / 2];
+    }
+    double encodeNs = secondsSince(t0) * 1e9 / frames;
+
+    // Stream as the firmware sends it: boot text, a hello and a log line every second
+    std::vector<uint8_t> wire;
+    const char* bootText = "ets Jun  8 2016 00:22:57\r\nrst:0x1 (POWERON_RESET),boot:0x13\r\n";
+    wire.insert(wire.end(), bootText, bootText + strlen(bootText));
+    uint8_t seq = 0;
+    const uint32_t perSecond = 1000 / DEFAULT_LOOP_INTERVAL_MS;
+    for (uint32_t i = 0; i < frames; i++) {
+        if (i % perSecond == 0) {
+            uint8_t hello[SERIAL_STREAM_HELLO_SIZE];
+            SerialStream_MakeHello(hello);
+            size_t n = SerialStream_Encode(SERIAL_STREAM_TYPE_HELLO, seq++, hello, sizeof(hello), pkt, sizeof(pkt));
+            wire.insert(wire.end(), pkt, pkt + n);
+            char line[LOGGER_MAX_LOG_LENGTH];
+            int len = snprintf(line, sizeof(line), "[INFO] frame %u, heap 182044, all zero bytes \\0 are escaped", i);
+            n = SerialStream_Encode(SERIAL_STREAM_TYPE_LOG, seq++, (const uint8_t*)line, (size_t)len, pkt, sizeof(pkt));
+            wire.insert(wire.end(), pkt, pkt + n);
+        }
+        memcpy(payload, &i, 4);
+        memcpy(payload + 4, &sent[i], sizeof(SensorData));
+        size_t n = SerialStream_Encode(SERIAL_STREAM_TYPE_FRAME, seq++, payload, sizeof(payload), pkt, sizeof(pkt));
+        wire.insert(wire.end(), pkt, pkt + n);
+    }
+
+    // Exact round trip, fed in UART-sized pieces; the boot text costs at most one framing error
+    SerialStreamDecoder_t dec;
+    t0 = Clock::now();
+    BenchRx rx = decodeAll(wire, sent, &dec, 64);
+    double decodeNs = secondsSince(t0) * 1e9 / frames;
+    bool ok = rx.frames == frames && rx.wrong == 0 && rx.ordered && rx.logs == (frames + perSecond - 1) / perSecond &&
+              dec.crcErrors + dec.framingErrors <= 1;
+    printf("round trip: %llu/%u frames, %llu log lines, %u crc + %u framing errors  %s\n",
+           (unsigned long long)rx.frames, frames, (unsigned long long)rx.logs, dec.crcErrors, dec.framingErrors,
+           ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+
+    // One corrupted byte per ~4 kB: each may cost two packets, none may deliver a wrong frame
+    std::vector<uint8_t> noisy = wire;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> pos(0, noisy.size() - 1);
+    size_t flips = noisy.size() / 4096;
+    for (size_t k = 0; k < flips; k++) {
+        noisy[pos(rng)] ^= (uint8_t)(1 + rng() % 255);
+    }
+    rx = decodeAll(noisy, sent, &dec, 64);
+    ok = rx.wrong == 0 && rx.frames + 2 * flips >= frames;
+    printf("corrupted:  %llu/%u frames after %zu flipped bytes, %u crc + %u framing errors, %llu wrong  %s\n",
+           (unsigned long long)rx.frames, frames, flips, dec.crcErrors, dec.framingErrors,
+           (unsigned long long)rx.wrong, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+
+    printf("\nencode %.0f ns/frame, decode %.0f ns/frame (host)\n\n", encodeNs, decodeNs);
+    printf("%-26s %12s %14s %16s\n", "transport", "bytes/frame", "max frames/s", "sender CPU/frame");
+    const uint32_t bauds[] = { 921600, 2000000, 3000000 };
+    for (uint32_t baud : bauds) {
+        char name[32];
+        snprintf(name, sizeof(name), "serial %u 8N1", baud);
+        printf("%-26s %12zu %14.0f %13.2f us\n", name, frameWire, baud / 10.0 / frameWire, encodeNs / 1000.0);
+    }
+    size_t bleAir = sizeof(SensorData) + BLE_MODEL_LINK_OVERHEAD;
+    printf("%-26s %12zu %14.0f %13u us\n", "BLE model, 1 frame/notify", bleAir,
+           1e6 / BLE_MODEL_INTERVAL_US * BLE_MODEL_PACKETS_PER_EVENT, BLE_MODEL_NOTIFY_CPU_US);
+    printf("(BLE: %u packets per %u us connection event, notify cost as in selftest_sim)\n",
+           BLE_MODEL_PACKETS_PER_EVENT, BLE_MODEL_INTERVAL_US);
+    printf("stream at %u frames/s uses %.1f%% of 921600 baud\n", perSecond,
+           100.0 * perSecond * frameWire / (921600 / 10.0));
+
+    printf("%s\n", failures ? "serial stream bench FAILED" : "serial stream bench passed");
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    const char* outPath = nullptr;
+    const char* logPath = nullptr;
+    uint32_t baud = SERIAL_STREAM_BAUD;
+    uint32_t frames = 200000;
+    double seconds = 0;
+    bool bench = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--bench")) bench = true;
+        else if (!strcmp(argv[i], "--baud") && i + 1 < argc) baud = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc) outPath = argv[++i];
+        else if (!strcmp(argv[i], "--log") && i + 1 < argc) logPath = argv[++i];
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = (uint32_t)atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !path) path = argv[i];
+        else {
+            fprintf(stderr, "usage: serial_capture <tty|file> [--baud n] [--out f.ises] [--log file] [--seconds s]\n"
+                            "       serial_capture --bench [--frames n]\n");
+            return 2;
+        }
+    }
+    if (bench) {
+        return runBench(frames ? frames : 1);
+    }
+    if (!path) {
+        fprintf(stderr, "no input; pass a tty, a recorded file or --bench\n");
+        return 2;
+    }
+    return runCapture(path, baud, outPath, logPath, seconds);
+}
@@ -0,0 +1,224 @@
+// Corrupt-file check for host/src/SessionFile.cpp: writes a small session with raw and
+// with delta-encoded blocks, then opens copies that are truncated at every length, carry a
+// bad magic or version, have two timestamps out of order inside a chunk, or an index
+// min/max that does not match the chunk's timestamps. Every corrupt copy must fail to open
+// with SESSION_ERR_FORMAT, since readRange binary-searches the timestamps it accepts; the
+// intact files must open and read back every row (build with -fsanitize=address to have
+// stray reads of the mapping reported).
+// Exits non-zero on failure.
+// Usage: session_check
+#include "SessionFile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#define CHUNK_ROWS  16
+#define ROWS        (3 * CHUNK_ROWS + 8)
+#define PERIOD_MS   20
+#define BAD_CHUNK   1       // chunk whose timestamps get corrupted
+#define BAD_ROW     5       // row inside BAD_CHUNK, swapped with the next one
+
+static int s_failures = 0;
+static char s_path[] = "/tmp/session_check_XXXXXX";
+
+static void expect(bool ok, const char* encoding, const char* what, size_t arg)
+{
+    if (!ok && s_failures++ < 20) {
+        printf("  FAIL %s: %s (%zu)\n", encoding, what, arg);
+    }
+}
+
+static uint32_t timestampOf(size_t r)
+{
+    // Row 9 repeats row 8: equal timestamps are allowed
+    return (uint32_t)(100000 + PERIOD_MS * (r - (r > 8)));
+}
+
+static bool writeSession(bool delta, std::vector<uint8_t>& bytes)
+{
+    SessionWriter w;
+    SessionWriterOptions opt = { CHUNK_ROWS, delta };
+    if (w.open(s_path, opt) != SESSION_OK) {
+        return false;
+    }
+    for (size_t r = 0; r < ROWS; r++) {
+        SensorData d;
+        memset(&d, 0, sizeof(d));
+        d.battery = (uint8_t)(90 - r / 16);
+        d.accel_x = (int16_t)(r * 7);
+        d.accel_y = (int16_t)(-(int)r);
+        d.accel_z = 1000;
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            d.pressure[ch] = (uint16_t)(ch * 100 + r);
+        }
+        if (w.append(timestampOf(r), d) != SESSION_OK) {
+            return false;
+        }
+    }
+    if (w.close() != SESSION_OK) {
+        return false;
+    }
+    FILE* f = fopen(s_path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    bytes.resize((size_t)ftell(f));
+    fseek(f, 0, SEEK_SET);
+    bool ok = fread(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    fclose(f);
+    return ok;
+}
+
+// Writes `len` bytes of `bytes` to the scratch file and opens it
+static SessionStatus_t openCopy(const std::vector<uint8_t>& bytes, size_t len, SessionReader& reader)
+{
+    FILE* f = fopen(s_path, "wb");
+    if (!f) {
+        return SESSION_ERR_IO;
+    }
+    bool ok = fwrite(bytes.data(), 1, len, f) == len;
+    if (fclose(f) != 0 || !ok) {
+        return SESSION_ERR_IO;
+    }
+    return reader.open(s_path);
+}
+
+static void expectRejected(const std::vector<uint8_t>& bytes, const char* encoding, const char* what, size_t arg)
+{
+    SessionReader reader;
+    SessionStatus_t st = openCopy(bytes, bytes.size(), reader);
+    expect(st == SESSION_ERR_FORMAT && reader.rowCount() == 0, encoding, what, arg);
+}
+
+static SessionChunkIndex* indexOf(std::vector<uint8_t>& bytes, size_t chunk)
+{
+    const SessionFileHeader* h = (const SessionFileHeader*)bytes.data();
+    return (SessionChunkIndex*)(bytes.data() + h->indexOffset) + chunk;
+}
+
+// Offset of the varint of row `row` inside a delta block
+static size_t varintAt(const uint8_t* block, size_t row)
+{
+    size_t p = 0;
+    for (size_t r = 0; r < row; r++) {
+        while (block[p++] & 0x80) {}
+    }
+    return p;
+}
+
+static void checkIntact(const std::vector<uint8_t>& bytes, const char* encoding)
+{
+    SessionReader reader;
+    SessionStatus_t st = openCopy(bytes, bytes.size(), reader);
+    expect(st == SESSION_OK, encoding, "intact file rejected", (size_t)st);
+    if (st != SESSION_OK) {
+        return;
+    }
+    expect(reader.rowCount() == ROWS && reader.chunkCount() == (ROWS + CHUNK_ROWS - 1) / CHUNK_ROWS,
+           encoding, "row or chunk count", (size_t)reader.rowCount());
+
+    std::vector<uint32_t> ts(ROWS);
+    std::vector<uint8_t> battery(ROWS);
+    std::vector<int16_t> accel[3];
+    std::vector<uint16_t> pressure[PRESSURE_CHANNEL_COUNT];
+    for (auto& a : accel) a.resize(ROWS);
+    for (auto& p : pressure) p.resize(ROWS);
+    FrameColumns out = {};
+    out.capacity = ROWS;
+    out.timestamp = ts.data();
+    out.battery = battery.data();
+    out.accel_x = accel[0].data();
+    out.accel_y = accel[1].data();
+    out.accel_z = accel[2].data();
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        out.pressure[ch] = pressure[ch].data();
+    }
+
+    SessionResult res = reader.readRange(0, UINT32_MAX, out);
+    expect(res.status == SESSION_OK && res.rows == ROWS, encoding, "full range rows", res.rows);
+    for (size_t r = 0; r < res.rows; r++) {
+        expect(ts[r] == timestampOf(r) && pressure[PRESSURE_CHANNEL_COUNT - 1][r] ==
+               (uint16_t)((PRESSURE_CHANNEL_COUNT - 1) * 100 + r), encoding, "full range row", r);
+    }
+
+    // A range across the repeated timestamp and a chunk boundary
+    res = reader.readRange(timestampOf(8), timestampOf(CHUNK_ROWS + 2), out);
+    expect(res.status == SESSION_OK && res.rows == CHUNK_ROWS + 2 - 8 + 1 && ts[0] == timestampOf(8),
+           encoding, "sub-range rows", res.rows);
+}
+
+static void checkCorrupt(const std::vector<uint8_t>& intact, bool delta, const char* encoding)
+{
+    std::vector<uint8_t> bytes;
+
+    // Every truncation loses the index at the end of the file
+    for (size_t len = 0; len < intact.size(); len++) {
+        SessionReader reader;
+        SessionStatus_t st = openCopy(intact, len, reader);
+        expect(st == SESSION_ERR_FORMAT, encoding, "truncated file opened", len);
+    }
+    bytes = intact;
+    ((SessionFileHeader*)bytes.data())->magic ^= 1;
+    expectRejected(bytes, encoding, "bad magic", 0);
+    bytes = intact;
+    ((SessionFileHeader*)bytes.data())->version++;
+    expectRejected(bytes, encoding, "bad version", 0);
+
+    // Two timestamps out of order inside a chunk; first, last and index min/max unchanged
+    bytes = intact;
+    const SessionColumnIndex& col = indexOf(bytes, BAD_CHUNK)->column[SESSION_COL_TIMESTAMP];
+    expect(col.encoding == (delta ? SESSION_ENC_DELTA_VARINT : SESSION_ENC_RAW), encoding, "timestamp encoding",
+           col.encoding);
+    uint8_t* block = bytes.data() + col.offset;
+    if (delta) {
+        // Deltas +20, +20 become -20, +60 (zigzag 39 and 120, still one byte each)
+        size_t p = varintAt(block, BAD_ROW);
+        expect(block[p] == 2 * PERIOD_MS && block[p + 1] == 2 * PERIOD_MS, encoding, "delta block layout", p);
+        block[p] = 2 * PERIOD_MS - 1;
+        block[p + 1] = 6 * PERIOD_MS;
+    } else {
+        uint32_t* t = (uint32_t*)block;
+        uint32_t tmp = t[BAD_ROW];
+        t[BAD_ROW] = t[BAD_ROW + 1];
+        t[BAD_ROW + 1] = tmp;
+    }
+    expectRejected(bytes, encoding, "timestamps out of order", BAD_ROW);
+
+    // Index min/max that do not match the chunk's timestamps
+    bytes = intact;
+    indexOf(bytes, BAD_CHUNK)->column[SESSION_COL_TIMESTAMP].min--;
+    expectRejected(bytes, encoding, "index min below the first timestamp", BAD_CHUNK);
+    bytes = intact;
+    indexOf(bytes, BAD_CHUNK)->column[SESSION_COL_TIMESTAMP].max++;
+    expectRejected(bytes, encoding, "index max above the last timestamp", BAD_CHUNK);
+}
+
+int main()
+{
+    int fd = mkstemp(s_path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    const char* names[2] = { "raw", "delta" };
+    for (int i = 0; i < 2; i++) {
+        std::vector<uint8_t> intact;
+        if (!writeSession(i == 1, intact)) {
+            printf("  FAIL %s: cannot write %s\n", names[i], s_path);
+            s_failures++;
+            continue;
+        }
+        checkIntact(intact, names[i]);
+        checkCorrupt(intact, i == 1, names[i]);
+        printf("%-6s %d rows, %zu bytes, every truncation and 5 corruptions\n", names[i], ROWS, intact.size());
+    }
+    remove(s_path);
+
+    printf("session check %s\n", s_failures ? "FAILED" : "passed");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,380 @@
+// Session file conversion, inspection and CSV comparison benchmark.
+// Usage:
+//   session_tool convert <in.csv|in.trc> <out.ises> [--delta] [--chunk rows]
+//   session_tool export <in.ises> <out.csv> [t0_ms t1_ms]
+//   session_tool info <in.ises>
+//   session_tool bench [minutes] [period_ms]     one foot; a two-foot session is twice the work
+//
+// CSV layout: timestamp_ms,battery,accel_x,accel_y,accel_z,p0,...,p15 with a header line.
+#include "SessionFile.h"
+#include "TraceModule.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Owned storage behind a FrameColumns
+struct ColumnStore {
+    std::vector<uint32_t> timestamp;
+    std::vector<uint8_t>  battery;
+    std::vector<int16_t>  ax, ay, az;
+    std::vector<uint16_t> pressure[PRESSURE_CHANNEL_COUNT];
+
+    FrameColumns resize(size_t rows)
+    {
+        timestamp.resize(rows);
+        battery.resize(rows);
+        ax.resize(rows);
+        ay.resize(rows);
+        az.resize(rows);
+        FrameColumns cols = { rows, timestamp.data(), battery.data(), ax.data(), ay.data(), az.data(), {}, nullptr, nullptr };
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            pressure[ch].resize(rows);
+            cols.pressure[ch] = pressure[ch].data();
+        }
+        return cols;
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& out)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(size > 0 ? (size_t)size : 0);
+    bool ok = fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+static long fileSize(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static void csvHeader(FILE* f)
+{
+    fprintf(f, "timestamp_ms,battery,accel_x,accel_y,accel_z");
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        fprintf(f, ",p%d", ch);
+    }
+    fprintf(f, "\n");
+}
+
+static void csvRow(FILE* f, const FrameColumns& c, size_t r)
+{
+    fprintf(f, "%u,%u,%d,%d,%d", c.timestamp[r], c.battery[r], c.accel_x[r], c.accel_y[r], c.accel_z[r]);
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        fprintf(f, ",%u", c.pressure[ch][r]);
+    }
+    fprintf(f, "\n");
+}
+
+// Parses a whole CSV into columns; returns rows or -1
+static long loadCsv(const char* path, ColumnStore& store)
+{
+    std::vector<uint8_t> text;
+    if (!readFile(path, text)) {
+        return -1;
+    }
+    text.push_back('\0');
+    const char* p = (const char*)text.data();
+    p = strchr(p, '\n');        // skip header
+    if (!p) {
+        return 0;
+    }
+    size_t rows = 0;
+    for (const char* q = p + 1; *q; q++) {
+        rows += (*q == '\n');
+    }
+    FrameColumns cols = store.resize(rows);
+
+    size_t r = 0;
+    char* next = (char*)p + 1;
+    while (r < rows && *next) {
+        long v[5 + PRESSURE_CHANNEL_COUNT];
+        for (int i = 0; i < 5 + PRESSURE_CHANNEL_COUNT; i++) {
+            v[i] = strtol(next, &next, 10);
+            if (*next == ',') {
+                next++;
+            }
+        }
+        if (*next == '\r') {
+            next++;
+        }
+        if (*next == '\n') {
+            next++;
+        }
+        cols.timestamp[r] = (uint32_t)v[0];
+        cols.battery[r] = (uint8_t)v[1];
+        cols.accel_x[r] = (int16_t)v[2];
+        cols.accel_y[r] = (int16_t)v[3];
+        cols.accel_z[r] = (int16_t)v[4];
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            cols.pressure[ch][r] = (uint16_t)v[5 + ch];
+        }
+        r++;
+    }
+    store.resize(r);
+    return (long)r;
+}
+
+static int cmdConvert(int argc, char** argv)
+{
+    if (argc < 4) return 1;
+    SessionWriterOptions opt = { SESSION_DEFAULT_CHUNK_ROWS, false };
+    for (int i = 4; i < argc; i++) {
+        if (!strcmp(argv[i], "--delta")) opt.deltaEncode = true;
+        else if (!strcmp(argv[i], "--chunk") && i + 1 < argc) opt.chunkRows = (uint32_t)atoi(argv[++i]);
+    }
+
+    SessionWriter writer;
+    SessionStatus_t st = writer.open(argv[3], opt);
+    if (st != SESSION_OK) {
+        fprintf(stderr, "%s: %s\n", argv[3], Session_StatusString(st));
+        return 1;
+    }
+
+    std::vector<uint8_t> img;
+    const TraceHeader* trace = nullptr;
+    if (readFile(argv[2], img) && (trace = Trace_Validate(img.data(), img.size())) != nullptr) {
+        for (uint32_t i = 0; i < trace->record_count && st == SESSION_OK; i++) {
+            SensorData frame;
+            Trace_GetRecord(img.data(), i, &frame);
+            st = writer.append(i * trace->period_ms, frame);
+        }
+    } else {
+        ColumnStore store;
+        long rows = loadCsv(argv[2], store);
+        if (rows < 0) {
+            fprintf(stderr, "cannot read %s\n", argv[2]);
+            return 1;
+        }
+        st = writer.append(store.resize((size_t)rows), (size_t)rows);
+    }
+    if (st == SESSION_OK) {
+        st = writer.close();
+    }
+    if (st != SESSION_OK) {
+        fprintf(stderr, "%s: %s\n", argv[3], Session_StatusString(st));
+        return 1;
+    }
+    printf("%llu rows, %ld bytes\n", (unsigned long long)writer.rowCount(), fileSize(argv[3]));
+    return 0;
+}
+
+static int cmdExport(int argc, char** argv)
+{
+    if (argc < 4) return 1;
+    SessionReader reader;
+    SessionStatus_t st = reader.open(argv[2]);
+    if (st != SESSION_OK) {
+        fprintf(stderr, "%s: %s\n", argv[2], Session_StatusString(st));
+        return 1;
+    }
+    uint32_t t0 = (argc > 5) ? (uint32_t)strtoul(argv[4], nullptr, 10) : 0;
+    uint32_t t1 = (argc > 5) ? (uint32_t)strtoul(argv[5], nullptr, 10) : UINT32_MAX;
+
+    ColumnStore store;
+    FrameColumns cols = store.resize((size_t)reader.rowCount());
+    SessionResult res = reader.readRange(t0, t1, cols);
+    if (res.status != SESSION_OK) {
+        fprintf(stderr, "%s: %s\n", argv[2], Session_StatusString(res.status));
+        return 1;
+    }
+    FILE* f = fopen(argv[3], "w");
+    if (!f) return 1;
+    csvHeader(f);
+    for (size_t r = 0; r < res.rows; r++) {
+        csvRow(f, cols, r);
+    }
+    fclose(f);
+    printf("%zu rows\n", res.rows);
+    return 0;
+}
+
+static int cmdInfo(int argc, char** argv)
+{
+    if (argc < 3) return 1;
+    SessionReader reader;
+    SessionStatus_t st = reader.open(argv[2]);
+    if (st != SESSION_OK) {
+        fprintf(stderr, "%s: %s\n", argv[2], Session_StatusString(st));
+        return 1;
+    }
+    printf("%llu rows in %zu chunks\n", (unsigned long long)reader.rowCount(), reader.chunkCount());
+    for (size_t i = 0; i < reader.chunkCount(); i++) {
+        const SessionChunkIndex& c = reader.chunk(i);
+        uint64_t bytes = 0;
+        int delta = 0;
+        for (int col = 0; col < SESSION_COLUMN_COUNT; col++) {
+            bytes += c.column[col].bytes;
+            delta += (c.column[col].encoding == SESSION_ENC_DELTA_VARINT);
+        }
+        printf("  chunk %4zu: rows %6u, t %lld..%lld ms, %llu bytes, %d/%d delta columns\n", i, c.rows,
+               (long long)c.column[SESSION_COL_TIMESTAMP].min, (long long)c.column[SESSION_COL_TIMESTAMP].max,
+               (unsigned long long)bytes, delta, SESSION_COLUMN_COUNT);
+    }
+    return 0;
+}
+
+// Sum of one pressure channel over the file, zero-copy where the block is raw
+static uint64_t scanChannel(const SessionReader& reader, int ch, std::vector<uint16_t>& scratch)
+{
+    uint64_t sum = 0;
+    int col = SESSION_COL_PRESSURE0 + ch;
+    for (size_t i = 0; i < reader.chunkCount(); i++) {
+        uint32_t rows = reader.chunk(i).rows;
+        const uint16_t* v = (const uint16_t*)reader.columnData(i, col);
+        if (!v) {
+            scratch.resize(rows);
+            reader.readColumn(i, col, scratch.data());
+            v = scratch.data();
+        }
+        for (uint32_t r = 0; r < rows; r++) {
+            sum += v[r];
+        }
+    }
+    return sum;
+}
+
+static int cmdBench(int argc, char** argv)
+{
+    double minutes = (argc > 2) ? atof(argv[2]) : 60.0;
+    uint16_t period = (argc > 3) ? (uint16_t)atoi(argv[3]) : 20;
+    size_t rows = period ? (size_t)(minutes * 60000.0 / period) : 0;
+    if (rows == 0) return 1;
+
+    const char* csvPath = "/tmp/session_bench.csv";
+    const char* rawPath = "/tmp/session_bench_raw.ises";
+    const char* deltaPath = "/tmp/session_bench_delta.ises";
+
+    // Synthetic walk with a little sensor noise, so deltas are not unrealistically small
+    ColumnStore src;
+    FrameColumns cols = src.resize(rows);
+    srand(1);
+    for (size_t r = 0; r < rows; r++) {
+        SensorData d;
+        Trace_Synthesize(TRACE_GAIT_WALK, (uint32_t)(r * period), &d);
+        cols.timestamp[r] = (uint32_t)(r * period);
+        cols.battery[r] = d.battery;
+        cols.accel_x[r] = (int16_t)(d.accel_x + rand() % 3 - 1);
+        cols.accel_y[r] = (int16_t)(d.accel_y + rand() % 3 - 1);
+        cols.accel_z[r] = (int16_t)(d.accel_z + rand() % 3 - 1);
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            cols.pressure[ch][r] = (uint16_t)(d.pressure[ch] + rand() % 8);
+        }
+    }
+
+    FILE* f = fopen(csvPath, "w");
+    if (!f) return 1;
+    csvHeader(f);
+    for (size_t r = 0; r < rows; r++) {
+        csvRow(f, cols, r);
+    }
+    fclose(f);
+    const char* paths[2] = { rawPath, deltaPath };
+    for (int i = 0; i < 2; i++) {
+        SessionWriter w;
+        SessionWriterOptions opt = { SESSION_DEFAULT_CHUNK_ROWS, i == 1 };
+        if (w.open(paths[i], opt) != SESSION_OK || w.append(cols, rows) != SESSION_OK || w.close() != SESSION_OK) {
+            fprintf(stderr, "cannot write %s\n", paths[i]);
+            return 1;
+        }
+    }
+
+    printf("%zu rows (%.1f min at %u ms)\n\n", rows, minutes, period);
+    printf("%-14s %12s %12s %14s %14s\n", "format", "bytes", "load ms", "scan Mrows/s", "10s range ms");
+
+    // CSV: every query parses the whole file
+    ColumnStore csv;
+    auto start = std::chrono::steady_clock::now();
+    long csvRows = loadCsv(csvPath, csv);
+    double csvLoad = secondsSince(start);
+    if (csvRows != (long)rows) {
+        fprintf(stderr, "csv round trip lost rows\n");
+        return 1;
+    }
+    printf("%-14s %12ld %12.1f %14s %14.1f\n", "csv", fileSize(csvPath), csvLoad * 1e3, "-", csvLoad * 1e3);
+
+    const char* names[2] = { "session raw", "session delta" };
+    for (int i = 0; i < 2; i++) {
+        ColumnStore out;
+        FrameColumns oc = out.resize(rows);
+        SessionReader reader;
+
+        // Load: open (mmap + index check) and materialize every column
+        start = std::chrono::steady_clock::now();
+        if (reader.open(paths[i]) != SESSION_OK) return 1;
+        SessionResult res = reader.readRange(0, UINT32_MAX, oc);
+        double load = secondsSince(start);
+        if (res.status != SESSION_OK || res.rows != rows ||
+            memcmp(out.pressure[5].data(), src.pressure[5].data(), rows * 2) != 0 ||
+            memcmp(out.timestamp.data(), src.timestamp.data(), rows * 4) != 0) {
+            fprintf(stderr, "%s round trip mismatch\n", names[i]);
+            return 1;
+        }
+
+        // Scan: one pressure channel over the whole session
+        std::vector<uint16_t> scratch;
+        uint64_t sum = 0;
+        size_t scanned = 0;
+        start = std::chrono::steady_clock::now();
+        do {
+            sum += scanChannel(reader, (int)(scanned / rows) % PRESSURE_CHANNEL_COUNT, scratch);
+            scanned += rows;
+        } while (secondsSince(start) < 0.5);
+        double scanRate = scanned / secondsSince(start);
+
+        // Range: 10 s in the middle of the session, only the overlapping chunks are touched
+        uint32_t t0 = (uint32_t)(rows / 2 * period);
+        int reps = 0;
+        start = std::chrono::steady_clock::now();
+        do {
+            reader.readRange(t0, t0 + 10000, oc);
+            reps++;
+        } while (secondsSince(start) < 0.2);
+        double range = secondsSince(start) / reps;
+
+        printf("%-14s %12ld %12.1f %14.1f %14.3f\n", names[i], fileSize(paths[i]), load * 1e3, scanRate / 1e6,
+               range * 1e3);
+        if (sum == 1) printf(" ");   // keep the scan alive
+    }
+    remove(csvPath);
+    remove(rawPath);
+    remove(deltaPath);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int ret = 1;
+    if (argc > 1 && !strcmp(argv[1], "convert")) ret = cmdConvert(argc, argv);
+    else if (argc > 1 && !strcmp(argv[1], "export")) ret = cmdExport(argc, argv);
+    else if (argc > 1 && !strcmp(argv[1], "info")) ret = cmdInfo(argc, argv);
+    else if (argc > 1 && !strcmp(argv[1], "bench")) ret = cmdBench(argc, argv);
+    if (ret) {
+        fprintf(stderr, "usage: session_tool convert <in.csv|in.trc> <out.ises> [--delta] [--chunk rows]\n"
+                        "       session_tool export <in.ises> <out.csv> [t0_ms t1_ms]\n"
+                        "       session_tool info <in.ises>\n"
+                        "       session_tool bench [minutes] [period_ms]\n");
+    }
+    return ret;
+}
@@ -0,0 +1,242 @@
+// Session statistics check: runs synthetic stand/walk/run sessions through Stats_Update()
+// and compares every channel with exact statistics computed in double precision over the
+// samples it should count: mean and standard deviation, min/max, nearest-rank p50/p90/p99
+// within the sketch's 6.25% bound, and time above threshold with pauses capped like the
+// firmware does. Some pressure channels are only converted every few frames and hold 0 in
+// between, and one ADS1115 goes down for a stretch with its slots still marked valid; neither
+// may count. Also decodes the read pages and checks them against Stats_GetChannel().
+// Exits non-zero on failure.
+// Usage: stats_check [minutes]   (session length per gait, default 240)
+#include "StatsModule.h"
+#include "TraceModule.h"
+#include "Config.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define FRAME_US            20000
+#define PAUSE_EVERY         30000   // frames between pauses (no subscriber, no frames)
+#define PAUSE_US            5000000
+#define DOWN_ADC            (ActiveTopology::AdcCount - 1)  // drops out for a stretch of each session
+
+static const struct { const char* name; TraceGait_t gait; } GAITS[] = {
+    { "stand", TRACE_GAIT_STAND },
+    { "walk",  TRACE_GAIT_WALK },
+    { "run",   TRACE_GAIT_RUN },
+};
+
+typedef struct {
+    std::vector<int32_t> values;
+    double aboveUs;
+    uint32_t lastUs;
+} Exact;
+
+// Cold channels: slot ch is converted every (1 + ch % 4)-th frame
+static bool converted(int ch, uint32_t frame)
+{
+    return (frame + ch) % (1 + ch % 4) == 0;
+}
+
+static int32_t channelValue(const SensorData& f, int ch)
+{
+    if (ch < PRESSURE_CHANNEL_COUNT) return f.pressure[ch];
+    if (ch == STATS_CH_ACC_X) return f.accel_x;
+    if (ch == STATS_CH_ACC_Y) return f.accel_y;
+    if (ch == STATS_CH_ACC_Z) return f.accel_z;
+    float mag = sqrtf((float)f.accel_x * f.accel_x + (float)f.accel_y * f.accel_y + (float)f.accel_z * f.accel_z);
+    return (int32_t)(mag + 0.5f);
+}
+
+static int32_t nearestRank(const std::vector<int32_t>& sorted, uint16_t permille)
+{
+    size_t rank = (size_t)(((uint64_t)sorted.size() * permille + 999) / 1000);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static float getFloat(const uint8_t* p)
+{
+    uint32_t bits = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint32_t getLe(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static bool checkPages(const char* gait)
+{
+    bool ok = true;
+    StatsSummary_t s;
+    Stats_GetSummary(&s);
+    for (uint8_t page = 0; page < STATS_PAGES; page++) {
+        uint8_t buf[STATS_PAGE_SIZE];
+        size_t n = Stats_EncodePage(page, buf, sizeof(buf));
+        uint8_t first = (uint8_t)(page * STATS_PAGE_CHANNELS);
+        size_t count = (n > STATS_PAGE_HEADER_SIZE) ? (n - STATS_PAGE_HEADER_SIZE) / STATS_WIRE_CHANNEL_SIZE : 0;
+        if (n == 0 || getLe(buf, 4) != s.frames || getLe(buf + 4, 4) != s.durationMs || buf[8] != page ||
+            buf[9] != STATS_PAGES || (first + count != STATS_CHANNELS && count != STATS_PAGE_CHANNELS)) {
+            printf("  FAIL: %s: page %u header\n", gait, page);
+            ok = false;
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* p = buf + STATS_PAGE_HEADER_SIZE + i * STATS_WIRE_CHANNEL_SIZE;
+            StatsChannel_t c;
+            Stats_GetChannel((uint8_t)(first + i), &c);
+            bool axis = first + i >= STATS_CH_ACC_X && first + i <= STATS_CH_ACC_Z;
+            int32_t mn = axis ? (int16_t)getLe(p + 8, 2) : (int32_t)getLe(p + 8, 2);
+            int32_t mx = axis ? (int16_t)getLe(p + 10, 2) : (int32_t)getLe(p + 10, 2);
+            if (getFloat(p) != c.mean || getFloat(p + 4) != c.stddev || mn != c.min || mx != c.max ||
+                getLe(p + 12, 2) != c.p50 || getLe(p + 14, 2) != c.p90 || getLe(p + 16, 2) != c.p99 ||
+                getLe(p + 18, 4) != c.aboveMs) {
+                printf("  FAIL: %s: channel %zu differs on the wire\n", gait, first + i);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t minutes = (argc > 1) ? (uint32_t)atoi(argv[1]) : 240;
+    uint32_t frames = (uint32_t)((uint64_t)minutes * 60u * 1000000u / FRAME_US);
+    int failures = 0;
+    printf("%u frames per session, %d channels, %zu B of state\n\n", frames, STATS_CHANNELS,
+           (size_t)STATS_SKETCHES * STATS_BUCKETS * 4 + (size_t)STATS_CHANNELS * 40 + STATS_SKETCHES * 12);
+    printf("%-6s %12s %12s %9s %9s %9s %9s  %s\n", "gait", "mean err", "stddev err", "p50 err", "p90 err",
+           "p99 err", "above err", "checks");
+
+    for (const auto& g : GAITS) {
+        Stats_SetThresholds(STATS_PRESSURE_THRESHOLD, STATS_ACCEL_THRESHOLD);
+        std::vector<Exact> exact(STATS_CHANNELS);
+        for (Exact& e : exact) {
+            e.values.reserve(frames);
+            e.aboveUs = 0;
+        }
+        // Starts just before the micros() wrap
+        uint32_t t = 0xFFFFFFFFu - 60000000u;
+        for (uint32_t i = 0; i < frames; i++) {
+            if (i && i % PAUSE_EVERY == 0) {
+                t += PAUSE_US;
+            }
+            SensorData f;
+            Trace_Synthesize(g.gait, (uint32_t)((uint64_t)i * FRAME_US / 1000), &f);
+            SensorFrameInfo info = {};
+            info.adc_healthy = (uint8_t)((1u << ActiveTopology::AdcCount) - 1);
+            for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+                if (converted(ch, i)) {
+                    info.pressure_valid |= (PressureMask_t)((PressureMask_t)1 << ch);
+                } else {
+                    f.pressure[ch] = 0;
+                }
+            }
+            bool down = i >= frames / 3 && i < frames / 3 + frames / 10;
+            if (down) {
+                info.adc_healthy &= (uint8_t)~(1u << DOWN_ADC);
+                for (unsigned input = 0; input < ActiveTopology::ChannelsPerAdc; input++) {
+                    f.pressure[ActiveTopology::sensorOf(DOWN_ADC, input)] = PRESSURE_VALUE_DOWN;
+                }
+            }
+            Stats_Update(&f, &info, t);
+            for (int ch = 0; ch < STATS_CHANNELS; ch++) {
+                Exact& e = exact[ch];
+                if (ch < PRESSURE_CHANNEL_COUNT && (!converted(ch, i) || f.pressure[ch] == PRESSURE_VALUE_DOWN)) {
+                    continue;
+                }
+                int32_t v = channelValue(f, ch);
+                uint32_t dt = e.values.empty() ? 0 : std::min<uint32_t>(t - e.lastUs, (uint32_t)STATS_MAX_GAP_MS * 1000u);
+                e.values.push_back(v);
+                e.lastUs = t;
+                uint16_t thr = (ch < PRESSURE_CHANNEL_COUNT) ? STATS_PRESSURE_THRESHOLD : STATS_ACCEL_THRESHOLD;
+                if (v >= thr) {
+                    e.aboveUs += dt;
+                }
+            }
+            t += FRAME_US;
+        }
+
+        // Worst error over the channels: moments relative to the channel's spread, quantiles to the value
+        double worstMean = 0, worstStd = 0, worstQ[3] = { 0, 0, 0 }, worstAbove = 0;
+        bool ok = true;
+        for (int ch = 0; ch < STATS_CHANNELS; ch++) {
+            std::vector<int32_t>& v = exact[ch].values;
+            double sum = 0;
+            for (int32_t x : v) sum += x;
+            double mean = sum / v.size();
+            double ss = 0;
+            for (int32_t x : v) ss += (x - mean) * (x - mean);
+            double sd = sqrt(ss / (v.size() - 1));
+            std::sort(v.begin(), v.end());
+
+            StatsChannel_t c;
+            Stats_GetChannel((uint8_t)ch, &c);
+            double scale = std::max(sd, 1.0);
+            double meanErr = fabs(c.mean - mean) / scale;
+            double sdErr = fabs(c.stddev - sd) / scale;
+            worstMean = std::max(worstMean, meanErr);
+            worstStd = std::max(worstStd, sdErr);
+            if (meanErr > 1e-4 || sdErr > 1e-4 || c.min != v.front() || c.max != v.back()) {
+                printf("  FAIL: %s ch %d: mean %.2f/%.2f sd %.2f/%.2f min %d/%d max %d/%d\n", g.name, ch,
+                       c.mean, mean, c.stddev, sd, c.min, v.front(), c.max, v.back());
+                ok = false;
+            }
+            bool axis = ch >= STATS_CH_ACC_X && ch <= STATS_CH_ACC_Z;
+            if (axis) {
+                continue;
+            }
+            const uint16_t permille[3] = { 500, 900, 990 };
+            const uint16_t got[3] = { c.p50, c.p90, c.p99 };
+            for (int k = 0; k < 3; k++) {
+                int32_t want = nearestRank(v, permille[k]);
+                double err = fabs((double)got[k] - want);
+                worstQ[k] = std::max(worstQ[k], want ? err / want : err);
+                if (err > want / 16.0 + 0.5) {
+                    printf("  FAIL: %s ch %d p%u: %u, exact %d\n", g.name, ch, permille[k] / 10, got[k], want);
+                    ok = false;
+                }
+            }
+            double aboveErr = fabs((double)c.aboveMs - exact[ch].aboveUs / 1000.0);
+            worstAbove = std::max(worstAbove, aboveErr);
+            if (aboveErr > 1.0) {
+                printf("  FAIL: %s ch %d: %u ms above, exact %.1f\n", g.name, ch, c.aboveMs, exact[ch].aboveUs / 1000.0);
+                ok = false;
+            }
+        }
+        StatsSummary_t s;
+        Stats_GetSummary(&s);
+        if (s.frames != frames) {
+            printf("  FAIL: %s: %u frames counted\n", g.name, s.frames);
+            ok = false;
+        }
+        ok = checkPages(g.name) && ok;
+        printf("%-6s %10.2e sd %9.2e sd %8.2f%% %8.2f%% %8.2f%% %6.1f ms  %s\n", g.name, worstMean, worstStd,
+               worstQ[0] * 100, worstQ[1] * 100, worstQ[2] * 100, worstAbove, ok ? "ok" : "FAIL");
+        if (!ok) {
+            failures++;
+        }
+    }
+
+    // A reset starts an empty session
+    Stats_Reset();
+    StatsSummary_t s;
+    StatsChannel_t c;
+    Stats_GetSummary(&s);
+    Stats_GetChannel(0, &c);
+    bool resetOk = s.frames == 0 && s.durationMs == 0 && c.mean == 0 && c.p99 == 0 && c.aboveMs == 0;
+    printf("reset: %s\n", resetOk ? "ok" : "FAIL");
+    if (!resetOk) {
+        failures++;
+    }
+
+    printf("%s\n", failures ? "stats check FAILED" : "stats check passed");
+    return failures ? 1 : 0;
+}
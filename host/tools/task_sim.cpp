@@ -0,0 +1,1190 @@
+// Discrete-event timing model of the firmware task set: SensorTask, CommunicationTask, LoggerTask
+// and the NimBLE host task. The model covers:
+//   - a fixed-priority preemptive scheduler on N cores, with tick round-robin between equal priorities;
+//   - priority-inheriting mutexes: the retx lock (comm task) and the serial stream lock (sensor
+//     task vs logger sink). Freed TX buffers are not announced, so the comm task retries the ring
+//     on its wakes, every RETX_POLL_MS while notifications wait;
+//   - the BLE connection-event schedule and the stack's notification buffers;
+//   - the logger queue and the UART TX ring.
+// Every stage time is a distribution read from a profile file, so measured timings replace the
+// defaults, which come from Config.h and selftest_sim's I2C model.
+// Predicts sensor deadline misses, response and end-to-end latency distributions, and drop rates.
+// Usage:
+//   task_sim [profile] [--set key=value]... [--seconds s]
+//   task_sim [profile] [--set key=value]... --sweep key=v1,v2,...
+//   task_sim --dump-profile
+#include "CommonTypes.h"
+#include "SerialStreamModule.h"
+#include "Config.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <math.h>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define SIM_ADS1115_CONV_US     1163    // 860 SPS, as in PressureModule.cpp
+#define SIM_BATT_READ_PERIOD_MS (5 * 60 * 1000)     // BATT_READ_PERIOD_MS
+#define SIM_ACC_FIFO_ENTRIES    32
+#define SIM_EPS_US              1e-6
+
+// ''''''' DISTRIBUTIONS ''''''''''''''''''' //
+
+// Stage time in us: const x | uniform a b | normal mean sd | samples v... | file path (one value per line)
+struct Dist {
+    enum Kind { NONE, CONST, UNIFORM, NORMAL, SAMPLES } kind = NONE;
+    double a = 0, b = 0;
+    std::vector<double> samples;
+
+    static Dist constant(double v) { Dist d; d.kind = CONST; d.a = v; return d; }
+    static Dist normal(double mean, double sd) { Dist d; d.kind = NORMAL; d.a = mean; d.b = sd; return d; }
+
+    double sample(std::mt19937_64& rng) const
+    {
+        double v = 0;
+        switch (kind) {
+        case CONST:   v = a; break;
+        case UNIFORM: v = std::uniform_real_distribution<double>(a, b)(rng); break;
+        case NORMAL:  v = std::normal_distribution<double>(a, b)(rng); break;
+        case SAMPLES: v = samples[std::uniform_int_distribution<size_t>(0, samples.size() - 1)(rng)]; break;
+        default: break;
+        }
+        return std::max(v, 0.0);
+    }
+
+    std::string describe() const
+    {
+        char buf[64];
+        switch (kind) {
+        case CONST:   snprintf(buf, sizeof(buf), "const %.1f", a); break;
+        case UNIFORM: snprintf(buf, sizeof(buf), "uniform %.1f %.1f", a, b); break;
+        case NORMAL:  snprintf(buf, sizeof(buf), "normal %.1f %.1f", a, b); break;
+        case SAMPLES: {
+            std::string out = "samples";
+            for (double v : samples) {
+                snprintf(buf, sizeof(buf), " %g", v);
+                out += buf;
+            }
+            return out;
+        }
+        default:      snprintf(buf, sizeof(buf), "unset"); break;
+        }
+        return buf;
+    }
+};
+
+static bool parseDist(const char* text, Dist* d)
+{
+    char kind[16] = "";
+    char path[256] = "";
+    double a = 0, b = 0;
+    Dist out;
+    if (sscanf(text, "%15s", kind) != 1) {
+        return false;
+    }
+    if (!strcmp(kind, "const") && sscanf(text, "%*s %lf", &a) == 1) {
+        out = Dist::constant(a);
+    } else if (!strcmp(kind, "uniform") && sscanf(text, "%*s %lf %lf", &a, &b) == 2 && b >= a) {
+        out.kind = Dist::UNIFORM;
+        out.a = a;
+        out.b = b;
+    } else if (!strcmp(kind, "normal") && sscanf(text, "%*s %lf %lf", &a, &b) == 2) {
+        out = Dist::normal(a, b);
+    } else if (!strcmp(kind, "samples") || !strcmp(kind, "file")) {
+        out.kind = Dist::SAMPLES;
+        if (!strcmp(kind, "file")) {
+            FILE* f = (sscanf(text, "%*s %255s", path) == 1) ? fopen(path, "r") : nullptr;
+            if (!f) {
+                fprintf(stderr, "cannot read samples from '%s'\n", path);
+                return false;
+            }
+            while (fscanf(f, "%lf", &a) == 1) out.samples.push_back(a);
+            fclose(f);
+        } else {
+            const char* p = text + strlen("samples");
+            char* end;
+            for (a = strtod(p, &end); end != p; a = strtod(p, &end)) {
+                out.samples.push_back(a);
+                p = end;
+            }
+        }
+        if (out.samples.empty()) {
+            return false;
+        }
+    } else if (sscanf(text, "%lf", &a) == 1) {
+        out = Dist::constant(a);
+    } else {
+        return false;
+    }
+    *d = out;
+    return true;
+}
+
+// ''''''' PROFILE ''''''''''''''''''' //
+
+struct Params {
+    double cores = 2;
+    double tickUs = 1000;               // FreeRTOS tick, round-robin slice between equal priorities
+    double seconds = 60;
+    double seed = 1;
+    double loopIntervalMs = DEFAULT_LOOP_INTERVAL_MS;
+    double sensorPriority = 2;
+    double commPriority = 1;
+    double loggerPriority = LOGGER_TASK_PRIORITY;
+    double blePriority = 21;            // NimBLE host task, configMAX_PRIORITIES - 4
+    double bleCore = 0;                 // pinned; the firmware's own tasks are unpinned
+    double i2cHz = 400000;
+    double i2cCpuShare = 0.25;          // part of an I2C stage the task keeps the CPU (driver, polling)
+    double adcCount = ActiveTopology::AdcCount;
+    double pressureTicks = PRESSURE_SCAN_TICKS_PER_FRAME;
+    double accOdrHz = 800;
+    double batteryPeriodMs = SIM_BATT_READ_PERIOD_MS;
+    double sensorLogLines = 0;          // per frame; a debug build logs values and frames
+    double commLogLines = 0;            // per comm loop
+    double reportLines = 12;            // loop()'s memory/latency/stats report
+    double reportPeriodMs = MEMORY_REPORT_INTERVAL_MS;
+    double bleConnected = 1;
+    double bleIntervalUs = 15000;
+    double blePacketsPerEvent = 4;
+    double bleStackBuffers = 12;
+    double bleSkipProb = 0;             // connection events that carry nothing (interference)
+    double bleDriftPpm = 50;            // controller sleep clock against the CPU clock
+    double retxEnabled = RETX_ENABLED;
+    double retxSlots = RETX_BUFFER_SLOTS;
+    double retxPollMs = RETX_POLL_MS;
+    double loggerQueue = LOGGER_QUEUE_SIZE;
+    double logRatePerS = 100;           // LOGGER_RATE_LIMIT_PER_S at DEBUG, the level of per-frame lines; 0 => off
+    double logBurst = 40;               // LOGGER_RATE_LIMIT_BURST at DEBUG
+    double loggerRetryMs = LOGGER_SINK_RETRY_MS;
+    double uartBaud = LOGGER_UART_BAUD;
+    double uartTxBuffer = LOGGER_UART_TX_BUFFER_SIZE;
+    double streamEnabled = SERIAL_STREAM_ENABLED;
+
+    // Stage times [us]; unset I2C stages are derived from the bus model
+    Dist battery, acc, pressureTick;
+    Dist process = Dist::normal(400, 40);       // filter, alignment, packing, stats, encoding
+    Dist logEnqueue = Dist::normal(15, 3);
+    Dist notify = Dist::normal(40, 5);
+    Dist bleEvent = Dist::normal(30, 5);
+    Dist bleStatus = Dist::normal(8, 2);
+    Dist loggerWrite = Dist::normal(25, 5);
+    Dist lineBytes = Dist::normal(90, 25);
+    Dist streamSend = Dist::normal(12, 2);
+};
+
+struct Key {
+    const char* name;
+    double Params::* num;
+    Dist Params::* dist;
+};
+
+static const Key KEYS[] = {
+    { "cores", &Params::cores, nullptr },
+    { "tick_us", &Params::tickUs, nullptr },
+    { "seconds", &Params::seconds, nullptr },
+    { "seed", &Params::seed, nullptr },
+    { "loop_interval_ms", &Params::loopIntervalMs, nullptr },
+    { "sensor.priority", &Params::sensorPriority, nullptr },
+    { "comm.priority", &Params::commPriority, nullptr },
+    { "logger.priority", &Params::loggerPriority, nullptr },
+    { "ble.priority", &Params::blePriority, nullptr },
+    { "ble.core", &Params::bleCore, nullptr },
+    { "i2c.hz", &Params::i2cHz, nullptr },
+    { "i2c.cpu_share", &Params::i2cCpuShare, nullptr },
+    { "adc.count", &Params::adcCount, nullptr },
+    { "pressure.ticks", &Params::pressureTicks, nullptr },
+    { "acc.odr_hz", &Params::accOdrHz, nullptr },
+    { "battery.period_ms", &Params::batteryPeriodMs, nullptr },
+    { "sensor.log_lines", &Params::sensorLogLines, nullptr },
+    { "comm.log_lines", &Params::commLogLines, nullptr },
+    { "report.lines", &Params::reportLines, nullptr },
+    { "report.period_ms", &Params::reportPeriodMs, nullptr },
+    { "ble.connected", &Params::bleConnected, nullptr },
+    { "ble.interval_us", &Params::bleIntervalUs, nullptr },
+    { "ble.packets_per_event", &Params::blePacketsPerEvent, nullptr },
+    { "ble.stack_buffers", &Params::bleStackBuffers, nullptr },
+    { "ble.skip_prob", &Params::bleSkipProb, nullptr },
+    { "ble.drift_ppm", &Params::bleDriftPpm, nullptr },
+    { "retx.enabled", &Params::retxEnabled, nullptr },
+    { "retx.slots", &Params::retxSlots, nullptr },
+    { "retx.poll_ms", &Params::retxPollMs, nullptr },
+    { "logger.queue", &Params::loggerQueue, nullptr },
+    { "log.rate_per_s", &Params::logRatePerS, nullptr },
+    { "log.burst", &Params::logBurst, nullptr },
+    { "logger.retry_ms", &Params::loggerRetryMs, nullptr },
+    { "uart.baud", &Params::uartBaud, nullptr },
+    { "uart.tx_buffer", &Params::uartTxBuffer, nullptr },
+    { "stream.enabled", &Params::streamEnabled, nullptr },
+    { "sensor.battery", nullptr, &Params::battery },
+    { "sensor.acc", nullptr, &Params::acc },
+    { "sensor.pressure_tick", nullptr, &Params::pressureTick },
+    { "sensor.process", nullptr, &Params::process },
+    { "log.enqueue", nullptr, &Params::logEnqueue },
+    { "comm.notify", nullptr, &Params::notify },
+    { "ble.event", nullptr, &Params::bleEvent },
+    { "ble.status", nullptr, &Params::bleStatus },
+    { "logger.write", nullptr, &Params::loggerWrite },
+    { "logger.line_bytes", nullptr, &Params::lineBytes },
+    { "stream.send", nullptr, &Params::streamSend },
+};
+
+static bool setKey(Params* p, const char* key, const char* value)
+{
+    for (const Key& k : KEYS) {
+        if (strcmp(k.name, key) != 0) {
+            continue;
+        }
+        if (k.num) {
+            char* end;
+            double v = strtod(value, &end);
+            if (end == value) {
+                return false;
+            }
+            p->*k.num = v;
+            return true;
+        }
+        return parseDist(value, &(p->*k.dist));
+    }
+    fprintf(stderr, "unknown key '%s'\n", key);
+    return false;
+}
+
+// "key = value" or "key=value"; '#' starts a comment
+static bool parseAssignment(Params* p, const char* line)
+{
+    std::string s(line);
+    size_t hash = s.find('#');
+    if (hash != std::string::npos) s.erase(hash);
+    size_t eq = s.find('=');
+    auto trim = [](std::string t) {
+        size_t b = t.find_first_not_of(" \t\r\n"), e = t.find_last_not_of(" \t\r\n");
+        return (b == std::string::npos) ? std::string() : t.substr(b, e - b + 1);
+    };
+    if (eq == std::string::npos) {
+        return trim(s).empty();
+    }
+    return setKey(p, trim(s.substr(0, eq)).c_str(), trim(s.substr(eq + 1)).c_str());
+}
+
+static bool loadProfile(Params* p, const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[4096];
+    int n = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), f)) {
+        n++;
+        if (!parseAssignment(p, line)) {
+            fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, n, line);
+            ok = false;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+// One I2C transaction of n bytes incl. address, 9 clocks per byte (selftest_sim's model)
+static double txUs(const Params& p, int bytes)
+{
+    return bytes * 9.0 * 1e6 / p.i2cHz + 10;
+}
+
+// I2C stages the profile leaves unset, from the bus model at the configured rates
+static void deriveDefaults(Params* p)
+{
+    if (p->pressureTick.kind == Dist::NONE) {
+        // All starts, the rest of the first conversion, then every device collected in turn
+        double starts = p->adcCount * txUs(*p, 4);
+        double wait = std::max(0.0, SIM_ADS1115_CONV_US - (starts - txUs(*p, 4)));
+        double collect = p->adcCount * 2 * (txUs(*p, 2) + txUs(*p, 3));
+        double us = starts + wait + collect;
+        p->pressureTick = Dist::normal(us, us * 0.03);
+    }
+    if (p->acc.kind == Dist::NONE) {
+        double entries = std::min<double>(SIM_ACC_FIFO_ENTRIES, p->accOdrHz * p->loopIntervalMs / 1000.0);
+        double us = 2 * txUs(*p, 2) + entries * (txUs(*p, 2) + txUs(*p, 7));
+        p->acc = Dist::normal(us, us * 0.03);
+    }
+    if (p->battery.kind == Dist::NONE) {
+        double us = txUs(*p, 2) + txUs(*p, 3);
+        p->battery = Dist::normal(us, us * 0.03);
+    }
+}
+
+static void dumpProfile(const Params& p)
+{
+    printf("# task_sim profile; times in us\n");
+    for (const Key& k : KEYS) {
+        if (k.num) {
+            printf("%-22s = %g\n", k.name, p.*k.num);
+        } else {
+            printf("%-22s = %s\n", k.name, (p.*k.dist).describe().c_str());
+        }
+    }
+}
+
+// ''''''' SCHEDULER ''''''''''''''''''' //
+
+enum OpKind { OP_CPU, OP_IO, OP_LOCK, OP_UNLOCK, OP_CALL, OP_DELAY_UNTIL, OP_NOTIFY_TAKE, OP_QUEUE_RECV, OP_WAIT_WORK };
+
+struct Op {
+    OpKind kind;
+    double us;                      // CPU/IO time, absolute wake time or timeout
+    int lock;
+    std::function<void()> fn;
+};
+
+static Op cpuOp(double us) { return Op{ OP_CPU, us, -1, nullptr }; }
+static Op ioOp(double us) { return Op{ OP_IO, us, -1, nullptr }; }
+static Op lockOp(int lock) { return Op{ OP_LOCK, 0, lock, nullptr }; }
+static Op unlockOp(int lock) { return Op{ OP_UNLOCK, 0, lock, nullptr }; }
+static Op callOp(std::function<void()> fn) { return Op{ OP_CALL, 0, -1, std::move(fn) }; }
+
+struct Task {
+    const char* name;
+    int basePrio;
+    int prio;                       // with inheritance
+    int core;                       // -1 => any
+    std::deque<Op> script;
+    std::function<void()> nextJob;  // refills an empty script
+    bool ready = false;
+    bool keepCpu = false;           // running, not rotated out by the tick
+    int  runningOn = -1;
+    double readySince = 0;
+    uint64_t waitToken = 0;
+    bool waitingNotify = false, waitingQueue = false, waitingWork = false;
+    uint32_t notifyCount = 0;
+    uint32_t lastTake = 0;          // ulTaskNotifyTake() result
+    double cpuUs = 0;
+};
+
+struct Lock {
+    const char* name;
+    int holder = -1;
+    std::vector<std::pair<int, double>> waiters;    // task, since
+    uint64_t takes = 0, contended = 0;
+    double maxWaitUs = 0, totalWaitUs = 0;
+};
+
+enum EventKind { EV_WAKE, EV_CONN, EV_TICK, EV_REPORT };
+
+struct Event {
+    double t;
+    uint64_t seq;
+    EventKind kind;
+    int task;
+    uint64_t token;
+    bool operator>(const Event& o) const { return t != o.t ? t > o.t : seq > o.seq; }
+};
+
+struct Frame {
+    uint32_t seq;
+    double sampleUs;
+};
+
+struct LogLine {
+    double enqueuedUs;
+    double bytes;
+};
+
+static double percentile(std::vector<double>& v, double q)
+{
+    if (v.empty()) {
+        return 0;
+    }
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)ceil(q * v.size());
+    return v[rank ? rank - 1 : 0];
+}
+
+struct Results {
+    uint64_t jobs = 0, misses = 0;
+    std::vector<double> responseUs, jitterUs, latencyUs, logLatencyUs;
+    uint64_t published = 0, overwritten = 0, direct = 0, queued = 0, retxDropped = 0, refusedDropped = 0;
+    uint64_t onAir = 0, inFlight = 0;
+    uint64_t logLines = 0, logRateDrops = 0, logQueueDrops = 0, logSinkDrops = 0;
+    uint64_t streamed = 0, streamDrops = 0;
+    std::vector<double> taskCpu;
+    std::vector<const char*> taskNames;
+    std::vector<Lock> locks;
+    double simUs = 0;
+};
+
+class Sim {
+public:
+    explicit Sim(const Params& p) : m_p(p), m_rng((uint64_t)p.seed) {}
+    Results run();
+
+private:
+    enum { T_SENSOR, T_COMM, T_LOGGER, T_BLE };
+    enum { L_RETX, L_STREAM };
+
+    void schedule(double t, EventKind kind, int task = -1, uint64_t token = 0)
+    {
+        m_events.push(Event{ t, m_seq++, kind, task, token });
+    }
+    void block(int ti, double wakeAt)
+    {
+        Task& t = m_tasks[ti];
+        t.ready = false;
+        t.keepCpu = false;
+        if (wakeAt >= 0) {
+            schedule(wakeAt, EV_WAKE, ti, t.waitToken);
+        }
+    }
+    void wake(int ti)
+    {
+        Task& t = m_tasks[ti];
+        t.waitToken++;
+        t.ready = true;
+        t.keepCpu = false;
+        t.readySince = m_now;
+        t.waitingNotify = t.waitingQueue = t.waitingWork = false;
+        runOps(ti);
+    }
+    void pushFront(int ti, std::vector<Op> ops)
+    {
+        std::deque<Op>& s = m_tasks[ti].script;
+        s.insert(s.begin(), std::make_move_iterator(ops.begin()), std::make_move_iterator(ops.end()));
+    }
+    void appendWork(int ti, std::vector<Op> ops)
+    {
+        Task& t = m_tasks[ti];
+        for (Op& op : ops) t.script.push_back(std::move(op));
+        if (t.waitingWork) {
+            wake(ti);
+        }
+    }
+    void notifyGive(int ti)
+    {
+        Task& t = m_tasks[ti];
+        t.notifyCount++;
+        if (t.waitingNotify) {
+            t.lastTake = t.notifyCount;
+            t.notifyCount = 0;
+            wake(ti);
+        }
+    }
+    void updateInheritance(int li)
+    {
+        Lock& l = m_locks[li];
+        if (l.holder < 0) {
+            return;
+        }
+        Task& h = m_tasks[l.holder];
+        h.prio = h.basePrio;
+        for (const Lock& other : m_locks) {
+            if (other.holder != l.holder) continue;
+            for (const auto& w : other.waiters) h.prio = std::max(h.prio, m_tasks[w.first].prio);
+        }
+    }
+    void runOps(int ti);
+    void dispatch();
+    void advanceTo(double t);
+    double i2cStage(std::vector<Op>* ops, const Dist& d);
+
+    // Tasks
+    void sensorJob();
+    void commJob();
+    void loggerJob();
+    void loggerAttempt(LogLine line, double startUs);
+    void connEvent();
+    void enqueueLog(double bytes);
+    void debugLog(double bytes);
+    void stackSendOrQueue(const Frame& f);
+    size_t drainRetx();
+    double uartFree();
+    void uartPush(double bytes);
+
+    Params m_p;
+    std::mt19937_64 m_rng;
+    double m_now = 0;
+    uint64_t m_seq = 0;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+    std::vector<Task> m_tasks;
+    std::vector<Lock> m_locks;
+    std::vector<int> m_cores;
+    Results m_r;
+
+    // Sensor
+    double m_lastWakeUs = 0;
+    double m_lastBatteryUs = -1e18;
+    uint32_t m_frameSeq = 0;
+    bool m_haveLatest = false;
+    bool m_latestTaken = true;
+    Frame m_latest = { 0, 0 };
+    // BLE
+    double m_connIntervalUs = 0;
+    std::deque<Frame> m_stack;
+    std::deque<Frame> m_retx;
+    // Logger and UART
+    std::deque<LogLine> m_logQueue;
+    double m_logTokens = 0;
+    double m_logRefillUs = 0;
+    double m_uartLevel = 0;
+    double m_uartUpdatedUs = 0;
+};
+
+void Sim::runOps(int ti)
+{
+    Task& t = m_tasks[ti];
+    for (;;) {
+        if (t.script.empty()) {
+            t.nextJob();
+            continue;
+        }
+        Op& op = t.script.front();
+        switch (op.kind) {
+        case OP_CPU:
+            if (op.us > SIM_EPS_US) {
+                return;
+            }
+            t.script.pop_front();
+            break;
+        case OP_IO: {
+            double until = m_now + op.us;
+            t.script.pop_front();
+            block(ti, until);
+            return;
+        }
+        case OP_LOCK: {
+            Lock& l = m_locks[op.lock];
+            int li = op.lock;
+            t.script.pop_front();
+            l.takes++;
+            if (l.holder < 0) {
+                l.holder = ti;
+                break;
+            }
+            l.contended++;
+            l.waiters.push_back({ ti, m_now });
+            block(ti, -1);
+            updateInheritance(li);
+            return;
+        }
+        case OP_UNLOCK: {
+            Lock& l = m_locks[op.lock];
+            int li = op.lock;
+            t.script.pop_front();
+            l.holder = -1;
+            // Back to the base priority, unless waiters on another held lock still lift it
+            t.prio = t.basePrio;
+            for (const Lock& other : m_locks) {
+                if (other.holder == ti) {
+                    for (const auto& w : other.waiters) t.prio = std::max(t.prio, m_tasks[w.first].prio);
+                }
+            }
+            if (!l.waiters.empty()) {
+                // The highest-priority waiter gets the mutex, first come first served between equals
+                auto best = l.waiters.begin();
+                for (auto it = l.waiters.begin(); it != l.waiters.end(); ++it) {
+                    if (m_tasks[it->first].prio > m_tasks[best->first].prio) best = it;
+                }
+                int next = best->first;
+                double waited = m_now - best->second;
+                l.waiters.erase(best);
+                l.holder = next;
+                l.maxWaitUs = std::max(l.maxWaitUs, waited);
+                l.totalWaitUs += waited;
+                updateInheritance(li);
+                wake(next);
+            }
+            break;
+        }
+        case OP_CALL: {
+            std::function<void()> fn = std::move(op.fn);
+            t.script.pop_front();
+            fn();
+            break;
+        }
+        case OP_DELAY_UNTIL: {
+            double until = op.us;
+            t.script.pop_front();
+            if (until > m_now + SIM_EPS_US) {
+                block(ti, until);
+                return;
+            }
+            break;
+        }
+        case OP_NOTIFY_TAKE: {
+            double timeout = op.us;
+            t.script.pop_front();
+            if (t.notifyCount > 0) {
+                t.lastTake = t.notifyCount;
+                t.notifyCount = 0;
+                break;
+            }
+            t.lastTake = 0;
+            t.waitingNotify = true;
+            block(ti, m_now + timeout);
+            return;
+        }
+        case OP_QUEUE_RECV: {
+            double timeout = op.us;
+            t.script.pop_front();
+            if (!m_logQueue.empty()) {
+                break;
+            }
+            t.waitingQueue = true;
+            block(ti, m_now + timeout);
+            return;
+        }
+        case OP_WAIT_WORK:
+            t.script.pop_front();
+            if (!t.script.empty()) {
+                break;
+            }
+            t.waitingWork = true;
+            block(ti, -1);
+            return;
+        }
+    }
+}
+
+// Highest priorities first; a running task keeps its core against equal priorities until the
+// tick rotates it; otherwise first ready, first served
+void Sim::dispatch()
+{
+    std::vector<int> order;
+    for (int i = 0; i < (int)m_tasks.size(); i++) {
+        if (m_tasks[i].ready) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const Task& x = m_tasks[a];
+        const Task& y = m_tasks[b];
+        if (x.prio != y.prio) return x.prio > y.prio;
+        if (x.keepCpu != y.keepCpu) return x.keepCpu;
+        if (x.readySince != y.readySince) return x.readySince < y.readySince;
+        return a < b;
+    });
+    std::vector<int> cores(m_cores.size(), -1);
+    std::vector<int> previous(m_tasks.size());
+    for (size_t i = 0; i < m_tasks.size(); i++) {
+        previous[i] = m_tasks[i].runningOn;
+        m_tasks[i].runningOn = -1;
+    }
+    for (int ti : order) {
+        Task& t = m_tasks[ti];
+        int pick = -1;
+        if (t.core >= 0) {
+            pick = (t.core < (int)cores.size() && cores[t.core] < 0) ? t.core : -1;
+        } else if (previous[ti] >= 0 && cores[previous[ti]] < 0) {
+            pick = previous[ti];
+        } else {
+            for (size_t c = 0; c < cores.size() && pick < 0; c++) {
+                if (cores[c] < 0) pick = (int)c;
+            }
+        }
+        if (pick >= 0) {
+            cores[pick] = ti;
+            t.runningOn = pick;
+            t.keepCpu = true;
+        } else if (previous[ti] >= 0) {
+            t.keepCpu = false;      // preempted
+        }
+    }
+    m_cores = cores;
+}
+
+void Sim::advanceTo(double t)
+{
+    double dt = t - m_now;
+    if (dt > 0) {
+        for (int ti : m_cores) {
+            if (ti < 0) continue;
+            Task& task = m_tasks[ti];
+            task.script.front().us -= dt;
+            task.cpuUs += dt;
+        }
+    }
+    m_now = t;
+}
+
+// ''''''' TASK MODELS ''''''''''''''''''' //
+
+double Sim::i2cStage(std::vector<Op>* ops, const Dist& d)
+{
+    double us = d.sample(m_rng);
+    ops->push_back(cpuOp(us * m_p.i2cCpuShare));
+    ops->push_back(ioOp(us * (1 - m_p.i2cCpuShare)));
+    return us;
+}
+
+double Sim::uartFree()
+{
+    double rate = m_p.uartBaud / 10.0 / 1e6;    // bytes per us, 8N1
+    m_uartLevel = std::max(0.0, m_uartLevel - (m_now - m_uartUpdatedUs) * rate);
+    m_uartUpdatedUs = m_now;
+    return m_p.uartTxBuffer - m_uartLevel;
+}
+
+void Sim::uartPush(double bytes)
+{
+    uartFree();
+    m_uartLevel += bytes;
+}
+
+void Sim::enqueueLog(double bytes)
+{
+    if (m_logQueue.size() >= (size_t)m_p.loggerQueue) {
+        m_r.logQueueDrops++;
+        return;
+    }
+    m_logQueue.push_back(LogLine{ m_now, bytes });
+    Task& logger = m_tasks[T_LOGGER];
+    if (logger.waitingQueue) {
+        wake(T_LOGGER);
+    }
+}
+
+// Per-frame and comm lines are DEBUG level and pass the logger's token bucket first
+void Sim::debugLog(double bytes)
+{
+    if (m_p.logRatePerS > 0) {
+        m_logTokens = std::min(m_p.logBurst, m_logTokens + (m_now - m_logRefillUs) * m_p.logRatePerS / 1e6);
+        m_logRefillUs = m_now;
+        if (m_logTokens < 1) {
+            m_r.logRateDrops++;
+            return;
+        }
+        m_logTokens -= 1;
+    }
+    enqueueLog(bytes);
+}
+
+// Retx_Send(): queued entries go first, a refused notification joins the ring
+void Sim::stackSendOrQueue(const Frame& f)
+{
+    if (m_retx.empty() && m_stack.size() < (size_t)m_p.bleStackBuffers) {
+        m_stack.push_back(f);
+        m_r.direct++;
+        return;
+    }
+    if (!m_p.retxEnabled) {
+        m_r.refusedDropped++;
+        return;
+    }
+    if (m_retx.size() >= (size_t)m_p.retxSlots) {
+        m_retx.pop_front();
+        m_r.retxDropped++;
+    }
+    m_retx.push_back(f);
+    m_r.queued++;
+}
+
+size_t Sim::drainRetx()
+{
+    size_t moved = 0;
+    while (!m_retx.empty() && m_stack.size() < (size_t)m_p.bleStackBuffers) {
+        m_stack.push_back(m_retx.front());
+        m_retx.pop_front();
+        moved++;
+    }
+    return moved;
+}
+
+void Sim::sensorJob()
+{
+    // vTaskDelayUntil(): an overrun wakes right away and keeps the original grid
+    double release = m_lastWakeUs + m_p.loopIntervalMs * 1000;
+    m_lastWakeUs = release;
+    std::vector<Op> ops;
+    ops.push_back(Op{ OP_DELAY_UNTIL, release, -1, nullptr });
+    auto sampleUs = std::make_shared<double>(0);
+    ops.push_back(callOp([this, release, sampleUs]() {
+        *sampleUs = m_now;
+        m_r.jitterUs.push_back(m_now - release);
+    }));
+    bool reading = m_p.bleConnected || m_p.streamEnabled;
+    if (reading) {
+        if (m_now - m_lastBatteryUs >= m_p.batteryPeriodMs * 1000) {
+            m_lastBatteryUs = release;
+            i2cStage(&ops, m_p.battery);
+        }
+        i2cStage(&ops, m_p.acc);
+        for (int i = 0; i < (int)m_p.pressureTicks; i++) {
+            i2cStage(&ops, m_p.pressureTick);
+        }
+        ops.push_back(cpuOp(m_p.process.sample(m_rng)));
+        if (m_p.streamEnabled) {
+            ops.push_back(lockOp(L_STREAM));
+            ops.push_back(cpuOp(m_p.streamSend.sample(m_rng)));
+            ops.push_back(callOp([this]() {
+                double bytes = SERIAL_STREAM_WIRE_SIZE(SERIAL_STREAM_FRAME_SIZE);
+                if (uartFree() >= bytes) {
+                    uartPush(bytes);
+                    m_r.streamed++;
+                } else {
+                    m_r.streamDrops++;
+                }
+            }));
+            ops.push_back(unlockOp(L_STREAM));
+        }
+    } else {
+        ops.push_back(cpuOp(5));        // clearSensorData()
+    }
+    ops.push_back(callOp([this, sampleUs, reading]() {
+        if (reading) {
+            if (m_p.bleConnected && m_haveLatest && !m_latestTaken) {
+                m_r.overwritten++;
+            }
+            m_latest = Frame{ m_frameSeq++, *sampleUs };
+            m_haveLatest = true;
+            m_latestTaken = false;
+            m_r.published++;
+        }
+        notifyGive(T_COMM);
+    }));
+    for (int i = 0; i < (int)m_p.sensorLogLines; i++) {
+        ops.push_back(cpuOp(m_p.logEnqueue.sample(m_rng)));
+        ops.push_back(callOp([this]() { debugLog(m_p.lineBytes.sample(m_rng)); }));
+    }
+    ops.push_back(callOp([this, release]() {
+        double response = m_now - release;
+        m_r.jobs++;
+        m_r.responseUs.push_back(response);
+        if (response > m_p.loopIntervalMs * 1000) {
+            m_r.misses++;
+        }
+    }));
+    pushFront(T_SENSOR, std::move(ops));
+}
+
+void Sim::commJob()
+{
+    std::vector<Op> ops;
+    // Wakes sooner while notifications wait for a TX buffer (BLE_ServiceRetx)
+    double timeoutUs = m_retx.empty() ? 2 * m_p.loopIntervalMs * 1000 : m_p.retxPollMs * 1000;
+    ops.push_back(Op{ OP_NOTIFY_TAKE, timeoutUs, -1, nullptr });
+    ops.push_back(callOp([this]() {
+        std::vector<Op> body;
+        bool fresh = m_tasks[T_COMM].lastTake > 0 && m_p.bleConnected && m_haveLatest && !m_latestTaken;
+        if (fresh || (m_p.bleConnected && !m_retx.empty())) {
+            Frame f = m_latest;
+            m_latestTaken = m_latestTaken || fresh;
+            body.push_back(lockOp(L_RETX));
+            // notify() raises onStatus() before it returns, on this task
+            if (fresh) {
+                body.push_back(cpuOp(m_p.notify.sample(m_rng) + m_p.bleStatus.sample(m_rng)));
+            }
+            body.push_back(callOp([this, f, fresh]() {
+                size_t resent = drainRetx();
+                if (fresh) {
+                    stackSendOrQueue(f);
+                }
+                if (resent) {
+                    pushFront(T_COMM, { cpuOp(resent * (m_p.notify.sample(m_rng) + m_p.bleStatus.sample(m_rng))) });
+                }
+            }));
+            body.push_back(unlockOp(L_RETX));
+        }
+        for (int i = 0; i < (int)m_p.commLogLines; i++) {
+            body.push_back(cpuOp(m_p.logEnqueue.sample(m_rng)));
+            body.push_back(callOp([this]() { debugLog(m_p.lineBytes.sample(m_rng)); }));
+        }
+        pushFront(T_COMM, std::move(body));
+    }));
+    pushFront(T_COMM, std::move(ops));
+}
+
+// One sink write; LoggerWriteLine() retries every tick until LOGGER_SINK_RETRY_MS has passed
+void Sim::loggerAttempt(LogLine line, double startUs)
+{
+    std::vector<Op> ops;
+    auto retry = std::make_shared<bool>(false);
+    if (m_p.streamEnabled) {
+        ops.push_back(lockOp(L_STREAM));
+        ops.push_back(cpuOp(m_p.streamSend.sample(m_rng)));
+    }
+    ops.push_back(callOp([this, line, startUs, retry]() {
+        double bytes = m_p.streamEnabled ? SERIAL_STREAM_WIRE_SIZE((int)line.bytes) : line.bytes + 2;
+        if (uartFree() >= bytes) {
+            uartPush(bytes);
+            m_r.logLines++;
+            m_r.logLatencyUs.push_back(m_now - line.enqueuedUs);
+        } else if (m_now - startUs >= m_p.loggerRetryMs * 1000) {
+            m_r.logSinkDrops++;
+        } else {
+            *retry = true;
+        }
+    }));
+    if (m_p.streamEnabled) ops.push_back(unlockOp(L_STREAM));
+    ops.push_back(callOp([this, line, startUs, retry]() {
+        if (*retry) {
+            pushFront(T_LOGGER, { ioOp(m_p.tickUs), callOp([this, line, startUs]() { loggerAttempt(line, startUs); }) });
+        }
+    }));
+    pushFront(T_LOGGER, std::move(ops));
+}
+
+void Sim::loggerJob()
+{
+    std::vector<Op> ops;
+    ops.push_back(Op{ OP_QUEUE_RECV, 1e6, -1, nullptr });
+    ops.push_back(callOp([this]() {
+        if (m_logQueue.empty()) {
+            return;     // timeout: drop report and watchdog only
+        }
+        LogLine line = m_logQueue.front();
+        m_logQueue.pop_front();
+        pushFront(T_LOGGER, { cpuOp(m_p.loggerWrite.sample(m_rng)),
+                              callOp([this, line]() { loggerAttempt(line, m_now); }) });
+    }));
+    pushFront(T_LOGGER, std::move(ops));
+}
+
+// The controller sends queued notifications; the buffers come back without a callback
+void Sim::connEvent()
+{
+    if (!m_p.bleConnected) {
+        return;
+    }
+    if (std::uniform_real_distribution<double>(0, 1)(m_rng) < m_p.bleSkipProb) {
+        return;
+    }
+    size_t n = std::min(m_stack.size(), (size_t)m_p.blePacketsPerEvent);
+    if (n == 0) {
+        return;
+    }
+    std::vector<Op> work;
+    work.push_back(cpuOp(m_p.bleEvent.sample(m_rng)));
+    for (size_t i = 0; i < n; i++) {
+        m_r.latencyUs.push_back(m_now - m_stack.front().sampleUs);
+        m_r.onAir++;
+        m_stack.pop_front();
+    }
+    appendWork(T_BLE, std::move(work));
+}
+
+Results Sim::run()
+{
+    deriveDefaults(&m_p);
+    auto makeTask = [](const char* name, double prio, int core) {
+        Task t;
+        t.name = name;
+        t.basePrio = t.prio = (int)prio;
+        t.core = core;
+        return t;
+    };
+    m_tasks.push_back(makeTask("SensorTask", m_p.sensorPriority, -1));
+    m_tasks.push_back(makeTask("CommTask", m_p.commPriority, -1));
+    m_tasks.push_back(makeTask("LoggerTask", m_p.loggerPriority, -1));
+    m_tasks.push_back(makeTask("NimBLE host", m_p.blePriority, (int)m_p.bleCore));
+    m_tasks[T_SENSOR].nextJob = [this]() { sensorJob(); };
+    m_tasks[T_COMM].nextJob = [this]() { commJob(); };
+    m_tasks[T_LOGGER].nextJob = [this]() { loggerJob(); };
+    m_tasks[T_BLE].nextJob = [this]() { m_tasks[T_BLE].script.push_back(Op{ OP_WAIT_WORK, 0, -1, nullptr }); };
+    m_locks.resize(2);
+    m_locks[L_RETX].name = "retx";
+    m_locks[L_STREAM].name = "stream";
+    m_cores.assign(std::max(1, (int)m_p.cores), -1);
+    m_logTokens = m_p.logBurst;
+
+    for (int i = 0; i < (int)m_tasks.size(); i++) {
+        m_tasks[i].ready = true;
+        runOps(i);
+    }
+    // Connection events start at a random phase to the frame grid and drift against it
+    m_connIntervalUs = m_p.bleIntervalUs * (1 + m_p.bleDriftPpm * 1e-6);
+    schedule(std::uniform_real_distribution<double>(0, m_p.bleIntervalUs)(m_rng), EV_CONN);
+    schedule(m_p.tickUs, EV_TICK);
+    if (m_p.reportPeriodMs > 0) {
+        schedule(m_p.reportPeriodMs * 1000, EV_REPORT);
+    }
+    dispatch();
+
+    double endUs = m_p.seconds * 1e6;
+    for (;;) {
+        double next = m_events.empty() ? endUs : m_events.top().t;
+        for (int ti : m_cores) {
+            if (ti >= 0) next = std::min(next, m_now + m_tasks[ti].script.front().us);
+        }
+        if (next >= endUs) {
+            advanceTo(endUs);
+            break;
+        }
+        advanceTo(next);
+        for (size_t c = 0; c < m_cores.size(); c++) {
+            int ti = m_cores[c];
+            if (ti >= 0 && m_tasks[ti].script.front().us <= SIM_EPS_US) {
+                m_tasks[ti].script.pop_front();
+                runOps(ti);
+            }
+        }
+        while (!m_events.empty() && m_events.top().t <= m_now + SIM_EPS_US) {
+            Event ev = m_events.top();
+            m_events.pop();
+            switch (ev.kind) {
+            case EV_WAKE:
+                if (m_tasks[ev.task].waitToken == ev.token && !m_tasks[ev.task].ready) {
+                    wake(ev.task);
+                }
+                break;
+            case EV_CONN:
+                connEvent();
+                schedule(m_now + m_connIntervalUs, EV_CONN);
+                break;
+            case EV_TICK:
+                // Round-robin: a task that ran through a tick yields to a waiting equal
+                for (int ti : m_cores) {
+                    if (ti >= 0) m_tasks[ti].keepCpu = false;
+                }
+                schedule(m_now + m_p.tickUs, EV_TICK);
+                break;
+            case EV_REPORT:
+                for (int i = 0; i < (int)m_p.reportLines; i++) {
+                    enqueueLog(m_p.lineBytes.sample(m_rng));
+                }
+                schedule(m_now + m_p.reportPeriodMs * 1000, EV_REPORT);
+                break;
+            }
+        }
+        dispatch();
+    }
+
+    m_r.inFlight = m_stack.size() + m_retx.size();
+    m_r.simUs = m_now;
+    for (const Task& t : m_tasks) {
+        m_r.taskCpu.push_back(t.cpuUs);
+        m_r.taskNames.push_back(t.name);
+    }
+    m_r.locks = m_locks;
+    return m_r;
+}
+
+// ''''''' REPORTS ''''''''''''''''''' //
+
+static void printReport(const Params& p, Results& r)
+{
+    printf("%.0f s, %d cores, loop %g ms, %d ADS1115 x %d ticks, BLE %g us x %g, stream %s\n\n", r.simUs / 1e6,
+           (int)p.cores, p.loopIntervalMs, (int)p.adcCount, (int)p.pressureTicks, p.bleIntervalUs,
+           p.blePacketsPerEvent, p.streamEnabled ? "on" : "off");
+    printf("%-12s %8s\n", "task", "CPU");
+    for (size_t i = 0; i < r.taskNames.size(); i++) {
+        printf("%-12s %7.1f%%\n", r.taskNames[i], 100.0 * r.taskCpu[i] / r.simUs);
+    }
+    printf("\nsensor task: %llu jobs, %llu deadline misses (%.2f%%)\n", (unsigned long long)r.jobs,
+           (unsigned long long)r.misses, r.jobs ? 100.0 * r.misses / r.jobs : 0.0);
+    printf("  response    p50 %7.0f  p90 %7.0f  p99 %7.0f  max %7.0f us (deadline %.0f)\n",
+           percentile(r.responseUs, 0.5), percentile(r.responseUs, 0.9), percentile(r.responseUs, 0.99),
+           percentile(r.responseUs, 1.0), p.loopIntervalMs * 1000);
+    printf("  start delay p50 %7.0f  p90 %7.0f  p99 %7.0f  max %7.0f us\n", percentile(r.jitterUs, 0.5),
+           percentile(r.jitterUs, 0.9), percentile(r.jitterUs, 0.99), percentile(r.jitterUs, 1.0));
+    uint64_t lost = r.overwritten + r.retxDropped + r.refusedDropped;
+    printf("frames: %llu published, %llu overwritten before the comm task took them, %llu refused and queued,\n"
+           "        %llu dropped from the retry ring, %llu refused without retry, %llu on air, %llu in flight\n",
+           (unsigned long long)r.published, (unsigned long long)r.overwritten, (unsigned long long)r.queued,
+           (unsigned long long)r.retxDropped, (unsigned long long)r.refusedDropped, (unsigned long long)r.onAir,
+           (unsigned long long)r.inFlight);
+    printf("  loss %.3f%%; sample -> air p50 %6.1f  p90 %6.1f  p99 %6.1f  max %6.1f ms\n",
+           r.published ? 100.0 * lost / r.published : 0.0, percentile(r.latencyUs, 0.5) / 1000,
+           percentile(r.latencyUs, 0.9) / 1000, percentile(r.latencyUs, 0.99) / 1000,
+           percentile(r.latencyUs, 1.0) / 1000);
+    printf("log: %llu lines written, dropped: %llu rate limit, %llu queue full, %llu sink full; latency p50 %.1f p99 %.1f ms\n",
+           (unsigned long long)r.logLines, (unsigned long long)r.logRateDrops, (unsigned long long)r.logQueueDrops,
+           (unsigned long long)r.logSinkDrops,
+           percentile(r.logLatencyUs, 0.5) / 1000, percentile(r.logLatencyUs, 0.99) / 1000);
+    if (p.streamEnabled) {
+        printf("serial stream: %llu frames, %llu dropped (UART full)\n", (unsigned long long)r.streamed,
+               (unsigned long long)r.streamDrops);
+    }
+    for (const Lock& l : r.locks) {
+        if (l.takes) {
+            printf("lock %-6s: %llu takes, %llu contended, wait mean %.1f max %.1f us\n", l.name,
+                   (unsigned long long)l.takes, (unsigned long long)l.contended,
+                   l.contended ? l.totalWaitUs / l.contended : 0.0, l.maxWaitUs);
+        }
+    }
+}
+
+static void printSweepHeader(const char* key)
+{
+    printf("%-14s %8s %9s %9s %8s %8s %8s %9s %9s\n", key, "miss %", "resp p99", "resp max", "loss %",
+           "lat p50", "lat p99", "log drop", "sens CPU");
+}
+
+static void printSweepRow(const char* value, const Params& p, Results& r)
+{
+    uint64_t lost = r.overwritten + r.retxDropped + r.refusedDropped;
+    printf("%-14s %7.2f%% %6.0f us %6.0f us %7.3f%% %5.1f ms %5.1f ms %9llu %8.1f%%\n", value,
+           r.jobs ? 100.0 * r.misses / r.jobs : 0.0, percentile(r.responseUs, 0.99), percentile(r.responseUs, 1.0),
+           r.published ? 100.0 * lost / r.published : 0.0, percentile(r.latencyUs, 0.5) / 1000,
+           percentile(r.latencyUs, 0.99) / 1000, (unsigned long long)(r.logRateDrops + r.logQueueDrops + r.logSinkDrops),
+           100.0 * r.taskCpu[0] / r.simUs);
+    (void)p;
+}
+
+int main(int argc, char** argv)
+{
+    Params p;
+    const char* sweep = nullptr;
+    bool dump = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            if (!parseAssignment(&p, argv[++i])) {
+                fprintf(stderr, "bad --set '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            p.seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--sweep") && i + 1 < argc) {
+            sweep = argv[++i];
+        } else if (!strcmp(argv[i], "--dump-profile")) {
+            dump = true;
+        } else if (argv[i][0] != '-') {
+            if (!loadProfile(&p, argv[i])) {
+                return 2;
+            }
+        } else {
+            fprintf(stderr, "usage: task_sim [profile] [--set key=value]... [--seconds s] [--sweep key=v1,v2,...]\n"
+                            "       task_sim --dump-profile\n");
+            return 2;
+        }
+    }
+    if (dump) {
+        Params derived = p;
+        deriveDefaults(&derived);
+        dumpProfile(derived);
+        return 0;
+    }
+    if (!sweep) {
+        Results r = Sim(p).run();
+        printReport(p, r);
+        return 0;
+    }
+
+    // One run per value, the I2C stages re-derived for each unless the profile fixed them
+    std::string spec(sweep);
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos) {
+        fprintf(stderr, "--sweep wants key=v1,v2,...\n");
+        return 2;
+    }
+    std::string key = spec.substr(0, eq);
+    printSweepHeader(key.c_str());
+    size_t start = eq + 1;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string value = spec.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        Params q = p;
+        if (!setKey(&q, key.c_str(), value.c_str())) {
+            fprintf(stderr, "bad sweep value '%s'\n", value.c_str());
+            return 2;
+        }
+        Results r = Sim(q).run();
+        printSweepRow(value.c_str(), q, r);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return 0;
+}
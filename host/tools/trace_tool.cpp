@@ -0,0 +1,133 @@
+// Trace generation, conversion and replay.
+// Usage:
+//   trace_tool gen <stand|walk|run> <seconds> <period_ms> <out.trc>
+//   trace_tool header <in.trc> <out.h>        C array for -DTRACE_FLASH_HEADER
+//   trace_tool replay <in.trc> <speed> [seconds]
+//        speed 1 = real time, N = N x real time, 0 = as fast as possible
+#include "TraceModule.h"
+#include "FrameDecoder.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+static bool readFile(const char* path, std::vector<uint8_t>& out)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(size > 0 ? (size_t)size : 0);
+    bool ok = fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+static int cmdGen(int argc, char** argv)
+{
+    if (argc < 6) return 1;
+    TraceGait_t gait = TRACE_GAIT_WALK;
+    if (!strcmp(argv[2], "stand")) gait = TRACE_GAIT_STAND;
+    else if (!strcmp(argv[2], "run")) gait = TRACE_GAIT_RUN;
+
+    uint16_t period = (uint16_t)atoi(argv[4]);
+    uint32_t records = period ? (uint32_t)(atof(argv[3]) * 1000.0 / period) : 0;
+    std::vector<uint8_t> buf(sizeof(TraceHeader) + (size_t)records * sizeof(SensorData));
+    size_t n = Trace_Generate(gait, period, records, buf.data(), buf.size());
+    if (!n) {
+        fprintf(stderr, "invalid trace parameters\n");
+        return 1;
+    }
+    FILE* f = fopen(argv[5], "wb");
+    if (!f || fwrite(buf.data(), 1, n, f) != n) {
+        fprintf(stderr, "cannot write %s\n", argv[5]);
+        return 1;
+    }
+    fclose(f);
+    printf("%u records, %zu bytes\n", records, n);
+    return 0;
+}
+
+static int cmdHeader(int argc, char** argv)
+{
+    if (argc < 4) return 1;
+    std::vector<uint8_t> img;
+    if (!readFile(argv[2], img) || !Trace_Validate(img.data(), img.size())) {
+        fprintf(stderr, "invalid trace %s\n", argv[2]);
+        return 1;
+    }
+    FILE* f = fopen(argv[3], "w");
+    if (!f) return 1;
+    fprintf(f, "// Generated by trace_tool from %s\n#pragma once\n#include <stdint.h>\n\n", argv[2]);
+    fprintf(f, "static const uint8_t trace_image[%zu] = {", img.size());
+    for (size_t i = 0; i < img.size(); i++) {
+        fprintf(f, "%s0x%02X,", (i % 16) ? " " : "\n    ", img[i]);
+    }
+    fprintf(f, "\n};\n");
+    fclose(f);
+    return 0;
+}
+
+static int cmdReplay(int argc, char** argv)
+{
+    if (argc < 4) return 1;
+    std::vector<uint8_t> img;
+    const TraceHeader* hdr = nullptr;
+    if (!readFile(argv[2], img) || !(hdr = Trace_Validate(img.data(), img.size()))) {
+        fprintf(stderr, "invalid trace %s\n", argv[2]);
+        return 1;
+    }
+    double speed = atof(argv[3]);
+    double seconds = (argc > 4) ? atof(argv[4]) : 5.0;
+
+    // Replay frame by frame through the host decoder, paced like the device would send them
+    std::vector<uint32_t> ts(1);
+    std::vector<uint8_t> batt(1);
+    std::vector<int16_t> ax(1), ay(1), az(1);
+    std::vector<uint16_t> p[PRESSURE_CHANNEL_COUNT];
+    FrameColumns cols = { 1, ts.data(), batt.data(), ax.data(), ay.data(), az.data(), {}, nullptr, nullptr };
+    for (int c = 0; c < PRESSURE_CHANNEL_COUNT; c++) {
+        p[c].resize(1);
+        cols.pressure[c] = p[c].data();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t frames = 0, load = 0;
+    double elapsed = 0;
+    SensorData rec;
+    while (elapsed < seconds) {
+        Trace_GetRecord(img.data(), (uint32_t)frames, &rec);
+        Decoder_DecodeBatch((const uint8_t*)&rec, sizeof(rec), FRAME_LAYOUT_RAW, cols);
+        load += p[0][0];
+        frames++;
+        if (speed > 0) {
+            auto due = start + std::chrono::duration<double>(frames * hdr->period_ms / 1000.0 / speed);
+            std::this_thread::sleep_until(due);
+        }
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double traceSeconds = frames * hdr->period_ms / 1000.0;
+    printf("%llu frames in %.2f s: %.0f frames/s, %.1f x real time (mean heel load %llu)\n",
+           (unsigned long long)frames, elapsed, frames / elapsed, traceSeconds / elapsed,
+           (unsigned long long)(load / (frames ? frames : 1)));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int ret = 1;
+    if (argc > 1 && !strcmp(argv[1], "gen")) ret = cmdGen(argc, argv);
+    else if (argc > 1 && !strcmp(argv[1], "header")) ret = cmdHeader(argc, argv);
+    else if (argc > 1 && !strcmp(argv[1], "replay")) ret = cmdReplay(argc, argv);
+    if (ret) {
+        fprintf(stderr, "usage: trace_tool gen <stand|walk|run> <seconds> <period_ms> <out.trc>\n"
+                        "       trace_tool header <in.trc> <out.h>\n"
+                        "       trace_tool replay <in.trc> <speed> [seconds]\n");
+    }
+    return ret;
+}
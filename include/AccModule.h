@@ -16,11 +16,24 @@ typedef enum {
     ACC_STATUS_READ_ERROR
 } AccStatus_t;
 
+// Raw ADXL345 LSB (full resolution, 4 mg/LSB) to m/s^2 x 10, Q16: 0.004 * 9.80665 * 10 * 65536
+#define ACC_RAW_TO_MS2X10_Q16   25708
+
+static inline int16_t Acc_RawToMs2x10(int32_t raw)
+{
+    return (int16_t)((raw * ACC_RAW_TO_MS2X10_Q16 + 0x8000) >> 16);
+}
+
 extern int16_t Acc_Array[3];
+extern uint32_t Acc_SampleUs;       // micros() at which the value in Acc_Array was sampled
 extern AccStatus_t Acc_Status;
 
-uint8_t Acc_Init(void);
+// present: addresses that answered on Wire at boot; without the ADXL345 in it there is
+// no probe. NULL probes.
+uint8_t Acc_Init(const uint8_t* present = nullptr, uint8_t presentCount = 0);
 uint8_t Acc_Read(void);
+// Reads every FIFO entry into the filter and Acc_Array; entries read, -1 on an I2C error
+int Acc_DrainFifo(void);
 void Acc_Test(void);
 
 #endif
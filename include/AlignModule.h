@@ -0,0 +1,56 @@
+#ifndef ALIGN_MODULE_H
+#define ALIGN_MODULE_H
+
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' TIMEBASE ALIGNMENT ''''''''''''''''''' //
+// The accelerometer and the pressure channels are converted at different
+// instants of a frame (and slow channels not every frame). Every channel keeps
+// its last two timestamped samples and is linearly interpolated onto the
+// frame's nominal instant, so all values of one frame describe the same moment.
+// Channels not converted this frame are extrapolated along their last slope,
+// by no more than one sample spacing or ALIGN_MAX_EXTRAPOLATE_US, then held.
+// Results are clamped to what the frame fields hold (pressure: the ADS1115's
+// 0..ALIGN_PRESSURE_MAX, accel: int16), so a steep fall extrapolated past zero
+// reads 0, never a wrapped value or PRESSURE_VALUE_DOWN.
+// The resampler builds on the host; Align_Apply() is the firmware glue.
+
+// Channel numbering: pressure slots first, then the three accel axes
+#define ALIGN_CH_ACC_X          PRESSURE_CHANNEL_COUNT
+#define ALIGN_CHANNEL_COUNT     (PRESSURE_CHANNEL_COUNT + 3)
+
+#define ALIGN_PRESSURE_MAX      0x7FFF  // single-ended ADS1115 conversions are never negative
+
+// Forgets all history
+void Align_Reset(void);
+
+/**
+ * @brief Adds one sample of a channel. A sample with the timestamp of the
+ *        channel's newest sample is ignored, so unchanged values can be pushed every frame.
+ * @param t_us acquisition instant [us, micros() timebase, wraps]
+ */
+void Align_Push(uint8_t channel, int32_t value, uint32_t t_us);
+
+/**
+ * @brief Value of one channel at instant t_us, clamped to the channel's range.
+ * @return false if the channel has no sample yet (out is left untouched)
+ */
+bool Align_Sample(uint8_t channel, uint32_t t_us, int32_t* out);
+
+/**
+ * @brief Largest |t_us - newest sample instant| over all channels with samples,
+ *        i.e. how far the unaligned frame was spread in time [us].
+ */
+uint32_t Align_MaxSkewUs(uint32_t t_us);
+
+#ifdef ARDUINO
+/**
+ * @brief Pushes the current Pressure_Array / Acc_Array values with their
+ *        sample instants and overwrites them with the values at frameUs.
+ */
+void Align_Apply(uint32_t frameUs);
+#endif
+
+#endif // ALIGN_MODULE_H
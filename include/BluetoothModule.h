@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "CommonTypes.h"
+#include "LinkModule.h"
 
 // /////////////////////////////////////////////////////////////////
 // ''''''' BLE ''''''''''''''''''' //
@@ -22,10 +23,13 @@
 #define ADVERTISING_INTERVAL_MAX 0x100 // 0x100 * 0.625ms = ~160ms
 
 // ------------------------------
-// Advertising intervals PREFERRED
+// Preferred connection interval range, advertised in the scan response (1.25 ms units)
 // ------------------------------
-#define ADVERTISING_INTERVAL_MIN_PREFERRED 0x06  // Suggested parameters for iphone
-#define ADVERTISING_INTERVAL_MAX_PREFERRED 0x12 // Suggested parameters for iphone
+#define ADVERTISING_INTERVAL_MIN_PREFERRED LINK_FAST_INTERVAL_MIN  // 0x06 = 7.5 ms, suggested parameters for iphone
+#define ADVERTISING_INTERVAL_MAX_PREFERRED LINK_FAST_INTERVAL_MAX  // 0x12 = 22.5 ms
+
+// ATT MTU offered to the central; larger MTUs let packed frames share a notification
+#define BLE_PREFERRED_MTU 185
 
 // Add configurable parameter for power:
 #define BLE_TX_POWER ESP_PWR_LVL_P9
@@ -39,10 +43,46 @@ static const char* INSOLE_NAME_LEFT  = "Insole Left";
 // Right-Side UUIDs
 static const char* SERVICE_UUID_RIGHT        = "4276d6a5-3c2e-494a-bee2-0357f0c8e7f1";
 static const char* CHARACTERISTIC_UUID_RIGHT = "af4ce09f-721e-459b-9ba5-b1a743073afa";
+static const char* CONTROL_UUID_RIGHT        = "af4ce0a0-721e-459b-9ba5-b1a743073afa";
+static const char* BURST_UUID_RIGHT          = "af4ce0a1-721e-459b-9ba5-b1a743073afa";
+static const char* STATS_UUID_RIGHT          = "af4ce0a2-721e-459b-9ba5-b1a743073afa";
+static const char* SELFTEST_UUID_RIGHT       = "af4ce0a3-721e-459b-9ba5-b1a743073afa";
 
 // Left-Side UUIDs
 static const char* SERVICE_UUID_LEFT         = "e59f97e5-31c5-4d8c-bd07-27b9c0284d31";
 static const char* CHARACTERISTIC_UUID_LEFT  = "10480c36-db9c-476a-8ecf-129aa85243b8";
+static const char* CONTROL_UUID_LEFT         = "10480c37-db9c-476a-8ecf-129aa85243b8";
+static const char* BURST_UUID_LEFT           = "10480c38-db9c-476a-8ecf-129aa85243b8";
+static const char* STATS_UUID_LEFT           = "10480c39-db9c-476a-8ecf-129aa85243b8";
+static const char* SELFTEST_UUID_LEFT        = "10480c3a-db9c-476a-8ecf-129aa85243b8";
+
+// ------------------------------
+// Control characteristic (write: command, read: current link settings)
+// ------------------------------
+// SET_FORMAT: [0x01][format][shift, 0xFF = format default][frames per notification, 0 = as many as fit]
+// FRAME_FMT_DELTA ignores the shift; frames per notification counts frames actually sent.
+// A count the granted link cannot carry at the stream's rate is raised until it can (up to what
+// fits); delta streams measure their rate and frame size over each LINK_MEASURE_MS.
+#define BLE_CMD_SET_FORMAT      0x01
+// SET_DELTA: [0x02][pressure deadband LE16][accel deadband][keyframe interval LE16][max silence]
+//            Deadbands apply to all channels of a kind, intervals are in frames (0 = off).
+//            Rejected when neither interval keeps a gap within 255 frames (the sequence byte).
+#define BLE_CMD_SET_DELTA       0x02
+// SELFTEST: [0x03] runs the performance self-test (SelfTestModule.h); its notify phase sends
+//           filler notifications on the self-test characteristic if the central subscribed
+//           to it (never on the stream), the report goes to the log
+#define BLE_CMD_SELFTEST        0x03
+// BURST_TRIGGER: [0x04] captures a burst window around now (BurstModule.h); the chunks are
+//                notified on the burst characteristic, the stream goes on
+#define BLE_CMD_BURST_TRIGGER   0x04
+// STATS_RESET: [0x05] starts a new statistics session (StatsModule.h);
+//              [0x05][pressure threshold LE16][accel magnitude threshold LE16] also sets the
+//              time-above thresholds (ADC counts, m/s^2 x 10)
+#define BLE_CMD_STATS_RESET     0x05
+// Read value: [format][shift][frames per notification][MTU lo][MTU hi]
+#define BLE_CONTROL_READ_SIZE   5
+
+// Stats characteristic: write [page] to select, read returns that page (StatsModule.h)
 
 
 
@@ -62,9 +102,19 @@ bool BLE_Init(bool FlagSide);
 /**
  * @brief Sends a 39-byte message immediately via BLE (if connected).
  * @param msg A pointer to the 39-byte array to send
- * @return true if successfully sent, false if not connected
+ * @return true if sent (or batched for the next notification), false if not connected
+ *         or the notification had to wait in the retry ring for a TX buffer
  */
 bool BLE_SendBuffer(SensorData* sensor_msg);
+
+/**
+ * @brief Sends a frame that is already in wire format (e.g. a frame pool slot)
+ *        without copying it first.
+ * @param info validity and ADS1115 health of the frame, sent along by the packed
+ *             and delta formats; NULL => every channel fresh
+ * @return true if successfully sent, false if not connected
+ */
+bool BLE_SendFrame(const uint8_t* frame, size_t len, const SensorFrameInfo* info);
 /**
  * @brief A unit test for the Bluetooth module. Initializes BLE
  *        (using "Insole Right" as an example) and sends a 39-byte test message.
@@ -74,4 +124,47 @@ void BLE_Test(void);
 bool Get_BLE_Connected_Status(void);
 
 uint8_t BLE_GetNumOfSubscribers(void);
+
+/**
+ * @brief Uploads a captured burst window (BurstModule.h) a few chunks per call, between
+ *        stream frames. Releases the window once it is sent or nobody listens for it.
+ *        Call from the communication task.
+ */
+void BLE_ServiceBurst(void);
+
+/**
+ * @brief Resends the notifications waiting in the retry ring while TX buffers are free.
+ *        No callback announces a freed buffer, so call from the communication task on
+ *        every wake.
+ * @return notifications still waiting; wake again within RETX_POLL_MS while non-zero
+ */
+uint16_t BLE_ServiceRetx(void);
+
+// Logs the notification retry counters since the connection started (RetransmitModule.h)
+void BLE_PrintRetxSummary(void);
+
+// ATT MTU negotiated with the central (23 until it asks for more)
+uint16_t BLE_GetPeerMtu(void);
+
+/**
+ * @brief Measures the stream load and asks the central for the connection parameters
+ *        of the matching profile (LinkModule.h). Call from the communication task.
+ */
+void BLE_ServiceLink(void);
+
+// What the granted connection parameters carry; false if nobody is connected
+bool BLE_GetLinkCapacity(LinkCapacity_t* cap);
+
+// Logs the granted parameters, their capacity and the stream load
+void BLE_PrintLinkSummary(void);
+
+// Notification payload of the self-test characteristic, 0 if the central is not subscribed to it
+uint16_t BLE_GetSelfTestPayload(void);
+
+/**
+ * @brief Sends self-test filler as one notification on the self-test characteristic,
+ *        so it never reaches a stream decoder.
+ * @return false if nobody is subscribed to it or the stack has no buffer free
+ */
+bool BLE_NotifySelfTest(const uint8_t* data, size_t len);
 #endif // BLUETOOTH_MODULE_H
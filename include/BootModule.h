@@ -0,0 +1,47 @@
+#ifndef BOOT_MODULE_H
+#define BOOT_MODULE_H
+
+#include <Arduino.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' FAST BOOT ''''''''''''''''''' //
+// Boot-phase timing and the NVS-cached I2C device map. With a valid cache only
+// the known addresses are probed; the full 126-address scan runs on first boot,
+// after a config/firmware change, or when a cached device stops answering.
+
+#define BOOT_MAX_PHASES         16
+#define BOOT_MAX_I2C_DEVICES    16
+
+#define BOOT_NVS_NAMESPACE      "boot"
+#define BOOT_NVS_KEY_DEVMAP     "devmap"
+#define BOOT_DEVMAP_MAGIC       0x50414D44u     // "DMAP"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t configHash;                    // firmware build and sensor configuration the map belongs to
+    uint8_t  count;
+    uint8_t  addr[BOOT_MAX_I2C_DEVICES];    // 7-bit addresses that answered
+} BootDeviceMap_t;
+
+// Records the end of a boot phase (time since reset); safe from any task
+void Boot_MarkPhase(const char* name);
+
+// First frame published by SensorTask / first notification the stack accepted; only the first call counts
+void Boot_MarkFirstFrame(void);
+void Boot_MarkFirstNotify(void);
+
+// Logs every phase with its duration and the time-to-first-frame milestones reached so far
+void Boot_PrintReport(void);
+
+/**
+ * @brief Finds the I2C devices, from the NVS cache when it is still valid.
+ * @param map Filled with the devices found
+ * @return true if the cache was used, false if a full scan was needed
+ */
+bool Boot_DiscoverI2C(BootDeviceMap_t* map);
+
+// Drops the cached map so the next boot runs the full scan
+void Boot_InvalidateDeviceMap(void);
+
+#endif // BOOT_MODULE_H
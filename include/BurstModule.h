@@ -0,0 +1,100 @@
+#ifndef BURST_MODULE_H
+#define BURST_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' BURST CAPTURE ''''''''''''''''''' //
+// Every raw conversion the drivers hand to the decimation filter is also
+// written to a pre-allocated RAM ring, so the last BURST_RING_RECORDS samples
+// are kept at the full scan / FIFO rate. A trigger (accel magnitude, pressure
+// slope on any channel, or a command) keeps recording for BURST_POST_MS and
+// then freezes the ring; the window from BURST_PRE_MS before the trigger is
+// uploaded in chunks while the 50 Hz stream goes on. Recording resumes once
+// the upload is released, so triggers while frozen are ignored.
+// The ring, the triggers and the chunk encoder build on the host.
+//
+// Upload chunks: [index LE16][count LE16] + body
+//   chunk 0:  [source][record count LE32][trigger us LE32][pre ms LE16][post ms LE16][channels]
+//   others:   records of BURST_WIRE_RECORD_SIZE bytes: [t - trigger, us, LE32 signed][channel]
+//             [value LE16] x 3 (accel x/y/z; pressure uses the first, the others are 0)
+
+#define BURST_CH_ACC                PRESSURE_CHANNEL_COUNT     // channel number of accel records
+#define BURST_CHUNK_HEADER_SIZE     4
+#define BURST_META_SIZE             14
+#define BURST_WIRE_RECORD_SIZE      11
+
+typedef enum {
+    BURST_TRIG_NONE = 0,
+    BURST_TRIG_ACCEL,
+    BURST_TRIG_PRESSURE,
+    BURST_TRIG_COMMAND
+} BurstTrigger_t;
+
+typedef enum {
+    BURST_ARMED = 0,            // recording, waiting for a trigger
+    BURST_POST,                 // triggered, recording the post window
+    BURST_FROZEN                // window complete, waiting for the upload
+} BurstState_t;
+
+typedef struct {
+    uint32_t t_us;
+    uint8_t  channel;           // pressure frame slot or BURST_CH_ACC
+    int16_t  v[3];
+} BurstRecord_t;
+
+typedef struct {
+    BurstTrigger_t source;
+    uint32_t triggerUs;
+    uint32_t count;             // records in the window
+    uint32_t firstUs;           // oldest record, later than triggerUs - pre if the ring was short
+    uint32_t lastUs;
+} BurstWindow_t;
+
+typedef struct {
+    uint32_t triggers;          // windows captured
+    uint32_t ignored;           // triggers while a window was pending
+    uint32_t uploaded;
+} BurstStats_t;
+
+// Empties the ring and arms the trigger
+void Burst_Reset(void);
+
+// Driver taps, same arguments as Filter_PushPressure() / Filter_PushAcc()
+void Burst_PushPressure(uint8_t channel, int16_t raw, uint32_t t_us);
+void Burst_PushAcc(int16_t x, int16_t y, int16_t z, uint32_t t_us);
+
+// Command trigger; safe from any task, taken at the next pushed sample
+void Burst_Request(void);
+
+/**
+ * @brief Freezes a post window that no sample closed (sensors stopped delivering).
+ * @param now_us current time on the samples' timebase
+ */
+void Burst_Poll(uint32_t now_us);
+
+BurstState_t Burst_GetState(void);
+
+// Window of a frozen capture; false unless BURST_FROZEN
+bool Burst_GetWindow(BurstWindow_t* window);
+
+// i-th record of the frozen window, oldest first
+const BurstRecord_t* Burst_GetRecord(uint32_t index);
+
+// Upload chunks of the frozen window for a notification payload size, 0 if not frozen
+uint16_t Burst_ChunkCount(size_t payload);
+
+/**
+ * @brief Encodes one upload chunk of the frozen window.
+ * @return bytes written, 0 if not frozen, index out of range or payload too small
+ */
+size_t Burst_EncodeChunk(uint16_t index, uint8_t* out, size_t payload);
+
+// Ends the upload (done or abandoned) and resumes recording
+void Burst_Release(void);
+
+void Burst_GetStats(BurstStats_t* stats);
+
+#endif // BURST_MODULE_H
@@ -2,9 +2,12 @@
 #define COMMON_TYPES_H
 
 #include <stdint.h>  // For fixed-width integer types (e.g., uint8_t, int16_t)
+#include "SensorTopology.h"
+#ifdef ARDUINO  // also compiled into the host tools under host/
 extern "C" {
   #include "esp_task_wdt.h"
 }
+#endif
 
 
 // Common error definitions (shared across modules)
@@ -16,7 +19,8 @@ extern "C" {
 #define ERR_BATTERY_OVERVOLT       0x05
 #define ERR_BATTERY_UNDERVOLT      0x06
 
-
+// Number of pressure channels carried in every frame, set by the insole variant
+#define PRESSURE_CHANNEL_COUNT     INSOLE_SENSOR_COUNT
 
 
 #pragma pack(push, 1)  // Disable struct padding
@@ -25,8 +29,21 @@ typedef struct {
     int16_t accel_x;      // 2 bytes
     int16_t accel_y;      // 2 bytes
     int16_t accel_z;      // 2 bytes
-    uint16_t pressure[16]; // 16 × 2 bytes = 32 bytes
-} SensorData;             // Total size: 1 + 2 + 2 + 2 + 32 = 39 bytes
+    uint16_t pressure[PRESSURE_CHANNEL_COUNT]; // 16 × 2 bytes = 32 bytes
+} SensorData;             // Total size: 1 + 2 + 2 + 2 + 32 = 39 bytes (16-sensor insole)
 #pragma pack(pop)        // Restore default struct padding
 
+static_assert(sizeof(SensorData) == ActiveTopology::FrameSize, "SensorData must match the topology frame size");
+
+// pressure[n] of an ADS1115 that is down; conversions are never negative, so never above 0x7FFF
+#define PRESSURE_VALUE_DOWN        0xFFFF
+
+// Per-frame side information, kept next to SensorData but not part of the 39-byte BLE payload
+typedef struct {
+    PressureMask_t pressure_valid;                 // bit n set => pressure[n] was converted during this frame
+    uint8_t  pressure_age[PRESSURE_CHANNEL_COUNT]; // frames since pressure[n] was last converted (saturates at 255)
+    uint8_t  adc_healthy;                          // bit n set => ADS1115 n is in the scan (up to 8 ADCs)
+    uint32_t sample_us;                            // micros() when the sensor reads for this frame started
+} SensorFrameInfo;
+
 #endif // COMMON_TYPES_H
@@ -1,6 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "SensorTopology.h"   // INSOLE_SENSOR_COUNT selects the per-variant tables below
+
 // /////////////////////////////////////////////////////////////////
 // ''''''' General watchdog ''''''''''''''''''' //
 //  Watchdog period, 10 seconds for each stage, 
@@ -14,10 +16,26 @@
 #define g_sideFlag 0 // 0 => left, 1 => right
 #define testDeviceBLE 0 // if device is used for BLE tests, set this flag to 1
 
+// Test-device mode replays a trace instead of reading the sensors (see TraceModule.h).
+// Build with -DTRACE_FLASH_HEADER=\"trace.h\" (from host/tools/trace_tool) to replay a recorded
+// session from flash, otherwise a synthetic gait is generated.
+#define TRACE_REPLAY_GAIT   TRACE_GAIT_WALK
+#define TRACE_REPLAY_SPEED  1   // 1 => real time, N => sensor and BLE loops run N times faster
+
+
+// Fast boot: probe the I2C device map cached in NVS instead of scanning every address,
+// and bring BLE up in its own task while the sensors initialize (see BootModule.h)
+#define FAST_BOOT_ENABLED          1
+#define BOOT_BLE_TASK_STACK_SIZE   8192
+#define BOOT_BLE_TIMEOUT_MS        5000    // BLE bring-up taking longer is logged; the tasks still wait for it
+
 
 // I2C pins (ESP32)
 #define I2C_SCL_Pin     22
 #define I2C_SDA_Pin     21
+// Second bus, only brought up by topologies with more than four ADS1115s (32-sensor insole)
+#define I2C1_SCL_Pin    32
+#define I2C1_SDA_Pin    33
 
 
 // /////////////////////////////////////////////////////////////////
@@ -48,6 +66,21 @@
 
 // Logger task stack size
 #define LOGGER_TASK_STACK_SIZE   16384
+#define LOGGER_TASK_PRIORITY     1      // below SensorTask (2): logging never preempts sampling
+
+// Log sinks (see LogSinkModule.h)
+#define LOGGER_UART_ENABLED         1
+#define LOGGER_RAM_RING_ENABLED     1       // mirror log lines into RTC RAM for post-mortem dumps
+#define LOGGER_UART_BAUD            921600  // keep monitor_speed in platformio.ini in sync
+#define LOGGER_UART_TX_BUFFER_SIZE  4096    // UART driver TX ring
+#define LOGGER_RAM_RING_SIZE        2048    // bytes, lives in 8 KB RTC slow memory
+#define LOGGER_SINK_RETRY_MS        5       // how long the logger task waits for sink space before dropping a line
+#define LOGGER_DROP_REPORT_MS       1000    // period of the "dropped N lines" report, 0 => off
+
+// Per-level rate limit: token bucket refilled at RATE lines/s, holding up to BURST lines. 0 => unlimited.
+// Index = level (NA, ERROR, WARN, INFO, DEBUG, VERBOSE)
+#define LOGGER_RATE_LIMIT_PER_S     { 0, 0, 50, 50, 100, 100 }
+#define LOGGER_RATE_LIMIT_BURST     { 0, 0, 20, 20,  40,  40 }
 
 
 
@@ -55,6 +88,7 @@
 #define DEFAULT_LOOP_INTERVAL_MS   20      // sensor loop: 100 Hz
 #define DEBUG_LOOP_INTERVAL_MS   500      // sensor loop: 100 Hz
 #define PRINT_INTERVAL      1000     // Print every 1000 ms if serial is enabled
+#define MEMORY_REPORT_INTERVAL_MS  10000   // stack/heap and latency report from loop(), 0 => disabled
 
 
 #ifdef LOG_LEVEL_SELECTED
@@ -67,6 +101,15 @@
     #define LOOP_INTERVAL_MS   DEFAULT_LOOP_INTERVAL_MS          // Default: 50 Hz if LOG_LEVEL not defined
 #endif
 
+// Period of the sensor/BLE tasks; trace replay at N x speed shortens it accordingly
+#if testDeviceBLE && (LOOP_INTERVAL_MS / TRACE_REPLAY_SPEED) > 0
+    #define TASK_LOOP_INTERVAL_MS   (LOOP_INTERVAL_MS / TRACE_REPLAY_SPEED)
+#elif testDeviceBLE
+    #define TASK_LOOP_INTERVAL_MS   1
+#else
+    #define TASK_LOOP_INTERVAL_MS   LOOP_INTERVAL_MS
+#endif
+
 
 
 // /////////////////////////////////////////////////////////////////
@@ -81,5 +124,103 @@
 // BLE task stack size
 #define SENSOR_TASK_STACK_SIZE   16384
 
+// Pressure scan scheduler
+// Each scan tick starts one conversion on every ADS1115 in parallel (860 SPS => ~1.2 ms + I2C),
+// so 6 ticks fit comfortably in one 20 ms sensor loop => 300 conversion slots/s per ADS1115.
+#define PRESSURE_SCAN_TICKS_PER_FRAME   6
+#define PRESSURE_SCAN_MAX_SEQ_LEN       300     // max length of the interleaved mux sequence per ADS1115
+#define PRESSURE_CONV_TIMEOUT_US        3000    // give up on a conversion after 3 ms
+
+// ADS1115 health: a device is taken out of the scan after this many failed conversions in a row
+// and re-initialized in the background with exponential backoff
+#define PRESSURE_MAX_CONSECUTIVE_ERRORS 3
+#define PRESSURE_REINIT_BACKOFF_MIN_MS  100
+#define PRESSURE_REINIT_BACKOFF_MAX_MS  5000
+
+// Requested sample rate per pressure sensor [Hz], indexed by frame slot (see SensorTopology.h).
+// Each quarter of the frame is one zone: heel, arch, metatarsal heads, toes.
+// Rates above the per-ADS1115 slot budget are scaled down, unused slots skip the I2C transaction.
+#if INSOLE_SENSOR_COUNT == 8
+#define PRESSURE_CHANNEL_RATES_HZ { \
+    200,  50,             /* heel       */ \
+     25,  25,             /* arch       */ \
+    100,  50,             /* met heads  */ \
+     50,  25              /* toes       */ }
+#elif INSOLE_SENSOR_COUNT == 32
+#define PRESSURE_CHANNEL_RATES_HZ { \
+    200, 200,  50,  50,  25,  25,  25,  25,   /* heel       */ \
+     25,  25,  25,  25,  25,  25,  25,  25,   /* arch       */ \
+    100, 100, 100, 100,  50,  50,  50,  50,   /* met heads  */ \
+     50,  50,  50,  50,  25,  25,  25,  25    /* toes       */ }
+#else
+#define PRESSURE_CHANNEL_RATES_HZ { \
+    200,  50,  25,  25,   /* heel       */ \
+     25,  25,  25,  25,   /* arch       */ \
+    100, 100,  50,  50,   /* met heads  */ \
+     50,  50,  25,  25    /* toes       */ }
+#endif
+
+// Oversampling / decimation stage between the drivers and PackSensorData()
+#define DSP_DECIMATION_ENABLED   1      // 0 => frames carry the latest raw sample only
+#define DSP_MAX_SAMPLES_PER_FRAME 64    // samples averaged per channel and frame, extra samples are dropped
+
+// Resample every channel onto the frame's start instant (SensorFrameInfo.sample_us), see AlignModule.h
+#define ALIGN_ENABLED            1      // 0 => each channel keeps its own sample instant
+#define ALIGN_MAX_EXTRAPOLATE_US (LOOP_INTERVAL_MS * 1000)  // slow channels are projected at most one frame ahead
+
+// Send-on-delta stream (FRAME_FMT_DELTA, see DeltaModule.h); intervals count frames of LOOP_INTERVAL_MS
+#define DELTA_PRESSURE_DEADBAND  64     // ADC counts a pressure channel may drift before it is re-sent
+#define DELTA_ACCEL_DEADBAND     3      // m/s^2 x 10
+#define DELTA_KEYFRAME_INTERVAL  50     // full frame every second, heals lost notifications
+#define DELTA_MAX_SILENCE        10     // empty heartbeat after 200 ms without a notification
+
+// Notifications refused by the BLE stack are retried in order (RetransmitModule.h)
+#define RETX_ENABLED                1
+#define RETX_BUFFER_SLOTS           16      // x 185 B; a full ring drops its oldest entry
+#define RETX_POLL_MS                5       // comm task wake while notifications wait; under the 7.5 ms shortest interval
+
+// Connection parameters follow the load (LinkModule.h)
+#define LINK_MANAGER_ENABLED        1
+#define LINK_MEASURE_MS             1000    // load window; the profile is re-checked after each
+#define LINK_MAX_LOAD_PCT           60      // the power profile is kept while the stream needs at most this share of it
+#define LINK_STEP_DOWN_MS           5000    // a lower profile must be enough this long before it is requested
+#define LINK_REQUEST_TIMEOUT_MS     2000    // wait for the central's answer before asking again
+#define LINK_MAX_REQUESTS           3       // per profile change; then the central's parameters stand
+#define LINK_MAX_PACKETS_PER_EVENT  4       // LL packets the central takes per connection event
+#define LINK_EVENT_USE_PCT          75      // share of the interval the controller fills
+
+// Burst capture (BurstModule.h): raw samples at the full scan / FIFO rate around a trigger
+#define BURST_ENABLED               1
+#define BURST_RING_RECORDS          2048    // x 12 B, power of two; ~0.6 s at 32 sensors + accel
+#define BURST_PRE_MS                300     // kept before the trigger
+#define BURST_POST_MS               200     // recorded after the trigger
+#define BURST_ACCEL_TRIGGER_MG      6000    // accel magnitude, 1 g at rest
+#define BURST_PRESSURE_SLOPE        800     // rising ADC counts per ms on any channel, 0 => off
+#define BURST_CHUNKS_PER_FRAME      4       // upload notifications per comm frame, next to the stream
+
+// Session statistics over the sent frames (StatsModule.h)
+#define STATS_ENABLED               1
+#define STATS_PRESSURE_THRESHOLD    4000    // ADC counts; time at or above it is totalled per channel
+#define STATS_ACCEL_THRESHOLD       196     // accel magnitude, m/s^2 x 10 (2 g)
+#define STATS_MAX_GAP_MS            (2 * LOOP_INTERVAL_MS)  // longer gaps (no subscriber) count as this
+
+// Wired lab capture (SerialStreamModule.h): binary frame + log packets on the USB UART
+#define SERIAL_STREAM_ENABLED       0       // 1 => frames stream without a BLE subscriber, log lines become packets
+#define SERIAL_STREAM_BAUD          921600  // 2000000 with a CP2102N/CH343 bridge; serial_capture --baud must match
+#define SERIAL_STREAM_TX_BUFFER_SIZE 8192   // UART driver TX ring, ~90 ms at 921600
+#define SERIAL_STREAM_HELLO_MS      1000    // frame layout announcement for late receivers
+
+// Performance self-test (SelfTestModule.h): pass/fail limits
+#define SELFTEST_ON_BOOT            0       // 1 => run once at boot, before streaming starts
+#define SELFTEST_POLL_MS            100     // loop() checks for serial/BLE requests this often
+#define SELFTEST_PAUSE_TIMEOUT_MS   (4 * LOOP_INTERVAL_MS)  // SensorTask acknowledges the pause within this
+#define SELFTEST_PHASE_MS           500     // per phase, every ADS1115 gets its own
+#define SELFTEST_MIN_ADS_SPS        600     // single-shot conversions/s per ADS1115 (860 SPS nominal)
+#define SELFTEST_MAX_LATENCY_US     2500    // slowest conversion incl. I2C (1163 us conversion)
+#define SELFTEST_MAX_I2C_ERROR_PPM  1000
+#define SELFTEST_MIN_ACC_DRAIN_HZ   2400    // FIFO entries/s of bus time, 3x the 800 Hz ODR
+#define SELFTEST_MIN_FRAME_HZ       (1000 / DEFAULT_LOOP_INTERVAL_MS)   // per-frame path keeps up with the streaming rate
+#define SELFTEST_MIN_NOTIFY_BPS     4000    // 2x the legacy stream at 50 frames/s
+
 
 #endif // CONFIG_H
@@ -0,0 +1,93 @@
+#ifndef DELTA_MODULE_H
+#define DELTA_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' SEND-ON-DELTA ''''''''''''''''''' //
+// Stateful FRAME_FMT_DELTA stream. A channel is only sent when it moved more
+// than its deadband away from the value the receiver holds, so the receiver
+// is never off by more than the deadband. Frames in which nothing moved are
+// not sent at all; the sequence byte tells the receiver how many frames
+// passed. Keyframes carry every channel at a fixed interval (and after any
+// reconfiguration) so a lost notification heals, and an empty heartbeat
+// goes out when the link has been silent for too long.
+//
+//   keyframe: [FRAME_FMT_DELTA:4 | DELTA_KIND_KEY:4] [seq] [battery] [accel x,y,z LE] [pressure LE x N]
+//             [ADS1115 health]
+//   delta:    [FRAME_FMT_DELTA:4 | DELTA_KIND_DELTA:4] [seq] [changed mask, LSB first]
+//             [changed values in channel order: pressure/accel LE16, battery and health 1 byte]
+//
+// ADS1115 health (SensorFrameInfo.adc_healthy) is a channel with no deadband,
+// so the receiver learns in the same frame that a device went down and its
+// pressure values stopped being readings. A held value of a cold channel
+// never moves, so per-frame validity is not sent; the packed formats carry it.
+//
+// Several delta frames may be concatenated into one notification. The same
+// code builds on the host for reconstruction.
+
+// Channel numbering: pressure slots, accel x/y/z, battery, ADS1115 health
+#define DELTA_CH_ACC_X          PRESSURE_CHANNEL_COUNT
+#define DELTA_CH_BATTERY        (PRESSURE_CHANNEL_COUNT + 3)
+#define DELTA_CH_HEALTH         (PRESSURE_CHANNEL_COUNT + 4)
+#define DELTA_CHANNEL_COUNT     (PRESSURE_CHANNEL_COUNT + 5)
+#define DELTA_MASK_BYTES        ((DELTA_CHANNEL_COUNT + 7) / 8)
+
+#define DELTA_KIND_DELTA        0
+#define DELTA_KIND_KEY          1
+
+#define DELTA_KEYFRAME_SIZE     (2 + sizeof(SensorData) + 1)
+#define DELTA_MAX_FRAME_SIZE    (2 + DELTA_MASK_BYTES + sizeof(SensorData) + 1)
+
+typedef struct {
+    // Settings
+    uint16_t deadband[DELTA_CHANNEL_COUNT]; // largest change that is not sent
+    uint16_t keyframeInterval;              // frames between keyframes, 0 => only on request
+    uint8_t  maxSilence;                    // frames without output before a heartbeat, 0 => none
+                                            // (then keyframes must keep gaps within the 8-bit seq)
+    // State
+    int32_t  ref[DELTA_CHANNEL_COUNT];      // value the receiver holds
+    uint16_t sinceKey;
+    uint8_t  sinceSent;
+    uint8_t  seq;
+    bool     needKey;
+} DeltaEncoder_t;
+
+typedef struct {
+    SensorData current;                     // reconstructed frame
+    uint8_t adcHealthy;                     // reconstructed ADS1115 health
+    uint8_t lastSeq;
+    bool    synced;                         // a keyframe has arrived
+} DeltaDecoder_t;
+
+// Encoder with the Config.h deadbands and intervals; the next frame is a keyframe
+void Delta_InitEncoder(DeltaEncoder_t* enc);
+
+// Makes the next frame a keyframe (new subscriber, settings change). Delta_Encode moves
+// the reference as soon as it encodes, so the caller also forces one when an encoded
+// frame never reaches the receiver.
+void Delta_ForceKeyframe(DeltaEncoder_t* enc);
+
+/**
+ * @brief Encodes one frame; call once per frame period, also when nothing is expected to be sent.
+ * @param info ADS1115 health of the frame, NULL => every device up
+ * @param out  must hold DELTA_MAX_FRAME_SIZE bytes
+ * @return bytes written, 0 if the frame is suppressed (or out is too small, state is then unchanged)
+ */
+size_t Delta_Encode(DeltaEncoder_t* enc, const SensorData* in, const SensorFrameInfo* info,
+                    uint8_t* out, size_t outLen);
+
+void Delta_InitDecoder(DeltaDecoder_t* dec);
+
+/**
+ * @brief Applies one encoded frame to the reconstruction.
+ * @param out     reconstructed frame after this one (dec->current; health in dec->adcHealthy)
+ * @param elapsed frame periods since the previous decoded frame; the ones in
+ *                between repeat the previous reconstruction. 0 while not synced.
+ * @return bytes consumed, 0 if the input is malformed or truncated
+ */
+size_t Delta_Decode(DeltaDecoder_t* dec, const uint8_t* in, size_t len, SensorData* out, uint8_t* elapsed);
+
+#endif // DELTA_MODULE_H
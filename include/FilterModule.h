@@ -0,0 +1,38 @@
+#ifndef FILTER_MODULE_H
+#define FILTER_MODULE_H
+
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' DECIMATION FILTER ''''''''''''''''''' //
+// The drivers push every oversampled conversion here, and once per frame the
+// filter dumps a fixed-point first-order CIC (integrate-and-dump) average
+// per channel into Pressure_Array / Acc_Array. State is kept as
+// structure-of-arrays so the dump loop auto-vectorizes on the host build.
+
+// Clears all accumulators
+void Filter_Reset(void);
+
+// One pressure conversion, channel index = frame slot (ActiveTopology::sensorOf), t_us = sample instant
+void Filter_PushPressure(uint8_t channel, int16_t raw, uint32_t t_us);
+
+// One accelerometer sample in raw ADXL345 LSB
+void Filter_PushAcc(int16_t x, int16_t y, int16_t z, uint32_t t_us);
+
+/**
+ * @brief Decimates the samples pushed since the last call down to one value per channel.
+ *        Channels without new samples keep their previous value.
+ *        An average is stamped with the mean instant of its samples.
+ * @param pressureOut   PRESSURE_CHANNEL_COUNT outputs
+ * @param accRawOut     3 outputs in raw ADXL345 LSB
+ * @param pressureUsOut PRESSURE_CHANNEL_COUNT sample instants, updated with pressureOut
+ * @param accUsOut      sample instant of accRawOut, updated with it
+ * @return bitmask of pressure channels that received at least one sample
+ */
+PressureMask_t Filter_Decimate(uint16_t* pressureOut, int16_t* accRawOut, uint32_t* pressureUsOut, uint32_t* accUsOut);
+
+// Runs Filter_Decimate() into Pressure_Array / Pressure_SampleUs and Acc_Array (converted to m/s^2 x 10) / Acc_SampleUs
+void Filter_Apply(void);
+
+#endif // FILTER_MODULE_H
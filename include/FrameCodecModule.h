@@ -0,0 +1,86 @@
+#ifndef FRAME_CODEC_MODULE_H
+#define FRAME_CODEC_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' FRAME CODEC ''''''''''''''''''' //
+// Selectable on-air pressure resolution. The legacy format is the plain
+// 39-byte SensorData. Packed formats start with a header byte naming the
+// format and the scaling shift, followed by battery, accel, the frame status
+// and the 16 pressure values right-shifted and packed LSB-first into `bits` each:
+//
+//   [fmt:4 | shift:4] [battery] [accel x,y,z LE] [status] [pressure bitstream]
+//
+// The status is the SensorFrameInfo a receiver needs to tell a fresh value
+// from a held one: one byte of ADS1115 health (bit n => device n is in the
+// scan) and the pressure valid mask (bit n => pressure[n] was converted for
+// this frame), LSB first. A channel's age is the number of frames since its
+// valid bit was last set. Several packed frames may be concatenated into one
+// notification.
+//
+// Channels of an ADS1115 that is down carry PRESSURE_VALUE_DOWN, never a 0
+// that looks like an unloaded sensor. That is the only status a legacy frame
+// has room for; packed frames saturate it and decode it back from the health byte.
+
+typedef enum {
+    FRAME_FMT_LEGACY16 = 0,     // 39-byte SensorData, no header
+    FRAME_FMT_PACKED16 = 1,
+    FRAME_FMT_PACKED12 = 2,
+    FRAME_FMT_PACKED10 = 3,
+    FRAME_FMT_PACKED8  = 4,
+    FRAME_FMT_COUNT,            // fixed-size formats end here
+    FRAME_FMT_DELTA    = 8      // stateful send-on-delta stream, see DeltaModule.h
+} FrameFormat_t;
+
+#define FRAME_STATUS_SIZE           (1 + (PRESSURE_CHANNEL_COUNT + 7) / 8)  // ADS1115 health, valid mask
+#define FRAME_PACKED_HEADER_SIZE    (8 + FRAME_STATUS_SIZE)                 // header, battery, 3 x accel, status
+#define FRAME_CODEC_MAX_SIZE        (FRAME_PACKED_HEADER_SIZE + PRESSURE_CHANNEL_COUNT * 2)
+
+// Negotiated encoding
+typedef struct {
+    uint8_t format;             // FrameFormat_t
+    uint8_t shift;              // raw >> shift before packing (0..15)
+    uint8_t framesPerNotify;    // packed frames concatenated per notification
+} FrameCodecConfig;
+
+// Bits per pressure value of a format
+uint8_t Codec_BitsPerValue(uint8_t format);
+
+// Default shift that maps the 15-bit ADS1115 range onto the format's width
+uint8_t Codec_DefaultShift(uint8_t format);
+
+// Encoded frame size in bytes, 0 for an unknown format
+size_t Codec_FrameSize(uint8_t format);
+
+// How many frames of a format fit in one notification for a given ATT MTU
+uint8_t Codec_FramesPerNotification(uint8_t format, uint16_t mtu);
+
+/**
+ * @brief Encodes one frame.
+ * @param info validity and health of the frame, NULL => every channel fresh, every ADS1115 up.
+ *             Legacy frames have no room for it.
+ * @return bytes written to out (Codec_FrameSize), 0 if the format is invalid or out is too small
+ */
+size_t Codec_Encode(const SensorData* in, const SensorFrameInfo* info, const FrameCodecConfig* cfg,
+                    uint8_t* out, size_t outLen);
+
+/**
+ * @brief Decodes one frame of any format; pressure values are scaled back (<< shift).
+ * @param info if not NULL, receives pressure_valid and adc_healthy; for legacy frames both are
+ *             derived from PRESSURE_VALUE_DOWN, so held values count as valid
+ * @return bytes consumed, 0 if the input is malformed or truncated
+ */
+size_t Codec_Decode(const uint8_t* in, size_t len, uint8_t format, SensorData* out, SensorFrameInfo* info);
+
+// Frame status block (FRAME_STATUS_SIZE bytes); info NULL => all valid, all healthy
+void Codec_PackStatus(const SensorFrameInfo* info, uint8_t* out);
+void Codec_UnpackStatus(const uint8_t* in, PressureMask_t* valid, uint8_t* adcHealthy);
+
+// Bit-packer primitives: count values of `bits` width (8, 10, 12 or 16), LSB-first
+void Codec_PackValues(const uint16_t* values, size_t count, uint8_t bits, uint8_t* out);
+void Codec_UnpackValues(const uint8_t* in, size_t count, uint8_t bits, uint16_t* values);
+
+#endif // FRAME_CODEC_MODULE_H
@@ -0,0 +1,47 @@
+#ifndef FRAME_POOL_MODULE_H
+#define FRAME_POOL_MODULE_H
+
+#include <Arduino.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' FRAME POOL ''''''''''''''''''' //
+// Fixed set of reference-counted frame buffers. The sensor task writes each
+// frame once, in wire format, into a pool slot and publishes it; BLE, logging
+// and storage consumers borrow the latest slot and read it in place.
+
+#define FRAME_POOL_SLOTS    4     // latest + writer + one borrow per consumer
+#define FRAME_MAX_SIZE      (((int)ActiveTopology::FrameSize > 64) ? (int)ActiveTopology::FrameSize : 64) // wire bytes per slot
+
+typedef struct {
+    uint8_t  data[FRAME_MAX_SIZE];  // wire format, e.g. a packed SensorData
+    uint16_t length;                // valid bytes in data
+    SensorFrameInfo info;           // side information that is not sent on air
+    volatile uint8_t refs;          // owned by the pool, do not touch
+} FrameSlot_t;
+
+void FramePool_Init(void);
+
+// Free slot for the writer (holds one reference), nullptr if every slot is in use
+FrameSlot_t* FramePool_Acquire(void);
+
+// Makes a written slot the latest frame; the writer's reference passes to the pool
+void FramePool_Publish(FrameSlot_t* slot);
+
+// Takes a reference on the latest frame, nullptr if none was published yet
+FrameSlot_t* FramePool_BorrowLatest(void);
+
+// Drops a reference taken by FramePool_Acquire() or FramePool_BorrowLatest()
+void FramePool_Release(FrameSlot_t* slot);
+
+// Published frames and frames lost because no slot was free
+uint32_t FramePool_GetPublished(void);
+uint32_t FramePool_GetOverruns(void);
+
+// Wire payload of a slot viewed as the 39-byte SensorData frame
+static inline SensorData* FramePool_AsSensorData(FrameSlot_t* slot)
+{
+    return (SensorData*)slot->data;
+}
+
+#endif // FRAME_POOL_MODULE_H
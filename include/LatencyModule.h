@@ -0,0 +1,37 @@
+#ifndef LATENCY_MODULE_H
+#define LATENCY_MODULE_H
+
+#include <stdint.h>
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' SAMPLE-TO-AIR LATENCY ''''''''''''''''''' //
+// Log-linear histogram of the time from the start of a frame's sensor reads to
+// the notify() that carried it, one sample per notification, taken from its
+// oldest frame (batched, and possibly resent from the retry ring). 8 buckets
+// per power of two => percentiles within 12.5%.
+
+#define LATENCY_SUB_BUCKET_BITS  3
+#define LATENCY_BUCKETS          192     // covers up to ~67 s, larger values land in the last bucket
+
+typedef struct {
+    uint32_t count;     // notifications recorded since the last reset
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;    // exact
+} LatencySummary_t;
+
+void Latency_Reset(void);
+
+// Records one notification
+void Latency_Record(uint32_t latencyUs);
+
+// Upper bound of the bucket holding the given percentile, permille in 0..1000
+uint32_t Latency_Percentile(uint16_t permille);
+
+void Latency_GetSummary(LatencySummary_t* summary);
+
+// Logs the summary at INFO level
+void Latency_PrintSummary(void);
+
+#endif // LATENCY_MODULE_H
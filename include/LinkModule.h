@@ -0,0 +1,127 @@
+#ifndef LINK_MODULE_H
+#define LINK_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' BLE LINK MANAGER ''''''''''''''''''' //
+// Chooses the connection parameters for what the link has to carry and
+// models what the granted parameters can carry. Three profiles:
+//   IDLE        connected, nothing subscribed: long interval, events skipped
+//   POWER       the stream fits a long interval with room to spare
+//   THROUGHPUT  short interval, for streams that do not fit POWER, uploads,
+//               or when the stack refused notifications under POWER
+// The central decides what it grants; the manager compares the granted
+// interval, PHY and data length with the request, asks again a few times,
+// then works with what it got. Stepping up is immediate, stepping down waits
+// until the lower profile was enough for LINK_STEP_DOWN_MS.
+// Not thread-safe: the BLE module calls it from the communication task only.
+// Builds on the host (host/tools/link_check).
+//
+// Capacity model: every LL data PDU of the data length is answered by an
+// empty PDU of the central, T_IFS apart. A connection event holds as many of
+// these exchanges as fit LINK_EVENT_USE_PCT of the interval, at most
+// LINK_MAX_PACKETS_PER_EVENT (the central's limit). A notification takes
+// ceil((payload + 7) / data length) PDUs (ATT and L2CAP headers).
+
+// Throughput profile interval range, 1.25 ms units (7.5 - 22.5 ms); also
+// advertised as the preferred range (ADVERTISING_INTERVAL_*_PREFERRED)
+#define LINK_FAST_INTERVAL_MIN  0x06
+#define LINK_FAST_INTERVAL_MAX  0x12
+
+// PHY numbers as reported by the controller (BLE_GAP_LE_PHY_*)
+#define LINK_PHY_1M             1
+#define LINK_PHY_2M             2
+#define LINK_PHY_CODED          3
+
+#define LINK_DEFAULT_DATA_LEN   27      // LL payload octets before data length extension
+#define LINK_MAX_DATA_LEN       251
+#define LINK_DEFAULT_MTU        23
+
+typedef enum {
+    LINK_PROFILE_IDLE = 0,
+    LINK_PROFILE_POWER,
+    LINK_PROFILE_THROUGHPUT,
+    LINK_PROFILE_COUNT
+} LinkProfile_t;
+
+// What a profile asks for; 0 fields (and minInterval 0) leave that part as it is
+typedef struct {
+    uint16_t minInterval;       // 1.25 ms units
+    uint16_t maxInterval;
+    uint16_t latency;           // connection events the peripheral may skip
+    uint16_t timeout;           // supervision timeout, 10 ms units
+    uint8_t  phy;               // LINK_PHY_*
+    uint16_t dataLen;           // LL TX payload octets
+} LinkProfileParams_t;
+
+// What the central granted
+typedef struct {
+    uint16_t interval;          // 1.25 ms units
+    uint16_t latency;
+    uint16_t timeout;           // 10 ms units
+    uint8_t  txPhy;
+    uint8_t  rxPhy;
+    uint16_t dataLen;
+    uint16_t mtu;
+} LinkParams_t;
+
+typedef struct {
+    uint32_t intervalUs;
+    uint16_t packetsPerEvent;   // LL data PDUs per connection event
+    uint16_t maxPayload;        // largest notification payload, MTU - 3
+    uint16_t notifyPerSec;      // of maxPayload
+    uint32_t bytesPerSec;       // payload bytes at maxPayload notifications
+} LinkCapacity_t;
+
+// Load measured by the send path over the last window
+typedef struct {
+    bool     streaming;         // a central is subscribed to the stream
+    uint16_t payload;           // mean stream notification payload
+    uint16_t notifyPerSec;      // stream notifications per second
+    bool     bulk;              // an upload (burst window) waits for spare capacity
+    uint16_t refused;           // notifications the stack refused (retry ring) in the window
+} LinkDemand_t;
+
+typedef struct {
+    uint32_t requests;          // parameter requests sent
+    uint32_t changes;           // profile changes
+    uint32_t rejected;          // requests given up on, the central kept other parameters
+    uint8_t  profile;           // wanted LinkProfile_t
+    bool     phyRefused;        // the central did not switch to the profile's PHY
+    uint16_t loadPct;           // stream load on the granted parameters
+    bool     shortfall;         // the stream needs more than the granted parameters carry
+} LinkStats_t;
+
+// Parameters a profile asks for
+const LinkProfileParams_t* Link_GetProfile(LinkProfile_t profile);
+
+const char* Link_ProfileName(LinkProfile_t profile);
+
+void Link_Capacity(const LinkParams_t* params, LinkCapacity_t* cap);
+
+// Notifications of a payload per second the parameters carry
+uint32_t Link_NotifyRate(const LinkParams_t* params, size_t payload);
+
+// Fewest frames of frameSize per notification for which the parameters carry framesPerSec
+// frames, at most fit (also when even fit is not enough); 1 while the interval is unknown
+uint8_t Link_BatchFrames(const LinkParams_t* params, size_t frameSize, uint32_t framesPerSec, uint8_t fit);
+
+// Share of the parameters' capacity the stream demand takes, percent
+uint16_t Link_LoadPct(const LinkParams_t* params, const LinkDemand_t* demand);
+
+// Starts a connection: no request pending, nothing refused
+void Link_Reset(uint32_t nowMs);
+
+/**
+ * @brief Picks the profile for the demand and checks what the central granted.
+ * @param request filled with the parts to ask for (0 fields are left as they are)
+ * @return true if request should be sent to the central now
+ */
+bool Link_Update(const LinkParams_t* granted, const LinkDemand_t* demand, uint32_t nowMs,
+                 LinkProfileParams_t* request);
+
+void Link_GetStats(LinkStats_t* stats);
+
+#endif // LINK_MODULE_H
@@ -0,0 +1,40 @@
+#ifndef LOG_SINK_MODULE_H
+#define LOG_SINK_MODULE_H
+
+#include <Arduino.h>
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' LOG SINKS ''''''''''''''''''' //
+// Destinations for the logger task. A sink never blocks: write() either takes
+// the whole line or returns false, and the logger counts the line as dropped.
+
+typedef struct {
+    const char* name;
+    bool (*init)(void);
+    bool (*write)(const char* line, size_t len);   // len excludes the line ending
+} LogSink_t;
+
+// UART through the driver's TX ring buffer at LOGGER_UART_BAUD; refuses lines that do not fit
+extern const LogSink_t LogSink_Uart;
+
+// LOG packets of the wired stream (SerialStreamModule.h); replaces LogSink_Uart when SERIAL_STREAM_ENABLED
+extern const LogSink_t LogSink_SerialStream;
+
+// Ring in RTC no-init RAM; survives a software reset, panic or watchdog reset for a post-mortem dump
+extern const LogSink_t LogSink_RamRing;
+
+// Discards everything (benchmarks, production builds)
+extern const LogSink_t LogSink_Null;
+
+/**
+ * @brief Writes the RAM ring left by the previous boot to the UART, oldest line first.
+ *        Does nothing after a power-on reset, when the ring content is undefined.
+ *        Blocking, call during setup only.
+ * @return Bytes dumped
+ */
+size_t LogSink_DumpRamRing(void);
+
+// Empties the RAM ring
+void LogSink_ClearRamRing(void);
+
+#endif // LOG_SINK_MODULE_H
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "Config.h"
 #include "CommonTypes.h"
+#include "LogSinkModule.h"
 
 // Logging macros (function name & line number included)
 #define LOG_ERROR(fmt, ...) LoggerPrint(LOGGER_LEVEL_ERROR, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
@@ -11,14 +12,38 @@
 #define LOG_INFO(fmt,  ...) LoggerPrint(LOGGER_LEVEL_INFO,  __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
 #define LOG_DEBUG(fmt, ...) LoggerPrint(LOGGER_LEVEL_DEBUG, __FUNCTION__, __LINE__, fmt, ##__VA_ARGS__)
 
-// Initialize the logger with desired level and whether to enable serial
+#define LOGGER_MAX_SINKS    3
+
+// Counters since boot
+typedef struct {
+    uint32_t queued;            // lines accepted by LoggerPrint()
+    uint32_t written;           // lines handed to every sink
+    uint32_t droppedQueueFull;  // logger queue was full
+    uint32_t droppedRateLimit;  // level exceeded its rate limit
+    uint32_t droppedSink;       // a sink had no room within LOGGER_SINK_RETRY_MS
+} LoggerStats_t;
+
+// Initialize the logger: attaches the sinks enabled in Config.h (unless sinks were added before)
+// and dumps the RAM ring left by a crash
 void LoggerInit();
 
-// Main logging function
+// Attaches a sink, up to LOGGER_MAX_SINKS; call before LoggerInit() to replace the defaults
+bool LoggerAddSink(const LogSink_t* sink);
+
+// Detaches all sinks
+void LoggerClearSinks(void);
+
+// Main logging function, never blocks
 void LoggerPrint(uint8_t level, const char* func, int line, const char* format, ...);
 
-// FreeRTOS logger task
+// FreeRTOS logger task, the only writer to the sinks
 void LoggerTask(void* pvParams);
 
+// One pass of LoggerTask: waits up to `wait` for a line, writes it, reports drops when due.
+// Returns false if no line arrived. Host tools call it in place of the task.
+bool LoggerService(TickType_t wait);
+
+void LoggerGetStats(LoggerStats_t* stats);
+
 void LoggerPrintLoopMessage(SensorData* sensor_msg);
 #endif // LOGGER_MODULE_H
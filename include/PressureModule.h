@@ -8,21 +8,56 @@
 #define PRESSURE_ERR_INIT        ERR_SENSOR_INIT_FAIL
 #define PRESSURE_ERR_READ        ERR_SENSOR_READ_FAIL
 
+#define PRESSURE_ADC_COUNT          ActiveTopology::AdcCount        // ADS1115 devices, see SensorTopology.h
+#define PRESSURE_CHANNELS_PER_ADC   ActiveTopology::ChannelsPerAdc  // single-ended inputs per ADS1115
+
 typedef enum {
     PRESSURE_STATUS_OK = 0,
     PRESSURE_STATUS_INIT_ERROR,
-    PRESSURE_STATUS_READ_ERROR
+    PRESSURE_STATUS_READ_ERROR,
+    PRESSURE_STATUS_DEGRADED        // some ADS1115s are down, the others keep streaming
 } PressureStatus_t;
 
-extern uint16_t Pressure_Array[16];
+typedef enum {
+    PRESSURE_DEV_OK = 0,
+    PRESSURE_DEV_DOWN               // excluded from the scan, re-initialized in the background
+} PressureDevState_t;
+
+// Per-ADS1115 health
+typedef struct {
+    PressureDevState_t state;
+    uint8_t  consecutiveErrors;     // failed conversions in a row
+    uint32_t retryAtMs;             // next re-init attempt while down
+    uint32_t backoffMs;             // current re-init backoff
+    uint32_t errorCount;            // failed conversions since boot
+    uint32_t reinitCount;           // successful re-inits since boot
+} PressureDevHealth_t;
+
+extern uint16_t Pressure_Array[PRESSURE_CHANNEL_COUNT];
+extern PressureMask_t Pressure_ValidMask;                // channels converted during the last Pressure_Read()
+extern uint8_t  Pressure_Age[PRESSURE_CHANNEL_COUNT];    // Pressure_Read() calls since last conversion
+extern uint32_t Pressure_SampleUs[PRESSURE_CHANNEL_COUNT]; // micros() at the middle of the last conversion
 extern PressureStatus_t Pressure_Status;
+extern PressureDevHealth_t Pressure_DevHealth[PRESSURE_ADC_COUNT];
+
+// Bit n set => ADS1115 n is healthy
+uint8_t Pressure_GetHealthyMask(void);
 
-// init
-uint8_t Pressure_Init(void);
+// init. present: addresses that answered on Wire at boot (Boot_DiscoverI2C); a Wire
+// device not in it is marked down without a probe. NULL probes every device.
+uint8_t Pressure_Init(const uint8_t* present = nullptr, uint8_t presentCount = 0);
 // read
 uint8_t Pressure_Read(void);
 // test
 void Pressure_Test(void);
 
+/**
+ * @brief One blocking single-shot conversion on an ADS1115 input, outside the scan
+ *        (self-test). Does not touch Pressure_Array or the device health.
+ * @param value raw result, may be NULL
+ * @return false on an I2C error or timeout
+ */
+bool Pressure_ConvertOnce(uint8_t dev, uint8_t input, int16_t* value);
+
 void Pressure_PrintValues(void);
 #endif // PRESSURE_MODULE_H
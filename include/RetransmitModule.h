@@ -0,0 +1,66 @@
+#ifndef RETRANSMIT_MODULE_H
+#define RETRANSMIT_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' NOTIFICATION RETRY RING ''''''''''''''''''' //
+// Notifications the BLE stack refused (no TX buffer) wait here instead of
+// being discarded, each with the caller's stamp (the BLE module's oldest sample
+// time), which goes back to the send function with the data. They go out
+// strictly in order once the stack takes data again; a new notification is only sent
+// directly while the ring is empty. When the ring is full the oldest entry
+// is dropped and counted, so memory stays at RETX_SLOTS x RETX_SLOT_SIZE.
+// Notifications are indexed in send order for the statistics only; the
+// index is not sent, the receiver sees a gap as missing frames.
+// Not thread-safe: the BLE module serializes access. Builds on the host.
+
+#define RETX_SLOTS          RETX_BUFFER_SLOTS   // Config.h
+#define RETX_SLOT_SIZE      185                 // BLE_PREFERRED_MTU, largest notification
+
+typedef struct {
+    uint32_t direct;        // sent right away
+    uint32_t queued;        // notifications that had to wait
+    uint32_t resent;        // of those, sent later
+    uint32_t dropped;       // oldest entries pushed out by a full ring
+    uint32_t oversize;      // longer than RETX_SLOT_SIZE, dropped right away
+    uint16_t depth;         // entries waiting now
+    uint16_t maxDepth;
+    uint16_t nextIndex;     // send-order index of the next notification (local, not on the air)
+    uint16_t lastDroppedIndex;
+} RetxStats_t;
+
+// Sends one notification; false if the stack refused it
+typedef bool (*RetxSendFn)(const uint8_t* data, size_t len, uint32_t stamp, void* ctx);
+
+// Drops everything waiting and clears the counters
+void Retx_Reset(void);
+
+// Number of notifications waiting
+uint16_t Retx_Depth(void);
+
+/**
+ * @brief Queues a notification at the tail, dropping the oldest one if the ring is full.
+ * @return the send-order index it was queued under
+ */
+uint16_t Retx_Push(const uint8_t* data, size_t len, uint32_t stamp);
+
+/**
+ * @brief Sends waiting notifications oldest first until the ring is empty or send refuses one,
+ *        which then stays at the head.
+ * @return notifications sent
+ */
+uint16_t Retx_Drain(RetxSendFn send, void* ctx);
+
+/**
+ * @brief Keeps the order: drains the ring, sends data directly if that emptied it,
+ *        queues it otherwise (or if the direct send is refused). Either way it takes
+ *        the next send-order index.
+ * @return true if data went out right away
+ */
+bool Retx_Send(const uint8_t* data, size_t len, uint32_t stamp, RetxSendFn send, void* ctx);
+
+void Retx_GetStats(RetxStats_t* stats);
+
+#endif // RETRANSMIT_MODULE_H
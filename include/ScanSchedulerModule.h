@@ -0,0 +1,37 @@
+#ifndef SCAN_SCHEDULER_MODULE_H
+#define SCAN_SCHEDULER_MODULE_H
+
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' PRESSURE SCAN SCHEDULER ''''''''''''''''''' //
+// Builds one interleaved mux sequence per ADS1115 from a per-channel rate table.
+// Hot channels get more slots of the sequence, cold channels fewer, and slots that
+// nobody needs are left idle so the I2C transaction can be skipped.
+
+#define SCAN_SLOT_IDLE    0xFF
+
+/**
+ * @brief Builds the mux sequences.
+ * @param ratesHz   Requested rate per channel [Hz], PRESSURE_CHANNEL_COUNT entries indexed by frame slot
+ * @param tickRateHz Scan ticks per second, i.e. conversion slots per second per ADS1115
+ */
+void ScanScheduler_Init(const uint16_t* ratesHz, uint16_t tickRateHz);
+
+/**
+ * @brief Returns the ADS1115 input (0..3) to convert on the next tick, or SCAN_SLOT_IDLE.
+ *        Advances the device's position in its sequence.
+ */
+uint8_t ScanScheduler_NextChannel(uint8_t dev);
+
+// Rate actually granted to a frame slot by the sequence [Hz]
+uint16_t ScanScheduler_GetScheduledRateHz(uint8_t channel);
+
+// Rate every channel would get if the same slot budget were spread uniformly [Hz]
+uint16_t ScanScheduler_GetUniformRateHz(void);
+
+// Logs requested vs scheduled rates and the gain over a uniform scan
+void ScanScheduler_PrintSummary(void);
+
+#endif // SCAN_SCHEDULER_MODULE_H
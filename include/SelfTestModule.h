@@ -0,0 +1,125 @@
+#ifndef SELF_TEST_MODULE_H
+#define SELF_TEST_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' PERFORMANCE SELF-TEST ''''''''''''''''''' //
+// Production-line / field check. Measures, one phase after the other:
+//   - sustained single-shot conversions per ADS1115 and their I2C latency
+//   - the ADXL345 FIFO drain rate (entries per second of bus time)
+//   - the I2C error rate over both
+//   - end-to-end frames per second of the per-frame path
+//   - notify throughput on the self-test characteristic, if a central subscribed
+//     to it (skipped otherwise)
+// and grades them against SelfTestLimits_t (defaults in Config.h).
+// The hardware is reached through SelfTestOps_t, so the measurement and the
+// report build on the host against simulated devices; the firmware ops and
+// the triggers (boot flag, serial "selftest", BLE_CMD_SELFTEST) are ARDUINO only.
+
+#define SELFTEST_ADC_COUNT          ActiveTopology::AdcCount
+#define SELFTEST_NOTIFY_MAX         244     // largest notification payload tried (ATT MTU 247)
+#define SELFTEST_ACC_FILL_US        20000   // FIFO fill time between drains (16 entries at 800 Hz)
+
+// SelfTestResult_t.failed bits
+#define SELFTEST_FAIL_ADS_RATE      0x01
+#define SELFTEST_FAIL_I2C_LATENCY   0x02
+#define SELFTEST_FAIL_I2C_ERRORS    0x04
+#define SELFTEST_FAIL_ACC_DRAIN     0x08
+#define SELFTEST_FAIL_FRAME_RATE    0x10
+#define SELFTEST_FAIL_NOTIFY_RATE   0x20
+
+// Hardware access; every call blocks until done
+typedef struct {
+    void* ctx;
+    uint32_t (*nowUs)(void* ctx);
+    void     (*delayUs)(void* ctx, uint32_t us);
+    // One single-shot conversion on an ADS1115 input, start to result; false on an I2C error or timeout
+    bool     (*adsConvert)(void* ctx, uint8_t dev, uint8_t input);
+    // Reads every ADXL345 FIFO entry; entries read, -1 on an I2C error
+    int      (*accDrain)(void* ctx);
+    // One pass of the per-frame path (reads, DSP, pack, send when subscribed); false if a read failed
+    bool     (*frame)(void* ctx);
+    // Notification payload the subscribed central takes, 0 => nobody subscribed
+    uint16_t (*notifyPayload)(void* ctx);
+    // Sends one notification; false if the stack refused it (out of buffers)
+    bool     (*notify)(void* ctx, const uint8_t* data, size_t len);
+} SelfTestOps_t;
+
+typedef struct {
+    uint32_t phaseMs;           // duration of every phase (each ADS1115 gets its own)
+    uint16_t minAdsSps;         // sustained conversions per second per ADS1115
+    uint32_t maxLatencyUs;      // slowest successful conversion, start to result
+    uint32_t maxI2cErrorPpm;
+    uint32_t minAccDrainHz;     // FIFO entries per second of bus time
+    uint16_t minFrameHz;
+    uint32_t minNotifyBps;      // notification payload bytes per second
+} SelfTestLimits_t;
+
+typedef struct {
+    uint32_t conversions;       // successful
+    uint32_t errors;
+    uint32_t sps;
+    uint32_t avgLatencyUs;
+    uint32_t maxLatencyUs;
+} SelfTestAdc_t;
+
+typedef struct {
+    SelfTestAdc_t adc[SELFTEST_ADC_COUNT];
+    uint32_t i2cTransactions;
+    uint32_t i2cErrors;
+    uint32_t i2cErrorPpm;
+    uint32_t accEntries;
+    uint32_t accDrainHz;        // entries per second of time spent draining
+    uint32_t accOdrHz;          // entries per second of phase time, i.e. what the sensor delivered
+    uint32_t frames;
+    uint32_t frameErrors;
+    uint32_t frameHz;
+    bool     notifyRun;         // false => no central subscribed, phase skipped
+    uint16_t notifyPayload;
+    uint32_t notifyBytes;
+    uint32_t notifyRefused;
+    uint32_t notifyBps;
+    uint8_t  failed;            // SELFTEST_FAIL_* bits, 0 => pass
+} SelfTestResult_t;
+
+// Limits from Config.h
+void SelfTest_DefaultLimits(SelfTestLimits_t* limits);
+
+/**
+ * @brief Runs every phase and grades the result.
+ * @return true if every measured value is within its limit
+ */
+bool SelfTest_Run(const SelfTestOps_t* ops, const SelfTestLimits_t* limits, SelfTestResult_t* result);
+
+/**
+ * @brief Writes the pass/fail report, one line per measurement.
+ * @return length written (truncated to len - 1)
+ */
+size_t SelfTest_FormatReport(const SelfTestResult_t* result, const SelfTestLimits_t* limits, char* buf, size_t len);
+
+#ifdef ARDUINO
+// Asks loop() to run the self-test; safe from any task (BLE control, serial)
+void SelfTest_Request(void);
+
+// True while the self-test owns the sensors; SensorTask skips its frames meanwhile
+bool SelfTest_Active(void);
+
+// SensorTask calls this between frames while SelfTest_Active(): it has let go of the
+// sensors, and the waiting self-test may start
+void SelfTest_AckPause(void);
+
+// Runs the self-test now against the real devices and logs the report
+bool SelfTest_RunNow(void);
+
+/**
+ * @brief Called from loop(): reads the serial "selftest" command and runs a
+ *        pending request, pausing SensorTask for the duration. The test starts
+ *        only once SensorTask has acknowledged the pause (SelfTest_AckPause).
+ */
+void SelfTest_Service(void);
+#endif
+
+#endif // SELF_TEST_MODULE_H
@@ -0,0 +1,121 @@
+#ifndef SENSOR_TOPOLOGY_H
+#define SENSOR_TOPOLOGY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' SENSOR TOPOLOGY ''''''''''''''''''' //
+// Compile-time description of an insole variant: which ADS1115s sit on which
+// I2C bus and which frame slot every ADC input lands in. The driver loops,
+// masks and frame sizes are all derived from SensorTopology<N>, so an 8, 16
+// or 32-sensor build carries no runtime indirection beyond a constant table.
+// Select the variant with -DINSOLE_SENSOR_COUNT=8|16|32 (default 16).
+
+#ifndef INSOLE_SENSOR_COUNT
+#define INSOLE_SENSOR_COUNT 16
+#endif
+
+typedef struct {
+    uint8_t bus;        // 0 => Wire, 1 => Wire1
+    uint8_t address;    // 7-bit I2C address
+} TopologyAdc;
+
+// ADS1115s per variant, in scan order
+static constexpr TopologyAdc TOPOLOGY_ADC_8[]  = { {0, 0x48}, {0, 0x49} };
+static constexpr TopologyAdc TOPOLOGY_ADC_16[] = { {0, 0x48}, {0, 0x49}, {0, 0x4A}, {0, 0x4B} };
+static constexpr TopologyAdc TOPOLOGY_ADC_32[] = { {0, 0x48}, {0, 0x49}, {0, 0x4A}, {0, 0x4B},
+                                                   {1, 0x48}, {1, 0x49}, {1, 0x4A}, {1, 0x4B} };
+
+// Frame slot of ADC input (dev * 4 + input). Slots run heel -> toes so that
+// consumers can treat every quarter of the frame as one anatomical zone.
+static constexpr uint8_t TOPOLOGY_MAP_8[] = {
+    0, 1, 2, 3,   4, 5, 6, 7 };
+static constexpr uint8_t TOPOLOGY_MAP_16[] = {
+    0,  1,  2,  3,    4,  5,  6,  7,    8,  9, 10, 11,   12, 13, 14, 15 };
+// Second bus carries the forefoot; its harness is routed toes first
+static constexpr uint8_t TOPOLOGY_MAP_32[] = {
+    0,  1,  2,  3,    4,  5,  6,  7,    8,  9, 10, 11,   12, 13, 14, 15,
+   28, 29, 30, 31,   24, 25, 26, 27,   20, 21, 22, 23,   16, 17, 18, 19 };
+
+// Smallest unsigned type with one bit per sensor
+template <unsigned Sensors> struct TopologyMask          { typedef uint32_t Type; };
+template <>                 struct TopologyMask<8>       { typedef uint8_t  Type; };
+template <>                 struct TopologyMask<16>      { typedef uint16_t Type; };
+
+template <unsigned Sensors>
+struct SensorTopology {
+    static_assert(Sensors == 8 || Sensors == 16 || Sensors == 32, "supported insoles have 8, 16 or 32 sensors");
+
+    enum {
+        ChannelCount   = Sensors,
+        ChannelsPerAdc = 4,                  // single-ended inputs per ADS1115
+        AdcCount       = Sensors / 4,
+        BusCount       = (Sensors > 16) ? 2 : 1,
+        FrameSize      = 7 + 2 * Sensors     // battery + 3 x accel + pressure words
+    };
+
+    typedef typename TopologyMask<Sensors>::Type Mask;
+
+    static constexpr Mask allSensors() { return (Mask)(((uint64_t)1 << Sensors) - 1); }
+
+    static constexpr TopologyAdc adc(unsigned dev)
+    {
+        return (Sensors == 8) ? TOPOLOGY_ADC_8[dev] : (Sensors == 16) ? TOPOLOGY_ADC_16[dev] : TOPOLOGY_ADC_32[dev];
+    }
+
+    // Frame slot fed by input `input` of ADS1115 `dev`
+    static constexpr uint8_t sensorOf(unsigned dev, unsigned input)
+    {
+        return (Sensors == 8)  ? TOPOLOGY_MAP_8[dev * ChannelsPerAdc + input] :
+               (Sensors == 16) ? TOPOLOGY_MAP_16[dev * ChannelsPerAdc + input] :
+                                 TOPOLOGY_MAP_32[dev * ChannelsPerAdc + input];
+    }
+
+    // Consistency checks, evaluated at compile time below (C++11 constexpr: one return each)
+    static constexpr unsigned countSlot(unsigned slot, unsigned k = 0)
+    {
+        return (k == Sensors) ? 0 : (unsigned)(sensorOf(k / ChannelsPerAdc, k % ChannelsPerAdc) == slot) + countSlot(slot, k + 1);
+    }
+    static constexpr bool mapIsPermutation(unsigned slot = 0)
+    {
+        return (slot == Sensors) || (countSlot(slot) == 1 && mapIsPermutation(slot + 1));
+    }
+    static constexpr bool adcDiffers(unsigned i, unsigned j)
+    {
+        return adc(i).bus != adc(j).bus || adc(i).address != adc(j).address;
+    }
+    static constexpr bool adcsUnique(unsigned i = 0, unsigned j = 1)
+    {
+        return (i + 1 >= AdcCount) ||
+               ((j >= AdcCount) ? adcsUnique(i + 1, i + 2) : (adcDiffers(i, j) && adcsUnique(i, j + 1)));
+    }
+    static constexpr bool busesValid(unsigned dev = 0)
+    {
+        return (dev == AdcCount) || (adc(dev).bus < BusCount && busesValid(dev + 1));
+    }
+};
+
+// Every variant is instantiated here, so each build checks all three tables
+static_assert(sizeof(TOPOLOGY_ADC_8)  / sizeof(TopologyAdc) == SensorTopology<8>::AdcCount,  "8-sensor ADC list");
+static_assert(sizeof(TOPOLOGY_ADC_16) / sizeof(TopologyAdc) == SensorTopology<16>::AdcCount, "16-sensor ADC list");
+static_assert(sizeof(TOPOLOGY_ADC_32) / sizeof(TopologyAdc) == SensorTopology<32>::AdcCount, "32-sensor ADC list");
+static_assert(sizeof(TOPOLOGY_MAP_8)  == 8,  "8-sensor map");
+static_assert(sizeof(TOPOLOGY_MAP_16) == 16, "16-sensor map");
+static_assert(sizeof(TOPOLOGY_MAP_32) == 32, "32-sensor map");
+static_assert(SensorTopology<8>::mapIsPermutation(),  "8-sensor map must hit every slot once");
+static_assert(SensorTopology<16>::mapIsPermutation(), "16-sensor map must hit every slot once");
+static_assert(SensorTopology<32>::mapIsPermutation(), "32-sensor map must hit every slot once");
+static_assert(SensorTopology<8>::adcsUnique()  && SensorTopology<8>::busesValid(),  "8-sensor ADC addresses");
+static_assert(SensorTopology<16>::adcsUnique() && SensorTopology<16>::busesValid(), "16-sensor ADC addresses");
+static_assert(SensorTopology<32>::adcsUnique() && SensorTopology<32>::busesValid(), "32-sensor ADC addresses");
+static_assert(SensorTopology<8>::FrameSize == 23 && SensorTopology<16>::FrameSize == 39 &&
+              SensorTopology<32>::FrameSize == 71, "frame sizes");
+static_assert(SensorTopology<8>::allSensors() == 0xFF && SensorTopology<16>::allSensors() == 0xFFFF &&
+              SensorTopology<32>::allSensors() == 0xFFFFFFFFu, "sensor masks");
+
+// The variant this build is for
+typedef SensorTopology<INSOLE_SENSOR_COUNT> ActiveTopology;
+typedef ActiveTopology::Mask PressureMask_t;
+
+#endif // SENSOR_TOPOLOGY_H
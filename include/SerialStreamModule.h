@@ -0,0 +1,91 @@
+#ifndef SERIAL_STREAM_MODULE_H
+#define SERIAL_STREAM_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' WIRED STREAM ''''''''''''''''''' //
+// Binary lab capture over the USB UART (SERIAL_STREAM_ENABLED): every frame and
+// every log line goes out as a CRC-protected packet, so frames and logs share
+// the port without corrupting each other. Packets are COBS-encoded with a zero
+// byte on both sides; stray raw text (boot messages) only costs itself, the
+// receiver resynchronises at the next zero byte.
+// The packet codec builds on the host (host/tools/serial_capture).
+//
+// Packet before COBS: [type][seq][payload][CRC-16/CCITT-FALSE LE16 over type..payload]
+//   HELLO: [version][pressure channels][frame size][loop interval ms LE16], every SERIAL_STREAM_HELLO_MS
+//   FRAME: [sample us LE32][SensorData]
+//   LOG:   log line text, no line ending
+// seq counts every packet, dropped ones included, so the receiver sees lost packets of any type.
+
+#define SERIAL_STREAM_VERSION       1
+#define SERIAL_STREAM_TYPE_HELLO    0x01
+#define SERIAL_STREAM_TYPE_FRAME    0x02
+#define SERIAL_STREAM_TYPE_LOG      0x03
+
+#define SERIAL_STREAM_HELLO_SIZE    5
+#define SERIAL_STREAM_FRAME_SIZE    (4 + sizeof(SensorData))
+#define SERIAL_STREAM_MAX_PAYLOAD   256     // LOGGER_MAX_LOG_LENGTH
+#define SERIAL_STREAM_OVERHEAD      4       // type, seq, CRC
+
+// Encoded size: COBS adds one byte per started 254 bytes, plus the two delimiters
+#define SERIAL_STREAM_WIRE_SIZE(payload) \
+    ((payload) + SERIAL_STREAM_OVERHEAD + ((payload) + SERIAL_STREAM_OVERHEAD) / 254 + 1 + 2)
+#define SERIAL_STREAM_MAX_WIRE_SIZE SERIAL_STREAM_WIRE_SIZE(SERIAL_STREAM_MAX_PAYLOAD)
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF); pass the previous result to continue
+uint16_t SerialStream_Crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Builds one packet, delimiters included.
+ * @return bytes written, 0 if the payload is too long or out too small
+ */
+size_t SerialStream_Encode(uint8_t type, uint8_t seq, const uint8_t* payload, size_t len,
+                           uint8_t* out, size_t cap);
+
+// Payload of a HELLO packet for this build
+void SerialStream_MakeHello(uint8_t* out);
+
+typedef void (*SerialStreamPacketFn)(void* ctx, uint8_t type, uint8_t seq, const uint8_t* payload, size_t len);
+
+typedef struct {
+    uint8_t  buf[SERIAL_STREAM_MAX_PAYLOAD + SERIAL_STREAM_OVERHEAD + 2];
+    size_t   len;
+    bool     overflow;          // current packet is longer than any valid one, skipped to the next zero
+    uint32_t packets;           // delivered to the callback
+    uint32_t crcErrors;
+    uint32_t framingErrors;     // bad COBS, too short or too long
+} SerialStreamDecoder_t;
+
+void SerialStream_InitDecoder(SerialStreamDecoder_t* dec);
+
+// Feeds received bytes; calls fn for every packet with a good CRC
+void SerialStream_Feed(SerialStreamDecoder_t* dec, const uint8_t* data, size_t len,
+                       SerialStreamPacketFn fn, void* ctx);
+
+#ifdef ARDUINO
+typedef struct {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t dropped;           // UART TX buffer had no room
+} SerialStreamStats_t;
+
+// Starts the UART at SERIAL_STREAM_BAUD; called by the log sink's init
+bool SerialStream_Begin(void);
+
+// True once streaming runs; frames are then read and sent without a BLE subscriber
+bool SerialStream_Active(void);
+
+// Never block: a packet that does not fit the UART TX buffer is dropped and counted
+bool SerialStream_SendFrame(const SensorData* frame, uint32_t sample_us);
+bool SerialStream_SendLog(const char* line, size_t len);
+
+void SerialStream_GetStats(SerialStreamStats_t* stats);
+
+// Logs packets, bytes and drops at INFO level (WARN once a packet was dropped); only while streaming
+void SerialStream_PrintSummary(void);
+#endif
+
+#endif // SERIAL_STREAM_MODULE_H
@@ -0,0 +1,96 @@
+#ifndef STATS_MODULE_H
+#define STATS_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' SESSION STATISTICS ''''''''''''''''''' //
+// Running per-channel summary of the frames sent since the last reset, so a
+// session can be summarised without pulling the raw stream: Welford mean and
+// variance (float per block of samples, folded into double totals), min/max,
+// p50/p90/p99 and time above a threshold. Quantiles come from a log-linear
+// histogram per channel (16 exact buckets, then 8 per power of two, the bucket
+// midpoint is reported => within 6.25%). Each update is a fixed amount of work
+// per channel; quantiles are only walked when read, outside the lock.
+// A pressure channel counts only frames with a fresh conversion from a healthy
+// ADS1115, so held values and PRESSURE_VALUE_DOWN never enter its statistics;
+// its time above threshold spans from its previous counted sample.
+// Pressure channels and the accel magnitude get quantiles and time above
+// threshold, the signed accel axes moments and min/max only.
+// The same code builds on the host.
+//
+// Read page (stats characteristic):
+//   [frames LE32][duration ms LE32][page][pages] + STATS_PAGE_CHANNELS channels of
+//   [mean f32 LE][stddev f32 LE][min LE16][max LE16][p50 LE16][p90 LE16][p99 LE16][above ms LE32]
+//   min/max are signed for the accel axes; the last page may hold fewer channels.
+
+#define STATS_CH_ACC_X              PRESSURE_CHANNEL_COUNT
+#define STATS_CH_ACC_Y              (PRESSURE_CHANNEL_COUNT + 1)
+#define STATS_CH_ACC_Z              (PRESSURE_CHANNEL_COUNT + 2)
+#define STATS_CH_ACC_MAG            (PRESSURE_CHANNEL_COUNT + 3)   // |a| in m/s^2 x 10
+#define STATS_CHANNELS              (PRESSURE_CHANNEL_COUNT + 4)
+#define STATS_SKETCHES              (PRESSURE_CHANNEL_COUNT + 1)   // pressure + accel magnitude
+
+#define STATS_SUB_BUCKET_BITS       3
+#define STATS_BUCKETS               112     // covers 0..65535
+
+#define STATS_PAGE_HEADER_SIZE      10
+#define STATS_WIRE_CHANNEL_SIZE     22
+#define STATS_PAGE_CHANNELS         7       // a page fits a 185-byte MTU
+#define STATS_PAGE_SIZE             (STATS_PAGE_HEADER_SIZE + STATS_PAGE_CHANNELS * STATS_WIRE_CHANNEL_SIZE)
+#define STATS_PAGES                 ((STATS_CHANNELS + STATS_PAGE_CHANNELS - 1) / STATS_PAGE_CHANNELS)
+
+typedef struct {
+    float    mean;
+    float    stddev;        // sample standard deviation, 0 below two frames
+    int32_t  min;
+    int32_t  max;
+    uint16_t p50;           // 0 for the accel axes
+    uint16_t p90;
+    uint16_t p99;
+    uint32_t aboveMs;       // time at or above the channel's threshold, 0 for the accel axes
+} StatsChannel_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t durationMs;    // frame gaps longer than STATS_MAX_GAP_MS count as STATS_MAX_GAP_MS
+    uint16_t pressureThreshold;
+    uint16_t accelThreshold;
+} StatsSummary_t;
+
+// Clears every channel; the thresholds stay
+void Stats_Reset(void);
+
+// Thresholds for time above: ADC counts for pressure, m/s^2 x 10 for the accel magnitude. Resets.
+void Stats_SetThresholds(uint16_t pressure, uint16_t accelMagnitude);
+
+/**
+ * @brief Adds one frame.
+ * @param info which pressure slots were converted (pressure_valid) and which ADS1115s
+ *             are up (adc_healthy); NULL => every channel fresh
+ * @param t_us frame instant, used for the time-above and duration totals
+ */
+void Stats_Update(const SensorData* frame, const SensorFrameInfo* info, uint32_t t_us);
+
+void Stats_GetSummary(StatsSummary_t* summary);
+
+// Snapshot of one channel (STATS_CH_* or a pressure frame slot); false if out of range
+bool Stats_GetChannel(uint8_t channel, StatsChannel_t* out);
+
+// Value at the given percentile, permille in 0..1000; 0 for channels without quantiles
+uint16_t Stats_Quantile(uint8_t channel, uint16_t permille);
+
+/**
+ * @brief Encodes one read page (layout above).
+ * @return bytes written, 0 if the page is out of range or len too small
+ */
+size_t Stats_EncodePage(uint8_t page, uint8_t* out, size_t len);
+
+#ifdef ARDUINO
+// Logs frames, duration and the peak pressure channel at INFO level
+void Stats_PrintSummary(void);
+#endif
+
+#endif // STATS_MODULE_H
@@ -0,0 +1,68 @@
+#ifndef TRACE_MODULE_H
+#define TRACE_MODULE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "CommonTypes.h"
+
+// /////////////////////////////////////////////////////////////////
+// ''''''' TRACE REPLAY ''''''''''''''''''' //
+// Recorded or synthetic sessions that stand in for Pressure_Read(),
+// Acc_Read() and Battery_Read() in test-device mode (testDeviceBLE),
+// played at real time or N x speed. The same code builds on the host.
+
+#define TRACE_ERR_OK        ERR_OK
+#define TRACE_ERR_FORMAT    0x10
+#define TRACE_ERR_EMPTY     0x11
+
+#define TRACE_MAGIC         0x43525449u   // "ITRC" little-endian
+#define TRACE_VERSION       1
+
+typedef enum {
+    TRACE_GAIT_STAND = 0,
+    TRACE_GAIT_WALK,
+    TRACE_GAIT_RUN
+} TraceGait_t;
+
+#pragma pack(push, 1)
+// File / flash image: header followed by record_count SensorData records (wire layout)
+typedef struct {
+    uint32_t magic;         // TRACE_MAGIC
+    uint8_t  version;       // TRACE_VERSION
+    uint8_t  channels;      // pressure channels per record, PRESSURE_CHANNEL_COUNT
+    uint16_t period_ms;     // time between records
+    uint32_t record_count;
+} TraceHeader;              // 12 bytes
+#pragma pack(pop)
+
+/**
+ * @brief Fills one frame of a synthetic session at time t_ms.
+ *        Heel, arch, metatarsal and toe channels (ADS1115 0..3) are loaded in
+ *        stance-phase order, the accelerometer sees heel-strike impacts.
+ */
+void Trace_Synthesize(TraceGait_t gait, uint32_t t_ms, SensorData* out);
+
+/**
+ * @brief Writes a synthetic trace image (header + records) into buf.
+ * @return bytes written, 0 if buf is too small
+ */
+size_t Trace_Generate(TraceGait_t gait, uint16_t period_ms, uint32_t record_count, uint8_t* buf, size_t len);
+
+// Checks a trace image and returns its header, or null if malformed
+const TraceHeader* Trace_Validate(const uint8_t* image, size_t len);
+
+// Record `index` of a validated image (wraps around at the end)
+void Trace_GetRecord(const uint8_t* image, uint32_t index, SensorData* out);
+
+// Device-side replay source
+uint8_t Trace_Open(const uint8_t* image, size_t len);   // image may live in flash
+void Trace_UseSynthetic(TraceGait_t gait);
+void Trace_SetSpeed(uint16_t speed);                     // 1 = real time
+/**
+ * @brief Replay stand-in for Battery_Read(), Acc_Read() and Pressure_Read():
+ *        fills BatteryVoltage, Acc_Array and Pressure_Array with the sample
+ *        due at the current (scaled) trace time.
+ */
+uint8_t Trace_Read(void);
+
+#endif // TRACE_MODULE_H
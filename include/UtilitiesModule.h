@@ -31,12 +31,22 @@ extern BatteryStatus_t Battery_Status;
 uint8_t Battery_Init(void);
 uint8_t Battery_Read(void);
 void Battery_Test(void);
-void i2cScanner(void);
+// Scans all 7-bit addresses; returns the responding ones in found (up to maxFound) and how
+// many responded, which exceeds maxFound when found could not hold them all
+uint8_t i2cScanner(uint8_t* found = nullptr, uint8_t maxFound = 0);
+// Latest readings into a frame; channels of a downed ADS1115 carry PRESSURE_VALUE_DOWN
 void PackSensorData(SensorData &sensor_data);
+void PackSensorInfo(SensorFrameInfo &sensor_info);
 void setupTimerGroupWDT();
 void feedHardwareWDT();
 void clearSensorData(SensorData* data);
 void addDummyData(SensorData &sensor_data);
 void deviceResetReason();
 
+// Memory budget report: stack high-water marks of registered tasks, heap state and a snapshot
+// of the heap blocks in use (not a count of allocations)
+#define MEMORY_MAX_TASKS    6
+void Memory_RegisterTask(TaskHandle_t handle, const char* name, uint32_t stackSize);
+void Memory_Report(void);
+
 #endif
@@ -1,18 +1,27 @@
 #include "AccModule.h"
+#include "FilterModule.h"
+#include "BurstModule.h"
 #include "LoggerModule.h"
 #include "Config.h"
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_ADXL345_U.h>
+#include <string.h>
 
 static Adafruit_ADXL345_Unified accel = Adafruit_ADXL345_Unified(12345);
 
+#define ADXL345_FIFO_MODE_STREAM  0x80   // FIFO_CTL: stream mode, keeps the newest 32 samples
+#define ADXL345_FIFO_ENTRIES_MASK 0x3F
+#define ACC_SAMPLE_PERIOD_US      1250   // 800 Hz output data rate
+
 int16_t Acc_Array[3] = {0};
+uint32_t Acc_SampleUs = 0;
 AccStatus_t Acc_Status = ACC_STATUS_OK;
 
-uint8_t Acc_Init(void)
+uint8_t Acc_Init(const uint8_t* present, uint8_t presentCount)
 {
-    if (!accel.begin()) {
+    bool listed = !present || memchr(present, ADXL345_DEFAULT_ADDRESS, presentCount) != NULL;
+    if (!listed || !accel.begin()) {
         LOG_ERROR("ADXL345 init fail");
         Acc_Status = ACC_STATUS_INIT_ERROR;
         return ACC_ERR_INIT;
@@ -22,29 +31,80 @@ uint8_t Acc_Init(void)
     accel.setRange(ADXL345_RANGE_16_G);
     LOG_DEBUG("accel.setRange complete.");
 
-    accel.setDataRate(ADXL345_DATARATE_3200_HZ);
+    // Oversample into the FIFO. It holds 32 samples, i.e. 40 ms at 800 Hz, so one drain
+    // per 20 ms sensor loop never overflows (at 3200 Hz it would span only 10 ms).
+    accel.setDataRate(ADXL345_DATARATE_800_HZ);
     LOG_DEBUG("accel.setDataRate complete.");
 
+    accel.writeRegister(ADXL345_REG_FIFO_CTL, ADXL345_FIFO_MODE_STREAM);
+    LOG_DEBUG("accel FIFO stream mode enabled.");
+
     Acc_Status = ACC_STATUS_OK;
     LOG_INFO("Acceleration module init OK");
     return ACC_ERR_OK;
 }
 
+// Reads one FIFO entry; the 6 data registers must be read in one burst to pop it
+static bool Acc_ReadFifoEntry(int16_t* xyz)
+{
+    Wire.beginTransmission(ADXL345_DEFAULT_ADDRESS);
+    Wire.write(ADXL345_REG_DATAX0);
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if (Wire.requestFrom((uint8_t)ADXL345_DEFAULT_ADDRESS, (uint8_t)6) != 6) {
+        return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        uint8_t lo = Wire.read();
+        uint8_t hi = Wire.read();
+        xyz[axis] = (int16_t)((hi << 8) | lo);
+    }
+    return true;
+}
+
+int Acc_DrainFifo(void)
+{
+    // Drain everything sampled since the last call into the decimation filter.
+    // The newest entry is taken as sampled now, older ones one output period apart.
+    uint8_t entries = accel.readRegister(ADXL345_REG_FIFO_STATUS) & ADXL345_FIFO_ENTRIES_MASK;
+    uint32_t newestUs = micros();
+    int16_t xyz[3];
+    for (uint8_t i = 0; i < entries; i++) {
+        if (!Acc_ReadFifoEntry(xyz)) {
+            return -1;
+        }
+        uint32_t sampleUs = newestUs - (uint32_t)(entries - 1 - i) * ACC_SAMPLE_PERIOD_US;
+        Filter_PushAcc(xyz[0], xyz[1], xyz[2], sampleUs);
+        if (BURST_ENABLED) {
+            Burst_PushAcc(xyz[0], xyz[1], xyz[2], sampleUs);
+        }
+    }
+
+    // Latest sample, used as is when the decimation stage is disabled
+    if (entries > 0) {
+        Acc_Array[0] = Acc_RawToMs2x10(xyz[0]);
+        Acc_Array[1] = Acc_RawToMs2x10(xyz[1]);
+        Acc_Array[2] = Acc_RawToMs2x10(xyz[2]);
+        Acc_SampleUs = newestUs;
+    }
+    return entries;
+}
+
 uint8_t Acc_Read(void)
 {
     if (Acc_Status == ACC_STATUS_INIT_ERROR) {
         return ACC_ERR_INIT;
     }
-    sensors_event_t event;
-    accel.getEvent(&event);
 
-    // Convert float (m/s^2) to raw short. 
-    // E.g. multiply by 10 to keep some resolution
-    Acc_Array[0] = (int16_t)(event.acceleration.x * 10);
-    Acc_Array[1] = (int16_t)(event.acceleration.y * 10);
-    Acc_Array[2] = (int16_t)(event.acceleration.z * 10);
+    int entries = Acc_DrainFifo();
+    if (entries < 0) {
+        LOG_ERROR("ADXL345 FIFO read fail");
+        Acc_Status = ACC_STATUS_READ_ERROR;
+        return ACC_ERR_READ;
+    }
 
-    LOG_DEBUG("Acc test: x=%d, y=%d, z=%d", Acc_Array[0], Acc_Array[1], Acc_Array[2]);
+    LOG_DEBUG("Acc test: x=%d, y=%d, z=%d (%d samples)", Acc_Array[0], Acc_Array[1], Acc_Array[2], entries);
 
     Acc_Status = ACC_STATUS_OK;
     return ACC_ERR_OK;
@@ -0,0 +1,121 @@
+#include "AlignModule.h"
+#include "Config.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "PressureModule.h"
+#include "AccModule.h"
+#endif
+
+// Two-tap history per channel: [0] older, [1] newest
+static int32_t  s_value[2][ALIGN_CHANNEL_COUNT];
+static uint32_t s_timeUs[2][ALIGN_CHANNEL_COUNT];
+static uint8_t  s_count[ALIGN_CHANNEL_COUNT];
+
+void Align_Reset(void)
+{
+    memset(s_value, 0, sizeof(s_value));
+    memset(s_timeUs, 0, sizeof(s_timeUs));
+    memset(s_count, 0, sizeof(s_count));
+}
+
+void Align_Push(uint8_t channel, int32_t value, uint32_t t_us)
+{
+    if (channel >= ALIGN_CHANNEL_COUNT) {
+        return;
+    }
+    if (s_count[channel] > 0 && t_us == s_timeUs[1][channel]) {
+        return;
+    }
+    s_value[0][channel]  = s_value[1][channel];
+    s_timeUs[0][channel] = s_timeUs[1][channel];
+    s_value[1][channel]  = value;
+    s_timeUs[1][channel] = t_us;
+    if (s_count[channel] < 2) {
+        s_count[channel]++;
+    }
+}
+
+// Range of the frame field the channel is stored in
+static inline int32_t clampChannel(uint8_t channel, int32_t v)
+{
+    int32_t lo = (channel < ALIGN_CH_ACC_X) ? 0 : INT16_MIN;
+    int32_t hi = (channel < ALIGN_CH_ACC_X) ? ALIGN_PRESSURE_MAX : INT16_MAX;
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+bool Align_Sample(uint8_t channel, uint32_t t_us, int32_t* out)
+{
+    if (channel >= ALIGN_CHANNEL_COUNT || s_count[channel] == 0) {
+        return false;
+    }
+    int32_t v1 = s_value[1][channel];
+    if (s_count[channel] == 1) {
+        *out = v1;
+        return true;
+    }
+    int32_t v0 = s_value[0][channel];
+    // Signed differences keep working across the micros() wrap
+    int32_t span = (int32_t)(s_timeUs[1][channel] - s_timeUs[0][channel]);
+    int32_t since = (int32_t)(t_us - s_timeUs[0][channel]);
+    if (since <= 0 || span <= 0) {
+        *out = v0;
+        return true;
+    }
+    // Past the newest sample: bounded extrapolation
+    int32_t limit = span + ((span < ALIGN_MAX_EXTRAPOLATE_US) ? span : ALIGN_MAX_EXTRAPOLATE_US);
+    if (since > limit) {
+        since = limit;
+    }
+    // v0 + (v1 - v0) * since / span, rounded to nearest
+    int64_t num = (int64_t)(v1 - v0) * since;
+    int64_t half = (num >= 0) ? span / 2 : -(span / 2);
+    *out = clampChannel(channel, v0 + (int32_t)((num + half) / span));
+    return true;
+}
+
+uint32_t Align_MaxSkewUs(uint32_t t_us)
+{
+    uint32_t maxSkew = 0;
+    for (int ch = 0; ch < ALIGN_CHANNEL_COUNT; ch++) {
+        if (s_count[ch] == 0) {
+            continue;
+        }
+        int32_t d = (int32_t)(t_us - s_timeUs[1][ch]);
+        uint32_t skew = (uint32_t)((d < 0) ? -d : d);
+        if (skew > maxSkew) {
+            maxSkew = skew;
+        }
+    }
+    return maxSkew;
+}
+
+#ifdef ARDUINO
+void Align_Apply(uint32_t frameUs)
+{
+    int32_t v;
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        bool down = (Pressure_DevHealth[dev].state != PRESSURE_DEV_OK);
+        for (int input = 0; input < PRESSURE_CHANNELS_PER_ADC; input++) {
+            uint8_t ch = ActiveTopology::sensorOf(dev, input);
+            if (down || Pressure_Array[ch] == PRESSURE_VALUE_DOWN) {
+                // Channels of a device that is down read PRESSURE_VALUE_DOWN until their first
+                // conversion after recovery; restart from scratch then
+                s_count[ch] = 0;
+                continue;
+            }
+            Align_Push(ch, Pressure_Array[ch], Pressure_SampleUs[ch]);
+            if (Align_Sample(ch, frameUs, &v)) {
+                Pressure_Array[ch] = (uint16_t)v;
+            }
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        Align_Push(ALIGN_CH_ACC_X + axis, Acc_Array[axis], Acc_SampleUs);
+        if (Align_Sample(ALIGN_CH_ACC_X + axis, frameUs, &v)) {
+            Acc_Array[axis] = (int16_t)v;
+        }
+    }
+}
+#endif
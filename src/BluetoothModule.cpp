@@ -1,5 +1,15 @@
 #include "BluetoothModule.h"
 #include "LoggerModule.h"
+#include "FramePoolModule.h"
+#include "FrameCodecModule.h"
+#include "DeltaModule.h"
+#include "SelfTestModule.h"
+#include "RetransmitModule.h"
+#include "BurstModule.h"
+#include "StatsModule.h"
+#include "LinkModule.h"
+#include "LatencyModule.h"
+#include "BootModule.h"
 
 // Use NimBLE-Arduino library
 #include "NimBLEDevice.h"
@@ -12,11 +22,96 @@
 // Global variables
 static NimBLEServer* pServer                   = nullptr;
 static NimBLECharacteristic* pTxCharacteristic = nullptr;
+static NimBLECharacteristic* pControlCharacteristic = nullptr;
+static NimBLECharacteristic* pBurstCharacteristic = nullptr;
+static NimBLECharacteristic* pStatsCharacteristic = nullptr;
+static NimBLECharacteristic* pSelfTestCharacteristic = nullptr;
 static NimBLEAdvertising* pAdvertising         = nullptr;
 static bool bleConnected                       = false;
 
 // Track subscription count
 static volatile uint8_t numSubscribers = 0;
+static volatile bool s_burstSubscribed = false;
+static volatile bool s_selfTestSubscribed = false;
+
+// Negotiated frame encoding. The NimBLE task writes s_pendingCodec, the send path
+// switches over between notifications. Both pending structs are several bytes, so
+// they are written and copied out under s_codecMux, never read half-updated.
+static FrameCodecConfig s_codec = { FRAME_FMT_LEGACY16, 0, 1 };
+static FrameCodecConfig s_pendingCodec = { FRAME_FMT_LEGACY16, 0, 1 };
+static volatile bool s_codecChanged = false;
+static portMUX_TYPE s_codecMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint16_t s_peerMtu = 23;   // ATT default until the central negotiates
+
+// Send-on-delta settings requested over SET_DELTA, applied together with the codec
+typedef struct {
+    uint16_t pressureDeadband;
+    uint8_t  accelDeadband;
+    uint16_t keyframeInterval;
+    uint8_t  maxSilence;
+} DeltaSettings;
+
+static const DeltaSettings DELTA_DEFAULTS = {
+    DELTA_PRESSURE_DEADBAND, DELTA_ACCEL_DEADBAND, DELTA_KEYFRAME_INTERVAL, DELTA_MAX_SILENCE
+};
+static DeltaSettings s_pendingDelta = DELTA_DEFAULTS;
+static DeltaEncoder_t s_delta;
+static uint32_t s_retxLost = 0;            // retry ring drops the delta stream has resynced after
+// Frames the delta stream sent in the current window (comm task only); suppressed ones
+// take no link capacity, so its batches are sized from what actually went out
+static uint32_t s_deltaWindowMs = 0;
+static uint32_t s_deltaFrames = 0;
+static uint32_t s_deltaBytes = 0;
+static uint8_t  s_deltaBatch = 1;          // frames per notification the link needs, last window
+
+// Notifications refused for lack of TX buffers wait in the retry ring. NimBLE raises
+// NOTIFY_TX (onStatus) inside notify() itself, so nothing announces a freed buffer: the
+// comm task retries the ring on its wakes (BLE_ServiceRetx). Senders on other tasks
+// (BLE_SendBuffer) share the ring, so it goes through the lock.
+static StaticSemaphore_t s_retxLockBuf;
+static SemaphoreHandle_t s_retxLock = NULL;
+static void BLE_ResetRetx(void);
+
+// Packed frames waiting to fill a notification
+static uint8_t s_notifyBuf[BLE_PREFERRED_MTU];
+static_assert(sizeof(s_notifyBuf) <= RETX_SLOT_SIZE, "a full notification must fit a retry slot");
+static size_t  s_notifyLen = 0;
+static uint8_t s_notifyFrames = 0;
+static uint32_t s_notifySampleUs = 0;      // sample_us of the oldest frame in s_notifyBuf
+
+// Burst upload in progress (comm task only): payload fixed for the whole window, next chunk
+static uint8_t  s_burstBuf[BLE_PREFERRED_MTU];
+static size_t   s_burstPayload = 0;
+static uint16_t s_burstChunk = 0;
+
+// Stats page the central selected for its next read
+static volatile uint8_t s_statsPage = 0;
+
+// Connection parameters the central granted. The NimBLE task writes them, the comm task
+// reads them for the link manager and the batching. The data length stays at the LL
+// default until the controller reports the change (BLE_GAP_EVENT_DATA_LEN_CHG); a
+// stack without that event never counts on data length extension.
+static volatile uint16_t s_connHandle = 0;
+static volatile uint16_t s_connInterval = 0;
+static volatile uint16_t s_connLatency = 0;
+static volatile uint16_t s_connTimeout = 0;
+static volatile uint8_t  s_txPhy = LINK_PHY_1M;
+static volatile uint8_t  s_rxPhy = LINK_PHY_1M;
+static volatile uint16_t s_dataLen = LINK_DEFAULT_DATA_LEN;
+static volatile bool     s_linkReset = false;  // new connection, the comm task restarts the manager
+static volatile bool     s_linkLost = false;   // central left, the comm task drops what waited for it
+
+// Stream load of the current window (comm task only)
+static uint32_t s_linkWindowMs = 0;
+static uint32_t s_linkNotifies = 0;
+static uint32_t s_linkBytes = 0;
+static uint16_t s_linkRefused = 0;
+static uint16_t s_linkStreamRate = 0;      // notifications/s of the last window
+static void linkGranted(LinkParams_t* params);
+#define BLE_STREAM_FRAMES_PER_SEC   (1000 / TASK_LOOP_INTERVAL_MS)  // what packed batching must keep up with
+static uint8_t linkBatch(size_t frameSize, uint32_t framesPerSec, uint8_t fit);
+
+static void BLE_HandleControl(const uint8_t* cmd, size_t len);
 
 // Watchdog timer variables
 static unsigned long lastSuccessfulOperation   = 0;
@@ -24,10 +119,32 @@ uint32_t lastCheck = 0;
 
 
 
+#ifdef BLE_GAP_EVENT_DATA_LEN_CHG
+// NimBLE task: the only word on what the controller negotiated
+static int gapEvent(ble_gap_event* event, void* arg)
+{
+    (void)arg;
+    if (event->type == BLE_GAP_EVENT_DATA_LEN_CHG && event->data_len_chg.conn_handle == s_connHandle) {
+        s_dataLen = event->data_len_chg.max_tx_octets;
+        LOG_INFO("Data length %u", event->data_len_chg.max_tx_octets);
+    }
+    return 0;
+}
+#endif
+
 class MyServerCallbacks: public NimBLEServerCallbacks {
     void onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) override {
+        (void)pServer;
         bleConnected = true;
         LOG_INFO("BLE device connected");
+        s_connHandle = connInfo.getConnHandle();
+        s_connInterval = connInfo.getConnInterval();
+        s_connLatency = connInfo.getConnLatency();
+        s_connTimeout = connInfo.getConnTimeout();
+        s_txPhy = LINK_PHY_1M;
+        s_rxPhy = LINK_PHY_1M;
+        s_dataLen = LINK_DEFAULT_DATA_LEN;
+        s_linkReset = true;
         lastSuccessfulOperation = millis();
 
         if (pAdvertising) {
@@ -36,7 +153,23 @@ class MyServerCallbacks: public NimBLEServerCallbacks {
     }
 
     void onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo, int reason) {
+        (void)pServer; (void)connInfo; (void)reason;
         bleConnected = false;
+        // Waiting notifications and the partial batch belong to the central that left. The
+        // comm task drops them: it may hold the retry lock, which the NimBLE task never waits for.
+        s_linkLost = true;
+        // A pending burst upload is dropped by the comm task
+        s_burstSubscribed = false;
+        s_selfTestSubscribed = false;
+        // Encoding is negotiated per connection
+        portENTER_CRITICAL(&s_codecMux);
+        s_pendingCodec.format = FRAME_FMT_LEGACY16;
+        s_pendingCodec.shift = 0;
+        s_pendingCodec.framesPerNotify = 1;
+        s_pendingDelta = DELTA_DEFAULTS;
+        s_codecChanged = true;
+        portEXIT_CRITICAL(&s_codecMux);
+        s_peerMtu = 23;
         LOG_INFO("BLE device disconnected");
         if (pAdvertising) {
             pAdvertising->start();
@@ -44,13 +177,31 @@ class MyServerCallbacks: public NimBLEServerCallbacks {
         }
     }
     // Inside your NimBLE server callback:
-    void onMTUChange(uint16_t MTU) {
-        LOG_INFO("Negotiated MTU: %d\n", MTU);
+    void onMTUChange(uint16_t MTU, NimBLEConnInfo& connInfo) override {
+        (void)connInfo;
+        s_peerMtu = MTU;
+        LOG_INFO("Negotiated MTU: %d", MTU);
+    }
+
+    void onConnParamsUpdate(NimBLEConnInfo& connInfo) override {
+        s_connInterval = connInfo.getConnInterval();
+        s_connLatency = connInfo.getConnLatency();
+        s_connTimeout = connInfo.getConnTimeout();
+        LOG_INFO("Connection interval %u x 1.25 ms, latency %u, timeout %u0 ms",
+                 s_connInterval, s_connLatency, s_connTimeout);
+    }
+
+    void onPhyUpdate(NimBLEConnInfo& connInfo, uint8_t txPhy, uint8_t rxPhy) override {
+        (void)connInfo;
+        s_txPhy = txPhy;
+        s_rxPhy = rxPhy;
+        LOG_INFO("PHY tx %u, rx %u", txPhy, rxPhy);
     }
 };
 
 class CharacteristicCallbacks: public NimBLECharacteristicCallbacks {
     void onSubscribe(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo, uint16_t subValue) override  {
+        (void)connInfo;
         if (!pTxCharacteristic) {
         LOG_ERROR("pTxCharacteristic is null!");
         return;
@@ -59,6 +210,17 @@ class CharacteristicCallbacks: public NimBLECharacteristicCallbacks {
         // subValue = 1: Subscribed to notifications
         // subValue = 2: Subscribed to indications
 
+        // Burst uploads do not count as stream subscribers
+        if (pCharacteristic == pBurstCharacteristic) {
+            s_burstSubscribed = (subValue != 0);
+            LOG_INFO("Client %s burst uploads.", subValue ? "subscribed to" : "unsubscribed from");
+            return;
+        }
+        if (pCharacteristic == pSelfTestCharacteristic) {
+            s_selfTestSubscribed = (subValue != 0);
+            LOG_INFO("Client %s self-test filler.", subValue ? "subscribed to" : "unsubscribed from");
+            return;
+        }
         if (subValue != 0) {
             numSubscribers++;
         } else {
@@ -67,11 +229,135 @@ class CharacteristicCallbacks: public NimBLECharacteristicCallbacks {
         LOG_INFO("onSubscribe Called! %d active subscribers", numSubscribers);
         if (pCharacteristic->getUUID().equals(pTxCharacteristic->getUUID())) {
             LOG_INFO("Client %s notifications.", subValue ? "subscribed to" : "unsubscribed from");
+            // Re-applying the codec restarts a delta stream with a keyframe for the new subscriber
+            s_codecChanged = true;
+        }
+    }
+};
+
+
+class ControlCallbacks: public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) override {
+        (void)connInfo;
+        NimBLEAttValue value = pCharacteristic->getValue();
+        BLE_HandleControl(value.data(), value.size());
+    }
+
+    void onRead(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) override {
+        (void)connInfo;
+        uint16_t mtu = s_peerMtu;
+        portENTER_CRITICAL(&s_codecMux);
+        FrameCodecConfig codec = s_pendingCodec;
+        portEXIT_CRITICAL(&s_codecMux);
+        uint8_t state[BLE_CONTROL_READ_SIZE] = {
+            codec.format, codec.shift, codec.framesPerNotify,
+            (uint8_t)(mtu & 0xFF), (uint8_t)(mtu >> 8)
+        };
+        pCharacteristic->setValue(state, sizeof(state));
+    }
+};
+
+
+class StatsCallbacks: public NimBLECharacteristicCallbacks {
+    void onWrite(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) override {
+        (void)connInfo;
+        NimBLEAttValue value = pCharacteristic->getValue();
+        if (value.size() >= 1 && value.data()[0] < STATS_PAGES) {
+            s_statsPage = value.data()[0];
         }
     }
+
+    void onRead(NimBLECharacteristic* pCharacteristic, NimBLEConnInfo& connInfo) override {
+        (void)connInfo;
+        uint8_t page[STATS_PAGE_SIZE];
+        size_t n = Stats_EncodePage(s_statsPage, page, sizeof(page));
+        pCharacteristic->setValue(page, n);
+    }
 };
 
 
+// Callback objects live for the whole program instead of being re-allocated on every BLE_Init()
+static MyServerCallbacks s_serverCallbacks;
+static CharacteristicCallbacks s_characteristicCallbacks;
+static ControlCallbacks s_controlCallbacks;
+static StatsCallbacks s_statsCallbacks;
+
+
+// Commands written to the control characteristic (runs in the NimBLE task)
+static void BLE_HandleControl(const uint8_t* cmd, size_t len)
+{
+    if (len < 1) {
+        return;
+    }
+    switch (cmd[0]) {
+        case BLE_CMD_SET_FORMAT: {
+            if (len < 4 || (Codec_FrameSize(cmd[1]) == 0 && cmd[1] != FRAME_FMT_DELTA)) {
+                LOG_WARN("SET_FORMAT rejected (len %u)", (unsigned)len);
+                return;
+            }
+            FrameCodecConfig cfg;
+            cfg.format = cmd[1];
+            cfg.shift = (cmd[2] == 0xFF || cmd[1] == FRAME_FMT_DELTA) ? Codec_DefaultShift(cmd[1]) : (cmd[2] & 0x0F);
+            cfg.framesPerNotify = (cfg.format == FRAME_FMT_LEGACY16) ? 1 : cmd[3];
+            portENTER_CRITICAL(&s_codecMux);
+            s_pendingCodec = cfg;
+            s_codecChanged = true;
+            portEXIT_CRITICAL(&s_codecMux);
+            LOG_INFO("Frame format %u, shift %u, %u frames/notification requested",
+                     cfg.format, cfg.shift, cfg.framesPerNotify);
+            break;
+        }
+        case BLE_CMD_SET_DELTA: {
+            if (len < 7) {
+                LOG_WARN("SET_DELTA rejected (len %u)", (unsigned)len);
+                return;
+            }
+            DeltaSettings d;
+            d.pressureDeadband = (uint16_t)(cmd[1] | (cmd[2] << 8));
+            d.accelDeadband = cmd[3];
+            d.keyframeInterval = (uint16_t)(cmd[4] | (cmd[5] << 8));
+            d.maxSilence = cmd[6];
+            // The 8-bit sequence tells the receiver how many frames a gap was; without a
+            // heartbeat, keyframes alone must come often enough that it cannot wrap
+            if (d.maxSilence == 0 && (d.keyframeInterval == 0 || d.keyframeInterval > 0xFF)) {
+                LOG_WARN("SET_DELTA rejected (keyframe every %u, no heartbeat: gaps past 255 frames)",
+                         d.keyframeInterval);
+                return;
+            }
+            portENTER_CRITICAL(&s_codecMux);
+            s_pendingDelta = d;
+            s_codecChanged = true;
+            portEXIT_CRITICAL(&s_codecMux);
+            LOG_INFO("Delta deadbands %u/%u, keyframe every %u, heartbeat after %u frames requested",
+                     d.pressureDeadband, d.accelDeadband, d.keyframeInterval, d.maxSilence);
+            break;
+        }
+        case BLE_CMD_SELFTEST:
+            LOG_INFO("Self-test requested by central");
+            SelfTest_Request();
+            break;
+        case BLE_CMD_BURST_TRIGGER:
+            LOG_INFO("Burst capture requested by central");
+            Burst_Request();
+            break;
+        case BLE_CMD_STATS_RESET:
+            if (len >= 5) {
+                uint16_t pressure = (uint16_t)(cmd[1] | (cmd[2] << 8));
+                uint16_t accel = (uint16_t)(cmd[3] | (cmd[4] << 8));
+                Stats_SetThresholds(pressure, accel);
+                LOG_INFO("Stats reset, thresholds %u counts / %u m/s^2 x 10", pressure, accel);
+            } else {
+                Stats_Reset();
+                LOG_INFO("Stats reset");
+            }
+            break;
+        default:
+            LOG_WARN("Unknown control command 0x%02X", cmd[0]);
+            break;
+    }
+}
+
+
 bool Get_BLE_Connected_Status(void)
 {
     return bleConnected;
@@ -83,6 +369,12 @@ uint8_t BLE_GetNumOfSubscribers(void)
     return numSubscribers;
 }
 
+
+uint16_t BLE_GetPeerMtu(void)
+{
+    return s_peerMtu;
+}
+
 bool BLE_Init(bool FlagSide)
 {
     // 1. Choose name and UUIDs based on side flag
@@ -91,18 +383,35 @@ bool BLE_Init(bool FlagSide)
     const char* charUUID     = (FlagSide) ? CHARACTERISTIC_UUID_RIGHT : CHARACTERISTIC_UUID_LEFT;
     
 
+    if (!s_retxLock) {
+        s_retxLock = xSemaphoreCreateMutexStatic(&s_retxLockBuf);
+    }
+    BLE_ResetRetx();
+
     // 2. Initialize NimBLE
-    NimBLEDevice::deinit(true); // Cleanup before re-initializing
+    // Cleanup only when re-initializing; on first boot there is nothing to tear down
+    if (NimBLEDevice::isInitialized()) {
+        NimBLEDevice::deinit(true);
+    }
     pServer = nullptr;
     pTxCharacteristic = nullptr;
+    pControlCharacteristic = nullptr;
+    pBurstCharacteristic = nullptr;
+    pStatsCharacteristic = nullptr;
+    pSelfTestCharacteristic = nullptr;
+    s_burstSubscribed = false;
+    s_selfTestSubscribed = false;
     pAdvertising = nullptr;
     NimBLEDevice::init(deviceName);
 
     // (Optional) Set TX power for better range
     esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_DEFAULT, BLE_TX_POWER);
 
-    // Set MTU to 50 bytes
-    NimBLEDevice::setMTU(50);
+    // Offer a larger MTU; legacy 39-byte frames still fit the old 50-byte setting
+    NimBLEDevice::setMTU(BLE_PREFERRED_MTU);
+#ifdef BLE_GAP_EVENT_DATA_LEN_CHG
+    NimBLEDevice::setCustomGapHandler(gapEvent);
+#endif
 
     // 3. Create BLE Server & set callbacks
     pServer = NimBLEDevice::createServer();
@@ -114,7 +423,7 @@ bool BLE_Init(bool FlagSide)
         pAdvertising = nullptr;
         return false;
     }
-    pServer->setCallbacks(new MyServerCallbacks());
+    pServer->setCallbacks(&s_serverCallbacks, false); // static object, NimBLE must not delete it
 
 
 
@@ -136,7 +445,53 @@ bool BLE_Init(bool FlagSide)
         return false;
     }
     // start  callback
-    pTxCharacteristic->setCallbacks(new CharacteristicCallbacks());
+    pTxCharacteristic->setCallbacks(&s_characteristicCallbacks);
+
+
+    // Control characteristic: format negotiation and other commands
+    pControlCharacteristic = pService->createCharacteristic(
+        (FlagSide) ? CONTROL_UUID_RIGHT : CONTROL_UUID_LEFT,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE
+    );
+    if (!pControlCharacteristic) {
+        LOG_ERROR("Failed to create BLE control characteristic");
+        return false;
+    }
+    pControlCharacteristic->setCallbacks(&s_controlCallbacks);
+
+    // Burst characteristic: captured windows are uploaded here, next to the stream
+    pBurstCharacteristic = pService->createCharacteristic(
+        (FlagSide) ? BURST_UUID_RIGHT : BURST_UUID_LEFT,
+        NIMBLE_PROPERTY::NOTIFY
+    );
+    if (!pBurstCharacteristic) {
+        LOG_ERROR("Failed to create BLE burst characteristic");
+        return false;
+    }
+    pBurstCharacteristic->setCallbacks(&s_characteristicCallbacks);
+
+    // Stats characteristic: session summary, one page per read
+    pStatsCharacteristic = pService->createCharacteristic(
+        (FlagSide) ? STATS_UUID_RIGHT : STATS_UUID_LEFT,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE
+    );
+    if (!pStatsCharacteristic) {
+        LOG_ERROR("Failed to create BLE stats characteristic");
+        return false;
+    }
+    pStatsCharacteristic->setCallbacks(&s_statsCallbacks);
+
+    // Self-test characteristic: the notify phase measures throughput with filler that must
+    // not reach a stream decoder (a legacy decoder takes any 39 bytes as a frame)
+    pSelfTestCharacteristic = pService->createCharacteristic(
+        (FlagSide) ? SELFTEST_UUID_RIGHT : SELFTEST_UUID_LEFT,
+        NIMBLE_PROPERTY::NOTIFY
+    );
+    if (!pSelfTestCharacteristic) {
+        LOG_ERROR("Failed to create BLE self-test characteristic");
+        return false;
+    }
+    pSelfTestCharacteristic->setCallbacks(&s_characteristicCallbacks);
 
 
     // Add CCCD descriptor explicitly
@@ -171,6 +526,8 @@ bool BLE_Init(bool FlagSide)
     // Use proper manufacturer ID + data format
     uint8_t mfgData[] = {0x01, 0x02, 'C','o','r','A','l','i','g','n'};
     scanResponse.setManufacturerData(mfgData, sizeof(mfgData));
+    // Centrals that honour it connect with a short interval right away
+    scanResponse.setPreferredParams(ADVERTISING_INTERVAL_MIN_PREFERRED, ADVERTISING_INTERVAL_MAX_PREFERRED);
 
     // Set the advertising and scan response data
     pAdvertising->setAdvertisementData(advData);
@@ -190,75 +547,247 @@ bool BLE_Init(bool FlagSide)
     return true;
 }
 
-bool processAndTransmitSensorData(const SensorData* data) {
-  // 1. Create individual 2-byte arrays for each multi-byte field
-  uint8_t battery_arr[1] = {data->battery}; // 1 byte
+// Sends a frame that is already in wire format, straight from the caller's buffer
+static bool processAndTransmitFrame(const uint8_t* frame, size_t len) {
+    if (LOG_LEVEL_SELECTED >= LOGGER_LEVEL_DEBUG)
+    {
+        // Hex dump only when it will be printed; "XX " per byte
+        char hex_str[3 * FRAME_MAX_SIZE + 1];
+        char* p = hex_str;
+        for (size_t i = 0; i < len && i < FRAME_MAX_SIZE; i++) {
+            static const char digits[] = "0123456789ABCDEF";
+            *p++ = digits[frame[i] >> 4];
+            *p++ = digits[frame[i] & 0x0F];
+            *p++ = ' ';
+        }
+        *p = '\0';
+        LOG_DEBUG("Frame (%u bytes): %s", (unsigned)len, hex_str);
+    }
 
-  uint8_t accel_x_arr[2];
-  memcpy(accel_x_arr, &data->accel_x, sizeof(data->accel_x));
+    // notify(value, len) sends without copying into the characteristic value first
+    return pTxCharacteristic->notify(frame, len);
+}
+
+// A notification went out: its oldest frame's sample-to-air latency, measured here
+// rather than when the frame was batched, suppressed or parked for retry
+static void notifySent(uint32_t sampleUs)
+{
+    Latency_Record(micros() - sampleUs);
+    Boot_MarkFirstNotify();
+}
 
-  uint8_t accel_y_arr[2];
-  memcpy(accel_y_arr, &data->accel_y, sizeof(data->accel_y));
+// Retry ring send function; the stamp is the oldest sample time of the notification
+static bool notifySend(const uint8_t* data, size_t len, uint32_t sampleUs, void* ctx)
+{
+    (void)ctx;
+    if (!processAndTransmitFrame(data, len)) {
+        return false;
+    }
+    notifySent(sampleUs);
+    return true;
+}
 
-  uint8_t accel_z_arr[2];
-  memcpy(accel_z_arr, &data->accel_z, sizeof(data->accel_z));
+uint16_t BLE_ServiceRetx(void)
+{
+    // Nothing of the last connection goes to the next central
+    if (s_linkLost || !s_retxLock) {
+        return 0;
+    }
+    xSemaphoreTake(s_retxLock, portMAX_DELAY);
+    Retx_Drain(notifySend, NULL);
+    uint16_t depth = Retx_Depth();
+    xSemaphoreGive(s_retxLock);
+    return depth;
+}
 
-  uint8_t pressure_arr[16][2]; // 16 pressure values × 2 bytes
-  for(int i=0; i<16; i++) {
-    memcpy(pressure_arr[i], &data->pressure[i], sizeof(uint16_t));
-  }
+static void BLE_ResetRetx(void)
+{
+    if (!s_retxLock) {
+        return;
+    }
+    xSemaphoreTake(s_retxLock, portMAX_DELAY);
+    Retx_Reset();
+    xSemaphoreGive(s_retxLock);
+}
 
+// Sends a finished notification behind any that are still waiting. sampleUs is the
+// oldest frame's sample time, kept with the notification until it goes out.
+// Returns true when it went out now; false when it waits in the retry ring (or,
+// without the ring, was refused).
+static bool sendOrQueue(const uint8_t* data, size_t len, uint32_t sampleUs)
+{
+    // Stream load for the link manager; a notification that had to wait means the link is short
+    s_linkNotifies++;
+    s_linkBytes += len;
+    if (!RETX_ENABLED || !s_retxLock) {
+        bool sent = notifySend(data, len, sampleUs, NULL);
+        if (!sent) {
+            s_linkRefused++;
+            Delta_ForceKeyframe(&s_delta);  // nothing retries it, so the delta base is lost
+        }
+        return sent;
+    }
+    xSemaphoreTake(s_retxLock, portMAX_DELAY);
+    bool sent = Retx_Send(data, len, sampleUs, notifySend, NULL);
+    if (!sent) {
+        s_linkRefused++;
+    }
+    RetxStats_t st;
+    Retx_GetStats(&st);
+    xSemaphoreGive(s_retxLock);
+    // The delta encoder moved its reference when it encoded what the ring just dropped,
+    // so the receiver's base is gone: the next delta frame is a keyframe
+    uint32_t lost = st.dropped + st.oversize;
+    if (lost > s_retxLost) {
+        Delta_ForceKeyframe(&s_delta);
+    }
+    s_retxLost = lost;
+    return sent;
+}
 
+// Starts a fresh delta stream (keyframe first) with the requested settings
+static void deltaRestart(const DeltaSettings* settings)
+{
+    Delta_InitEncoder(&s_delta);
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        s_delta.deadband[ch] = settings->pressureDeadband;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        s_delta.deadband[DELTA_CH_ACC_X + axis] = settings->accelDeadband;
+    }
+    s_delta.keyframeInterval = settings->keyframeInterval;
+    s_delta.maxSilence = settings->maxSilence;
+    s_deltaWindowMs = millis();
+    s_deltaFrames = 0;
+    s_deltaBytes = 0;
+    s_deltaBatch = 1;
+}
 
-  // 3. Concatenate all arrays into one buffer
-  uint8_t final_buffer[39];
-  int offset = 0;
+// Delta frames vary in size: batch until the target count is reached or the next
+// frame might not fit the MTU. Suppressed frames send nothing and count as success.
+static bool deltaTransmit(const SensorData* frame, const SensorFrameInfo* info, uint32_t sampleUs)
+{
+    size_t cap = (s_peerMtu > 3) ? (size_t)(s_peerMtu - 3) : 0;
+    if (cap > sizeof(s_notifyBuf)) {
+        cap = sizeof(s_notifyBuf);
+    }
+    if (cap < DELTA_MAX_FRAME_SIZE) {
+        cap = DELTA_MAX_FRAME_SIZE;     // small MTU: one frame per notification
+    }
 
-  // Battery (1 byte)
-  memcpy(final_buffer + offset, battery_arr, 1);
-  offset += 1;
+    // Once per window: the batch the granted link needs for the frames of the last one
+    uint32_t now = millis();
+    uint32_t elapsed = now - s_deltaWindowMs;
+    if (elapsed >= LINK_MEASURE_MS) {
+        s_deltaBatch = 1;
+        if (s_deltaFrames) {
+            size_t mean = s_deltaBytes / s_deltaFrames;
+            size_t fit = cap / (mean ? mean : 1);
+            s_deltaBatch = linkBatch(mean, s_deltaFrames * 1000 / elapsed, (uint8_t)((fit > 255) ? 255 : fit));
+        }
+        s_deltaWindowMs = now;
+        s_deltaFrames = 0;
+        s_deltaBytes = 0;
+    }
+    uint8_t target = s_codec.framesPerNotify;
+    if (target != 0 && target < s_deltaBatch) {
+        target = s_deltaBatch;
+    }
 
-  // Accelerations (2 bytes each)
-  memcpy(final_buffer + offset, accel_x_arr, 2);
-  offset += 2;
-  memcpy(final_buffer + offset, accel_y_arr, 2);
-  offset += 2;
-  memcpy(final_buffer + offset, accel_z_arr, 2);
-  offset += 2;
+    size_t n = Delta_Encode(&s_delta, frame, info, s_notifyBuf + s_notifyLen, cap - s_notifyLen);
+    if (n == 0) {
+        return true;
+    }
+    s_deltaFrames++;
+    s_deltaBytes += n;
+    if (s_notifyFrames == 0) {
+        s_notifySampleUs = sampleUs;
+    }
+    s_notifyLen += n;
+    ++s_notifyFrames;
+    if ((target != 0 && s_notifyFrames >= target) || cap - s_notifyLen < DELTA_MAX_FRAME_SIZE) {
+        bool sent = sendOrQueue(s_notifyBuf, s_notifyLen, s_notifySampleUs);
+        s_notifyLen = 0;
+        s_notifyFrames = 0;
+        return sent;
+    }
+    return true;
+}
 
-  // Pressures (2 bytes each)
-  for(int i=0; i<16; i++) {
-    memcpy(final_buffer + offset, pressure_arr[i], 2);
-    offset += 2;
-  }
+// Encodes a 39-byte frame with the negotiated format and sends it once a notification is full.
+// Returns true when the frame went out or waits in the batch for the next notification,
+// false when the notification it completed could not go out now.
+static bool encodeAndTransmit(const uint8_t* frame, size_t len, const SensorFrameInfo* info)
+{
+    // Frames without read timing (BLE_SendBuffer) count from now
+    uint32_t sampleUs = info ? info->sample_us : micros();
 
-  // 4. Print concatenated buffer
-  char hex_str[3*39 + 1] = {0};
-  for(int i=0; i<39; i++) {
-    snprintf(hex_str + strlen(hex_str), sizeof(hex_str) - strlen(hex_str), "%02X ", final_buffer[i]);
-  }
-    if (LOG_LEVEL_SELECTED >= LOGGER_LEVEL_DEBUG)
-    {
-        // 2. Print individual components
-        LOG_DEBUG("Battery: %02X", battery_arr[0]);
+    // The central left since the last frame: what waited for it is dropped, not sent to the next one
+    if (s_linkLost) {
+        s_linkLost = false;
+        BLE_ResetRetx();
+        s_retxLost = 0;
+        s_notifyLen = 0;
+        s_notifyFrames = 0;
+    }
 
-        LOG_DEBUG("Accel X: %02X %02X", accel_x_arr[0], accel_x_arr[1]);
-        LOG_DEBUG("Accel Y: %02X %02X", accel_y_arr[0], accel_y_arr[1]);
-        LOG_DEBUG("Accel Z: %02X %02X", accel_z_arr[0], accel_z_arr[1]);
+    // Switch formats only at a notification boundary
+    if (s_codecChanged) {
+        portENTER_CRITICAL(&s_codecMux);
+        FrameCodecConfig codec = s_pendingCodec;
+        DeltaSettings delta = s_pendingDelta;
+        s_codecChanged = false;
+        portEXIT_CRITICAL(&s_codecMux);
 
-        for(int i=0; i<16; i++) {
-            LOG_DEBUG("Pressure[%d]: %02X %02X", i, pressure_arr[i][0], pressure_arr[i][1]);
+        if (s_notifyLen > 0) {
+            sendOrQueue(s_notifyBuf, s_notifyLen, s_notifySampleUs);
+        }
+        s_notifyLen = 0;
+        s_notifyFrames = 0;
+        s_codec = codec;
+        if (s_codec.format == FRAME_FMT_DELTA) {
+            deltaRestart(&delta);
         }
-        LOG_DEBUG("Concatenated Buffer: %s", hex_str);
     }
 
+    if (s_codec.format == FRAME_FMT_DELTA && len == sizeof(SensorData)) {
+        return deltaTransmit((const SensorData*)frame, info, sampleUs);
+    }
+
+    if (s_codec.format == FRAME_FMT_LEGACY16 || len != sizeof(SensorData)) {
+        return sendOrQueue(frame, len, sampleUs);
+    }
 
-  // 5. Transmit via BLE
-  pTxCharacteristic->setValue(final_buffer, 39);
-  return pTxCharacteristic->notify();
+    // Never batch more than the negotiated MTU carries, nor less than the granted link carries
+    uint8_t fit = Codec_FramesPerNotification(s_codec.format, s_peerMtu);
+    uint8_t target = (s_codec.framesPerNotify == 0 || s_codec.framesPerNotify > fit) ? fit : s_codec.framesPerNotify;
+    uint8_t need = linkBatch(Codec_FrameSize(s_codec.format), BLE_STREAM_FRAMES_PER_SEC, fit);
+    if (target < need) {
+        target = need;
+    }
+    if (target == 0) {
+        target = 1;
+    }
+
+    size_t n = Codec_Encode((const SensorData*)frame, info, &s_codec, s_notifyBuf + s_notifyLen,
+                            sizeof(s_notifyBuf) - s_notifyLen);
+    if (n == 0) {
+        return false;
+    }
+    if (s_notifyFrames == 0) {
+        s_notifySampleUs = sampleUs;
+    }
+    s_notifyLen += n;
+    if (++s_notifyFrames < target) {
+        return true;
+    }
+    bool sent = sendOrQueue(s_notifyBuf, s_notifyLen, s_notifySampleUs);
+    s_notifyLen = 0;
+    s_notifyFrames = 0;
+    return sent;
 }
 
-bool BLE_SendBuffer(SensorData* sensor_msg)
+bool BLE_SendFrame(const uint8_t* frame, size_t len, const SensorFrameInfo* info)
 {
 // Try to send all buffered data
     bool anySent = false;
@@ -276,18 +805,248 @@ bool BLE_SendBuffer(SensorData* sensor_msg)
 
 
     // 3. Send the buffer via BLE
-    bool success = processAndTransmitSensorData(sensor_msg);
+    bool success = encodeAndTransmit(frame, len, info);
     
     if (success) {
         lastSuccessfulOperation = millis();  // Update watchdog timer
         anySent = true;
     } else {
-        LOG_WARN("BLE_SendByteArray: failed to notify");
+        LOG_WARN("BLE_SendFrame: notification not sent now (waiting for a TX buffer)");
         // If send fails, break the loop
     }
   return anySent;
 }
 
+void BLE_ServiceBurst(void)
+{
+    if (Burst_GetState() != BURST_FROZEN) {
+        return;
+    }
+    if (!pBurstCharacteristic || !pServer || !s_burstSubscribed || pServer->getConnectedCount() == 0) {
+        // Nobody to upload to; recording resumes
+        LOG_INFO("Burst window dropped, no subscriber");
+        Burst_Release();
+        s_burstPayload = 0;
+        return;
+    }
+
+    // The stream goes first: no chunks while refused frames are still waiting for a TX buffer
+    if (s_retxLock) {
+        if (xSemaphoreTake(s_retxLock, 0) != pdTRUE) {
+            return;
+        }
+        uint16_t depth = Retx_Depth();
+        xSemaphoreGive(s_retxLock);
+        if (depth > 0) {
+            return;
+        }
+    }
+
+    if (s_burstPayload == 0) {
+        uint16_t mtu = s_peerMtu;
+        s_burstPayload = (mtu > 3) ? (size_t)(mtu - 3) : 0;
+        if (s_burstPayload > sizeof(s_burstBuf)) {
+            s_burstPayload = sizeof(s_burstBuf);
+        }
+        s_burstChunk = 0;
+        BurstWindow_t w;
+        Burst_GetWindow(&w);
+        LOG_INFO("Burst capture (trigger %u): %lu records, %u chunks", (unsigned)w.source,
+                 (unsigned long)w.count, Burst_ChunkCount(s_burstPayload));
+    }
+
+    // Stay within what the granted link carries beside the stream, so stream frames keep their buffers
+    int budget = BURST_CHUNKS_PER_FRAME;
+    if (LINK_MANAGER_ENABLED) {
+        LinkParams_t granted;
+        linkGranted(&granted);
+        uint32_t rate = Link_NotifyRate(&granted, s_burstPayload);
+        uint32_t spare = (rate > s_linkStreamRate) ? (rate - s_linkStreamRate) * TASK_LOOP_INTERVAL_MS / 1000 : 0;
+        if (spare < (uint32_t)budget) {
+            budget = spare ? (int)spare : 1;
+        }
+    }
+
+    uint16_t chunks = Burst_ChunkCount(s_burstPayload);
+    for (int i = 0; i < budget && s_burstChunk < chunks; i++) {
+        size_t n = Burst_EncodeChunk(s_burstChunk, s_burstBuf, s_burstPayload);
+        if (n == 0 || !pBurstCharacteristic->notify(s_burstBuf, n)) {
+            break;      // no TX buffer; the same chunk goes next frame
+        }
+        s_burstChunk++;
+    }
+    if (s_burstChunk >= chunks) {
+        LOG_INFO("Burst upload complete (%u chunks)", chunks);
+        Burst_Release();
+        s_burstPayload = 0;
+    }
+}
+
+static void linkGranted(LinkParams_t* params)
+{
+    params->interval = s_connInterval;
+    params->latency = s_connLatency;
+    params->timeout = s_connTimeout;
+    params->txPhy = s_txPhy;
+    params->rxPhy = s_rxPhy;
+    params->dataLen = s_dataLen;
+    params->mtu = s_peerMtu;
+}
+
+static uint8_t phyMask(uint8_t phy)
+{
+    switch (phy) {
+        case LINK_PHY_2M:    return BLE_GAP_LE_PHY_2M_MASK;
+        case LINK_PHY_CODED: return BLE_GAP_LE_PHY_CODED_MASK;
+        default:             return BLE_GAP_LE_PHY_1M_MASK;
+    }
+}
+
+void BLE_ServiceLink(void)
+{
+    if (!LINK_MANAGER_ENABLED || !pServer || !bleConnected) {
+        return;
+    }
+    uint32_t now = millis();
+    if (s_linkReset) {
+        s_linkReset = false;
+        Link_Reset(now);
+        s_linkWindowMs = now;
+        s_linkNotifies = 0;
+        s_linkBytes = 0;
+        s_linkRefused = 0;
+        s_linkStreamRate = 0;
+        return;
+    }
+    uint32_t elapsed = now - s_linkWindowMs;
+    if (elapsed < LINK_MEASURE_MS) {
+        return;
+    }
+
+    LinkDemand_t demand;
+    demand.streaming = numSubscribers > 0;
+    demand.payload = s_linkNotifies ? (uint16_t)(s_linkBytes / s_linkNotifies) : 0;
+    demand.notifyPerSec = (uint16_t)(s_linkNotifies * 1000 / elapsed);
+    demand.bulk = BURST_ENABLED && s_burstSubscribed && Burst_GetState() == BURST_FROZEN;
+    demand.refused = s_linkRefused;
+    s_linkStreamRate = demand.notifyPerSec;
+    s_linkWindowMs = now;
+    s_linkNotifies = 0;
+    s_linkBytes = 0;
+    s_linkRefused = 0;
+
+    LinkParams_t granted;
+    linkGranted(&granted);
+    LinkProfileParams_t req;
+    if (!Link_Update(&granted, &demand, now, &req)) {
+        return;
+    }
+    LinkStats_t st;
+    Link_GetStats(&st);
+    LOG_INFO("Link profile %s: interval %u-%u, PHY %u, data length %u requested (load %u notify/s x %u B)",
+             Link_ProfileName((LinkProfile_t)st.profile), req.minInterval, req.maxInterval, req.phy,
+             req.dataLen, demand.notifyPerSec, demand.payload);
+    uint16_t handle = s_connHandle;
+    if (req.minInterval) {
+        pServer->updateConnParams(handle, req.minInterval, req.maxInterval, req.latency, req.timeout);
+    }
+    if (req.phy) {
+        pServer->updatePhy(handle, phyMask(req.phy), phyMask(req.phy), 0);
+    }
+    if (req.dataLen) {
+        // s_dataLen follows once the controller reports what it negotiated
+        pServer->setDataLen(handle, req.dataLen);
+    }
+}
+
+bool BLE_GetLinkCapacity(LinkCapacity_t* cap)
+{
+    if (!bleConnected) {
+        return false;
+    }
+    LinkParams_t granted;
+    linkGranted(&granted);
+    Link_Capacity(&granted, cap);
+    return true;
+}
+
+// Fewest frames per notification that keep up with framesPerSec on the granted link,
+// at most fit. 1 when single frames go through, so a short interval keeps its latency.
+static uint8_t linkBatch(size_t frameSize, uint32_t framesPerSec, uint8_t fit)
+{
+    LinkCapacity_t cap;
+    if (!LINK_MANAGER_ENABLED || !BLE_GetLinkCapacity(&cap) || cap.notifyPerSec >= framesPerSec) {
+        return 1;
+    }
+    LinkParams_t granted;
+    linkGranted(&granted);
+    return Link_BatchFrames(&granted, frameSize, framesPerSec, fit);
+}
+
+void BLE_PrintLinkSummary(void)
+{
+    if (!LINK_MANAGER_ENABLED || !bleConnected) {
+        return;
+    }
+    LinkParams_t granted;
+    linkGranted(&granted);
+    LinkCapacity_t cap;
+    Link_Capacity(&granted, &cap);
+    LinkStats_t st;
+    Link_GetStats(&st);
+    if (st.shortfall || st.rejected || st.phyRefused) {
+        LOG_WARN("Link %s: %lu us, PHY %u, data length %u, MTU %u => %u notify/s, %lu B/s; load %u%%, %lu requests, %lu rejected%s",
+                 Link_ProfileName((LinkProfile_t)st.profile), (unsigned long)cap.intervalUs, granted.txPhy,
+                 granted.dataLen, granted.mtu, cap.notifyPerSec, (unsigned long)cap.bytesPerSec, st.loadPct,
+                 (unsigned long)st.requests, (unsigned long)st.rejected, st.phyRefused ? ", PHY refused" : "");
+    } else {
+        LOG_INFO("Link %s: %lu us, PHY %u, data length %u, MTU %u => %u notify/s, %lu B/s; load %u%%, %lu requests",
+                 Link_ProfileName((LinkProfile_t)st.profile), (unsigned long)cap.intervalUs, granted.txPhy,
+                 granted.dataLen, granted.mtu, cap.notifyPerSec, (unsigned long)cap.bytesPerSec, st.loadPct,
+                 (unsigned long)st.requests);
+    }
+}
+
+void BLE_PrintRetxSummary(void)
+{
+    if (!s_retxLock) {
+        return;
+    }
+    RetxStats_t st;
+    xSemaphoreTake(s_retxLock, portMAX_DELAY);
+    Retx_GetStats(&st);
+    xSemaphoreGive(s_retxLock);
+    if (st.dropped || st.oversize) {
+        LOG_WARN("Notify retry: %lu direct, %lu queued, %lu resent, %lu dropped (last #%u), %lu oversize, depth %u max %u",
+                 (unsigned long)st.direct, (unsigned long)st.queued, (unsigned long)st.resent,
+                 (unsigned long)st.dropped, st.lastDroppedIndex, (unsigned long)st.oversize, st.depth, st.maxDepth);
+    } else {
+        LOG_INFO("Notify retry: %lu direct, %lu queued, %lu resent, depth %u max %u",
+                 (unsigned long)st.direct, (unsigned long)st.queued, (unsigned long)st.resent,
+                 st.depth, st.maxDepth);
+    }
+}
+
+uint16_t BLE_GetSelfTestPayload(void)
+{
+    uint16_t mtu = s_peerMtu;
+    return (s_selfTestSubscribed && mtu > 3) ? (uint16_t)(mtu - 3) : 0;
+}
+
+bool BLE_NotifySelfTest(const uint8_t* data, size_t len)
+{
+    if (!pSelfTestCharacteristic || !pServer || !s_selfTestSubscribed || pServer->getConnectedCount() == 0) {
+        return false;
+    }
+    return pSelfTestCharacteristic->notify(data, len);
+}
+
+bool BLE_SendBuffer(SensorData* sensor_msg)
+{
+    // SensorData is packed, so the struct itself is the 39-byte wire frame
+    return BLE_SendFrame((const uint8_t*)sensor_msg, sizeof(SensorData), NULL);
+}
+
 // Modified BLE_Test to demonstrate buffer functionality
 void BLE_Test(void)
 {
@@ -303,7 +1062,7 @@ void BLE_Test(void)
     sensor_msg.accel_x = 123;
     sensor_msg.accel_y = 456;
     sensor_msg.accel_z = 789;
-    for (int i = 0; i < 16; i++) {
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
         sensor_msg.pressure[i] = 1000 + i;
     }
 
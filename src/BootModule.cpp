@@ -0,0 +1,162 @@
+#include "BootModule.h"
+#include "UtilitiesModule.h"
+#include "LoggerModule.h"
+#include "Config.h"
+#include <Wire.h>
+#include <Preferences.h>
+
+typedef struct {
+    const char* name;
+    uint32_t    us;
+} BootPhase_t;
+
+static BootPhase_t s_phases[BOOT_MAX_PHASES];
+static uint8_t  s_phaseCount = 0;
+static uint32_t s_firstFrameUs = 0;
+static uint32_t s_firstNotifyUs = 0;
+
+// Phases are marked from setup() and the BLE bring-up task
+static portMUX_TYPE s_bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+void Boot_MarkPhase(const char* name)
+{
+    uint32_t now = micros();
+    portENTER_CRITICAL(&s_bootMux);
+    if (s_phaseCount < BOOT_MAX_PHASES) {
+        s_phases[s_phaseCount].name = name;
+        s_phases[s_phaseCount].us = now;
+        s_phaseCount++;
+    }
+    portEXIT_CRITICAL(&s_bootMux);
+}
+
+void Boot_MarkFirstFrame(void)
+{
+    if (s_firstFrameUs == 0) {
+        s_firstFrameUs = micros();
+        LOG_INFO("Boot: first frame at %lu ms", (unsigned long)(s_firstFrameUs / 1000));
+    }
+}
+
+// Called from the comm task and, for resent notifications, the NimBLE task
+void Boot_MarkFirstNotify(void)
+{
+    uint32_t now = micros();
+    portENTER_CRITICAL(&s_bootMux);
+    bool first = (s_firstNotifyUs == 0);
+    if (first) {
+        s_firstNotifyUs = now;
+    }
+    portEXIT_CRITICAL(&s_bootMux);
+    if (first) {
+        LOG_INFO("Boot: first notify at %lu ms", (unsigned long)(now / 1000));
+    }
+}
+
+void Boot_PrintReport(void)
+{
+    BootPhase_t phases[BOOT_MAX_PHASES];
+    portENTER_CRITICAL(&s_bootMux);
+    uint8_t count = s_phaseCount;
+    memcpy(phases, s_phases, count * sizeof(BootPhase_t));
+    portEXIT_CRITICAL(&s_bootMux);
+
+    // Durations run from the previous mark in time order, whichever task made it
+    LOG_INFO("Boot timing (%s):", FAST_BOOT_ENABLED ? "fast boot" : "full boot");
+    uint32_t prev = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        LOG_INFO("  %-16s done at %6lu us (+%lu us)", phases[i].name, (unsigned long)phases[i].us,
+                 (unsigned long)(phases[i].us - prev));
+        prev = phases[i].us;
+    }
+    if (s_firstFrameUs) {
+        LOG_INFO("  time to first frame  %lu us", (unsigned long)s_firstFrameUs);
+    }
+    if (s_firstNotifyUs) {
+        LOG_INFO("  time to first notify %lu us", (unsigned long)s_firstNotifyUs);
+    }
+}
+
+// FNV-1a over the build and the settings that decide which devices are expected
+static uint32_t Boot_ConfigHash(void)
+{
+    const char* build = __DATE__ " " __TIME__;
+    const uint32_t settings[] = { I2C_SDA_Pin, I2C_SCL_Pin, g_sideFlag, testDeviceBLE };
+    uint32_t h = 2166136261u;
+    for (const char* p = build; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    const uint8_t* s = (const uint8_t*)settings;
+    for (size_t i = 0; i < sizeof(settings); i++) {
+        h = (h ^ s[i]) * 16777619u;
+    }
+    return h;
+}
+
+static bool Boot_LoadDeviceMap(BootDeviceMap_t* map)
+{
+    Preferences prefs;
+    if (!prefs.begin(BOOT_NVS_NAMESPACE, true)) {
+        return false;
+    }
+    bool ok = prefs.getBytesLength(BOOT_NVS_KEY_DEVMAP) == sizeof(BootDeviceMap_t) &&
+              prefs.getBytes(BOOT_NVS_KEY_DEVMAP, map, sizeof(BootDeviceMap_t)) == sizeof(BootDeviceMap_t);
+    prefs.end();
+    return ok && map->magic == BOOT_DEVMAP_MAGIC && map->configHash == Boot_ConfigHash() &&
+           map->count > 0 && map->count <= BOOT_MAX_I2C_DEVICES;
+}
+
+static void Boot_SaveDeviceMap(const BootDeviceMap_t* map)
+{
+    Preferences prefs;
+    if (!prefs.begin(BOOT_NVS_NAMESPACE, false)) {
+        LOG_WARN("Boot: NVS not available, device map not cached");
+        return;
+    }
+    if (prefs.putBytes(BOOT_NVS_KEY_DEVMAP, map, sizeof(BootDeviceMap_t)) != sizeof(BootDeviceMap_t)) {
+        LOG_WARN("Boot: failed to cache device map");
+    }
+    prefs.end();
+}
+
+void Boot_InvalidateDeviceMap(void)
+{
+    Preferences prefs;
+    if (prefs.begin(BOOT_NVS_NAMESPACE, false)) {
+        prefs.clear();
+        prefs.end();
+    }
+}
+
+bool Boot_DiscoverI2C(BootDeviceMap_t* map)
+{
+    if (FAST_BOOT_ENABLED && Boot_LoadDeviceMap(map)) {
+        // One address transaction per known device instead of 126
+        uint8_t missing = 0;
+        for (uint8_t i = 0; i < map->count; i++) {
+            Wire.beginTransmission(map->addr[i]);
+            if (Wire.endTransmission() != 0) {
+                LOG_WARN("Boot: cached device 0x%02X not answering", map->addr[i]);
+                missing++;
+            }
+        }
+        if (missing == 0) {
+            LOG_INFO("Boot: %u cached I2C devices present, full scan skipped", map->count);
+            return true;
+        }
+    }
+
+    memset(map, 0, sizeof(*map));
+    map->magic = BOOT_DEVMAP_MAGIC;
+    map->configHash = Boot_ConfigHash();
+    map->count = i2cScanner(map->addr, BOOT_MAX_I2C_DEVICES);
+    if (map->count > BOOT_MAX_I2C_DEVICES) {
+        // The map would miss devices: leave it empty, so every device gets probed
+        LOG_WARN("Boot: %u I2C devices, map holds %u; not cached", map->count, BOOT_MAX_I2C_DEVICES);
+        map->count = 0;
+    }
+    if (FAST_BOOT_ENABLED && map->count > 0) {
+        Boot_SaveDeviceMap(map);
+    }
+    return false;
+}
@@ -0,0 +1,255 @@
+#include "BurstModule.h"
+#include "Config.h"
+#include <string.h>
+
+#define BURST_PRE_US                ((uint32_t)BURST_PRE_MS * 1000u)
+#define BURST_POST_US               ((uint32_t)BURST_POST_MS * 1000u)
+// ADXL345 full resolution is 4 mg/LSB; compared squared to skip the root
+#define BURST_ACCEL_TRIGGER_LSB     (BURST_ACCEL_TRIGGER_MG / 4)
+// Accel FIFO entries are drained (back-dated) up to one frame late, so the window is
+// closed one frame after its end; samples past the end are not recorded meanwhile
+#define BURST_SETTLE_US             ((uint32_t)LOOP_INTERVAL_MS * 1000u)
+
+static_assert((BURST_RING_RECORDS & (BURST_RING_RECORDS - 1)) == 0,
+              "BURST_RING_RECORDS must be a power of two so ring positions survive the write counter wrapping");
+
+static BurstRecord_t s_ring[BURST_RING_RECORDS];
+static uint32_t s_written = 0;                  // records written since the last reset/release, wraps
+static volatile uint8_t s_state = BURST_ARMED;  // BurstState_t; sensor task -> FROZEN, comm task -> ARMED
+static volatile bool s_requested = false;
+
+static BurstTrigger_t s_source = BURST_TRIG_NONE;
+static uint32_t s_triggerUs = 0;
+static uint32_t s_first = 0;                    // ring position of the window's oldest record
+static uint32_t s_count = 0;
+
+// Previous sample per pressure channel for the slope trigger
+static int16_t  s_lastRaw[PRESSURE_CHANNEL_COUNT];
+static uint32_t s_lastUs[PRESSURE_CHANNEL_COUNT];
+static PressureMask_t s_seen = 0;
+
+static BurstStats_t s_stats;
+
+static inline bool notBefore(uint32_t t, uint32_t ref)
+{
+    return (int32_t)(t - ref) >= 0;
+}
+
+void Burst_Reset(void)
+{
+    s_written = 0;
+    s_seen = 0;
+    s_requested = false;
+    s_source = BURST_TRIG_NONE;
+    s_count = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_state = BURST_ARMED;
+}
+
+// The window starts at the oldest stored record that is not older than trigger - pre
+static void freeze(void)
+{
+    uint32_t stored = (s_written < BURST_RING_RECORDS) ? s_written : BURST_RING_RECORDS;
+    uint32_t oldest = s_written - stored;
+    uint32_t start = s_triggerUs - BURST_PRE_US;
+    uint32_t skip = 0;
+    while (skip < stored && !notBefore(s_ring[(oldest + skip) % BURST_RING_RECORDS].t_us, start)) {
+        skip++;
+    }
+    s_first = (oldest + skip) % BURST_RING_RECORDS;
+    s_count = stored - skip;
+    s_state = BURST_FROZEN;
+}
+
+static void trigger(BurstTrigger_t source, uint32_t t_us)
+{
+    s_source = source;
+    s_triggerUs = t_us;
+    s_state = BURST_POST;
+    s_stats.triggers++;
+}
+
+// Shared by both taps: command trigger, post-window end, then the record itself
+static BurstRecord_t* beginRecord(uint32_t t_us)
+{
+    if (s_state == BURST_FROZEN) {
+        if (s_requested) {
+            s_requested = false;
+            s_stats.ignored++;
+        }
+        return NULL;
+    }
+    if (s_state == BURST_POST && !notBefore(s_triggerUs + BURST_POST_US, t_us)) {
+        if (notBefore(t_us, s_triggerUs + BURST_POST_US + BURST_SETTLE_US)) {
+            freeze();
+        }
+        return NULL;
+    }
+    if (s_requested && s_state == BURST_ARMED) {
+        s_requested = false;
+        trigger(BURST_TRIG_COMMAND, t_us);
+    }
+    BurstRecord_t* r = &s_ring[s_written % BURST_RING_RECORDS];
+    s_written++;
+    r->t_us = t_us;
+    return r;
+}
+
+void Burst_PushPressure(uint8_t channel, int16_t raw, uint32_t t_us)
+{
+    if (channel >= PRESSURE_CHANNEL_COUNT) {
+        return;
+    }
+    BurstRecord_t* r = beginRecord(t_us);
+    if (!r) {
+        return;
+    }
+    r->channel = channel;
+    r->v[0] = raw;
+    r->v[1] = 0;
+    r->v[2] = 0;
+
+    // Slope against the channel's previous conversion, in counts per ms
+    PressureMask_t bit = (PressureMask_t)((PressureMask_t)1 << channel);
+    if (BURST_PRESSURE_SLOPE && (s_seen & bit) && s_state == BURST_ARMED) {
+        uint32_t dt = t_us - s_lastUs[channel];
+        int32_t rise = (int32_t)raw - s_lastRaw[channel];
+        if (dt > 0 && rise > 0 && (int64_t)rise * 1000 > (int64_t)BURST_PRESSURE_SLOPE * dt) {
+            trigger(BURST_TRIG_PRESSURE, t_us);
+        }
+    }
+    s_lastRaw[channel] = raw;
+    s_lastUs[channel] = t_us;
+    s_seen |= bit;
+}
+
+void Burst_PushAcc(int16_t x, int16_t y, int16_t z, uint32_t t_us)
+{
+    BurstRecord_t* r = beginRecord(t_us);
+    if (!r) {
+        return;
+    }
+    r->channel = BURST_CH_ACC;
+    r->v[0] = x;
+    r->v[1] = y;
+    r->v[2] = z;
+
+    int32_t mag2 = (int32_t)x * x + (int32_t)y * y + (int32_t)z * z;
+    if (s_state == BURST_ARMED && mag2 > (int32_t)BURST_ACCEL_TRIGGER_LSB * BURST_ACCEL_TRIGGER_LSB) {
+        trigger(BURST_TRIG_ACCEL, t_us);
+    }
+}
+
+void Burst_Request(void)
+{
+    s_requested = true;
+}
+
+void Burst_Poll(uint32_t now_us)
+{
+    if (s_state == BURST_POST && notBefore(now_us, s_triggerUs + BURST_POST_US + BURST_SETTLE_US)) {
+        freeze();
+    }
+}
+
+BurstState_t Burst_GetState(void)
+{
+    return (BurstState_t)s_state;
+}
+
+bool Burst_GetWindow(BurstWindow_t* window)
+{
+    if (s_state != BURST_FROZEN) {
+        return false;
+    }
+    window->source = s_source;
+    window->triggerUs = s_triggerUs;
+    window->count = s_count;
+    window->firstUs = s_count ? s_ring[s_first].t_us : s_triggerUs;
+    window->lastUs = s_count ? s_ring[(s_first + s_count - 1) % BURST_RING_RECORDS].t_us : s_triggerUs;
+    return true;
+}
+
+const BurstRecord_t* Burst_GetRecord(uint32_t index)
+{
+    if (s_state != BURST_FROZEN || index >= s_count) {
+        return NULL;
+    }
+    return &s_ring[(s_first + index) % BURST_RING_RECORDS];
+}
+
+static inline uint32_t recordsPerChunk(size_t payload)
+{
+    return (payload > BURST_CHUNK_HEADER_SIZE) ? (uint32_t)((payload - BURST_CHUNK_HEADER_SIZE) / BURST_WIRE_RECORD_SIZE) : 0;
+}
+
+uint16_t Burst_ChunkCount(size_t payload)
+{
+    uint32_t per = recordsPerChunk(payload);
+    if (s_state != BURST_FROZEN || per == 0) {
+        return 0;
+    }
+    uint32_t chunks = 1 + (s_count + per - 1) / per;
+    return (uint16_t)((chunks > 0xFFFF) ? 0xFFFF : chunks);
+}
+
+static inline uint8_t* putLe16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t* putLe32(uint8_t* p, uint32_t v)
+{
+    p = putLe16(p, (uint16_t)v);
+    return putLe16(p, (uint16_t)(v >> 16));
+}
+
+size_t Burst_EncodeChunk(uint16_t index, uint8_t* out, size_t payload)
+{
+    uint16_t chunks = Burst_ChunkCount(payload);
+    if (index >= chunks || payload < BURST_CHUNK_HEADER_SIZE + BURST_META_SIZE) {
+        return 0;
+    }
+    uint8_t* p = putLe16(out, index);
+    p = putLe16(p, chunks);
+    if (index == 0) {
+        *p++ = (uint8_t)s_source;
+        p = putLe32(p, s_count);
+        p = putLe32(p, s_triggerUs);
+        p = putLe16(p, BURST_PRE_MS);
+        p = putLe16(p, BURST_POST_MS);
+        *p++ = PRESSURE_CHANNEL_COUNT;
+        return (size_t)(p - out);
+    }
+    uint32_t per = recordsPerChunk(payload);
+    uint32_t first = (uint32_t)(index - 1) * per;
+    for (uint32_t i = first; i < first + per && i < s_count; i++) {
+        const BurstRecord_t* r = &s_ring[(s_first + i) % BURST_RING_RECORDS];
+        p = putLe32(p, r->t_us - s_triggerUs);
+        *p++ = r->channel;
+        p = putLe16(p, (uint16_t)r->v[0]);
+        p = putLe16(p, (uint16_t)r->v[1]);
+        p = putLe16(p, (uint16_t)r->v[2]);
+    }
+    return (size_t)(p - out);
+}
+
+void Burst_Release(void)
+{
+    if (s_state != BURST_FROZEN) {
+        return;
+    }
+    s_stats.uploaded++;
+    // Recording starts over; the pre window fills up again before the next capture is complete
+    s_written = 0;
+    s_seen = 0;
+    s_count = 0;
+    s_state = BURST_ARMED;
+}
+
+void Burst_GetStats(BurstStats_t* stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,181 @@
+#include "DeltaModule.h"
+#include "FrameCodecModule.h"
+#include "Config.h"
+#include <string.h>
+
+// Channel value of a frame, widened so accel and pressure compare the same way
+static inline int32_t channelValue(const SensorData* d, uint8_t healthy, int ch)
+{
+    if (ch < PRESSURE_CHANNEL_COUNT) {
+        return d->pressure[ch];
+    }
+    switch (ch - PRESSURE_CHANNEL_COUNT) {
+        case 0:  return d->accel_x;
+        case 1:  return d->accel_y;
+        case 2:  return d->accel_z;
+        case 3:  return d->battery;
+        default: return healthy;
+    }
+}
+
+static inline void setChannel(DeltaDecoder_t* dec, int ch, int32_t v)
+{
+    SensorData* d = &dec->current;
+    if (ch < PRESSURE_CHANNEL_COUNT) {
+        d->pressure[ch] = (uint16_t)v;
+        return;
+    }
+    switch (ch - PRESSURE_CHANNEL_COUNT) {
+        case 0:  d->accel_x = (int16_t)v; break;
+        case 1:  d->accel_y = (int16_t)v; break;
+        case 2:  d->accel_z = (int16_t)v; break;
+        case 3:  d->battery = (uint8_t)v; break;
+        default: dec->adcHealthy = (uint8_t)v; break;
+    }
+}
+
+// Single-byte channels
+static inline bool byteChannel(int ch)
+{
+    return ch == DELTA_CH_BATTERY || ch == DELTA_CH_HEALTH;
+}
+
+void Delta_InitEncoder(DeltaEncoder_t* enc)
+{
+    memset(enc, 0, sizeof(*enc));
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        enc->deadband[ch] = DELTA_PRESSURE_DEADBAND;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        enc->deadband[DELTA_CH_ACC_X + axis] = DELTA_ACCEL_DEADBAND;
+    }
+    enc->deadband[DELTA_CH_BATTERY] = 0;
+    enc->deadband[DELTA_CH_HEALTH] = 0;
+    enc->keyframeInterval = DELTA_KEYFRAME_INTERVAL;
+    enc->maxSilence = DELTA_MAX_SILENCE;
+    enc->needKey = true;
+}
+
+void Delta_ForceKeyframe(DeltaEncoder_t* enc)
+{
+    enc->needKey = true;
+}
+
+size_t Delta_Encode(DeltaEncoder_t* enc, const SensorData* in, const SensorFrameInfo* info,
+                    uint8_t* out, size_t outLen)
+{
+    if (outLen < DELTA_MAX_FRAME_SIZE) {
+        return 0;
+    }
+    uint8_t healthy = info ? info->adc_healthy : (uint8_t)((1u << ActiveTopology::AdcCount) - 1);
+    uint8_t seq = enc->seq++;
+    enc->sinceKey++;
+    enc->sinceSent++;
+
+    if (enc->needKey || (enc->keyframeInterval && enc->sinceKey >= enc->keyframeInterval)) {
+        out[0] = (uint8_t)((FRAME_FMT_DELTA << 4) | DELTA_KIND_KEY);
+        out[1] = seq;
+        memcpy(out + 2, in, sizeof(SensorData));   // packed struct is the little-endian wire layout
+        out[2 + sizeof(SensorData)] = healthy;
+        for (int ch = 0; ch < DELTA_CHANNEL_COUNT; ch++) {
+            enc->ref[ch] = channelValue(in, healthy, ch);
+        }
+        enc->needKey = false;
+        enc->sinceKey = 0;
+        enc->sinceSent = 0;
+        return DELTA_KEYFRAME_SIZE;
+    }
+
+    uint8_t* mask = out + 2;
+    uint8_t* p = mask + DELTA_MASK_BYTES;
+    memset(mask, 0, DELTA_MASK_BYTES);
+    bool any = false;
+    for (int ch = 0; ch < DELTA_CHANNEL_COUNT; ch++) {
+        int32_t v = channelValue(in, healthy, ch);
+        int32_t d = v - enc->ref[ch];
+        if (d <= (int32_t)enc->deadband[ch] && -d <= (int32_t)enc->deadband[ch]) {
+            continue;
+        }
+        enc->ref[ch] = v;
+        mask[ch >> 3] |= (uint8_t)(1u << (ch & 7));
+        *p++ = (uint8_t)v;
+        if (!byteChannel(ch)) {
+            *p++ = (uint8_t)(v >> 8);
+        }
+        any = true;
+    }
+
+    // Nothing moved: stay silent unless the link needs a sign of life
+    if (!any && !(enc->maxSilence && enc->sinceSent >= enc->maxSilence)) {
+        return 0;
+    }
+    out[0] = (uint8_t)((FRAME_FMT_DELTA << 4) | DELTA_KIND_DELTA);
+    out[1] = seq;
+    enc->sinceSent = 0;
+    return (size_t)(p - out);
+}
+
+void Delta_InitDecoder(DeltaDecoder_t* dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+size_t Delta_Decode(DeltaDecoder_t* dec, const uint8_t* in, size_t len, SensorData* out, uint8_t* elapsed)
+{
+    *elapsed = 0;
+    if (len < 2 || (in[0] >> 4) != FRAME_FMT_DELTA) {
+        return 0;
+    }
+    uint8_t kind = in[0] & 0x0F;
+    uint8_t seq = in[1];
+
+    if (kind == DELTA_KIND_KEY) {
+        if (len < DELTA_KEYFRAME_SIZE) {
+            return 0;
+        }
+        *elapsed = dec->synced ? (uint8_t)(seq - dec->lastSeq) : 1;
+        memcpy(&dec->current, in + 2, sizeof(SensorData));
+        dec->adcHealthy = in[2 + sizeof(SensorData)];
+        dec->lastSeq = seq;
+        dec->synced = true;
+        *out = dec->current;
+        return DELTA_KEYFRAME_SIZE;
+    }
+    if (kind != DELTA_KIND_DELTA || len < 2 + DELTA_MASK_BYTES) {
+        return 0;
+    }
+
+    // Size first, so a truncated frame leaves the reconstruction untouched
+    const uint8_t* mask = in + 2;
+    size_t size = 2 + DELTA_MASK_BYTES;
+    for (int ch = 0; ch < DELTA_CHANNEL_COUNT; ch++) {
+        if (mask[ch >> 3] & (1u << (ch & 7))) {
+            size += byteChannel(ch) ? 1 : 2;
+        }
+    }
+    if (len < size) {
+        return 0;
+    }
+    if (!dec->synced) {
+        return size;    // deltas before the first keyframe have no base
+    }
+
+    const uint8_t* p = mask + DELTA_MASK_BYTES;
+    for (int ch = 0; ch < DELTA_CHANNEL_COUNT; ch++) {
+        if (!(mask[ch >> 3] & (1u << (ch & 7)))) {
+            continue;
+        }
+        int32_t v;
+        if (byteChannel(ch)) {
+            v = *p++;
+        } else {
+            v = (ch >= DELTA_CH_ACC_X) ? (int16_t)(p[0] | (p[1] << 8)) : (uint16_t)(p[0] | (p[1] << 8));
+            p += 2;
+        }
+        setChannel(dec, ch, v);
+    }
+    *elapsed = (uint8_t)(seq - dec->lastSeq);
+    dec->lastSeq = seq;
+    *out = dec->current;
+    return size;
+}
@@ -0,0 +1,119 @@
+#include "FilterModule.h"
+#include "PressureModule.h"
+#include "AccModule.h"
+#include "Config.h"
+#include <string.h>
+
+// Accumulators, one slot per channel (structure-of-arrays)
+static int32_t  s_pressureSum[PRESSURE_CHANNEL_COUNT];
+static uint16_t s_pressureCount[PRESSURE_CHANNEL_COUNT];
+static int32_t  s_accSum[3];
+static uint16_t s_accCount = 0;
+
+// Sample instants as offsets from the first sample of the frame, summed like the values
+static int32_t  s_pressureTimeSum[PRESSURE_CHANNEL_COUNT];
+static int32_t  s_accTimeSum = 0;
+static uint32_t s_epochUs = 0;
+static bool     s_epochSet = false;
+
+// Q24 reciprocals 1/n, so the dump needs no division. Entry 0 is unused.
+static uint32_t s_recipQ24[DSP_MAX_SAMPLES_PER_FRAME + 1];
+static bool     s_recipReady = false;
+
+// Rounded sum / count in fixed point
+static inline int32_t divideQ24(int32_t sum, uint16_t count)
+{
+    return (int32_t)(((int64_t)sum * s_recipQ24[count] + (1 << 23)) >> 24);
+}
+
+void Filter_Reset(void)
+{
+    if (!s_recipReady) {
+        s_recipQ24[0] = 0;
+        for (uint32_t n = 1; n <= DSP_MAX_SAMPLES_PER_FRAME; n++) {
+            s_recipQ24[n] = ((1u << 24) + n / 2) / n;
+        }
+        s_recipReady = true;
+    }
+    memset(s_pressureSum, 0, sizeof(s_pressureSum));
+    memset(s_pressureCount, 0, sizeof(s_pressureCount));
+    memset(s_accSum, 0, sizeof(s_accSum));
+    s_accCount = 0;
+    memset(s_pressureTimeSum, 0, sizeof(s_pressureTimeSum));
+    s_accTimeSum = 0;
+    s_epochSet = false;
+}
+
+// Offset of t_us from this frame's first sample
+static inline int32_t timeOffset(uint32_t t_us)
+{
+    if (!s_epochSet) {
+        s_epochUs = t_us;
+        s_epochSet = true;
+    }
+    return (int32_t)(t_us - s_epochUs);
+}
+
+void Filter_PushPressure(uint8_t channel, int16_t raw, uint32_t t_us)
+{
+    if (channel >= PRESSURE_CHANNEL_COUNT || s_pressureCount[channel] >= DSP_MAX_SAMPLES_PER_FRAME) {
+        return;
+    }
+    s_pressureSum[channel] += raw;
+    s_pressureTimeSum[channel] += timeOffset(t_us);
+    s_pressureCount[channel]++;
+}
+
+void Filter_PushAcc(int16_t x, int16_t y, int16_t z, uint32_t t_us)
+{
+    if (s_accCount >= DSP_MAX_SAMPLES_PER_FRAME) {
+        return;
+    }
+    s_accSum[0] += x;
+    s_accSum[1] += y;
+    s_accSum[2] += z;
+    s_accTimeSum += timeOffset(t_us);
+    s_accCount++;
+}
+
+PressureMask_t Filter_Decimate(uint16_t* pressureOut, int16_t* accRawOut, uint32_t* pressureUsOut, uint32_t* accUsOut)
+{
+    if (!s_recipReady) {
+        Filter_Reset();
+    }
+
+    // Branch-free dump: channels without samples select their previous output
+    PressureMask_t updated = 0;
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
+        int32_t avg = divideQ24(s_pressureSum[i], s_pressureCount[i]);
+        int32_t has = (s_pressureCount[i] != 0);
+        pressureOut[i] = (uint16_t)(has ? avg : pressureOut[i]);
+        pressureUsOut[i] = has ? s_epochUs + (uint32_t)divideQ24(s_pressureTimeSum[i], s_pressureCount[i]) : pressureUsOut[i];
+        updated |= (PressureMask_t)((PressureMask_t)has << i);
+    }
+
+    if (s_accCount) {
+        for (int axis = 0; axis < 3; axis++) {
+            accRawOut[axis] = (int16_t)divideQ24(s_accSum[axis], s_accCount);
+        }
+        *accUsOut = s_epochUs + (uint32_t)divideQ24(s_accTimeSum, s_accCount);
+    }
+
+    memset(s_pressureSum, 0, sizeof(s_pressureSum));
+    memset(s_pressureCount, 0, sizeof(s_pressureCount));
+    memset(s_accSum, 0, sizeof(s_accSum));
+    s_accCount = 0;
+    memset(s_pressureTimeSum, 0, sizeof(s_pressureTimeSum));
+    s_accTimeSum = 0;
+    s_epochSet = false;
+    return updated;
+}
+
+void Filter_Apply(void)
+{
+    static int16_t accRaw[3] = {0};
+    Filter_Decimate(Pressure_Array, accRaw, Pressure_SampleUs, &Acc_SampleUs);
+    for (int axis = 0; axis < 3; axis++) {
+        Acc_Array[axis] = Acc_RawToMs2x10(accRaw[axis]);
+    }
+}
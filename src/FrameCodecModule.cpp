@@ -0,0 +1,274 @@
+#include "FrameCodecModule.h"
+#include <string.h>
+
+static const uint8_t FORMAT_BITS[FRAME_FMT_COUNT]  = { 16, 16, 12, 10, 8 };
+static const uint8_t FORMAT_SHIFT[FRAME_FMT_COUNT] = {  0,  0,  3,  5, 7 };
+
+uint8_t Codec_BitsPerValue(uint8_t format)
+{
+    return (format < FRAME_FMT_COUNT) ? FORMAT_BITS[format] : 0;
+}
+
+uint8_t Codec_DefaultShift(uint8_t format)
+{
+    return (format < FRAME_FMT_COUNT) ? FORMAT_SHIFT[format] : 0;
+}
+
+size_t Codec_FrameSize(uint8_t format)
+{
+    if (format == FRAME_FMT_LEGACY16) {
+        return sizeof(SensorData);
+    }
+    if (format >= FRAME_FMT_COUNT) {
+        return 0;
+    }
+    return FRAME_PACKED_HEADER_SIZE + (PRESSURE_CHANNEL_COUNT * FORMAT_BITS[format] + 7) / 8;
+}
+
+uint8_t Codec_FramesPerNotification(uint8_t format, uint16_t mtu)
+{
+    size_t size = Codec_FrameSize(format);
+    if (size == 0 || mtu <= 3) {
+        return 0;
+    }
+    // Legacy frames carry no header, so they cannot be concatenated
+    if (format == FRAME_FMT_LEGACY16) {
+        return ((size_t)(mtu - 3) >= size) ? 1 : 0;
+    }
+    size_t n = (mtu - 3) / size;       // 3 bytes ATT notification header
+    return (uint8_t)((n > 255) ? 255 : n);
+}
+
+void Codec_PackValues(const uint16_t* v, size_t count, uint8_t bits, uint8_t* out)
+{
+    size_t i = 0;
+    switch (bits) {
+        case 8:
+            for (; i < count; i++) {
+                out[i] = (uint8_t)v[i];
+            }
+            break;
+        case 16:
+            for (; i < count; i++) {
+                out[2 * i]     = (uint8_t)v[i];
+                out[2 * i + 1] = (uint8_t)(v[i] >> 8);
+            }
+            break;
+        case 12:
+            // 2 values -> 3 bytes
+            for (; i + 2 <= count; i += 2, out += 3) {
+                out[0] = (uint8_t)v[i];
+                out[1] = (uint8_t)((v[i] >> 8) | (v[i + 1] << 4));
+                out[2] = (uint8_t)(v[i + 1] >> 4);
+            }
+            if (i < count) {
+                out[0] = (uint8_t)v[i];
+                out[1] = (uint8_t)(v[i] >> 8);
+            }
+            break;
+        case 10:
+            // 4 values -> 5 bytes
+            for (; i + 4 <= count; i += 4, out += 5) {
+                out[0] = (uint8_t)v[i];
+                out[1] = (uint8_t)((v[i] >> 8)     | (v[i + 1] << 2));
+                out[2] = (uint8_t)((v[i + 1] >> 6) | (v[i + 2] << 4));
+                out[3] = (uint8_t)((v[i + 2] >> 4) | (v[i + 3] << 6));
+                out[4] = (uint8_t)(v[i + 3] >> 2);
+            }
+            if (i < count) {
+                // Tail of 1..3 values through a bit accumulator; a bounded count keeps
+                // the loop from being analysed as running up to SIZE_MAX
+                const uint16_t* tail = v + i;
+                size_t left = count - i;
+                uint32_t acc = 0;
+                uint8_t used = 0;
+                for (size_t k = 0; k < left && k < 3; k++) {
+                    acc |= (uint32_t)(tail[k] & 0x3FF) << used;
+                    used += 10;
+                    while (used >= 8) {
+                        *out++ = (uint8_t)acc;
+                        acc >>= 8;
+                        used -= 8;
+                    }
+                }
+                if (used) {
+                    *out = (uint8_t)acc;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void Codec_UnpackValues(const uint8_t* in, size_t count, uint8_t bits, uint16_t* v)
+{
+    size_t i = 0;
+    switch (bits) {
+        case 8:
+            for (; i < count; i++) {
+                v[i] = in[i];
+            }
+            break;
+        case 16:
+            for (; i < count; i++) {
+                v[i] = (uint16_t)(in[2 * i] | (in[2 * i + 1] << 8));
+            }
+            break;
+        case 12:
+            for (; i + 2 <= count; i += 2, in += 3) {
+                v[i]     = (uint16_t)(in[0] | ((in[1] & 0x0F) << 8));
+                v[i + 1] = (uint16_t)((in[1] >> 4) | (in[2] << 4));
+            }
+            if (i < count) {
+                v[i] = (uint16_t)(in[0] | ((in[1] & 0x0F) << 8));
+            }
+            break;
+        case 10:
+            for (; i + 4 <= count; i += 4, in += 5) {
+                v[i]     = (uint16_t)((in[0]        | (in[1] << 8)) & 0x3FF);
+                v[i + 1] = (uint16_t)(((in[1] >> 2) | (in[2] << 6)) & 0x3FF);
+                v[i + 2] = (uint16_t)(((in[2] >> 4) | (in[3] << 4)) & 0x3FF);
+                v[i + 3] = (uint16_t)(((in[3] >> 6) | (in[4] << 2)) & 0x3FF);
+            }
+            if (i < count) {
+                uint16_t* tail = v + i;
+                size_t left = count - i;
+                uint32_t acc = 0;
+                uint8_t have = 0;
+                for (size_t k = 0; k < left && k < 3; k++) {
+                    while (have < 10) {
+                        acc |= (uint32_t)(*in++) << have;
+                        have += 8;
+                    }
+                    tail[k] = (uint16_t)(acc & 0x3FF);
+                    acc >>= 10;
+                    have -= 10;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Health byte of a frame whose ADS1115s are all in the scan
+static inline uint8_t allAdcs(void)
+{
+    return (uint8_t)((1u << ActiveTopology::AdcCount) - 1);
+}
+
+void Codec_PackStatus(const SensorFrameInfo* info, uint8_t* out)
+{
+    PressureMask_t valid = info ? info->pressure_valid : ActiveTopology::allSensors();
+    out[0] = info ? info->adc_healthy : allAdcs();
+    for (int i = 0; i < (PRESSURE_CHANNEL_COUNT + 7) / 8; i++) {
+        out[1 + i] = (uint8_t)(valid >> (8 * i));
+    }
+}
+
+void Codec_UnpackStatus(const uint8_t* in, PressureMask_t* valid, uint8_t* adcHealthy)
+{
+    PressureMask_t mask = 0;
+    for (int i = 0; i < (PRESSURE_CHANNEL_COUNT + 7) / 8; i++) {
+        mask |= (PressureMask_t)((PressureMask_t)in[1 + i] << (8 * i));
+    }
+    *valid = mask;
+    *adcHealthy = in[0];
+}
+
+// Legacy frames have no status: a device is down when all of its channels read PRESSURE_VALUE_DOWN
+static void legacyStatus(const SensorData* d, SensorFrameInfo* info)
+{
+    info->pressure_valid = 0;
+    info->adc_healthy = 0;
+    for (int dev = 0; dev < ActiveTopology::AdcCount; dev++) {
+        bool up = false;
+        for (int input = 0; input < ActiveTopology::ChannelsPerAdc; input++) {
+            uint8_t ch = ActiveTopology::sensorOf(dev, input);
+            if (d->pressure[ch] != PRESSURE_VALUE_DOWN) {
+                info->pressure_valid |= (PressureMask_t)((PressureMask_t)1 << ch);
+                up = true;
+            }
+        }
+        info->adc_healthy |= (uint8_t)(up ? (1u << dev) : 0);
+    }
+}
+
+size_t Codec_Encode(const SensorData* in, const SensorFrameInfo* info, const FrameCodecConfig* cfg,
+                    uint8_t* out, size_t outLen)
+{
+    size_t size = Codec_FrameSize(cfg->format);
+    if (size == 0 || outLen < size || cfg->shift > 15) {
+        return 0;
+    }
+    if (cfg->format == FRAME_FMT_LEGACY16) {
+        memcpy(out, in, sizeof(SensorData));
+        return size;
+    }
+
+    uint8_t bits = FORMAT_BITS[cfg->format];
+    uint16_t maxValue = (uint16_t)((1u << bits) - 1);
+
+    out[0] = (uint8_t)((cfg->format << 4) | cfg->shift);
+    out[1] = in->battery;
+    memcpy(out + 2, &in->accel_x, 6);  // accel_x..z are contiguous little-endian in the packed struct
+    Codec_PackStatus(info, out + 8);
+
+    // Scale, saturate, pack
+    uint16_t scaled[PRESSURE_CHANNEL_COUNT];
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
+        uint16_t s = (uint16_t)(in->pressure[i] >> cfg->shift);
+        scaled[i] = (s > maxValue) ? maxValue : s;
+    }
+    Codec_PackValues(scaled, PRESSURE_CHANNEL_COUNT, bits, out + FRAME_PACKED_HEADER_SIZE);
+    return size;
+}
+
+size_t Codec_Decode(const uint8_t* in, size_t len, uint8_t format, SensorData* out, SensorFrameInfo* info)
+{
+    if (format == FRAME_FMT_LEGACY16) {
+        if (len < sizeof(SensorData)) {
+            return 0;
+        }
+        memcpy(out, in, sizeof(SensorData));
+        if (info) {
+            legacyStatus(out, info);
+        }
+        return sizeof(SensorData);
+    }
+    if (len < 1) {
+        return 0;
+    }
+    uint8_t fmt = in[0] >> 4;
+    uint8_t shift = in[0] & 0x0F;
+    size_t size = Codec_FrameSize(fmt);
+    if (fmt == FRAME_FMT_LEGACY16 || size == 0 || len < size) {
+        return 0;
+    }
+
+    out->battery = in[1];
+    memcpy(&out->accel_x, in + 2, 6);
+    PressureMask_t valid;
+    uint8_t healthy;
+    Codec_UnpackStatus(in + 8, &valid, &healthy);
+    if (info) {
+        info->pressure_valid = valid;
+        info->adc_healthy = healthy;
+    }
+    uint16_t values[PRESSURE_CHANNEL_COUNT];
+    Codec_UnpackValues(in + FRAME_PACKED_HEADER_SIZE, PRESSURE_CHANNEL_COUNT, FORMAT_BITS[fmt], values);
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
+        out->pressure[i] = (uint16_t)(values[i] << shift);
+    }
+    // The saturated code of a downed device reads back as the same value legacy frames carry
+    for (int dev = 0; dev < ActiveTopology::AdcCount; dev++) {
+        if (healthy & (1u << dev)) {
+            continue;
+        }
+        for (int input = 0; input < ActiveTopology::ChannelsPerAdc; input++) {
+            out->pressure[ActiveTopology::sensorOf(dev, input)] = PRESSURE_VALUE_DOWN;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,88 @@
+#include "FramePoolModule.h"
+
+static FrameSlot_t s_slots[FRAME_POOL_SLOTS];
+static FrameSlot_t* s_latest = nullptr;
+static uint32_t s_published = 0;
+static uint32_t s_overruns = 0;
+
+// Sensor and BLE tasks may run on different cores, so a spinlock rather than a task lock
+static portMUX_TYPE s_poolMux = portMUX_INITIALIZER_UNLOCKED;
+
+void FramePool_Init(void)
+{
+    portENTER_CRITICAL(&s_poolMux);
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) {
+        s_slots[i].refs = 0;
+        s_slots[i].length = 0;
+    }
+    s_latest = nullptr;
+    s_published = 0;
+    s_overruns = 0;
+    portEXIT_CRITICAL(&s_poolMux);
+}
+
+FrameSlot_t* FramePool_Acquire(void)
+{
+    FrameSlot_t* slot = nullptr;
+    portENTER_CRITICAL(&s_poolMux);
+    for (int i = 0; i < FRAME_POOL_SLOTS; i++) {
+        if (s_slots[i].refs == 0) {
+            slot = &s_slots[i];
+            slot->refs = 1;
+            break;
+        }
+    }
+    if (!slot) {
+        s_overruns++;
+    }
+    portEXIT_CRITICAL(&s_poolMux);
+    return slot;
+}
+
+void FramePool_Publish(FrameSlot_t* slot)
+{
+    if (!slot) {
+        return;
+    }
+    portENTER_CRITICAL(&s_poolMux);
+    FrameSlot_t* previous = s_latest;
+    s_latest = slot;
+    s_published++;
+    if (previous) {
+        previous->refs--;
+    }
+    portEXIT_CRITICAL(&s_poolMux);
+}
+
+FrameSlot_t* FramePool_BorrowLatest(void)
+{
+    portENTER_CRITICAL(&s_poolMux);
+    FrameSlot_t* slot = s_latest;
+    if (slot) {
+        slot->refs++;
+    }
+    portEXIT_CRITICAL(&s_poolMux);
+    return slot;
+}
+
+void FramePool_Release(FrameSlot_t* slot)
+{
+    if (!slot) {
+        return;
+    }
+    portENTER_CRITICAL(&s_poolMux);
+    if (slot->refs > 0) {
+        slot->refs--;
+    }
+    portEXIT_CRITICAL(&s_poolMux);
+}
+
+uint32_t FramePool_GetPublished(void)
+{
+    return s_published;
+}
+
+uint32_t FramePool_GetOverruns(void)
+{
+    return s_overruns;
+}
@@ -0,0 +1,107 @@
+#include "LatencyModule.h"
+#include "LoggerModule.h"
+#include <string.h>
+
+static uint32_t s_buckets[LATENCY_BUCKETS];
+static uint32_t s_count = 0;
+static uint32_t s_max = 0;
+
+// Recorded by the communication task and, for resent notifications, the NimBLE task; read from loop()
+static portMUX_TYPE s_latencyMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Values below 2^(bits+1) get one bucket each, above that each octave is split in 2^bits buckets
+static uint16_t bucketOf(uint32_t v)
+{
+    const uint32_t linear = 1u << (LATENCY_SUB_BUCKET_BITS + 1);
+    if (v < linear) {
+        return (uint16_t)v;
+    }
+    int msb = 31 - __builtin_clz(v);
+    uint32_t sub = (v >> (msb - LATENCY_SUB_BUCKET_BITS)) & ((1u << LATENCY_SUB_BUCKET_BITS) - 1);
+    uint32_t idx = linear + ((uint32_t)(msb - LATENCY_SUB_BUCKET_BITS - 1) << LATENCY_SUB_BUCKET_BITS) + sub;
+    return (uint16_t)((idx < LATENCY_BUCKETS) ? idx : LATENCY_BUCKETS - 1);
+}
+
+// Largest value that maps to the bucket
+static uint32_t bucketUpper(uint16_t idx)
+{
+    const uint32_t linear = 1u << (LATENCY_SUB_BUCKET_BITS + 1);
+    if (idx < linear) {
+        return idx;
+    }
+    uint32_t octave = (idx - linear) >> LATENCY_SUB_BUCKET_BITS;
+    uint32_t sub = (idx - linear) & ((1u << LATENCY_SUB_BUCKET_BITS) - 1);
+    int msb = (int)octave + LATENCY_SUB_BUCKET_BITS + 1;
+    uint32_t width = 1u << (msb - LATENCY_SUB_BUCKET_BITS);
+    return (1u << msb) + (sub + 1) * width - 1;
+}
+
+void Latency_Reset(void)
+{
+    portENTER_CRITICAL(&s_latencyMux);
+    memset(s_buckets, 0, sizeof(s_buckets));
+    s_count = 0;
+    s_max = 0;
+    portEXIT_CRITICAL(&s_latencyMux);
+}
+
+void Latency_Record(uint32_t latencyUs)
+{
+    uint16_t idx = bucketOf(latencyUs);
+    portENTER_CRITICAL(&s_latencyMux);
+    s_buckets[idx]++;
+    s_count++;
+    if (latencyUs > s_max) {
+        s_max = latencyUs;
+    }
+    portEXIT_CRITICAL(&s_latencyMux);
+}
+
+// Caller holds s_latencyMux
+static uint32_t percentileLocked(uint16_t permille)
+{
+    if (s_count == 0) {
+        return 0;
+    }
+    // Rank of the sample at the percentile, 1-based
+    uint32_t rank = (uint32_t)(((uint64_t)s_count * permille + 999) / 1000);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += s_buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = bucketUpper(i);
+            return (upper < s_max) ? upper : s_max;
+        }
+    }
+    return s_max;
+}
+
+uint32_t Latency_Percentile(uint16_t permille)
+{
+    portENTER_CRITICAL(&s_latencyMux);
+    uint32_t v = percentileLocked(permille);
+    portEXIT_CRITICAL(&s_latencyMux);
+    return v;
+}
+
+void Latency_GetSummary(LatencySummary_t* summary)
+{
+    portENTER_CRITICAL(&s_latencyMux);
+    summary->count = s_count;
+    summary->p50_us = percentileLocked(500);
+    summary->p90_us = percentileLocked(900);
+    summary->p99_us = percentileLocked(990);
+    summary->max_us = s_max;
+    portEXIT_CRITICAL(&s_latencyMux);
+}
+
+void Latency_PrintSummary(void)
+{
+    LatencySummary_t s;
+    Latency_GetSummary(&s);
+    LOG_INFO("Sample-to-notify latency over %u notifications: p50 %u us, p90 %u us, p99 %u us, max %u us",
+             (unsigned)s.count, (unsigned)s.p50_us, (unsigned)s.p90_us, (unsigned)s.p99_us, (unsigned)s.max_us);
+}
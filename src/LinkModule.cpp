@@ -0,0 +1,265 @@
+#include "LinkModule.h"
+#include "Config.h"
+#include <string.h>
+
+#define LINK_T_IFS_US   150
+
+// IDLE asks for nothing beyond the interval: PHY and data length stay as they are
+static const LinkProfileParams_t s_profiles[LINK_PROFILE_COUNT] = {
+    // min   max  latency timeout  phy          data length
+    {   80,  160,  2,      600,     0,           0                 },  // IDLE: 100 - 200 ms, 6 s
+    {   24,   36,  0,      400,     LINK_PHY_2M, LINK_MAX_DATA_LEN },  // POWER: 30 - 45 ms, 4 s
+    {   LINK_FAST_INTERVAL_MIN, LINK_FAST_INTERVAL_MAX,
+                   0,      400,     LINK_PHY_2M, LINK_MAX_DATA_LEN },  // THROUGHPUT: 7.5 - 22.5 ms, 4 s
+};
+
+static const char* const s_profileNames[LINK_PROFILE_COUNT] = { "idle", "power", "throughput" };
+
+static LinkProfile_t s_wanted = LINK_PROFILE_THROUGHPUT;
+static bool     s_pending = false;          // waiting for the central to grant s_wanted
+static uint32_t s_requestMs = 0;
+static uint8_t  s_attempts = 0;
+static bool     s_lower = false;            // a lower profile has been enough since s_lowerMs
+static uint32_t s_lowerMs = 0;
+static uint32_t s_failedBps[LINK_PROFILE_COUNT];    // stream load the stack refused under a profile, 0 => none
+static LinkStats_t s_stats;
+
+const LinkProfileParams_t* Link_GetProfile(LinkProfile_t profile)
+{
+    return (profile < LINK_PROFILE_COUNT) ? &s_profiles[profile] : NULL;
+}
+
+const char* Link_ProfileName(LinkProfile_t profile)
+{
+    return (profile < LINK_PROFILE_COUNT) ? s_profileNames[profile] : "?";
+}
+
+// Air time of one LL data PDU, preamble to CRC
+static uint32_t pduUs(uint16_t payload, uint8_t phy)
+{
+    switch (phy) {
+        case LINK_PHY_2M:
+            return (2 + 4 + 2 + payload + 3) * 4;
+        case LINK_PHY_CODED:
+            // S=8: preamble, access address, CI and TERM1 at a fixed 376 us, then 64 us per byte and TERM2
+            return 376 + (2 + payload + 3) * 64 + 24;
+        default:
+            return (1 + 4 + 2 + payload + 3) * 8;
+    }
+}
+
+static uint16_t packetsPerEvent(const LinkParams_t* params)
+{
+    uint32_t exchange = pduUs(params->dataLen, params->txPhy) + LINK_T_IFS_US +
+                        pduUs(0, params->rxPhy) + LINK_T_IFS_US;
+    uint32_t n = params->interval * 1250u * LINK_EVENT_USE_PCT / 100 / exchange;
+    if (n > LINK_MAX_PACKETS_PER_EVENT) {
+        n = LINK_MAX_PACKETS_PER_EVENT;
+    }
+    return (uint16_t)(n ? n : 1);
+}
+
+// LL PDUs per notification: ATT opcode and handle, L2CAP length and channel
+static uint32_t fragments(size_t payload, uint16_t dataLen)
+{
+    uint16_t len = dataLen ? dataLen : LINK_DEFAULT_DATA_LEN;
+    return (uint32_t)((payload + 7 + len - 1) / len);
+}
+
+uint32_t Link_NotifyRate(const LinkParams_t* params, size_t payload)
+{
+    if (params->interval == 0) {
+        return 0;
+    }
+    return packetsPerEvent(params) * 1000000u / (params->interval * 1250u * fragments(payload, params->dataLen));
+}
+
+uint8_t Link_BatchFrames(const LinkParams_t* params, size_t frameSize, uint32_t framesPerSec, uint8_t fit)
+{
+    if (params->interval == 0 || fit <= 1) {
+        return 1;
+    }
+    for (uint8_t k = 1; k < fit; k++) {
+        if (Link_NotifyRate(params, k * frameSize) * k >= framesPerSec) {
+            return k;
+        }
+    }
+    return fit;
+}
+
+void Link_Capacity(const LinkParams_t* params, LinkCapacity_t* cap)
+{
+    memset(cap, 0, sizeof(*cap));
+    if (params->interval == 0) {
+        return;
+    }
+    cap->intervalUs = params->interval * 1250u;
+    cap->packetsPerEvent = packetsPerEvent(params);
+    cap->maxPayload = (params->mtu > 3) ? (uint16_t)(params->mtu - 3) : 0;
+    uint32_t rate = Link_NotifyRate(params, cap->maxPayload);
+    cap->notifyPerSec = (rate > UINT16_MAX) ? UINT16_MAX : (uint16_t)rate;
+    cap->bytesPerSec = rate * cap->maxPayload;
+}
+
+uint16_t Link_LoadPct(const LinkParams_t* params, const LinkDemand_t* demand)
+{
+    uint32_t needed = demand->notifyPerSec * fragments(demand->payload, params->dataLen);
+    if (needed == 0) {
+        return 0;
+    }
+    if (params->interval == 0) {
+        return UINT16_MAX;
+    }
+    uint32_t available = packetsPerEvent(params) * 1000000u / (params->interval * 1250u);
+    uint32_t pct = needed * 100 / available;
+    return (pct > UINT16_MAX) ? UINT16_MAX : (uint16_t)pct;
+}
+
+void Link_Reset(uint32_t nowMs)
+{
+    // Connection setup (discovery, subscription) runs on whatever the central chose.
+    // Treating that as a pending THROUGHPUT request defers the first request until the
+    // load is known: a lower profile after LINK_STEP_DOWN_MS, THROUGHPUT after the timeout.
+    s_wanted = LINK_PROFILE_THROUGHPUT;
+    s_pending = true;
+    s_requestMs = nowMs;
+    s_attempts = 0;
+    s_lower = false;
+    memset(s_failedBps, 0, sizeof(s_failedBps));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.profile = s_wanted;
+}
+
+// The granted parameters a profile would run on, taking the slowest interval it allows
+static void predict(LinkProfile_t profile, const LinkParams_t* granted, LinkParams_t* out)
+{
+    const LinkProfileParams_t* p = &s_profiles[profile];
+    *out = *granted;
+    out->interval = p->maxInterval;
+    out->latency = p->latency;
+    if (p->phy && !s_stats.phyRefused) {
+        out->txPhy = p->phy;
+        out->rxPhy = p->phy;
+    }
+    if (p->dataLen > out->dataLen) {
+        out->dataLen = p->dataLen;
+    }
+}
+
+static LinkProfile_t selectProfile(const LinkParams_t* granted, const LinkDemand_t* demand)
+{
+    if (demand->bulk) {
+        return LINK_PROFILE_THROUGHPUT;
+    }
+    if (!demand->streaming) {
+        return LINK_PROFILE_IDLE;
+    }
+    uint32_t bps = (uint32_t)demand->payload * demand->notifyPerSec;
+    for (int p = LINK_PROFILE_POWER; p < LINK_PROFILE_THROUGHPUT; p++) {
+        // Measured rates wobble a little; a profile that refused this load stays out
+        if (s_failedBps[p] && bps * 10 >= s_failedBps[p] * 9) {
+            continue;
+        }
+        LinkParams_t model;
+        predict((LinkProfile_t)p, granted, &model);
+        if (Link_LoadPct(&model, demand) <= LINK_MAX_LOAD_PCT) {
+            return (LinkProfile_t)p;
+        }
+    }
+    return LINK_PROFILE_THROUGHPUT;
+}
+
+// Parts of the wanted profile the central has not granted yet; false if none
+static bool outstanding(const LinkParams_t* granted, LinkProfileParams_t* req)
+{
+    *req = s_profiles[s_wanted];
+    if (granted->interval >= req->minInterval && granted->interval <= req->maxInterval) {
+        req->minInterval = 0;
+        req->maxInterval = 0;
+        req->latency = 0;
+        req->timeout = 0;
+    }
+    if (s_stats.phyRefused || (granted->txPhy == req->phy && granted->rxPhy == req->phy)) {
+        req->phy = 0;
+    }
+    if (granted->dataLen >= req->dataLen) {
+        req->dataLen = 0;
+    }
+    return req->minInterval || req->phy || req->dataLen;
+}
+
+static bool sendRequest(const LinkParams_t* granted, uint32_t nowMs, LinkProfileParams_t* request)
+{
+    s_pending = outstanding(granted, request);
+    if (!s_pending) {
+        return false;
+    }
+    s_requestMs = nowMs;
+    s_attempts++;
+    s_stats.requests++;
+    return true;
+}
+
+bool Link_Update(const LinkParams_t* granted, const LinkDemand_t* demand, uint32_t nowMs,
+                 LinkProfileParams_t* request)
+{
+    uint32_t bps = (uint32_t)demand->payload * demand->notifyPerSec;
+    if (demand->refused && demand->streaming && !s_pending && s_wanted < LINK_PROFILE_THROUGHPUT &&
+        (s_failedBps[s_wanted] == 0 || bps < s_failedBps[s_wanted])) {
+        // The model was optimistic for this central: the stack ran out of buffers
+        s_failedBps[s_wanted] = bps ? bps : 1;
+    }
+
+    LinkProfile_t want = selectProfile(granted, demand);
+    s_stats.loadPct = Link_LoadPct(granted, demand);
+    // Refusals at the top profile prove it too, whatever the model says (e.g. no data length extension)
+    s_stats.shortfall = demand->streaming &&
+                        (s_stats.loadPct > 100 || (demand->refused && !s_pending && s_wanted == LINK_PROFILE_THROUGHPUT));
+
+    if (want < s_wanted) {
+        if (!s_lower) {
+            s_lower = true;
+            s_lowerMs = nowMs;
+        }
+    } else {
+        s_lower = false;
+    }
+
+    if (want > s_wanted || (s_lower && nowMs - s_lowerMs >= LINK_STEP_DOWN_MS)) {
+        s_wanted = want;
+        s_stats.profile = want;
+        s_stats.changes++;
+        s_attempts = 0;
+        s_lower = false;
+        return sendRequest(granted, nowMs, request);
+    }
+
+    if (!s_pending) {
+        return false;
+    }
+    if (!outstanding(granted, request)) {
+        s_pending = false;
+        return false;
+    }
+    // A step down is coming anyway; do not insist on the current profile meanwhile
+    if (s_lower || nowMs - s_requestMs < LINK_REQUEST_TIMEOUT_MS) {
+        return false;
+    }
+    if (s_attempts >= LINK_MAX_REQUESTS) {
+        // The central's choice stands until the next profile change
+        if (request->phy) {
+            s_stats.phyRefused = true;
+        }
+        if (request->minInterval) {
+            s_stats.rejected++;
+        }
+        s_pending = false;
+        return false;
+    }
+    return sendRequest(granted, nowMs, request);
+}
+
+void Link_GetStats(LinkStats_t* stats)
+{
+    *stats = s_stats;
+}
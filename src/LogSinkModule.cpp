@@ -0,0 +1,125 @@
+#include "LogSinkModule.h"
+#include "Config.h"
+#include "SerialStreamModule.h"
+
+// ''''''' UART ''''''''''''''''''' //
+
+static bool uartInit(void)
+{
+    // The TX buffer must be sized before begin(); the UART driver drains it from its ISR
+    Serial.setTxBufferSize(LOGGER_UART_TX_BUFFER_SIZE);
+    Serial.begin(LOGGER_UART_BAUD);
+    return true;
+}
+
+static bool uartWrite(const char* line, size_t len)
+{
+    if ((size_t)Serial.availableForWrite() < len + 2) {
+        return false;
+    }
+    Serial.write((const uint8_t*)line, len);
+    Serial.write((const uint8_t*)"\r\n", 2);
+    return true;
+}
+
+const LogSink_t LogSink_Uart = { "uart", uartInit, uartWrite };
+
+// ''''''' SERIAL STREAM ''''''''''''''''''' //
+
+static bool serialStreamInit(void)
+{
+    return SerialStream_Begin();
+}
+
+const LogSink_t LogSink_SerialStream = { "stream", serialStreamInit, SerialStream_SendLog };
+
+// ''''''' RAM RING ''''''''''''''''''' //
+
+#define RAM_RING_MAGIC  0x4C4F4752u   // "LOGR"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t head;      // next write position
+    uint32_t used;      // valid bytes, up to LOGGER_RAM_RING_SIZE
+    char     data[LOGGER_RAM_RING_SIZE];
+} RamRing_t;
+
+static RTC_NOINIT_ATTR RamRing_t s_ring;
+
+void LogSink_ClearRamRing(void)
+{
+    s_ring.head = 0;
+    s_ring.used = 0;
+    s_ring.magic = RAM_RING_MAGIC;
+}
+
+static bool ramRingValid(void)
+{
+    return s_ring.magic == RAM_RING_MAGIC && s_ring.head < LOGGER_RAM_RING_SIZE &&
+           s_ring.used <= LOGGER_RAM_RING_SIZE;
+}
+
+static bool ramRingInit(void)
+{
+    // Keep the previous boot's content until it was dumped
+    if (!ramRingValid()) {
+        LogSink_ClearRamRing();
+    }
+    return true;
+}
+
+static void ramRingPut(const char* src, size_t len)
+{
+    while (len) {
+        size_t chunk = LOGGER_RAM_RING_SIZE - s_ring.head;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(&s_ring.data[s_ring.head], src, chunk);
+        s_ring.head = (s_ring.head + chunk) % LOGGER_RAM_RING_SIZE;
+        s_ring.used = (s_ring.used + chunk > LOGGER_RAM_RING_SIZE) ? LOGGER_RAM_RING_SIZE : s_ring.used + chunk;
+        src += chunk;
+        len -= chunk;
+    }
+}
+
+static bool ramRingWrite(const char* line, size_t len)
+{
+    // Oldest lines are overwritten, the ring always accepts
+    if (len > LOGGER_RAM_RING_SIZE - 1) {
+        line += len - (LOGGER_RAM_RING_SIZE - 1);
+        len = LOGGER_RAM_RING_SIZE - 1;
+    }
+    ramRingPut(line, len);
+    ramRingPut("\n", 1);
+    return true;
+}
+
+size_t LogSink_DumpRamRing(void)
+{
+    if (esp_reset_reason() == ESP_RST_POWERON || !ramRingValid() || s_ring.used == 0) {
+        return 0;
+    }
+    size_t start = (s_ring.head + LOGGER_RAM_RING_SIZE - s_ring.used) % LOGGER_RAM_RING_SIZE;
+    size_t first = (start + s_ring.used > LOGGER_RAM_RING_SIZE) ? LOGGER_RAM_RING_SIZE - start : s_ring.used;
+
+    Serial.println("---- log ring from previous boot ----");
+    Serial.write((const uint8_t*)&s_ring.data[start], first);
+    Serial.write((const uint8_t*)s_ring.data, s_ring.used - first);
+    Serial.println("---- end of log ring ----");
+    Serial.flush();
+    return s_ring.used;
+}
+
+const LogSink_t LogSink_RamRing = { "ram", ramRingInit, ramRingWrite };
+
+// ''''''' NULL ''''''''''''''''''' //
+
+static bool nullWrite(const char* line, size_t len)
+{
+    (void)line;
+    (void)len;
+    return true;
+}
+
+const LogSink_t LogSink_Null = { "null", nullptr, nullWrite };
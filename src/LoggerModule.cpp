@@ -5,7 +5,6 @@ static const size_t LOG_QUEUE_SIZE  = LOGGER_QUEUE_SIZE;   // number of messages
 static const size_t MAX_LOG_LENGTH  = LOGGER_MAX_LOG_LENGTH;  // max length per log message
 
 static uint8_t s_logLevel      = LOGGER_LEVEL_ERROR;
-static bool    s_serialEnabled = false;
 static unsigned long lastPrintTime = 0;
 typedef struct {
     char msg[MAX_LOG_LENGTH];
@@ -13,59 +12,222 @@ typedef struct {
 } LogItem_t;
 
 static QueueHandle_t s_loggerQueue = nullptr;
+static StaticQueue_t s_loggerQueueBuffer;
+static uint8_t s_loggerQueueStorage[LOG_QUEUE_SIZE * sizeof(LogItem_t)];
+
+static const LogSink_t* s_sinks[LOGGER_MAX_SINKS];
+static uint8_t s_sinkCount = 0;
+
+// Token buckets in 1/1000 lines, one per level
+static const uint16_t s_rateLimit[LOGGER_LEVEL_VERBOSE + 1] = LOGGER_RATE_LIMIT_PER_S;
+static const uint16_t s_rateBurst[LOGGER_LEVEL_VERBOSE + 1] = LOGGER_RATE_LIMIT_BURST;
+static uint32_t s_tokens[LOGGER_LEVEL_VERBOSE + 1];
+static uint32_t s_refillMs[LOGGER_LEVEL_VERBOSE + 1];
+
+static LoggerStats_t s_stats;
+
+// LoggerPrint() runs on every task and core
+static portMUX_TYPE s_loggerMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool LoggerAddSink(const LogSink_t* sink)
+{
+    if (!sink || s_sinkCount >= LOGGER_MAX_SINKS) {
+        return false;
+    }
+    s_sinks[s_sinkCount++] = sink;
+    return true;
+}
+
+void LoggerClearSinks(void)
+{
+    s_sinkCount = 0;
+}
 
 void LoggerInit()
 {
     s_logLevel = LOG_LEVEL_SELECTED;
 
-    Serial.begin(115200);
+    if (s_sinkCount == 0) {
+        if (SERIAL_STREAM_ENABLED) {
+            // Raw text would interleave with the binary packets
+            LoggerAddSink(&LogSink_SerialStream);
+        } else if (LOGGER_UART_ENABLED) {
+            LoggerAddSink(&LogSink_Uart);
+        }
+        if (LOGGER_RAM_RING_ENABLED) {
+            LoggerAddSink(&LogSink_RamRing);
+        }
+    }
+    for (uint8_t i = 0; i < s_sinkCount; i++) {
+        if (s_sinks[i]->init) {
+            s_sinks[i]->init();
+        }
+    }
+    if (LOGGER_RAM_RING_ENABLED) {
+        // Whatever the previous boot logged before it died
+        LogSink_DumpRamRing();
+        LogSink_ClearRamRing();
+    }
+
+    uint32_t now = millis();
+    for (int level = 0; level <= LOGGER_LEVEL_VERBOSE; level++) {
+        s_tokens[level] = s_rateBurst[level] * 1000u;
+        s_refillMs[level] = now;
+    }
+    memset(&s_stats, 0, sizeof(s_stats));
+
     // Create the queue if not created
     if (!s_loggerQueue) {
-        s_loggerQueue = xQueueCreate(LOG_QUEUE_SIZE, sizeof(LogItem_t));
+        s_loggerQueue = xQueueCreateStatic(LOG_QUEUE_SIZE, sizeof(LogItem_t),
+                                           s_loggerQueueStorage, &s_loggerQueueBuffer);
+    }
+}
+
+// Takes one token from the level's bucket; false => over the rate limit
+static bool LoggerRateAllow(uint8_t level)
+{
+    if (s_rateLimit[level] == 0) {
+        return true;
+    }
+    uint32_t now = millis();
+    bool allow = false;
+    portENTER_CRITICAL(&s_loggerMux);
+    uint32_t cap = s_rateBurst[level] * 1000u;
+    uint32_t elapsed = now - s_refillMs[level];
+    if (elapsed > 60000u) {
+        elapsed = 60000u;   // bucket is full long before, avoids overflow
+    }
+    s_tokens[level] += elapsed * s_rateLimit[level];
+    s_refillMs[level] = now;
+    if (s_tokens[level] > cap) {
+        s_tokens[level] = cap;
     }
+    if (s_tokens[level] >= 1000u) {
+        s_tokens[level] -= 1000u;
+        allow = true;
+    } else {
+        s_stats.droppedRateLimit++;
+    }
+    portEXIT_CRITICAL(&s_loggerMux);
+    return allow;
 }
 
 void LoggerPrint(uint8_t level, const char* func, int line, const char* format, ...)
 {
     // If level is above current log level, skip
-    if (level > s_logLevel) {
+    if (level > s_logLevel || !s_loggerQueue) {
+        return;
+    }
+    // Rate check before formatting, so a flood costs next to nothing
+    if (level > LOGGER_LEVEL_VERBOSE || !LoggerRateAllow(level)) {
         return;
     }
 
-    char buf[MAX_LOG_LENGTH];
+    // Format function & line and the message straight into the queue item
+    LogItem_t item;
+    int len = snprintf(item.msg, sizeof(item.msg), "[%s:%d] ", func, line);
+    if (len < 0 || len >= (int)sizeof(item.msg)) {
+        len = 0;
+    }
     va_list args;
     va_start(args, format);
-    vsnprintf(buf, sizeof(buf), format, args);
+    vsnprintf(item.msg + len, sizeof(item.msg) - len, format, args);
     va_end(args);
+    item.level = level;
 
-    // Prepend function & line
-    char finalMsg[MAX_LOG_LENGTH];
-    snprintf(finalMsg, sizeof(finalMsg), "[%s:%d] %s", func, line, buf);
+    // Enqueue without waiting; a full queue is counted, not waited out
+    bool queued = (xQueueSend(s_loggerQueue, &item, 0) == pdTRUE);
+    portENTER_CRITICAL(&s_loggerMux);
+    if (queued) {
+        s_stats.queued++;
+    } else {
+        s_stats.droppedQueueFull++;
+    }
+    portEXIT_CRITICAL(&s_loggerMux);
+}
 
-    // Enqueue
-    if (s_loggerQueue) {
-        LogItem_t item;
-        strncpy(item.msg, finalMsg, MAX_LOG_LENGTH);
-        item.msg[MAX_LOG_LENGTH-1] = '\0';
-        item.level = level;
-        xQueueSend(s_loggerQueue, &item, 0);
+// Hands a line to every sink; a full sink gets LOGGER_SINK_RETRY_MS to drain
+static void LoggerWriteLine(const char* msg, size_t len)
+{
+    bool dropped = false;
+    for (uint8_t i = 0; i < s_sinkCount; i++) {
+        uint32_t start = millis();
+        while (!s_sinks[i]->write(msg, len)) {
+            if (millis() - start >= LOGGER_SINK_RETRY_MS) {
+                dropped = true;
+                break;
+            }
+            vTaskDelay(1);
+        }
     }
+    portENTER_CRITICAL(&s_loggerMux);
+    if (dropped) {
+        s_stats.droppedSink++;
+    } else {
+        s_stats.written++;
+    }
+    portEXIT_CRITICAL(&s_loggerMux);
+}
+
+void LoggerGetStats(LoggerStats_t* stats)
+{
+    portENTER_CRITICAL(&s_loggerMux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_loggerMux);
+}
+
+// Reports drops since the last report, so lost lines are visible in the log itself
+static void LoggerReportDrops(void)
+{
+    static uint32_t lastReport = 0;
+    static uint32_t lastDropped = 0;
+    if (LOGGER_DROP_REPORT_MS == 0 || millis() - lastReport < LOGGER_DROP_REPORT_MS) {
+        return;
+    }
+    lastReport = millis();
+
+    LoggerStats_t st;
+    LoggerGetStats(&st);
+    uint32_t dropped = st.droppedQueueFull + st.droppedRateLimit + st.droppedSink;
+    if (dropped == lastDropped) {
+        return;
+    }
+    char msg[96];
+    int len = snprintf(msg, sizeof(msg), "[logger] dropped %lu lines (queue %lu, rate %lu, sink %lu)",
+                       (unsigned long)(dropped - lastDropped), (unsigned long)st.droppedQueueFull,
+                       (unsigned long)st.droppedRateLimit, (unsigned long)st.droppedSink);
+    lastDropped = dropped;
+    LoggerWriteLine(msg, (len > 0 && len < (int)sizeof(msg)) ? len : strlen(msg));
+}
+
+bool LoggerService(TickType_t wait)
+{
+    LogItem_t item;
+    bool got = s_loggerQueue && xQueueReceive(s_loggerQueue, &item, wait) == pdTRUE;
+    if (got) {
+        LoggerWriteLine(item.msg, strlen(item.msg));
+    }
+    LoggerReportDrops();
+    return got;
 }
 
 void LoggerTask(void* pvParams)
 {
+    (void)pvParams;
     esp_task_wdt_add(NULL); // "NULL" means "this current task"
-    LogItem_t item;
     for (;;) {
-        // Wait for next log message
-        if (xQueueReceive(s_loggerQueue, &item, portMAX_DELAY) == pdTRUE) {
-                Serial.println(item.msg);
-            // If serial not enabled, we discard or could store logs in memory
-            esp_task_wdt_reset();
-        }
+        // Wait for next log message; wake up at least once a second for drop reports and the watchdog
+        LoggerService(pdMS_TO_TICKS(1000));
+        esp_task_wdt_reset();
     }
 }
 
+// Pressure values per TxMsg line; larger insoles continue on the next lines
+#define LOOP_MSG_CHANNELS_PER_LINE  16
+// Header, then up to "65535, " per value and the continuation mark
+#define LOOP_MSG_LINE_SIZE          (64 + 7 * LOOP_MSG_CHANNELS_PER_LINE + 4)
+static_assert(LOOP_MSG_LINE_SIZE + 64 <= LOGGER_MAX_LOG_LENGTH, "a TxMsg line must fit a log line with its prefix");
+
 // Prints the sensor byte array if enough time has passed
 void LoggerPrintLoopMessage(SensorData* sensor_msg) {
     
@@ -74,31 +236,26 @@ void LoggerPrintLoopMessage(SensorData* sensor_msg) {
     if (currentTime - lastPrintTime >= PRINT_INTERVAL) {
         lastPrintTime = currentTime;
 
-        // Create debug string with all values in decimal
-        String dbg;
-        
-        // Battery
-        dbg += "Batt: ";
-        dbg += String(sensor_msg->battery);
-        dbg += " | ";
-
-        // Accelerometer
-        dbg += "Accel(";
-        dbg += String(sensor_msg->accel_x);
-        dbg += ", ";
-        dbg += String(sensor_msg->accel_y);
-        dbg += ", ";
-        dbg += String(sensor_msg->accel_z);
-        dbg += ") | ";
-
-        // Pressure array
-        dbg += "Press[";
-        for (int i = 0; i < 16; i++) {
-            dbg += String(sensor_msg->pressure[i]);
-            if (i < 15) dbg += ", ";
-        }
-        dbg += "]";
+        // Create debug string with all values in decimal, on the stack (no heap in the hot path)
+        for (int first = 0; first < PRESSURE_CHANNEL_COUNT; first += LOOP_MSG_CHANNELS_PER_LINE) {
+            char dbg[LOOP_MSG_LINE_SIZE];
+            int len = (first == 0) ? snprintf(dbg, sizeof(dbg), "Batt: %u | Accel(%d, %d, %d) | Press[",
+                                              sensor_msg->battery, sensor_msg->accel_x, sensor_msg->accel_y,
+                                              sensor_msg->accel_z)
+                                   : snprintf(dbg, sizeof(dbg), "... ");
+
+            // Pressure array, one line's share of it
+            int last = first + LOOP_MSG_CHANNELS_PER_LINE;
+            if (last > PRESSURE_CHANNEL_COUNT) {
+                last = PRESSURE_CHANNEL_COUNT;
+            }
+            for (int i = first; i < last && len > 0 && len < (int)sizeof(dbg); i++) {
+                len += snprintf(dbg + len, sizeof(dbg) - len,
+                                (i == PRESSURE_CHANNEL_COUNT - 1) ? "%u]" : (i == last - 1) ? "%u, ..." : "%u, ",
+                                sensor_msg->pressure[i]);
+            }
 
-        LOG_INFO("TxMsg: %s", dbg.c_str());
+            LOG_INFO("TxMsg: %s", dbg);
+        }
     }
 }
\ No newline at end of file
@@ -1,84 +1,287 @@
 #include "PressureModule.h"
+#include "ScanSchedulerModule.h"
+#include "FilterModule.h"
+#include "BurstModule.h"
 #include "LoggerModule.h"
 #include "Config.h"
 #include <Wire.h>
 #include <Adafruit_ADS1X15.h>
+#include <string.h>
 
-// Example addresses: 0x48, 0x49, 0x4A, 0x4B
-static const uint8_t ADS1115_ADDR[4] = {0x48, 0x49, 0x4A, 0x4B};
+// Bus and address of every ADS1115 come from the insole topology
+static inline uint8_t adsAddress(int dev)
+{
+    return ActiveTopology::adc(dev).address;
+}
+
+static inline TwoWire* adsBus(int dev)
+{
+    return (ActiveTopology::adc(dev).bus == 0) ? &Wire : &Wire1;
+}
 
-static Adafruit_ADS1115 ads[4];
-uint16_t Pressure_Array[16] = {0};
+// Single-ended mux setting per ADS1115 input
+static const uint16_t ADS1115_MUX[PRESSURE_CHANNELS_PER_ADC] = {
+    ADS1X15_REG_CONFIG_MUX_SINGLE_0, ADS1X15_REG_CONFIG_MUX_SINGLE_1,
+    ADS1X15_REG_CONFIG_MUX_SINGLE_2, ADS1X15_REG_CONFIG_MUX_SINGLE_3
+};
+
+// One conversion at 860 SPS; a sample is stamped at the middle of its conversion
+#define ADS1115_CONV_US     1163
+
+static const uint16_t s_channelRatesHz[PRESSURE_CHANNEL_COUNT] = PRESSURE_CHANNEL_RATES_HZ;
+
+static Adafruit_ADS1115 ads[PRESSURE_ADC_COUNT];
+uint16_t Pressure_Array[PRESSURE_CHANNEL_COUNT] = {0};
+PressureMask_t Pressure_ValidMask = 0;
+uint8_t  Pressure_Age[PRESSURE_CHANNEL_COUNT] = {0};
+uint32_t Pressure_SampleUs[PRESSURE_CHANNEL_COUNT] = {0};
 PressureStatus_t Pressure_Status = PRESSURE_STATUS_OK;
+PressureDevHealth_t Pressure_DevHealth[PRESSURE_ADC_COUNT];
+
+// Probes and configures one ADS1115
+static bool Pressure_StartDevice(int dev)
+{
+    if (!ads[dev].begin(adsAddress(dev), adsBus(dev))) {
+        return false;
+    }
+    LOG_DEBUG("ads[dev].begin(adsAddress(dev), adsBus(dev)) complete.");
+    // Configure for single-shot, 860SPS, gain=1, etc.
+    ads[dev].setGain(GAIN_ONE);
+    LOG_DEBUG("ads[dev].setGain complete.");
+
+    // Fastest rate: the scan scheduler decides how often each input is converted
+    ads[dev].setDataRate(RATE_ADS1115_860SPS);
+    LOG_DEBUG("ads[dev].setDataRate complete.");
 
-uint8_t Pressure_Init(void)
+    // Ready once a first conversion reads back; ~1.2 ms at 860 SPS instead of a fixed delay.
+    // A device that answers but converts garbage stays down instead of flapping.
+    ads[dev].startADCReading(ADS1115_MUX[0], false);
+    unsigned long start = micros();
+    while (!ads[dev].conversionComplete()) {
+        if (micros() - start > PRESSURE_CONV_TIMEOUT_US) {
+            LOG_ERROR("ADS1115 0x%02X: no conversion after configuration", adsAddress(dev));
+            return false;
+        }
+    }
+    if (ads[dev].getLastConversionResults() < 0) {
+        LOG_ERROR("ADS1115 0x%02X: bad conversion after configuration", adsAddress(dev));
+        return false;
+    }
+    return true;
+}
+
+// Takes a device out of the scan; its channels read 0 and are flagged invalid
+static void Pressure_MarkDown(int dev, uint32_t now)
 {
-    for (int i = 0; i < 4; i++) {
+    PressureDevHealth_t* h = &Pressure_DevHealth[dev];
+    if (h->state != PRESSURE_DEV_DOWN) {
+        h->state = PRESSURE_DEV_DOWN;
+        h->backoffMs = PRESSURE_REINIT_BACKOFF_MIN_MS;
+        LOG_ERROR("ADS1115 %u:0x%02X down, sensors %u %u %u %u invalid",
+                  ActiveTopology::adc(dev).bus, adsAddress(dev),
+                  ActiveTopology::sensorOf(dev, 0), ActiveTopology::sensorOf(dev, 1),
+                  ActiveTopology::sensorOf(dev, 2), ActiveTopology::sensorOf(dev, 3));
+    }
+    h->retryAtMs = now + h->backoffMs;
+    for (int ch = 0; ch < PRESSURE_CHANNELS_PER_ADC; ch++) {
+        Pressure_Array[ActiveTopology::sensorOf(dev, ch)] = PRESSURE_VALUE_DOWN;
+    }
+}
+
+// Retries devices that are down once their backoff has expired
+static void Pressure_ServiceRecovery(void)
+{
+    uint32_t now = millis();
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        PressureDevHealth_t* h = &Pressure_DevHealth[dev];
+        if (h->state != PRESSURE_DEV_DOWN || (int32_t)(now - h->retryAtMs) < 0) {
+            continue;
+        }
+        if (Pressure_StartDevice(dev)) {
+            h->state = PRESSURE_DEV_OK;
+            h->consecutiveErrors = 0;
+            h->reinitCount++;
+            LOG_INFO("ADS1115 0x%02X recovered", adsAddress(dev));
+        } else {
+            h->backoffMs = (h->backoffMs * 2 > PRESSURE_REINIT_BACKOFF_MAX_MS) ?
+                           PRESSURE_REINIT_BACKOFF_MAX_MS : h->backoffMs * 2;
+            h->retryAtMs = now + h->backoffMs;
+        }
+    }
+}
+
+uint8_t Pressure_GetHealthyMask(void)
+{
+    uint8_t mask = 0;
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        if (Pressure_DevHealth[dev].state == PRESSURE_DEV_OK) {
+            mask |= (uint8_t)(1u << dev);
+        }
+    }
+    return mask;
+}
+
+uint8_t Pressure_Init(const uint8_t* present, uint8_t presentCount)
+{
+    uint8_t healthy = 0;
+    uint32_t now = millis();
+    for (int i = 0; i < PRESSURE_ADC_COUNT; i++) {
         ads[i] = Adafruit_ADS1115(); // use default constructor
         LOG_DEBUG("Adafruit_ADS1115 object creation complete.");
+        memset(&Pressure_DevHealth[i], 0, sizeof(Pressure_DevHealth[i]));
 
-        if (!ads[i].begin(ADS1115_ADDR[i])) {
-            LOG_ERROR("ADS1115 init failed at addr 0x%02X", ADS1115_ADDR[i]);
-            Pressure_Status = PRESSURE_STATUS_INIT_ERROR;
-            return PRESSURE_ERR_INIT;
+        // A missing device costs its four channels, not the session; the backoff retries it later
+        bool listed = !present || ActiveTopology::adc(i).bus != 0 ||
+                      memchr(present, adsAddress(i), presentCount) != NULL;
+        if (!listed || !Pressure_StartDevice(i)) {
+            LOG_ERROR("ADS1115 %s at addr 0x%02X", listed ? "init failed" : "not found", adsAddress(i));
+            Pressure_MarkDown(i, now);
+            continue;
         }
-        LOG_DEBUG("ads[i].begin(ADS1115_ADDR[i]) complete.");
-        // Configure for single-shot, 860SPS, gain=1, etc.
-        ads[i].setGain(GAIN_ONE);
-        LOG_DEBUG("ads[i].setGain complete.");
+        healthy++;
+    }
+
+    ScanScheduler_Init(s_channelRatesHz, (uint16_t)(PRESSURE_SCAN_TICKS_PER_FRAME * 1000 / LOOP_INTERVAL_MS));
+    ScanScheduler_PrintSummary();
 
-        ads[i].setDataRate(RATE_ADS1115_128SPS);
-        LOG_DEBUG("ads[i].setDataRate complete.");
-        delay(100);
+    if (healthy < PRESSURE_ADC_COUNT) {
+        Pressure_Status = (healthy == 0) ? PRESSURE_STATUS_INIT_ERROR : PRESSURE_STATUS_DEGRADED;
+        LOG_WARN("Pressure module init: %d of %d ADS1115 up, retrying the rest in background",
+                 healthy, PRESSURE_ADC_COUNT);
+        return PRESSURE_ERR_INIT;
     }
     Pressure_Status = PRESSURE_STATUS_OK;
     LOG_INFO("Pressure module init OK.");
     return PRESSURE_ERR_OK;
 }
 
-uint8_t Pressure_Read(void)
+// Counts a failed conversion against the device's health
+static void Pressure_DeviceError(int dev)
 {
-    if (Pressure_Status == PRESSURE_STATUS_INIT_ERROR) {
-        return PRESSURE_ERR_INIT;
+    PressureDevHealth_t* h = &Pressure_DevHealth[dev];
+    h->errorCount++;
+    if (++h->consecutiveErrors >= PRESSURE_MAX_CONSECUTIVE_ERRORS) {
+        Pressure_MarkDown(dev, millis());
+    }
+}
+
+// One scan tick: start a conversion on every healthy ADS1115 that has a busy slot, then collect them.
+// The devices convert in parallel, so a tick costs one conversion time plus the I2C traffic.
+// A failing device only loses its own conversion; the others are still read.
+static void Pressure_ScanTick(PressureMask_t* convertedMask)
+{
+    uint8_t active[PRESSURE_ADC_COUNT];
+    uint32_t startedUs[PRESSURE_ADC_COUNT];
+
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        active[dev] = ScanScheduler_NextChannel(dev);
+        if (Pressure_DevHealth[dev].state != PRESSURE_DEV_OK) {
+            active[dev] = SCAN_SLOT_IDLE;
+        }
+        if (active[dev] != SCAN_SLOT_IDLE) {
+            startedUs[dev] = micros();
+            ads[dev].startADCReading(ADS1115_MUX[active[dev]], false);
+        }
     }
 
-    // Read 4 channels from each ADS1115
-    for (int dev = 0; dev < 4; dev++) {
-        for (int ch = 0; ch < 4; ch++) {
-            int16_t raw = ads[dev].readADC_SingleEnded(ch);
-            if (raw < 0) {
-                LOG_ERROR("ADS1115 read error: dev=%d ch=%d", dev, ch);
-                Pressure_Status = PRESSURE_STATUS_READ_ERROR;
-                return PRESSURE_ERR_READ;
+    unsigned long start = micros();
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        uint8_t ch = active[dev];
+        if (ch == SCAN_SLOT_IDLE) {
+            continue;
+        }
+        bool timedOut = false;
+        while (!ads[dev].conversionComplete()) {
+            if (micros() - start > PRESSURE_CONV_TIMEOUT_US) {
+                timedOut = true;
+                break;
             }
-            Pressure_Array[dev * 4 + ch] = (uint16_t) raw;
         }
+        int16_t raw = timedOut ? -1 : ads[dev].getLastConversionResults();
+        if (raw < 0) {
+            LOG_DEBUG("ADS1115 read error: dev=%d ch=%d%s", dev, ch, timedOut ? " (timeout)" : "");
+            Pressure_DeviceError(dev);
+            continue;
+        }
+        Pressure_DevHealth[dev].consecutiveErrors = 0;
+        uint8_t index = ActiveTopology::sensorOf(dev, ch);
+        uint32_t sampleUs = startedUs[dev] + ADS1115_CONV_US / 2;
+        Pressure_Array[index] = (uint16_t) raw;
+        Pressure_SampleUs[index] = sampleUs;
+        Filter_PushPressure(index, raw, sampleUs);
+        if (BURST_ENABLED) {
+            Burst_PushPressure(index, raw, sampleUs);
+        }
+        *convertedMask |= (PressureMask_t)((PressureMask_t)1 << index);
     }
+}
+
+uint8_t Pressure_Read(void)
+{
+    Pressure_ServiceRecovery();
+
+    // Run this frame's share of the interleaved mux sequence
+    PressureMask_t converted = 0;
+    for (int tick = 0; tick < PRESSURE_SCAN_TICKS_PER_FRAME; tick++) {
+        Pressure_ScanTick(&converted);
+    }
+
+    Pressure_ValidMask = converted;
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) {
+        if (converted & ((PressureMask_t)1 << i)) {
+            Pressure_Age[i] = 0;
+        } else if (Pressure_Age[i] < 0xFF) {
+            Pressure_Age[i]++;
+        }
+    }
+
     if (LOG_LEVEL_SELECTED >= LOGGER_LEVEL_DEBUG)
     {
         Pressure_PrintValues();
     }
-    
 
+    uint8_t healthy = Pressure_GetHealthyMask();
+    if (healthy == (uint8_t)((1u << PRESSURE_ADC_COUNT) - 1)) {
+        Pressure_Status = PRESSURE_STATUS_OK;
+        return PRESSURE_ERR_OK;
+    }
+    Pressure_Status = healthy ? PRESSURE_STATUS_DEGRADED : PRESSURE_STATUS_READ_ERROR;
+    return PRESSURE_ERR_READ;
+}
 
-    Pressure_Status = PRESSURE_STATUS_OK;
-    return PRESSURE_ERR_OK;
+bool Pressure_ConvertOnce(uint8_t dev, uint8_t input, int16_t* value)
+{
+    if (dev >= PRESSURE_ADC_COUNT || input >= PRESSURE_CHANNELS_PER_ADC) {
+        return false;
+    }
+    ads[dev].startADCReading(ADS1115_MUX[input], false);
+    unsigned long start = micros();
+    while (!ads[dev].conversionComplete()) {
+        if (micros() - start > PRESSURE_CONV_TIMEOUT_US) {
+            return false;
+        }
+    }
+    int16_t raw = ads[dev].getLastConversionResults();
+    if (raw < 0) {
+        return false;
+    }
+    if (value) {
+        *value = raw;
+    }
+    return true;
 }
 
 void Pressure_PrintValues(void)
 {
-      char debug_str[128];
-    snprintf(debug_str, sizeof(debug_str), 
-    "[0]=%u [1]=%u [2]=%u [3]=%u [4]=%u [5]=%u [6]=%u [7]=%u ",
-    Pressure_Array[0], Pressure_Array[1], Pressure_Array[2], Pressure_Array[3],
-    Pressure_Array[4], Pressure_Array[5], Pressure_Array[6], Pressure_Array[7]);
-    LOG_DEBUG("%s", debug_str);
-
-    snprintf(debug_str, sizeof(debug_str), 
-    "[8]=%u [9]=%u [10]=%u [11]=%u [12]=%u [13]=%u [14]=%u [15]=%u",
-    Pressure_Array[8], Pressure_Array[9], Pressure_Array[10], Pressure_Array[11],
-    Pressure_Array[12], Pressure_Array[13], Pressure_Array[14], Pressure_Array[15]);
-    LOG_DEBUG("%s", debug_str);
+    // Eight values per line, as many lines as the topology needs
+    for (int first = 0; first < PRESSURE_CHANNEL_COUNT; first += 8) {
+        char debug_str[128];
+        int pos = 0;
+        for (int i = first; i < first + 8 && i < PRESSURE_CHANNEL_COUNT; i++) {
+            pos += snprintf(debug_str + pos, sizeof(debug_str) - pos, "[%d]=%u ", i, Pressure_Array[i]);
+        }
+        LOG_DEBUG("%s", debug_str);
+    }
 }
 
 void Pressure_Test(void)
@@ -0,0 +1,95 @@
+#include "RetransmitModule.h"
+#include "Config.h"
+#include <string.h>
+
+typedef struct {
+    uint16_t index;         // send order, for the drop statistics
+    uint16_t len;
+    uint32_t stamp;
+    uint8_t  data[RETX_SLOT_SIZE];
+} RetxSlot_t;
+
+static RetxSlot_t s_slots[RETX_SLOTS];
+static uint16_t s_head = 0;         // oldest waiting entry
+static uint16_t s_depth = 0;
+static RetxStats_t s_stats;
+
+void Retx_Reset(void)
+{
+    s_head = 0;
+    s_depth = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+uint16_t Retx_Depth(void)
+{
+    return s_depth;
+}
+
+static void pushSlot(uint16_t index, const uint8_t* data, size_t len, uint32_t stamp)
+{
+    if (len > RETX_SLOT_SIZE) {
+        s_stats.oversize++;
+        return;
+    }
+    // Oldest-first drop: the stale head makes room for the fresh frame
+    if (s_depth == RETX_SLOTS) {
+        s_stats.lastDroppedIndex = s_slots[s_head].index;
+        s_head = (uint16_t)((s_head + 1) % RETX_SLOTS);
+        s_depth--;
+        s_stats.dropped++;
+    }
+    RetxSlot_t* slot = &s_slots[(s_head + s_depth) % RETX_SLOTS];
+    slot->index = index;
+    slot->len = (uint16_t)len;
+    slot->stamp = stamp;
+    memcpy(slot->data, data, len);
+    s_depth++;
+    s_stats.queued++;
+    if (s_depth > s_stats.maxDepth) {
+        s_stats.maxDepth = s_depth;
+    }
+}
+
+uint16_t Retx_Push(const uint8_t* data, size_t len, uint32_t stamp)
+{
+    uint16_t index = s_stats.nextIndex++;
+    pushSlot(index, data, len, stamp);
+    return index;
+}
+
+uint16_t Retx_Drain(RetxSendFn send, void* ctx)
+{
+    uint16_t sent = 0;
+    while (s_depth > 0) {
+        const RetxSlot_t* slot = &s_slots[s_head];
+        if (!send(slot->data, slot->len, slot->stamp, ctx)) {
+            break;
+        }
+        s_head = (uint16_t)((s_head + 1) % RETX_SLOTS);
+        s_depth--;
+        s_stats.resent++;
+        sent++;
+    }
+    return sent;
+}
+
+bool Retx_Send(const uint8_t* data, size_t len, uint32_t stamp, RetxSendFn send, void* ctx)
+{
+    if (s_depth > 0) {
+        Retx_Drain(send, ctx);
+    }
+    uint16_t index = s_stats.nextIndex++;
+    if (s_depth == 0 && send(data, len, stamp, ctx)) {
+        s_stats.direct++;
+        return true;
+    }
+    pushSlot(index, data, len, stamp);
+    return false;
+}
+
+void Retx_GetStats(RetxStats_t* stats)
+{
+    *stats = s_stats;
+    stats->depth = s_depth;
+}
@@ -0,0 +1,126 @@
+#include "ScanSchedulerModule.h"
+#include "PressureModule.h"
+#include "LoggerModule.h"
+#include "Config.h"
+
+// One interleaved mux sequence per ADS1115, replayed cyclically
+static uint8_t  s_sequence[PRESSURE_ADC_COUNT][PRESSURE_SCAN_MAX_SEQ_LEN];
+static uint16_t s_seqLen = 0;
+static uint16_t s_seqPos[PRESSURE_ADC_COUNT] = {0};
+static uint16_t s_tickRateHz = 0;
+
+static uint16_t s_requestedHz[PRESSURE_CHANNEL_COUNT] = {0};
+static uint16_t s_slots[PRESSURE_CHANNEL_COUNT] = {0};   // slots per sequence granted to each channel
+static uint16_t s_usedSlots = 0;                          // busy slots per sequence, summed over all devices
+
+// Smooth weighted round robin: every slot each candidate earns its weight and the
+// richest one is picked and pays the sequence length. This spreads the slots of a
+// channel evenly over the sequence instead of bunching them.
+static void buildSequence(uint8_t dev, const uint16_t* weights, uint16_t idleWeight)
+{
+    int32_t credit[PRESSURE_CHANNELS_PER_ADC + 1] = {0};
+
+    for (uint16_t slot = 0; slot < s_seqLen; slot++) {
+        uint8_t pick = 0;
+        for (uint8_t i = 0; i <= PRESSURE_CHANNELS_PER_ADC; i++) {
+            credit[i] += (i < PRESSURE_CHANNELS_PER_ADC) ? weights[i] : idleWeight;
+            if (credit[i] > credit[pick]) {
+                pick = i;
+            }
+        }
+        credit[pick] -= s_seqLen;
+        s_sequence[dev][slot] = (pick < PRESSURE_CHANNELS_PER_ADC) ? pick : SCAN_SLOT_IDLE;
+    }
+}
+
+void ScanScheduler_Init(const uint16_t* ratesHz, uint16_t tickRateHz)
+{
+    s_tickRateHz = (tickRateHz > 0) ? tickRateHz : 1;
+    s_seqLen = (s_tickRateHz < PRESSURE_SCAN_MAX_SEQ_LEN) ? s_tickRateHz : PRESSURE_SCAN_MAX_SEQ_LEN;
+    s_usedSlots = 0;
+
+    for (uint8_t dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        uint16_t weights[PRESSURE_CHANNELS_PER_ADC];
+        uint32_t sum = 0;
+
+        // Convert Hz into slots of one sequence, every requested channel gets at least one
+        for (uint8_t ch = 0; ch < PRESSURE_CHANNELS_PER_ADC; ch++) {
+            uint8_t sensor = ActiveTopology::sensorOf(dev, ch);
+            uint16_t rate = ratesHz[sensor];
+            uint32_t w = ((uint32_t)rate * s_seqLen + s_tickRateHz / 2) / s_tickRateHz;
+            if (rate > 0 && w == 0) {
+                w = 1;
+            }
+            weights[ch] = (uint16_t)w;
+            sum += w;
+            s_requestedHz[sensor] = rate;
+        }
+
+        // Over budget: scale everybody down by the same factor
+        if (sum > s_seqLen) {
+            uint32_t scaled = 0;
+            for (uint8_t ch = 0; ch < PRESSURE_CHANNELS_PER_ADC; ch++) {
+                uint32_t w = ((uint32_t)weights[ch] * s_seqLen) / sum;
+                if (weights[ch] > 0 && w == 0) {
+                    w = 1;
+                }
+                weights[ch] = (uint16_t)w;
+                scaled += w;
+            }
+            sum = scaled;
+            LOG_WARN("ADS1115 %d over slot budget, rates scaled down", dev);
+        }
+
+        uint16_t idle = (sum < s_seqLen) ? (uint16_t)(s_seqLen - sum) : 0;
+        buildSequence(dev, weights, idle);
+        s_seqPos[dev] = 0;
+
+        for (uint8_t ch = 0; ch < PRESSURE_CHANNELS_PER_ADC; ch++) {
+            s_slots[ActiveTopology::sensorOf(dev, ch)] = weights[ch];
+        }
+        s_usedSlots += (uint16_t)sum;
+    }
+}
+
+uint8_t ScanScheduler_NextChannel(uint8_t dev)
+{
+    if (dev >= PRESSURE_ADC_COUNT || s_seqLen == 0) {
+        return SCAN_SLOT_IDLE;
+    }
+    uint8_t ch = s_sequence[dev][s_seqPos[dev]];
+    if (++s_seqPos[dev] >= s_seqLen) {
+        s_seqPos[dev] = 0;
+    }
+    return ch;
+}
+
+uint16_t ScanScheduler_GetScheduledRateHz(uint8_t channel)
+{
+    if (channel >= PRESSURE_CHANNEL_COUNT || s_seqLen == 0) {
+        return 0;
+    }
+    return (uint16_t)(((uint32_t)s_slots[channel] * s_tickRateHz) / s_seqLen);
+}
+
+uint16_t ScanScheduler_GetUniformRateHz(void)
+{
+    if (s_seqLen == 0) {
+        return 0;
+    }
+    // Same number of conversions per second, spread over all channels
+    return (uint16_t)(((uint32_t)s_usedSlots * s_tickRateHz) / s_seqLen / PRESSURE_CHANNEL_COUNT);
+}
+
+void ScanScheduler_PrintSummary(void)
+{
+    uint16_t uniform = ScanScheduler_GetUniformRateHz();
+    LOG_INFO("Scan scheduler: %u ticks/s, sequence length %u, %u conversions/s on the bus",
+             s_tickRateHz, s_seqLen, (unsigned)(((uint32_t)s_usedSlots * s_tickRateHz) / s_seqLen));
+    for (uint8_t ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        uint16_t scheduled = ScanScheduler_GetScheduledRateHz(ch);
+        LOG_INFO("  ch%02u: requested %u Hz, scheduled %u Hz (uniform %u Hz, x%u.%02u)",
+                 ch, s_requestedHz[ch], scheduled, uniform,
+                 uniform ? scheduled / uniform : 0,
+                 uniform ? ((scheduled % uniform) * 100) / uniform : 0);
+    }
+}
@@ -0,0 +1,366 @@
+#include "SelfTestModule.h"
+#include "Config.h"
+#include <stdio.h>
+#include <string.h>
+
+void SelfTest_DefaultLimits(SelfTestLimits_t* limits)
+{
+    limits->phaseMs = SELFTEST_PHASE_MS;
+    limits->minAdsSps = SELFTEST_MIN_ADS_SPS;
+    limits->maxLatencyUs = SELFTEST_MAX_LATENCY_US;
+    limits->maxI2cErrorPpm = SELFTEST_MAX_I2C_ERROR_PPM;
+    limits->minAccDrainHz = SELFTEST_MIN_ACC_DRAIN_HZ;
+    limits->minFrameHz = SELFTEST_MIN_FRAME_HZ;
+    limits->minNotifyBps = SELFTEST_MIN_NOTIFY_BPS;
+}
+
+static inline uint32_t perSecond(uint64_t count, uint32_t elapsedUs)
+{
+    return elapsedUs ? (uint32_t)((count * 1000000u + elapsedUs / 2) / elapsedUs) : 0;
+}
+
+// Back-to-back conversions on one ADS1115, cycling through its inputs
+static void measureAdc(const SelfTestOps_t* ops, uint8_t dev, uint32_t phaseUs, SelfTestAdc_t* out)
+{
+    uint64_t latencySum = 0;
+    uint8_t input = 0;
+    uint32_t start = ops->nowUs(ops->ctx);
+    uint32_t now = start;
+    while (now - start < phaseUs) {
+        uint32_t t0 = now;
+        bool ok = ops->adsConvert(ops->ctx, dev, input);
+        now = ops->nowUs(ops->ctx);
+        input = (uint8_t)((input + 1) % ActiveTopology::ChannelsPerAdc);
+        if (!ok) {
+            out->errors++;
+            continue;
+        }
+        uint32_t latency = now - t0;
+        out->conversions++;
+        latencySum += latency;
+        if (latency > out->maxLatencyUs) {
+            out->maxLatencyUs = latency;
+        }
+    }
+    out->sps = perSecond(out->conversions, now - start);
+    out->avgLatencyUs = out->conversions ? (uint32_t)(latencySum / out->conversions) : 0;
+}
+
+// Lets the FIFO fill for a frame, then drains it; only the drain counts as bus time
+static void measureAcc(const SelfTestOps_t* ops, uint32_t phaseUs, SelfTestResult_t* r)
+{
+    uint32_t busyUs = 0;
+    uint32_t start = ops->nowUs(ops->ctx);
+    uint32_t now = start;
+    while (now - start < phaseUs) {
+        ops->delayUs(ops->ctx, SELFTEST_ACC_FILL_US);
+        uint32_t t0 = ops->nowUs(ops->ctx);
+        int entries = ops->accDrain(ops->ctx);
+        now = ops->nowUs(ops->ctx);
+        busyUs += now - t0;
+        r->i2cTransactions++;
+        if (entries < 0) {
+            r->i2cErrors++;
+            continue;
+        }
+        r->accEntries += (uint32_t)entries;
+    }
+    r->accDrainHz = perSecond(r->accEntries, busyUs);
+    r->accOdrHz = perSecond(r->accEntries, now - start);
+}
+
+static void measureFrames(const SelfTestOps_t* ops, uint32_t phaseUs, SelfTestResult_t* r)
+{
+    uint32_t start = ops->nowUs(ops->ctx);
+    uint32_t now = start;
+    while (now - start < phaseUs) {
+        if (!ops->frame(ops->ctx)) {
+            r->frameErrors++;
+        }
+        r->frames++;
+        now = ops->nowUs(ops->ctx);
+    }
+    r->frameHz = perSecond(r->frames, now - start);
+}
+
+// Full-size notifications as fast as the stack takes them; a refusal backs off briefly
+static void measureNotify(const SelfTestOps_t* ops, uint32_t phaseUs, SelfTestResult_t* r)
+{
+    uint16_t payload = ops->notifyPayload(ops->ctx);
+    if (payload == 0) {
+        return;
+    }
+    if (payload > SELFTEST_NOTIFY_MAX) {
+        payload = SELFTEST_NOTIFY_MAX;
+    }
+    uint8_t buf[SELFTEST_NOTIFY_MAX];
+    for (uint16_t i = 0; i < payload; i++) {
+        buf[i] = (uint8_t)i;
+    }
+    r->notifyRun = true;
+    r->notifyPayload = payload;
+
+    uint32_t start = ops->nowUs(ops->ctx);
+    uint32_t now = start;
+    while (now - start < phaseUs) {
+        if (ops->notify(ops->ctx, buf, payload)) {
+            r->notifyBytes += payload;
+        } else {
+            r->notifyRefused++;
+            ops->delayUs(ops->ctx, 1000);
+        }
+        now = ops->nowUs(ops->ctx);
+    }
+    r->notifyBps = perSecond(r->notifyBytes, now - start);
+}
+
+bool SelfTest_Run(const SelfTestOps_t* ops, const SelfTestLimits_t* limits, SelfTestResult_t* result)
+{
+    memset(result, 0, sizeof(*result));
+    uint32_t phaseUs = limits->phaseMs * 1000u;
+
+    for (uint8_t dev = 0; dev < SELFTEST_ADC_COUNT; dev++) {
+        SelfTestAdc_t* a = &result->adc[dev];
+        measureAdc(ops, dev, phaseUs, a);
+        result->i2cTransactions += a->conversions + a->errors;
+        result->i2cErrors += a->errors;
+        if (a->sps < limits->minAdsSps) {
+            result->failed |= SELFTEST_FAIL_ADS_RATE;
+        }
+        if (a->maxLatencyUs > limits->maxLatencyUs) {
+            result->failed |= SELFTEST_FAIL_I2C_LATENCY;
+        }
+    }
+    measureAcc(ops, phaseUs, result);
+    measureFrames(ops, phaseUs, result);
+    measureNotify(ops, phaseUs, result);
+
+    result->i2cErrorPpm = result->i2cTransactions ?
+        (uint32_t)((uint64_t)result->i2cErrors * 1000000u / result->i2cTransactions) : 0;
+    if (result->i2cErrorPpm > limits->maxI2cErrorPpm) {
+        result->failed |= SELFTEST_FAIL_I2C_ERRORS;
+    }
+    if (result->accDrainHz < limits->minAccDrainHz) {
+        result->failed |= SELFTEST_FAIL_ACC_DRAIN;
+    }
+    if (result->frameHz < limits->minFrameHz) {
+        result->failed |= SELFTEST_FAIL_FRAME_RATE;
+    }
+    if (result->notifyRun && result->notifyBps < limits->minNotifyBps) {
+        result->failed |= SELFTEST_FAIL_NOTIFY_RATE;
+    }
+    return result->failed == 0;
+}
+
+static const char* verdict(bool ok)
+{
+    return ok ? "PASS" : "FAIL";
+}
+
+size_t SelfTest_FormatReport(const SelfTestResult_t* r, const SelfTestLimits_t* limits, char* buf, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    size_t pos = 0;
+    buf[0] = '\0';
+#define SELFTEST_APPEND(...) do { \
+        if (pos < len) { \
+            int n = snprintf(buf + pos, len - pos, __VA_ARGS__); \
+            pos = (n < 0) ? pos : ((pos + (size_t)n >= len) ? len - 1 : pos + (size_t)n); \
+        } \
+    } while (0)
+
+    for (uint8_t dev = 0; dev < SELFTEST_ADC_COUNT; dev++) {
+        const SelfTestAdc_t* a = &r->adc[dev];
+        bool ok = a->sps >= limits->minAdsSps && a->maxLatencyUs <= limits->maxLatencyUs;
+        SELFTEST_APPEND("%s ADS1115 %u:0x%02X %lu SPS (min %u), latency avg %lu max %lu us (max %lu), %lu errors\n",
+                        verdict(ok), ActiveTopology::adc(dev).bus, ActiveTopology::adc(dev).address,
+                        (unsigned long)a->sps, limits->minAdsSps, (unsigned long)a->avgLatencyUs,
+                        (unsigned long)a->maxLatencyUs, (unsigned long)limits->maxLatencyUs,
+                        (unsigned long)a->errors);
+    }
+    SELFTEST_APPEND("%s I2C errors %lu of %lu = %lu ppm (max %lu)\n",
+                    verdict(!(r->failed & SELFTEST_FAIL_I2C_ERRORS)), (unsigned long)r->i2cErrors,
+                    (unsigned long)r->i2cTransactions, (unsigned long)r->i2cErrorPpm,
+                    (unsigned long)limits->maxI2cErrorPpm);
+    SELFTEST_APPEND("%s ADXL345 FIFO drain %lu entries/s (min %lu), sensor delivered %lu Hz\n",
+                    verdict(!(r->failed & SELFTEST_FAIL_ACC_DRAIN)), (unsigned long)r->accDrainHz,
+                    (unsigned long)limits->minAccDrainHz, (unsigned long)r->accOdrHz);
+    SELFTEST_APPEND("%s frames %lu/s (min %u), %lu with read errors\n",
+                    verdict(!(r->failed & SELFTEST_FAIL_FRAME_RATE)), (unsigned long)r->frameHz,
+                    limits->minFrameHz, (unsigned long)r->frameErrors);
+    if (r->notifyRun) {
+        SELFTEST_APPEND("%s notify %lu B/s (min %lu) in %u-byte notifications, %lu refused\n",
+                        verdict(!(r->failed & SELFTEST_FAIL_NOTIFY_RATE)), (unsigned long)r->notifyBps,
+                        (unsigned long)limits->minNotifyBps, r->notifyPayload, (unsigned long)r->notifyRefused);
+    } else {
+        SELFTEST_APPEND("SKIP notify: no central subscribed\n");
+    }
+    SELFTEST_APPEND("Self-test %s (0x%02X)\n", r->failed ? "FAILED" : "passed", r->failed);
+#undef SELFTEST_APPEND
+    return pos;
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "LoggerModule.h"
+#include "PressureModule.h"
+#include "AccModule.h"
+#include "UtilitiesModule.h"
+#include "BluetoothModule.h"
+#include "FilterModule.h"
+#include "AlignModule.h"
+
+static volatile bool s_requested = false;
+static volatile bool s_active = false;
+static TaskHandle_t volatile s_pauseWaiter = NULL;  // loop() task until SensorTask acknowledges
+
+static uint32_t hwNowUs(void* ctx)
+{
+    (void)ctx;
+    return micros();
+}
+
+static void hwDelayUs(void* ctx, uint32_t us)
+{
+    (void)ctx;
+    if (us >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(us / 1000));
+    } else {
+        delayMicroseconds(us);
+    }
+}
+
+static bool hwAdsConvert(void* ctx, uint8_t dev, uint8_t input)
+{
+    (void)ctx;
+    return Pressure_ConvertOnce(dev, input, NULL);
+}
+
+static int hwAccDrain(void* ctx)
+{
+    (void)ctx;
+    return Acc_DrainFifo();
+}
+
+// Same sequence as SensorTask, minus the frame pool
+static bool hwFrame(void* ctx)
+{
+    (void)ctx;
+    uint32_t sampleUs = micros();
+    Battery_Read();
+    bool ok = (Acc_Read() == ACC_ERR_OK);
+    ok = (Pressure_Read() == PRESSURE_ERR_OK) && ok;
+    if (DSP_DECIMATION_ENABLED) {
+        Filter_Apply();
+    }
+    if (ALIGN_ENABLED) {
+        Align_Apply(sampleUs);
+    }
+    SensorData frame;
+    SensorFrameInfo info;
+    PackSensorData(frame);
+    PackSensorInfo(info);
+    if (BLE_GetNumOfSubscribers() > 0) {
+        BLE_SendFrame((const uint8_t*)&frame, sizeof(frame), &info);
+    }
+    return ok;
+}
+
+static uint16_t hwNotifyPayload(void* ctx)
+{
+    (void)ctx;
+    return BLE_GetSelfTestPayload();
+}
+
+static bool hwNotify(void* ctx, const uint8_t* data, size_t len)
+{
+    (void)ctx;
+    return BLE_NotifySelfTest(data, len);
+}
+
+static const SelfTestOps_t s_hwOps = {
+    NULL, hwNowUs, hwDelayUs, hwAdsConvert, hwAccDrain, hwFrame, hwNotifyPayload, hwNotify
+};
+
+void SelfTest_Request(void)
+{
+    s_requested = true;
+}
+
+bool SelfTest_Active(void)
+{
+    return s_active;
+}
+
+void SelfTest_AckPause(void)
+{
+    TaskHandle_t waiter = s_pauseWaiter;
+    if (waiter) {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+bool SelfTest_RunNow(void)
+{
+    SelfTestLimits_t limits;
+    SelfTestResult_t result;
+    SelfTest_DefaultLimits(&limits);
+    LOG_INFO("Self-test started (%lu ms per phase)", (unsigned long)limits.phaseMs);
+    bool pass = SelfTest_Run(&s_hwOps, &limits, &result);
+
+    // The test samples must not leak into the stream
+    Filter_Reset();
+    Align_Reset();
+
+    static char report[1024];
+    SelfTest_FormatReport(&result, &limits, report, sizeof(report));
+    for (char* line = strtok(report, "\n"); line; line = strtok(NULL, "\n")) {
+        if (pass) {
+            LOG_INFO("%s", line);
+        } else {
+            LOG_WARN("%s", line);
+        }
+    }
+    return pass;
+}
+
+void SelfTest_Service(void)
+{
+    // Serial command: a line reading "selftest"
+    static char line[16];
+    static uint8_t lineLen = 0;
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+        if (c == '\r' || c == '\n') {
+            line[lineLen] = '\0';
+            if (strcmp(line, "selftest") == 0) {
+                s_requested = true;
+            }
+            lineLen = 0;
+        } else if (lineLen < sizeof(line) - 1) {
+            line[lineLen++] = c;
+        }
+    }
+
+    if (!s_requested) {
+        return;
+    }
+    s_requested = false;
+    // SensorTask finishes the frame it is in and acknowledges before the bus is taken over.
+    // A late acknowledgement of an earlier request is cleared first.
+    ulTaskNotifyTake(pdTRUE, 0);
+    s_pauseWaiter = xTaskGetCurrentTaskHandle();
+    s_active = true;
+    bool paused = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SELFTEST_PAUSE_TIMEOUT_MS)) != 0;
+    s_pauseWaiter = NULL;
+    if (!paused) {
+        s_active = false;
+        LOG_ERROR("Self-test not started: SensorTask did not pause within %d ms", SELFTEST_PAUSE_TIMEOUT_MS);
+        return;
+    }
+    SelfTest_RunNow();
+    s_active = false;
+}
+#endif
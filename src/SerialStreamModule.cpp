@@ -0,0 +1,277 @@
+#include "SerialStreamModule.h"
+#include "Config.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "LoggerModule.h"
+#endif
+
+static_assert(SERIAL_STREAM_MAX_PAYLOAD >= LOGGER_MAX_LOG_LENGTH, "a whole log line must fit a packet");
+static_assert(SERIAL_STREAM_FRAME_SIZE <= SERIAL_STREAM_MAX_PAYLOAD, "a frame must fit a packet");
+
+// Table-driven, one lookup per byte
+static const uint16_t CRC16_TABLE[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6, 0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485, 0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4, 0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823, 0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12, 0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41, 0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70, 0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F, 0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E, 0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D, 0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C, 0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB, 0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A, 0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9, 0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8, 0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+uint16_t SerialStream_Crc16(const uint8_t* data, size_t len, uint16_t crc)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 8) ^ CRC16_TABLE[(uint8_t)(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+// ''''''' COBS ''''''''''''''''''' //
+
+// Streaming COBS writer: `code` points at the pending length byte of the current block
+typedef struct {
+    uint8_t* out;
+    uint8_t* code;
+    size_t   pos;
+} CobsWriter;
+
+static inline void cobsStart(CobsWriter* w, uint8_t* out, size_t pos)
+{
+    w->out = out;
+    w->code = out + pos;
+    w->pos = pos + 1;
+    *w->code = 1;
+}
+
+static inline void cobsPut(CobsWriter* w, uint8_t b)
+{
+    if (b == 0) {
+        w->code = w->out + w->pos++;
+        *w->code = 1;
+        return;
+    }
+    w->out[w->pos++] = b;
+    if (++*w->code == 0xFF) {
+        w->code = w->out + w->pos++;
+        *w->code = 1;
+    }
+}
+
+size_t SerialStream_Encode(uint8_t type, uint8_t seq, const uint8_t* payload, size_t len,
+                           uint8_t* out, size_t cap)
+{
+    if (len > SERIAL_STREAM_MAX_PAYLOAD || cap < SERIAL_STREAM_WIRE_SIZE(len)) {
+        return 0;
+    }
+    uint8_t head[2] = { type, seq };
+    uint16_t crc = SerialStream_Crc16(head, sizeof(head));
+    crc = SerialStream_Crc16(payload, len, crc);
+
+    out[0] = 0;
+    CobsWriter w;
+    cobsStart(&w, out, 1);
+    cobsPut(&w, type);
+    cobsPut(&w, seq);
+    for (size_t i = 0; i < len; i++) {
+        cobsPut(&w, payload[i]);
+    }
+    cobsPut(&w, (uint8_t)crc);
+    cobsPut(&w, (uint8_t)(crc >> 8));
+    out[w.pos++] = 0;
+    return w.pos;
+}
+
+void SerialStream_MakeHello(uint8_t* out)
+{
+    out[0] = SERIAL_STREAM_VERSION;
+    out[1] = PRESSURE_CHANNEL_COUNT;
+    out[2] = (uint8_t)sizeof(SensorData);
+    out[3] = (uint8_t)(LOOP_INTERVAL_MS & 0xFF);
+    out[4] = (uint8_t)(LOOP_INTERVAL_MS >> 8);
+}
+
+// ''''''' DECODER ''''''''''''''''''' //
+
+void SerialStream_InitDecoder(SerialStreamDecoder_t* dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+// Decodes the COBS packet in dec->buf in place; false on a framing error
+static bool cobsDecode(SerialStreamDecoder_t* dec, size_t* outLen)
+{
+    size_t in = 0, out = 0;
+    while (in < dec->len) {
+        uint8_t code = dec->buf[in++];
+        if (code == 0 || in + code - 1 > dec->len) {
+            return false;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            dec->buf[out++] = dec->buf[in++];
+        }
+        if (code != 0xFF && in < dec->len) {
+            dec->buf[out++] = 0;
+        }
+    }
+    *outLen = out;
+    return true;
+}
+
+static void packetEnd(SerialStreamDecoder_t* dec, SerialStreamPacketFn fn, void* ctx)
+{
+    size_t n = 0;
+    if (dec->len == 0) {
+        return;     // back-to-back delimiters
+    }
+    if (dec->overflow || !cobsDecode(dec, &n) || n < SERIAL_STREAM_OVERHEAD) {
+        dec->framingErrors++;
+        return;
+    }
+    uint16_t crc = (uint16_t)(dec->buf[n - 2] | (dec->buf[n - 1] << 8));
+    if (SerialStream_Crc16(dec->buf, n - 2) != crc) {
+        dec->crcErrors++;
+        return;
+    }
+    dec->packets++;
+    fn(ctx, dec->buf[0], dec->buf[1], dec->buf + 2, n - SERIAL_STREAM_OVERHEAD);
+}
+
+void SerialStream_Feed(SerialStreamDecoder_t* dec, const uint8_t* data, size_t len,
+                       SerialStreamPacketFn fn, void* ctx)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        if (b == 0) {
+            packetEnd(dec, fn, ctx);
+            dec->len = 0;
+            dec->overflow = false;
+        } else if (dec->len < sizeof(dec->buf)) {
+            dec->buf[dec->len++] = b;
+        } else {
+            dec->overflow = true;
+        }
+    }
+}
+
+#ifdef ARDUINO
+
+// ''''''' UART ''''''''''''''''''' //
+
+// The logger task and the sensor task both send; the lock keeps packets whole and seq in order
+static StaticSemaphore_t s_lockBuf;
+static SemaphoreHandle_t s_lock = NULL;
+static uint8_t s_txBuf[SERIAL_STREAM_MAX_WIRE_SIZE];
+static uint8_t s_seq = 0;
+static uint32_t s_lastHelloMs = 0;
+static bool s_helloSent = false;
+static volatile bool s_active = false;
+static SerialStreamStats_t s_stats;
+
+bool SerialStream_Begin(void)
+{
+    if (!SERIAL_STREAM_ENABLED) {
+        return false;
+    }
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutexStatic(&s_lockBuf);
+    }
+    // The UART driver's ISR moves the TX ring into the FIFO; writers only copy into the ring
+    Serial.setTxBufferSize(SERIAL_STREAM_TX_BUFFER_SIZE);
+    Serial.begin(SERIAL_STREAM_BAUD);
+    s_active = true;
+    return true;
+}
+
+bool SerialStream_Active(void)
+{
+    return s_active;
+}
+
+// Caller holds s_lock
+static bool sendLocked(uint8_t type, const uint8_t* payload, size_t len)
+{
+    // A dropped packet uses up its seq too, so the receiver counts it as lost
+    size_t n = SerialStream_Encode(type, s_seq++, payload, len, s_txBuf, sizeof(s_txBuf));
+    if (n == 0 || (size_t)Serial.availableForWrite() < n) {
+        s_stats.dropped++;
+        return false;
+    }
+    Serial.write(s_txBuf, n);
+    s_stats.packets++;
+    s_stats.bytes += n;
+    return true;
+}
+
+static bool send(uint8_t type, const uint8_t* payload, size_t len)
+{
+    if (!s_active) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    // A receiver that starts late learns the frame layout within SERIAL_STREAM_HELLO_MS
+    uint32_t now = millis();
+    if (!s_helloSent || now - s_lastHelloMs >= SERIAL_STREAM_HELLO_MS) {
+        uint8_t hello[SERIAL_STREAM_HELLO_SIZE];
+        SerialStream_MakeHello(hello);
+        s_helloSent = sendLocked(SERIAL_STREAM_TYPE_HELLO, hello, sizeof(hello));
+        s_lastHelloMs = now;
+    }
+    bool ok = sendLocked(type, payload, len);
+    xSemaphoreGive(s_lock);
+    return ok;
+}
+
+bool SerialStream_SendFrame(const SensorData* frame, uint32_t sample_us)
+{
+    uint8_t payload[SERIAL_STREAM_FRAME_SIZE];
+    payload[0] = (uint8_t)sample_us;
+    payload[1] = (uint8_t)(sample_us >> 8);
+    payload[2] = (uint8_t)(sample_us >> 16);
+    payload[3] = (uint8_t)(sample_us >> 24);
+    memcpy(payload + 4, frame, sizeof(SensorData));
+    return send(SERIAL_STREAM_TYPE_FRAME, payload, sizeof(payload));
+}
+
+bool SerialStream_SendLog(const char* line, size_t len)
+{
+    if (len > SERIAL_STREAM_MAX_PAYLOAD) {
+        len = SERIAL_STREAM_MAX_PAYLOAD;
+    }
+    return send(SERIAL_STREAM_TYPE_LOG, (const uint8_t*)line, len);
+}
+
+void SerialStream_GetStats(SerialStreamStats_t* stats)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
+
+void SerialStream_PrintSummary(void)
+{
+    if (!s_active) {
+        return;
+    }
+    SerialStreamStats_t st;
+    SerialStream_GetStats(&st);
+    if (st.dropped) {
+        LOG_WARN("Serial stream: %lu packets, %lu bytes, %lu dropped",
+                 (unsigned long)st.packets, (unsigned long)st.bytes, (unsigned long)st.dropped);
+    } else {
+        LOG_INFO("Serial stream: %lu packets, %lu bytes", (unsigned long)st.packets, (unsigned long)st.bytes);
+    }
+}
+
+#endif
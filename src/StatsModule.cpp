@@ -0,0 +1,425 @@
+#include "StatsModule.h"
+#include "Config.h"
+#include <math.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "LoggerModule.h"
+
+// Updated by the sensor task, read by the NimBLE task and loop()
+static portMUX_TYPE s_statsMux = portMUX_INITIALIZER_UNLOCKED;
+#define STATS_ENTER()   portENTER_CRITICAL(&s_statsMux)
+#define STATS_EXIT()    portEXIT_CRITICAL(&s_statsMux)
+#else
+#define STATS_ENTER()
+#define STATS_EXIT()
+#endif
+
+#define STATS_MAX_GAP_US    ((uint32_t)STATS_MAX_GAP_MS * 1000u)
+#define STATS_PAGE_RETRIES  3       // a page read racing the sensor task gives up on coherence after this
+
+// Welford runs in float over blocks of STATS_BLOCK_FRAMES samples (the ESP32 has no double FPU);
+// each full block is folded into double totals (Chan et al.), so hours of frames keep their precision
+#define STATS_BLOCK_FRAMES  64
+
+// 1/n for the samples of a block, so a channel's update needs no division
+#define STATS_INV4(n)   1.0f / (n), 1.0f / ((n) + 1), 1.0f / ((n) + 2), 1.0f / ((n) + 3)
+#define STATS_INV16(n)  STATS_INV4(n), STATS_INV4((n) + 4), STATS_INV4((n) + 8), STATS_INV4((n) + 12)
+static const float INV_COUNT[STATS_BLOCK_FRAMES + 1] = {
+    0.0f, STATS_INV16(1), STATS_INV16(17), STATS_INV16(33), STATS_INV16(49)
+};
+static_assert(STATS_BLOCK_FRAMES == 64, "INV_COUNT is spelled out for 64 samples per block");
+
+typedef struct {
+    float    blockMean;
+    float    blockM2;       // sum of squared deviations from the running mean, this block
+    double   mean;          // samples before this block
+    double   m2;
+    uint32_t n;             // samples counted; a pressure channel skips frames it has no reading in
+    uint32_t blockN;        // of those, in the open block
+    int32_t  min;
+    int32_t  max;
+} Moments;
+
+// Raw counters of one channel, copied under the lock and summarized outside it
+typedef struct {
+    Moments  m;
+    uint32_t buckets[STATS_BUCKETS];
+    uint64_t aboveUs;
+} ChannelRaw;
+
+static uint32_t s_frames = 0;
+static uint32_t s_lastUs = 0;
+static uint64_t s_durationUs = 0;
+static Moments  s_moments[STATS_CHANNELS];
+static uint32_t s_buckets[STATS_SKETCHES][STATS_BUCKETS];
+static uint64_t s_aboveUs[STATS_SKETCHES];
+static uint32_t s_sketchLastUs[STATS_SKETCHES];  // last counted sample, time above spans from there
+
+static uint16_t s_pressureThreshold = STATS_PRESSURE_THRESHOLD;
+static uint16_t s_accelThreshold = STATS_ACCEL_THRESHOLD;
+
+// Values below 2^(bits+1) get one bucket each, above that each octave is split in 2^bits buckets
+static inline uint8_t bucketOf(uint16_t v)
+{
+    const uint32_t linear = 1u << (STATS_SUB_BUCKET_BITS + 1);
+    if (v < linear) {
+        return (uint8_t)v;
+    }
+    int msb = 31 - __builtin_clz(v);
+    uint32_t sub = (v >> (msb - STATS_SUB_BUCKET_BITS)) & ((1u << STATS_SUB_BUCKET_BITS) - 1);
+    return (uint8_t)(linear + ((uint32_t)(msb - STATS_SUB_BUCKET_BITS - 1) << STATS_SUB_BUCKET_BITS) + sub);
+}
+
+static_assert(STATS_BUCKETS == (1 << (STATS_SUB_BUCKET_BITS + 1)) + (15 - STATS_SUB_BUCKET_BITS) * (1 << STATS_SUB_BUCKET_BITS),
+              "STATS_BUCKETS must cover every 16-bit value");
+
+// Middle of the value range that maps to the bucket
+static uint16_t bucketMid(uint8_t idx)
+{
+    const uint32_t linear = 1u << (STATS_SUB_BUCKET_BITS + 1);
+    if (idx < linear) {
+        return idx;
+    }
+    uint32_t octave = (idx - linear) >> STATS_SUB_BUCKET_BITS;
+    uint32_t sub = (idx - linear) & ((1u << STATS_SUB_BUCKET_BITS) - 1);
+    int msb = (int)octave + STATS_SUB_BUCKET_BITS + 1;
+    uint32_t width = 1u << (msb - STATS_SUB_BUCKET_BITS);
+    return (uint16_t)((1u << msb) + sub * width + (width - 1) / 2);
+}
+
+// Sketch of a channel, -1 for the accel axes
+static inline int sketchOf(uint8_t channel)
+{
+    if (channel < PRESSURE_CHANNEL_COUNT) {
+        return channel;
+    }
+    return (channel == STATS_CH_ACC_MAG) ? PRESSURE_CHANNEL_COUNT : -1;
+}
+
+void Stats_Reset(void)
+{
+    STATS_ENTER();
+    s_frames = 0;
+    s_durationUs = 0;
+    memset(s_moments, 0, sizeof(s_moments));
+    memset(s_buckets, 0, sizeof(s_buckets));
+    memset(s_aboveUs, 0, sizeof(s_aboveUs));
+    STATS_EXIT();
+}
+
+void Stats_SetThresholds(uint16_t pressure, uint16_t accelMagnitude)
+{
+    STATS_ENTER();
+    s_pressureThreshold = pressure;
+    s_accelThreshold = accelMagnitude;
+    STATS_EXIT();
+    Stats_Reset();
+}
+
+// Totals with the open block folded in
+static void combine(const Moments* m, double* mean, double* m2)
+{
+    if (m->blockN == 0) {
+        *mean = m->mean;
+        *m2 = m->m2;
+        return;
+    }
+    double nb = m->blockN, na = m->n - m->blockN, n = m->n;
+    double delta = (double)m->blockMean - m->mean;
+    *mean = m->mean + delta * nb / n;
+    *m2 = m->m2 + m->blockM2 + delta * delta * na * nb / n;
+}
+
+static inline void addMoment(Moments* m, int32_t x)
+{
+    if (x < m->min) m->min = x;
+    if (x > m->max) m->max = x;
+    m->n++;
+    float delta = (float)x - m->blockMean;
+    m->blockMean += delta * INV_COUNT[++m->blockN];
+    m->blockM2 += delta * ((float)x - m->blockMean);
+    if (m->blockN == STATS_BLOCK_FRAMES) {
+        combine(m, &m->mean, &m->m2);
+        m->blockMean = 0.0f;
+        m->blockM2 = 0.0f;
+        m->blockN = 0;
+    }
+}
+
+// The time since the sketch's previous sample counts at this sample's value
+static inline void addSketch(int sketch, uint16_t v, uint16_t threshold, uint32_t t_us)
+{
+    uint32_t dtUs = 0;
+    if (s_moments[sketch < PRESSURE_CHANNEL_COUNT ? sketch : STATS_CH_ACC_MAG].n > 0) {
+        dtUs = t_us - s_sketchLastUs[sketch];
+        if (dtUs > STATS_MAX_GAP_US) {
+            dtUs = STATS_MAX_GAP_US;
+        }
+    }
+    s_sketchLastUs[sketch] = t_us;
+    s_buckets[sketch][bucketOf(v)]++;
+    if (v >= threshold) {
+        s_aboveUs[sketch] += dtUs;
+    }
+}
+
+// Frame slots of the healthy ADS1115s. The health mask rarely changes between frames, so
+// the slots of the last one are kept (Stats_Update runs in the sensor task only); all
+// devices down, the initial mask, has no slots.
+static uint8_t s_slotsHealthy = 0;
+static PressureMask_t s_slotsOfHealthy = 0;
+
+static PressureMask_t healthySlots(uint8_t adcHealthy)
+{
+    if (adcHealthy == s_slotsHealthy) {
+        return s_slotsOfHealthy;
+    }
+    PressureMask_t slots = 0;
+    for (unsigned dev = 0; dev < ActiveTopology::AdcCount; dev++) {
+        if (adcHealthy & (1u << dev)) {
+            for (unsigned input = 0; input < ActiveTopology::ChannelsPerAdc; input++) {
+                slots |= (PressureMask_t)((PressureMask_t)1 << ActiveTopology::sensorOf(dev, input));
+            }
+        }
+    }
+    s_slotsHealthy = adcHealthy;
+    s_slotsOfHealthy = slots;
+    return slots;
+}
+
+void Stats_Update(const SensorData* frame, const SensorFrameInfo* info, uint32_t t_us)
+{
+    // Copies out of the packed frame
+    int32_t acc[3] = { frame->accel_x, frame->accel_y, frame->accel_z };
+    float mag = sqrtf((float)acc[0] * acc[0] + (float)acc[1] * acc[1] + (float)acc[2] * acc[2]);
+    uint16_t magnitude = (mag < 65535.0f) ? (uint16_t)(mag + 0.5f) : 65535;
+    // Only fresh conversions of working devices: held, zeroed and PRESSURE_VALUE_DOWN slots are no readings
+    PressureMask_t fresh = info ? (PressureMask_t)(info->pressure_valid & healthySlots(info->adc_healthy))
+                                : ActiveTopology::allSensors();
+
+    STATS_ENTER();
+    uint32_t dtUs = 0;
+    if (s_frames == 0) {
+        for (int ch = 0; ch < STATS_CHANNELS; ch++) {
+            s_moments[ch].min = INT32_MAX;
+            s_moments[ch].max = INT32_MIN;
+        }
+    } else {
+        dtUs = t_us - s_lastUs;
+        if (dtUs > STATS_MAX_GAP_US) {
+            dtUs = STATS_MAX_GAP_US;
+        }
+    }
+    s_lastUs = t_us;
+    s_durationUs += dtUs;
+    ++s_frames;
+
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        if (!(fresh & ((PressureMask_t)1 << ch))) {
+            continue;
+        }
+        uint16_t p = frame->pressure[ch];
+        addSketch(ch, p, s_pressureThreshold, t_us);
+        addMoment(&s_moments[ch], p);
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        addMoment(&s_moments[STATS_CH_ACC_X + axis], acc[axis]);
+    }
+    addSketch(PRESSURE_CHANNEL_COUNT, magnitude, s_accelThreshold, t_us);
+    addMoment(&s_moments[STATS_CH_ACC_MAG], magnitude);
+    STATS_EXIT();
+}
+
+void Stats_GetSummary(StatsSummary_t* summary)
+{
+    STATS_ENTER();
+    summary->frames = s_frames;
+    summary->durationMs = (uint32_t)(s_durationUs / 1000u);
+    summary->pressureThreshold = s_pressureThreshold;
+    summary->accelThreshold = s_accelThreshold;
+    STATS_EXIT();
+}
+
+// Copies a channel's counters; the only part of a read that holds the lock
+static void snapshot(uint8_t channel, ChannelRaw* raw)
+{
+    int sketch = sketchOf(channel);
+    STATS_ENTER();
+    raw->m = s_moments[channel];
+    if (sketch >= 0) {
+        memcpy(raw->buckets, s_buckets[sketch], sizeof(raw->buckets));
+        raw->aboveUs = s_aboveUs[sketch];
+    }
+    STATS_EXIT();
+}
+
+// Nearest-rank percentiles in one pass over the buckets, clamped to the exact min/max
+static void quantiles(const ChannelRaw* raw, const uint16_t* permille, uint16_t* out, int count)
+{
+    const Moments* m = &raw->m;
+    int k = 0;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < STATS_BUCKETS && k < count; i++) {
+        seen += raw->buckets[i];
+        while (k < count) {
+            uint32_t rank = (uint32_t)(((uint64_t)m->n * permille[k] + 999) / 1000);
+            if (rank == 0) {
+                rank = 1;
+            }
+            if (seen < rank) {
+                break;
+            }
+            int32_t v = bucketMid(i);
+            out[k++] = (uint16_t)((v < m->min) ? m->min : (v > m->max) ? m->max : v);
+        }
+    }
+    for (; k < count; k++) {
+        out[k] = 0;     // no samples yet
+    }
+}
+
+static void summarize(uint8_t channel, const ChannelRaw* raw, StatsChannel_t* out)
+{
+    const Moments* m = &raw->m;
+    double mean, m2;
+    combine(m, &mean, &m2);
+    out->mean = (float)mean;
+    out->stddev = (m->n > 1) ? (float)sqrt(m2 / (double)(m->n - 1)) : 0.0f;
+    out->min = m->n ? m->min : 0;
+    out->max = m->n ? m->max : 0;
+    if (sketchOf(channel) < 0) {
+        out->p50 = out->p90 = out->p99 = 0;
+        out->aboveMs = 0;
+        return;
+    }
+    static const uint16_t PERMILLE[3] = { 500, 900, 990 };
+    uint16_t q[3];
+    quantiles(raw, PERMILLE, q, 3);
+    out->p50 = q[0];
+    out->p90 = q[1];
+    out->p99 = q[2];
+    out->aboveMs = (uint32_t)(raw->aboveUs / 1000u);
+}
+
+bool Stats_GetChannel(uint8_t channel, StatsChannel_t* out)
+{
+    if (channel >= STATS_CHANNELS) {
+        return false;
+    }
+    ChannelRaw raw;
+    snapshot(channel, &raw);
+    summarize(channel, &raw, out);
+    return true;
+}
+
+uint16_t Stats_Quantile(uint8_t channel, uint16_t permille)
+{
+    if (channel >= STATS_CHANNELS || sketchOf(channel) < 0) {
+        return 0;
+    }
+    ChannelRaw raw;
+    snapshot(channel, &raw);
+    uint16_t v;
+    quantiles(&raw, &permille, &v, 1);
+    return v;
+}
+
+static inline uint8_t* putLe16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t* putLe32(uint8_t* p, uint32_t v)
+{
+    p = putLe16(p, (uint16_t)v);
+    return putLe16(p, (uint16_t)(v >> 16));
+}
+
+static inline uint8_t* putFloat(uint8_t* p, float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return putLe32(p, bits);
+}
+
+size_t Stats_EncodePage(uint8_t page, uint8_t* out, size_t len)
+{
+    if (page >= STATS_PAGES) {
+        return 0;
+    }
+    uint8_t first = (uint8_t)(page * STATS_PAGE_CHANNELS);
+    uint8_t count = (STATS_CHANNELS - first < STATS_PAGE_CHANNELS) ? (uint8_t)(STATS_CHANNELS - first) : STATS_PAGE_CHANNELS;
+    if (len < STATS_PAGE_HEADER_SIZE + (size_t)count * STATS_WIRE_CHANNEL_SIZE) {
+        return 0;
+    }
+
+    // Channels are copied one at a time and summarized outside the lock. A frame that lands
+    // in between restarts the page, so header and channels describe the same frames.
+    StatsChannel_t ch[STATS_PAGE_CHANNELS];
+    ChannelRaw raw;
+    uint32_t frames, durationMs;
+    for (int attempt = 0; ; attempt++) {
+        STATS_ENTER();
+        frames = s_frames;
+        durationMs = (uint32_t)(s_durationUs / 1000u);
+        STATS_EXIT();
+        for (uint8_t i = 0; i < count; i++) {
+            snapshot((uint8_t)(first + i), &raw);
+            summarize((uint8_t)(first + i), &raw, &ch[i]);
+        }
+        STATS_ENTER();
+        bool same = (s_frames == frames);
+        STATS_EXIT();
+        if (same || attempt == STATS_PAGE_RETRIES) {
+            break;
+        }
+    }
+
+    uint8_t* p = putLe32(out, frames);
+    p = putLe32(p, durationMs);
+    *p++ = page;
+    *p++ = STATS_PAGES;
+    for (uint8_t i = 0; i < count; i++) {
+        p = putFloat(p, ch[i].mean);
+        p = putFloat(p, ch[i].stddev);
+        p = putLe16(p, (uint16_t)ch[i].min);
+        p = putLe16(p, (uint16_t)ch[i].max);
+        p = putLe16(p, ch[i].p50);
+        p = putLe16(p, ch[i].p90);
+        p = putLe16(p, ch[i].p99);
+        p = putLe32(p, ch[i].aboveMs);
+    }
+    return (size_t)(p - out);
+}
+
+#ifdef ARDUINO
+
+void Stats_PrintSummary(void)
+{
+    StatsSummary_t s;
+    Stats_GetSummary(&s);
+    if (s.frames == 0) {
+        return;
+    }
+    // Channel with the highest p99 load
+    uint8_t peak = 0;
+    uint16_t peakP99 = 0;
+    for (uint8_t ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        uint16_t v = Stats_Quantile(ch, 990);
+        if (v > peakP99) {
+            peakP99 = v;
+            peak = ch;
+        }
+    }
+    StatsChannel_t c;
+    Stats_GetChannel(peak, &c);
+    LOG_INFO("Session stats over %lu frames (%lu s): peak channel %u mean %.0f p50 %u p90 %u p99 %u max %ld, %lu ms above %u",
+             (unsigned long)s.frames, (unsigned long)(s.durationMs / 1000), peak, c.mean, c.p50, c.p90, c.p99,
+             (long)c.max, (unsigned long)c.aboveMs, s.pressureThreshold);
+}
+
+#endif
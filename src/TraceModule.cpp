@@ -0,0 +1,214 @@
+#include "TraceModule.h"
+#include <math.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "PressureModule.h"
+#include "AccModule.h"
+#include "UtilitiesModule.h"
+#include "LoggerModule.h"
+#endif
+
+#define TRACE_PI            3.14159265f
+#define TRACE_UNLOADED      200       // ADC counts of an unloaded FSR
+#define TRACE_ADC_MAX       32767
+#define TRACE_GRAVITY_X10   98        // 1 g in m/s^2 x 10
+
+typedef struct {
+    uint16_t stride_ms;     // heel strike to heel strike
+    float    stance;        // fraction of the stride with the foot on the ground
+    float    peak;          // peak load [ADC counts]
+    float    impact;        // heel-strike impact [m/s^2 x 10]
+    float    swing;         // swing-phase forward acceleration [m/s^2 x 10]
+} GaitParams;
+
+static const GaitParams GAIT_PARAMS[] = {
+    /* STAND */ {    0, 1.00f,  6000.0f,   0.0f,   0.0f },
+    /* WALK  */ { 1100, 0.62f, 12000.0f, 150.0f,  60.0f },
+    /* RUN   */ {  700, 0.38f, 20000.0f, 300.0f, 150.0f },
+};
+
+// Part of the stance phase each zone (one quarter of the frame slots) carries load, and its relative peak
+static const float ZONE_START[4] = { 0.00f, 0.10f, 0.30f, 0.60f };
+static const float ZONE_END[4]   = { 0.45f, 0.60f, 0.90f, 1.00f };
+static const float ZONE_GAIN[4]  = { 1.00f, 0.25f, 0.85f, 0.45f };
+static const float STAND_LOAD[4] = { 0.50f, 0.12f, 0.40f, 0.15f };
+#define TRACE_ZONE_SENSORS (PRESSURE_CHANNEL_COUNT / 4)
+
+// Small deterministic noise, same value for the same (t, channel) on device and host
+static int16_t traceNoise(uint32_t t_ms, uint32_t channel, int16_t amplitude)
+{
+    uint32_t h = (t_ms * 2654435761u) ^ (channel * 40503u);
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    return (int16_t)((int32_t)(h % (2u * amplitude + 1u)) - amplitude);
+}
+
+static uint16_t clampAdc(float v)
+{
+    if (v < 0.0f) return 0;
+    if (v > TRACE_ADC_MAX) return TRACE_ADC_MAX;
+    return (uint16_t)v;
+}
+
+void Trace_Synthesize(TraceGait_t gait, uint32_t t_ms, SensorData* out)
+{
+    const GaitParams& g = GAIT_PARAMS[gait <= TRACE_GAIT_RUN ? gait : TRACE_GAIT_WALK];
+
+    // Battery drains one step per minute of session
+    uint32_t drain = t_ms / 60000u;
+    out->battery = (uint8_t)((drain < 80) ? 200 - drain : 120);
+
+    if (g.stride_ms == 0) {
+        // Quiet standing with slow postural sway between heel and forefoot
+        float sway = sinf(2.0f * TRACE_PI * (float)(t_ms % 4000u) / 4000.0f);
+        for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+            int zone = ch / TRACE_ZONE_SENSORS;
+            float load = g.peak * STAND_LOAD[zone] * (1.0f + ((zone == 0) ? 0.1f : -0.1f) * sway);
+            out->pressure[ch] = clampAdc(TRACE_UNLOADED + load + traceNoise(t_ms, ch, 40));
+        }
+        out->accel_x = traceNoise(t_ms, 100, 2);
+        out->accel_y = traceNoise(t_ms, 101, 2);
+        out->accel_z = (int16_t)(TRACE_GRAVITY_X10 + traceNoise(t_ms, 102, 2));
+        return;
+    }
+
+    float phase = (float)(t_ms % g.stride_ms) / (float)g.stride_ms;
+    bool stance = phase < g.stance;
+    float s = stance ? phase / g.stance : 0.0f;
+
+    for (int ch = 0; ch < PRESSURE_CHANNEL_COUNT; ch++) {
+        int zone = ch / TRACE_ZONE_SENSORS;
+        float load = 0.0f;
+        if (stance && s >= ZONE_START[zone] && s < ZONE_END[zone]) {
+            float w = (s - ZONE_START[zone]) / (ZONE_END[zone] - ZONE_START[zone]);
+            load = g.peak * ZONE_GAIN[zone] * (0.7f + 0.1f * (ch % TRACE_ZONE_SENSORS) * 4 / TRACE_ZONE_SENSORS) * sinf(TRACE_PI * w);
+        }
+        out->pressure[ch] = clampAdc(TRACE_UNLOADED + load + traceNoise(t_ms, ch, 40));
+    }
+
+    float ax = 0.0f;
+    float az = TRACE_GRAVITY_X10;
+    if (stance) {
+        // Heel-strike transient, decays within the first 8 % of stance
+        az += g.impact * expf(-s / 0.02f);
+    } else {
+        float w = (phase - g.stance) / (1.0f - g.stance);
+        ax = g.swing * sinf(2.0f * TRACE_PI * w);
+        az -= 0.3f * g.swing * sinf(TRACE_PI * w);
+    }
+    out->accel_x = (int16_t)(ax + traceNoise(t_ms, 100, 3));
+    out->accel_y = traceNoise(t_ms, 101, 3);
+    out->accel_z = (int16_t)(az + traceNoise(t_ms, 102, 3));
+}
+
+size_t Trace_Generate(TraceGait_t gait, uint16_t period_ms, uint32_t record_count, uint8_t* buf, size_t len)
+{
+    size_t need = sizeof(TraceHeader) + (size_t)record_count * sizeof(SensorData);
+    if (!buf || len < need || period_ms == 0) {
+        return 0;
+    }
+    TraceHeader hdr;
+    hdr.magic = TRACE_MAGIC;
+    hdr.version = TRACE_VERSION;
+    hdr.channels = PRESSURE_CHANNEL_COUNT;
+    hdr.period_ms = period_ms;
+    hdr.record_count = record_count;
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    SensorData rec;
+    for (uint32_t i = 0; i < record_count; i++) {
+        Trace_Synthesize(gait, i * period_ms, &rec);
+        memcpy(buf + sizeof(hdr) + (size_t)i * sizeof(SensorData), &rec, sizeof(rec));
+    }
+    return need;
+}
+
+const TraceHeader* Trace_Validate(const uint8_t* image, size_t len)
+{
+    if (!image || len < sizeof(TraceHeader)) {
+        return nullptr;
+    }
+    const TraceHeader* hdr = (const TraceHeader*)image;
+    if (hdr->magic != TRACE_MAGIC || hdr->version != TRACE_VERSION ||
+        hdr->channels != PRESSURE_CHANNEL_COUNT || hdr->period_ms == 0 || hdr->record_count == 0) {
+        return nullptr;
+    }
+    if ((len - sizeof(TraceHeader)) / sizeof(SensorData) < hdr->record_count) {
+        return nullptr;
+    }
+    return hdr;
+}
+
+void Trace_GetRecord(const uint8_t* image, uint32_t index, SensorData* out)
+{
+    const TraceHeader* hdr = (const TraceHeader*)image;
+    index %= hdr->record_count;
+    memcpy(out, image + sizeof(TraceHeader) + (size_t)index * sizeof(SensorData), sizeof(SensorData));
+}
+
+#ifdef ARDUINO
+// /////////////////////////////////////////////////////////////////
+// Device replay source
+
+static const uint8_t* s_image = nullptr;
+static TraceGait_t s_gait = TRACE_GAIT_WALK;
+static uint16_t s_speed = 1;
+static uint32_t s_startMs = 0;
+static bool s_started = false;
+
+uint8_t Trace_Open(const uint8_t* image, size_t len)
+{
+    const TraceHeader* hdr = Trace_Validate(image, len);
+    if (!hdr) {
+        LOG_ERROR("Trace image invalid (%u bytes)", (unsigned)len);
+        return TRACE_ERR_FORMAT;
+    }
+    s_image = image;
+    s_started = false;
+    LOG_INFO("Trace opened: %u records every %u ms", (unsigned)hdr->record_count, hdr->period_ms);
+    return TRACE_ERR_OK;
+}
+
+void Trace_UseSynthetic(TraceGait_t gait)
+{
+    s_image = nullptr;
+    s_gait = gait;
+    s_started = false;
+    LOG_INFO("Trace source: synthetic gait %d", gait);
+}
+
+void Trace_SetSpeed(uint16_t speed)
+{
+    s_speed = (speed > 0) ? speed : 1;
+}
+
+uint8_t Trace_Read(void)
+{
+    uint32_t now = millis();
+    if (!s_started) {
+        s_startMs = now;
+        s_started = true;
+    }
+    uint32_t t = (now - s_startMs) * s_speed;
+
+    SensorData rec;
+    if (s_image) {
+        const TraceHeader* hdr = (const TraceHeader*)s_image;
+        Trace_GetRecord(s_image, t / hdr->period_ms, &rec);
+    } else {
+        Trace_Synthesize(s_gait, t, &rec);
+    }
+
+    BatteryVoltage = rec.battery;
+    Acc_Array[0] = rec.accel_x;
+    Acc_Array[1] = rec.accel_y;
+    Acc_Array[2] = rec.accel_z;
+    memcpy(Pressure_Array, rec.pressure, sizeof(rec.pressure));
+    Pressure_ValidMask = ActiveTopology::allSensors();
+    memset(Pressure_Age, 0, sizeof(Pressure_Age));
+    return TRACE_ERR_OK;
+}
+#endif
@@ -1,6 +1,7 @@
 #include "UtilitiesModule.h"
 #include <Wire.h>
 #include <Adafruit_MAX1704X.h>
+#include "esp_heap_caps.h"
 
 static Adafruit_MAX17048 maxlipo;
 uint8_t BatteryVoltage = 0;
@@ -45,6 +46,24 @@ void PackSensorData(SensorData &sensor_data) {
     
     // Copy the pressure data into the struct
     memcpy(sensor_data.pressure, Pressure_Array, sizeof(sensor_data.pressure));
+
+    // A device that went down mid-frame may have left filtered values behind: the
+    // frame must not carry them as readings, whatever the format
+    for (int dev = 0; dev < PRESSURE_ADC_COUNT; dev++) {
+        if (Pressure_DevHealth[dev].state == PRESSURE_DEV_OK) {
+            continue;
+        }
+        for (int input = 0; input < PRESSURE_CHANNELS_PER_ADC; input++) {
+            sensor_data.pressure[ActiveTopology::sensorOf(dev, input)] = PRESSURE_VALUE_DOWN;
+        }
+    }
+}
+
+// Function to pack the validity/age information that goes with the frame
+void PackSensorInfo(SensorFrameInfo &sensor_info) {
+    sensor_info.pressure_valid = Pressure_ValidMask;
+    memcpy(sensor_info.pressure_age, Pressure_Age, sizeof(sensor_info.pressure_age));
+    sensor_info.adc_healthy = Pressure_GetHealthyMask();
 }
 
 // Clear all struct fields to zero
@@ -58,7 +77,7 @@ void addDummyData(SensorData &sensor_data){
     sensor_data.accel_x = 123;
     sensor_data.accel_y = 456;
     sensor_data.accel_z = 789;
-    for (int i = 0; i < 16; i++) 
+    for (int i = 0; i < PRESSURE_CHANNEL_COUNT; i++) 
     {
         sensor_data.pressure[i] = 1000 + i;
     }
@@ -130,8 +149,9 @@ void Battery_Test(void)
     LOG_INFO("Battery test done.");
 }
 
-void i2cScanner()
+uint8_t i2cScanner(uint8_t* found, uint8_t maxFound)
 {
+    uint8_t count = 0;
     // Print initial scanner message:
     LOG_INFO("I2C Scanner: Scanning for devices...");
 
@@ -146,6 +166,10 @@ void i2cScanner()
             snprintf(tmpMsg, sizeof(tmpMsg), 
                      "I2C device found at address 0x%02X!", address);
             LOG_INFO("%s", tmpMsg);
+            if (found && count < maxFound) {
+                found[count] = address;
+            }
+            count++;
         } 
         else if (error == 4) {
             // "Other error" in Wire lib
@@ -158,4 +182,53 @@ void i2cScanner()
 
     // Print final message after the scan:
     LOG_INFO("I2C scan complete.");
-}
\ No newline at end of file
+    return count;
+}
+
+
+typedef struct {
+    TaskHandle_t handle;
+    const char*  name;
+    uint32_t     stackSize;
+} MemoryTask_t;
+
+static MemoryTask_t s_memTasks[MEMORY_MAX_TASKS];
+static uint8_t s_memTaskCount = 0;
+static size_t s_lastAllocatedBlocks = 0;
+
+void Memory_RegisterTask(TaskHandle_t handle, const char* name, uint32_t stackSize)
+{
+    if (!handle || s_memTaskCount >= MEMORY_MAX_TASKS) {
+        return;
+    }
+    s_memTasks[s_memTaskCount].handle = handle;
+    s_memTasks[s_memTaskCount].name = name;
+    s_memTasks[s_memTaskCount].stackSize = stackSize;
+    s_memTaskCount++;
+}
+
+void Memory_Report(void)
+{
+    // On ESP32 the high-water mark is in bytes: the least free stack ever seen
+    for (uint8_t i = 0; i < s_memTaskCount; i++) {
+        uint32_t freeMin = uxTaskGetStackHighWaterMark(s_memTasks[i].handle);
+        uint32_t used = s_memTasks[i].stackSize - freeMin;
+        LOG_INFO("Stack %-10s: peak %5lu / %5lu bytes (%lu%%), %lu never used",
+                 s_memTasks[i].name, (unsigned long)used, (unsigned long)s_memTasks[i].stackSize,
+                 (unsigned long)((used * 100) / s_memTasks[i].stackSize), (unsigned long)freeMin);
+    }
+
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    LOG_INFO("Heap: free %lu, largest block %lu, min free %lu bytes",
+             (unsigned long)info.total_free_bytes, (unsigned long)info.largest_free_block,
+             (unsigned long)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+
+    // Blocks in use right now, not allocations made: a count that keeps growing between
+    // reports means something allocates in a loop without freeing
+    long delta = (long)info.allocated_blocks - (long)s_lastAllocatedBlocks;
+    LOG_INFO("Heap: %lu blocks in use (%+ld since last report), %lu free blocks",
+             (unsigned long)info.allocated_blocks, s_lastAllocatedBlocks ? delta : 0L,
+             (unsigned long)info.free_blocks);
+    s_lastAllocatedBlocks = info.allocated_blocks;
+}
@@ -6,16 +6,37 @@
 #include "AccModule.h"
 #include "UtilitiesModule.h"
 #include "BluetoothModule.h"
+#include "FilterModule.h"
+#include "AlignModule.h"
+#include "TraceModule.h"
+#include "FramePoolModule.h"
+#include "LatencyModule.h"
+#include "BootModule.h"
+#include "SelfTestModule.h"
+#include "BurstModule.h"
+#include "StatsModule.h"
+#include "SerialStreamModule.h"
+#ifdef TRACE_FLASH_HEADER
+#include TRACE_FLASH_HEADER   // defines trace_image[]
+#endif
 #include "CommonTypes.h"
 
 // Globals
 
 static unsigned long s_lastTaskTime = 0; // for watchdog
 
-//Use a mutex to protect access to msg to prevent concurrent modifications
-static SemaphoreHandle_t msgMutex = xSemaphoreCreateMutex();
+// Statically allocated task stacks and control blocks (no heap at task creation)
+static StackType_t  s_loggerStack[LOGGER_TASK_STACK_SIZE];
+static StaticTask_t s_loggerTcb;
+static StackType_t  s_sensorStack[SENSOR_TASK_STACK_SIZE];
+static StaticTask_t s_sensorTcb;
+static StackType_t  s_commStack[BLE_TASK_STACK_SIZE];
+static StaticTask_t s_commTcb;
+
+// Fast boot: BLE comes up in its own one-shot task while setup() initializes the sensors
+static TaskHandle_t s_setupTaskHandle = NULL;
+static volatile bool s_bleInitOk = false;
 
-SensorData sensor_data;
 
 TaskHandle_t SensorTaskHandle = NULL;
 TaskHandle_t CommunicationTaskHandle = NULL;
@@ -24,41 +45,91 @@ TaskHandle_t LoggerTaskHandle = NULL;
 void SensorTask(void* pvParam)
 {
     TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xFrequency = pdMS_TO_TICKS(LOOP_INTERVAL_MS);
+    const TickType_t xFrequency = pdMS_TO_TICKS(TASK_LOOP_INTERVAL_MS);
     esp_task_wdt_add(NULL);
     for(;;) {
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
-          // Read sensors
-          if (BLE_GetNumOfSubscribers() > 0)
+        if (SelfTest_Active())
+        {
+            // The self-test owns the sensors; stay alive without touching them. Between
+            // frames, so the waiting self-test may start now.
+            SelfTest_AckPause();
+            esp_task_wdt_reset();
+            continue;
+        }
+          // Each frame is written once, in wire format, into a pool slot and then shared
+          FrameSlot_t* slot = FramePool_Acquire();
+          if (slot)
           {
-            if (!testDeviceBLE)
+            SensorData* frame = FramePool_AsSensorData(slot);
+            uint32_t sampleUs = micros();
+            // Read sensors
+            if (BLE_GetNumOfSubscribers() > 0 || SerialStream_Active())
             {
-                Battery_Read();
-                Acc_Read();
-                Pressure_Read();
-                //Lock data and pack it.
-                if (xSemaphoreTake(msgMutex, portMAX_DELAY)) {
-                    PackSensorData(sensor_data);
-                    xSemaphoreGive(msgMutex);
-                }
+              if (!testDeviceBLE)
+              {
+                  Battery_Read();
+                  Acc_Read();
+                  Pressure_Read();
+                  if (DSP_DECIMATION_ENABLED)
+                  {
+                      Filter_Apply();
+                  }
+                  if (ALIGN_ENABLED)
+                  {
+                      Align_Apply(sampleUs);
+                  }
+              }
+              else
+              {
+                  // Replay stands in for the three sensor reads
+                  Trace_Read();
+              }
+              PackSensorData(*frame);
+              PackSensorInfo(slot->info);
+              if (STATS_ENABLED)
+              {
+                  Stats_Update(frame, &slot->info, sampleUs);
+              }
+              if (SerialStream_Active())
+              {
+                  // Wired capture gets every frame, whatever the BLE link does
+                  SerialStream_SendFrame(frame, sampleUs);
+              }
             }
             else
             {
-                addDummyData(sensor_data);
+              // If no BLE subscribers, clear the data
+              clearSensorData(frame);
+              memset(&slot->info, 0, sizeof(slot->info));
+            }
+            slot->info.sample_us = sampleUs;
+            slot->length = sizeof(SensorData);
+            FramePool_Publish(slot);
+            Boot_MarkFirstFrame();
+            if (BURST_ENABLED)
+            {
+                // Closes a burst window the samples did not close themselves
+                Burst_Poll(micros());
+            }
+            // Hand the frame over right away instead of waiting for the comm task's own period
+            if (CommunicationTaskHandle)
+            {
+              xTaskNotifyGive(CommunicationTaskHandle);
             }
-          }
-          else
-          {
-            // If no BLE subscribers, clear the data
-            clearSensorData(&sensor_data);
           }
         if (LOG_LEVEL_SELECTED >= LOGGER_LEVEL_DEBUG)
         {
-            LoggerPrintLoopMessage(&sensor_data);
+            FrameSlot_t* latest = FramePool_BorrowLatest();
+            if (latest)
+            {
+                LoggerPrintLoopMessage(FramePool_AsSensorData(latest));
+                FramePool_Release(latest);
+            }
         }
         bool connstatus = Get_BLE_Connected_Status();
         uint8_t numSubscribers = BLE_GetNumOfSubscribers();
-        if (connstatus || (numSubscribers > 0))
+        if (connstatus || (numSubscribers > 0) || SerialStream_Active())
         {
             esp_task_wdt_reset();
         }
@@ -70,19 +141,39 @@ void SensorTask(void* pvParam)
 // 2) Communication Task
 void CommunicationTask(void* pvParam)
 {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    const TickType_t xFrequency = pdMS_TO_TICKS(LOOP_INTERVAL_MS);
+    // Frames arrive by task notification from SensorTask; the timeout only keeps the status/watchdog path alive
+    const TickType_t xTimeout = pdMS_TO_TICKS(2 * TASK_LOOP_INTERVAL_MS);
+    uint16_t retxWaiting = 0;
      esp_task_wdt_add(NULL);
     for(;;) {
 
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // Refused notifications are retried on the next wake, so wake sooner while any wait
+        uint32_t fresh = ulTaskNotifyTake(pdTRUE, retxWaiting ? pdMS_TO_TICKS(RETX_POLL_MS) : xTimeout);
         // Send via BLE
-        if (BLE_GetNumOfSubscribers() > 0) {
-            if (xSemaphoreTake(msgMutex, portMAX_DELAY)) {
-                BLE_SendBuffer(&sensor_data);
-                xSemaphoreGive(msgMutex);
+        if (fresh && BLE_GetNumOfSubscribers() > 0) {
+            // Borrow the latest frame and send it in place
+            FrameSlot_t* frame = FramePool_BorrowLatest();
+            if (frame) {
+                // Latency and the first notify are stamped when the notification actually goes out
+                BLE_SendFrame(frame->data, frame->length, &frame->info);
+                FramePool_Release(frame);
+            }
+            if (BURST_ENABLED)
+            {
+                // Captured windows go out between stream frames
+                BLE_ServiceBurst();
             }
         }
+        if (RETX_ENABLED)
+        {
+            // Buffers the controller freed since the last wake take what still waits
+            retxWaiting = BLE_ServiceRetx();
+        }
+        if (LINK_MANAGER_ENABLED)
+        {
+            // Connection parameters follow the measured load, also after the last unsubscribe
+            BLE_ServiceLink();
+        }
         bool connstatus = Get_BLE_Connected_Status();
         uint8_t numSubscribers = BLE_GetNumOfSubscribers();
         if (LOG_LEVEL_SELECTED >= LOGGER_LEVEL_DEBUG)
@@ -90,7 +181,7 @@ void CommunicationTask(void* pvParam)
             LOG_DEBUG("Connection Status: %d", connstatus);
             LOG_DEBUG("Number of Subscribers: %d", numSubscribers);
         }
-        if (connstatus || (numSubscribers > 0))
+        if (connstatus || (numSubscribers > 0) || SelfTest_Active() || SerialStream_Active())
         {
 
             if (LOG_LEVEL_SELECTED >= LOGGER_LEVEL_DEBUG)
@@ -104,29 +195,63 @@ void CommunicationTask(void* pvParam)
     
 }
 
+// One-shot BLE bring-up, runs concurrently with the sensor init in setup()
+static void BleBootTask(void* pvParam)
+{
+    s_bleInitOk = BLE_Init(g_sideFlag);
+    Boot_MarkPhase("ble");
+    xTaskNotifyGive(s_setupTaskHandle);
+    vTaskDelete(NULL);
+}
+
 // 3) The usual Arduino setup
 void setup()
 {
 
     // 1. Logger init: let’s say we want INFO logs, with serial enabled
     LoggerInit();
+    Boot_MarkPhase("logger");
     Serial.printf("Logger level set to %d\n\r", LOG_LEVEL_SELECTED);
     LOG_DEBUG("LoggerInit complete.");
     
-    LOG_DEBUG("Sampling Interval %d ms", LOOP_INTERVAL_MS);
+    LOG_DEBUG("Sampling Interval %d ms", TASK_LOOP_INTERVAL_MS);
 
     deviceResetReason();
     esp_task_wdt_init(WATCHDOG_PERIOD, true);
 
+    FramePool_Init();
+    Latency_Reset();
+
     // 2. Create logger task
-    xTaskCreate(LoggerTask, "LoggerTask", LOGGER_TASK_STACK_SIZE, NULL, 3, &LoggerTaskHandle);
+    LoggerTaskHandle = xTaskCreateStatic(LoggerTask, "LoggerTask", LOGGER_TASK_STACK_SIZE, NULL, LOGGER_TASK_PRIORITY,
+                                         s_loggerStack, &s_loggerTcb);
+    Memory_RegisterTask(LoggerTaskHandle, "LoggerTask", LOGGER_TASK_STACK_SIZE);
     LOG_DEBUG("LoggerTask setup complete.");
 
+    bool bleBootTask = false;
+    if (FAST_BOOT_ENABLED)
+    {
+      // BLE does not touch I2C, so it can come up while the sensors are probed. The stack
+      // comes from the heap and goes back to it once the task has deleted itself.
+      s_setupTaskHandle = xTaskGetCurrentTaskHandle();
+      bleBootTask = xTaskCreate(BleBootTask, "BleBoot", BOOT_BLE_TASK_STACK_SIZE, NULL, 1, NULL) == pdPASS;
+      if (!bleBootTask) {
+          LOG_WARN("BLE bring-up task not created, BLE starts after the sensors");
+      }
+    }
 
     // 3. Initialize I2C
     Wire.begin(I2C_SDA_Pin, I2C_SCL_Pin, 400000); // 400 kHz
     LOG_DEBUG("Wire.begin complete.");
-    i2cScanner();
+    if (ActiveTopology::BusCount > 1) {
+        Wire1.begin(I2C1_SDA_Pin, I2C1_SCL_Pin, 400000);
+        LOG_DEBUG("Wire1.begin complete.");
+    }
+    BootDeviceMap_t devMap;
+    Boot_DiscoverI2C(&devMap);
+    Boot_MarkPhase("i2c");
+    // Devices the discovery did not find on Wire are not probed again
+    const uint8_t* present = devMap.count ? devMap.addr : nullptr;
 
     if (!testDeviceBLE)
     {
@@ -136,44 +261,112 @@ void setup()
           LOG_ERROR("Battery init failed, continuing anyway...");
       }
       LOG_DEBUG("Battery_Init complete.");
+      Boot_MarkPhase("battery");
 
 
       // 5. Init pressure (ADS1115)
-      if (Pressure_Init() != ERR_OK) {
-          LOG_ERROR("Pressure init failed, halting!");
-          while(true) { vTaskDelay(portMAX_DELAY); }
+      if (Pressure_Init(present, devMap.count) != ERR_OK) {
+          LOG_ERROR("Pressure init incomplete, streaming healthy channels...");
       }
       LOG_DEBUG("Pressure_Init complete.");
+      Boot_MarkPhase("pressure");
 
 
       // 6. Init acceleration (ADXL345)
-      if (Acc_Init() != ERR_OK) {
+      if (Acc_Init(present, devMap.count) != ERR_OK) {
           LOG_ERROR("Accel init failed, continuing anyway...");
       }
       LOG_DEBUG("Acc_Init complete.");
+      Boot_MarkPhase("accel");
+
+      Filter_Reset();
+      Align_Reset();
 
+      if (SELFTEST_ON_BOOT)
+      {
+          // Before the tasks exist, so nothing else touches the bus; no central yet, notify is skipped
+          SelfTest_RunNow();
+          Boot_MarkPhase("selftest");
+      }
+    }
+    else
+    {
+      Trace_SetSpeed(TRACE_REPLAY_SPEED);
+#ifdef TRACE_FLASH_HEADER
+      if (Trace_Open(trace_image, sizeof(trace_image)) != TRACE_ERR_OK)
+#endif
+      {
+          Trace_UseSynthetic(TRACE_REPLAY_GAIT);
+      }
+      Boot_MarkPhase("trace");
     }
     // 7. Init BLE (sideFlag => false => left, true => right)
-    BLE_Init(g_sideFlag);
+    if (bleBootTask)
+    {
+      // Join the bring-up task started in step 2. The tasks below call into the BLE module,
+      // so they never start while BLE_Init() is still running, however long it takes.
+      if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BOOT_BLE_TIMEOUT_MS)) == 0) {
+          LOG_ERROR("BLE bring-up did not finish within %d ms, still waiting", BOOT_BLE_TIMEOUT_MS);
+          ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      }
+    }
+    else
+    {
+      s_bleInitOk = BLE_Init(g_sideFlag);
+      Boot_MarkPhase("ble");
+    }
+    if (!s_bleInitOk) {
+        LOG_ERROR("BLE_Init failed");
+    }
     LOG_DEBUG("BLE_Init complete.");
 
 
     // 8. Create tasks
-    xTaskCreate(SensorTask, "SensorTask", SENSOR_TASK_STACK_SIZE, NULL, 2, &SensorTaskHandle);
+    SensorTaskHandle = xTaskCreateStatic(SensorTask, "SensorTask", SENSOR_TASK_STACK_SIZE, NULL, 2,
+                                         s_sensorStack, &s_sensorTcb);
+    Memory_RegisterTask(SensorTaskHandle, "SensorTask", SENSOR_TASK_STACK_SIZE);
     LOG_DEBUG("SensorTask setup complete.");
 
 
-    xTaskCreate(CommunicationTask, "CommTask", BLE_TASK_STACK_SIZE, NULL, 1, &CommunicationTaskHandle);
+    CommunicationTaskHandle = xTaskCreateStatic(CommunicationTask, "CommTask", BLE_TASK_STACK_SIZE, NULL, 1,
+                                                s_commStack, &s_commTcb);
+    Memory_RegisterTask(CommunicationTaskHandle, "CommTask", BLE_TASK_STACK_SIZE);
     LOG_DEBUG("CommunicationTask setup complete.");
+    Boot_MarkPhase("tasks");
 
     
     LOG_INFO("Setup complete.");
+    Boot_PrintReport();
 
     LOG_DEBUG("SensorData size: %d bytes\n", sizeof(SensorData));
 }
 
 void loop()
 {
-    // With FreeRTOS, do nothing in loop, tasks run in parallel
-    vTaskDelay(portMAX_DELAY);
+    // With FreeRTOS, tasks run in parallel; loop runs requested self-tests and the periodic memory and latency report
+    SelfTest_Service();
+    vTaskDelay(pdMS_TO_TICKS(SELFTEST_POLL_MS));
+    if (MEMORY_REPORT_INTERVAL_MS == 0) {
+        return;
+    }
+    static bool registered = false;
+    static uint32_t lastReportMs = 0;
+    if (!registered) {
+        Memory_RegisterTask(xTaskGetCurrentTaskHandle(), "loopTask", getArduinoLoopTaskStackSize());
+        registered = true;
+        lastReportMs = millis();
+    }
+    if (millis() - lastReportMs < MEMORY_REPORT_INTERVAL_MS) {
+        return;
+    }
+    lastReportMs = millis();
+    Memory_Report();
+    // Latency percentiles per report window
+    Latency_PrintSummary();
+    Latency_Reset();
+    BLE_PrintRetxSummary();
+    BLE_PrintLinkSummary();
+    // Session statistics run until the central resets them
+    Stats_PrintSummary();
+    SerialStream_PrintSummary();
 }